@@ -29,7 +29,7 @@ void WsOutQueues::push(const Queues::ExecReportEvent &evnt, const std::string &
         // 3. Broadcast book update for subscribed sessions
         const std::string &symbol = order->instrument_.get().symbol_;
         SourceIdT instrId = order->instrument_.getId();
-        BookSnapshot snap = orderBook_->getSnapshot(instrId, orderStorage_);
+        BookSnapshot snap = orderBook_->getSnapshot(instrId);
         std::string bookJson = serializeBookUpdate(symbol, snap);
         sessionMgr_->broadcastBookUpdate(symbol, bookJson);
     }
@@ -6,6 +6,7 @@
 #include "OrderBookImpl.h"
 #include "IdTGenerator.h"
 #include "QueuesDef.h"
+#include "SourceRegistry.h"
 #include "Logger.h"
 
 #include <chrono>
@@ -18,6 +19,19 @@ using tcp = net::ip::tcp;
 using namespace COP;
 using namespace COP::App;
 
+namespace
+{
+
+/// interned once, queues resolve the handle from the registry-owned string without hashing
+const std::string &webSocketSource()
+{
+    static const std::string &source =
+        Queues::SourceRegistry::instance()->name(Queues::SourceRegistry::instance()->intern("WebSocket"));
+    return source;
+}
+
+} // namespace
+
 WsSession::WsSession(tcp::socket &&socket, SessionManager *sessionMgr, Store::WideParamsDataStorage *wideData,
                      Store::OrderDataStorage *orderStorage, Queues::InQueues *inQueues, IdTValueGenerator *idGen,
                      OrderBookImpl *orderBook)
@@ -104,6 +118,14 @@ void WsSession::handleMessage(const std::string &msgStr)
             }
         }
 
+        // wide data added below can not be released, so reject before creating it;
+        // sessions racing past this check overshoot the bound by one event each
+        if (inQueues_->full())
+        {
+            send(serializeError("Server busy, order rejected"));
+            return;
+        }
+
         // Create clOrderId RawDataEntry
         std::string clOrdStr = "WS-" + std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(
                                                           std::chrono::system_clock::now().time_since_epoch())
@@ -120,8 +142,7 @@ void WsSession::handleMessage(const std::string &msgStr)
         SourceIdT execListId = Store::WideDataStorage::instance()->add(execList);
 
         // Create source string
-        std::string srcStr = "WebSocket";
-        auto *srcStrPtr = new StringT(srcStr);
+        auto *srcStrPtr = new StringT(webSocketSource());
         SourceIdT srcId = Store::WideDataStorage::instance()->add(srcStrPtr);
 
         // Create destination string
@@ -145,13 +166,16 @@ void WsSession::handleMessage(const std::string &msgStr)
                 .count());
 
         Queues::OrderEvent evt(order);
-        inQueues_->push("WebSocket", evt);
+        inQueues_->push(webSocketSource(), evt);
     }
     else if (msg.type == "cancel_order")
     {
         IdT orderId(msg.cancelOrder.orderId, 1);
         Queues::OrderCancelEvent evt(orderId, "Canceled by user");
-        inQueues_->push("WebSocket", evt);
+        if (!inQueues_->tryPush(webSocketSource(), evt))
+        {
+            send(serializeError("Server busy, cancel rejected"));
+        }
     }
     else if (msg.type == "replace_order")
     {
@@ -182,7 +206,11 @@ void WsSession::handleMessage(const std::string &msgStr)
         }
 
         Queues::OrderReplaceEvent evt(origOrderId, replacement);
-        inQueues_->push("WebSocket", evt);
+        if (!inQueues_->tryPush(webSocketSource(), evt))
+        {
+            delete replacement;
+            send(serializeError("Server busy, replace rejected"));
+        }
     }
     else if (msg.type == "subscribe_book")
     {
@@ -192,7 +220,7 @@ void WsSession::handleMessage(const std::string &msgStr)
         SourceIdT instrId = wideData_->findInstrumentBySymbol(msg.symbol);
         if (instrId.isValid())
         {
-            BookSnapshot snap = orderBook_->getSnapshot(instrId, orderStorage_);
+            BookSnapshot snap = orderBook_->getSnapshot(instrId);
             send(serializeBookUpdate(msg.symbol, snap));
         }
     }
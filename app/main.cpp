@@ -1,8 +1,10 @@
 #include <iostream>
 #include <string>
 #include <csignal>
+#include <cstdio>
 #include <memory>
 #include <thread>
+#include <algorithm>
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/signal_set.hpp>
@@ -18,7 +20,11 @@
 #include "Processor.h"
 #include "TaskManager.h"
 #include "LMDBStorage.h"
+#include "LMDBWriteBehind.h"
+#include "SegmentedLogStorage.h"
 #include "StorageRecordDispatcher.h"
+#include "StorageRecovery.h"
+#include "StorageSnapshot.h"
 
 #include "SessionManager.h"
 #include "WsServer.h"
@@ -38,6 +44,16 @@ struct Config
     std::string dataDir = "./data";
     int workers = 0;
     int cpuAffinityStart = -1; // -1 = disabled, >= 0 = pin starting from this core
+    unsigned eventBatch = 32;  // events drained per event task
+    unsigned trBatch = 16;     // ready transactions executed and removed together
+    bool busyPoll = false;     // pinned polling workers instead of TBB tasks
+    unsigned spinIterations = 10000;
+    unsigned persistBatch = 256;   // records per LMDB write transaction
+    unsigned persistDelayUs = 200; // writer waits this long for a batch to fill
+    Store::LMDBStorageParams::DurabilityMode durability = Store::LMDBStorageParams::FULL_SYNC_DURABILITY;
+    size_t mapSizeMb = 256; // initial LMDB map size, doubles when full
+    unsigned snapshotIntervalSec = 0; // 0 = no snapshots, restart scans the whole storage
+    bool logStorage = false;          // segmented append-only log instead of LMDB
     bool hugePages = false;
 };
 
@@ -63,6 +79,74 @@ Config parseArgs(int argc, char *argv[])
         {
             cfg.cpuAffinityStart = std::stoi(argv[++i]);
         }
+        else if (arg == "--event-batch" && i + 1 < argc)
+        {
+            cfg.eventBatch = static_cast<unsigned>(std::max(1, std::stoi(argv[++i])));
+        }
+        else if (arg == "--tr-batch" && i + 1 < argc)
+        {
+            cfg.trBatch = static_cast<unsigned>(std::max(1, std::stoi(argv[++i])));
+        }
+        else if (arg == "--busy-poll")
+        {
+            cfg.busyPoll = true;
+        }
+        else if (arg == "--spin-iterations" && i + 1 < argc)
+        {
+            cfg.spinIterations = static_cast<unsigned>(std::max(0, std::stoi(argv[++i])));
+        }
+        else if (arg == "--persist-batch" && i + 1 < argc)
+        {
+            cfg.persistBatch = static_cast<unsigned>(std::max(1, std::stoi(argv[++i])));
+        }
+        else if (arg == "--persist-delay-us" && i + 1 < argc)
+        {
+            cfg.persistDelayUs = static_cast<unsigned>(std::max(0, std::stoi(argv[++i])));
+        }
+        else if (arg == "--durability" && i + 1 < argc)
+        {
+            std::string mode = argv[++i];
+            if (mode == "full")
+            {
+                cfg.durability = Store::LMDBStorageParams::FULL_SYNC_DURABILITY;
+            }
+            else if (mode == "nometasync")
+            {
+                cfg.durability = Store::LMDBStorageParams::NO_META_SYNC_DURABILITY;
+            }
+            else if (mode == "nosync")
+            {
+                cfg.durability = Store::LMDBStorageParams::NO_SYNC_DURABILITY;
+            }
+            else if (mode == "writemap")
+            {
+                cfg.durability = Store::LMDBStorageParams::WRITE_MAP_ASYNC_DURABILITY;
+            }
+            else
+            {
+                std::cerr << "Unknown --durability mode '" << mode << "', using full" << std::endl;
+            }
+        }
+        else if (arg == "--map-size-mb" && i + 1 < argc)
+        {
+            cfg.mapSizeMb = static_cast<size_t>(std::max(1, std::stoi(argv[++i])));
+        }
+        else if (arg == "--snapshot-interval-sec" && i + 1 < argc)
+        {
+            cfg.snapshotIntervalSec = static_cast<unsigned>(std::max(0, std::stoi(argv[++i])));
+        }
+        else if (arg == "--storage" && i + 1 < argc)
+        {
+            std::string engine = argv[++i];
+            if (engine == "log")
+            {
+                cfg.logStorage = true;
+            }
+            else if (engine != "lmdb")
+            {
+                std::cerr << "Unknown --storage engine '" << engine << "', using lmdb" << std::endl;
+            }
+        }
         else if (arg == "--huge-pages")
         {
             cfg.hugePages = true;
@@ -85,7 +169,10 @@ int main(int argc, char *argv[])
 
     Store::WideDataStorage::create();
     IdTGenerator::create();
-    Store::OrderStorage::create();
+    // orders are kept in huge pages as well, regular pages are used if there are none
+    Store::OrderSlabParams slabParams;
+    slabParams.hugePages_ = cfg.hugePages;
+    Store::OrderStorage::create(slabParams);
 
     aux::ExchLogger::instance()->note("OrderProcessor WebSocket Server starting...");
 
@@ -119,15 +206,71 @@ int main(int argc, char *argv[])
         }
     }
 
-    // 2. Create LMDB storage and record dispatcher
-    auto lmdbStorage = std::make_unique<Store::LMDBStorage>();
-    auto dispatcher = std::make_unique<Store::StorageRecordDispatcher>();
-
-    // Phase 1: Load reference data (instruments, accounts, strings) — orderBook is null
-    dispatcher->init(Store::WideDataStorage::instance(), nullptr, lmdbStorage.get(), Store::OrderStorage::instance());
-    lmdbStorage->load(cfg.dataDir, dispatcher.get());
+    // 2. Create the storage and recover its content. LMDB loads the latest snapshot
+    // plus the journal after it, or scans the storage once; the log scans its segments.
+    // Reference data is restored by the load, decoded orders wait for the order book
+    Store::LMDBStorageParams storageParams;
+    storageParams.durability_ = cfg.durability;
+    storageParams.mapSize_ = cfg.mapSizeMb * 1024UL * 1024UL;
+    storageParams.journal_ = !cfg.logStorage && (0 < cfg.snapshotIntervalSec);
+    const std::string snapshotPath = cfg.dataDir + "/snapshot.cop";
+    std::unique_ptr<Store::LMDBStorage> lmdbStorage;
+    std::unique_ptr<Store::SegmentedLogStorage> logStorage;
+    auto recovery =
+        std::make_unique<Store::StorageRecovery>(Store::WideDataStorage::instance(), Store::OrderStorage::instance());
+    u64 snapshotSequence = 0;
+    if (cfg.logStorage)
+    {
+        if (0 < cfg.snapshotIntervalSec)
+        {
+            aux::ExchLogger::instance()->warn("--snapshot-interval-sec is ignored by the log storage");
+        }
+        // every mode but full syncs in the background, as LMDB does
+        Store::SegmentedLogParams logParams;
+        logParams.syncOnCommit_ = (Store::LMDBStorageParams::FULL_SYNC_DURABILITY == cfg.durability);
+        logParams.compactionIntervalMs_ = 10000;
+        logStorage = std::make_unique<Store::SegmentedLogStorage>(logParams);
+        logStorage->load(cfg.dataDir + "/log", recovery.get());
+    }
+    else if (!storageParams.journal_)
+    {
+        lmdbStorage = std::make_unique<Store::LMDBStorage>(storageParams);
+        // snapshot is not followed by the journal of the records saved since
+        std::remove(snapshotPath.c_str());
+        lmdbStorage->load(cfg.dataDir, recovery.get());
+    }
+    else
+    {
+        lmdbStorage = std::make_unique<Store::LMDBStorage>(storageParams);
+        bool snapshotLoaded = false;
+        recovery->startLoad();
+        try
+        {
+            snapshotLoaded = Store::StorageSnapshot::load(snapshotPath, recovery.get(), &snapshotSequence);
+        }
+        catch (const std::exception &ex)
+        {
+            // the storage still holds every record, the full scan restarts the recovery
+            aux::ExchLogger::instance()->error(std::string("Snapshot is damaged, falling back to the full scan: ") +
+                                               ex.what());
+        }
+        if (snapshotLoaded)
+        {
+            lmdbStorage->open(cfg.dataDir);
+            const u64 lastSequence = lmdbStorage->replay(snapshotSequence, recovery.get());
+            recovery->finishLoad();
+            aux::ExchLogger::instance()->note("Snapshot loaded, journal replayed from " +
+                                              std::to_string(snapshotSequence) + " to " +
+                                              std::to_string(lastSequence));
+        }
+        else
+        {
+            lmdbStorage->load(cfg.dataDir, recovery.get());
+        }
+    }
 
-    aux::ExchLogger::instance()->note("Phase 1 LMDB load complete (reference data)");
+    aux::ExchLogger::instance()->note("Storage load complete (reference data restored, " +
+                                      std::to_string(recovery->pendingOrders()) + " orders decoded)");
 
     // 3. Collect instrument IDs and init OrderBook
     OrderBookImpl::InstrumentsT instrumentIds;
@@ -138,21 +281,41 @@ int main(int argc, char *argv[])
         });
 
     auto orderBook = std::make_unique<OrderBookImpl>();
+    auto dispatcher = std::make_unique<Store::StorageRecordDispatcher>();
 
-    // 4. Phase 2: Create fresh LMDB + dispatcher with orderBook for order restoration
-    lmdbStorage.reset();
-    lmdbStorage = std::make_unique<Store::LMDBStorage>();
-    dispatcher = std::make_unique<Store::StorageRecordDispatcher>();
-    dispatcher->init(Store::WideDataStorage::instance(), orderBook.get(), lmdbStorage.get(),
-                     Store::OrderStorage::instance());
+    // Records saved while running are committed in batches by the write-behind thread,
+    // the log commits records of concurrent callers together itself
+    std::unique_ptr<Store::LMDBWriteBehind> writeBehind;
+    Store::FileSaver *saver = logStorage.get();
+    if (lmdbStorage)
+    {
+        Store::LMDBWriteBehindParams writeBehindParams;
+        writeBehindParams.maxBatchSize_ = cfg.persistBatch;
+        writeBehindParams.maxDelayUs_ = cfg.persistDelayUs;
+        writeBehind = std::make_unique<Store::LMDBWriteBehind>(lmdbStorage.get(), writeBehindParams);
+        saver = writeBehind.get();
+    }
+    dispatcher->init(Store::WideDataStorage::instance(), orderBook.get(), saver, Store::OrderStorage::instance());
+
+    std::unique_ptr<Store::StorageSnapshotter> snapshotter;
+    if (storageParams.journal_)
+    {
+        Store::StorageSnapshotParams snapshotParams;
+        snapshotParams.path_ = snapshotPath;
+        snapshotParams.intervalSec_ = cfg.snapshotIntervalSec;
+        snapshotter = std::make_unique<Store::StorageSnapshotter>(lmdbStorage.get(), writeBehind.get(),
+                                                                  Store::WideDataStorage::instance(),
+                                                                  Store::OrderStorage::instance(), snapshotParams);
+    }
 
     // Init order book with loaded instruments — need the dispatcher as OrderSaver
     orderBook->init(instrumentIds, dispatcher.get());
 
-    // Reload LMDB — this time orders will be restored into OrderBook
-    lmdbStorage->load(cfg.dataDir, dispatcher.get());
+    // 4. Restore decoded orders into OrderStorage and OrderBook in bulk
+    recovery->restoreOrders(orderBook.get());
+    recovery.reset();
 
-    aux::ExchLogger::instance()->note("Phase 2 LMDB load complete (orders restored)");
+    aux::ExchLogger::instance()->note("Order recovery complete");
 
     // 5. Bind dispatcher as saver for WideDataStorage
     Store::WideDataStorage::instance()->bindStorage(dispatcher.get());
@@ -200,6 +363,13 @@ int main(int argc, char *argv[])
     taskParams.evntProcessors_ = evntProcessors;
     taskParams.inQueues_ = inQueues.get();
     taskParams.cpuAffinityStart_ = cfg.cpuAffinityStart;
+    taskParams.eventBatchSize_ = cfg.eventBatch;
+    taskParams.transactionBatchSize_ = cfg.trBatch;
+    if (cfg.busyPoll)
+    {
+        taskParams.executionMode_ = Tasks::TaskManagerParams::BUSY_POLL_EXECUTION;
+        taskParams.spinIterations_ = cfg.spinIterations;
+    }
 
     auto taskMgr = std::make_unique<Tasks::TaskManager>(taskParams);
 
@@ -256,7 +426,10 @@ int main(int argc, char *argv[])
     sessionMgr.reset();
     orderBook.reset();
     dispatcher.reset();
+    snapshotter.reset();
+    writeBehind.reset();
     lmdbStorage.reset();
+    logStorage.reset();
 
     // Destroy singletons in reverse order
     Store::OrderStorage::destroy();
@@ -167,6 +167,10 @@ static void BM_QueuePopEvents(benchmark::State &state)
         {
             return false;
         }
+        u32 processBatch(u32) override
+        {
+            return 0;
+        }
         void onEvent(const std::string &, const OrderEvent &) override
         {
             ++count_;
@@ -278,6 +282,10 @@ static void BM_QueueThroughput(benchmark::State &state)
             {
                 return false;
             }
+            u32 processBatch(u32) override
+            {
+                return 0;
+            }
             void onEvent(const std::string &, const OrderEvent &) override {}
             void onEvent(const std::string &, const OrderCancelEvent &) override {}
             void onEvent(const std::string &, const OrderReplaceEvent &) override {}
@@ -296,6 +304,88 @@ static void BM_QueueThroughput(benchmark::State &state)
 }
 BENCHMARK(BM_QueueThroughput)->Range(64, 4096);
 
+static void BM_QueueThroughputBatchDrain(benchmark::State &state)
+{
+    BenchmarkSetup setup;
+    IncomingQueues queues;
+    const int batchSize = state.range(0);
+
+    class NullProcessor : public InQueueProcessor
+    {
+    public:
+        bool process() override
+        {
+            return false;
+        }
+        u32 processBatch(u32) override
+        {
+            return 0;
+        }
+        void onEvent(const std::string &, const OrderEvent &) override {}
+        void onEvent(const std::string &, const OrderCancelEvent &) override {}
+        void onEvent(const std::string &, const OrderReplaceEvent &) override {}
+        void onEvent(const std::string &, const OrderChangeStateEvent &) override {}
+        void onEvent(const std::string &, const ProcessEvent &) override {}
+        void onEvent(const std::string &, const TimerEvent &) override {}
+    };
+    NullProcessor processor;
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < batchSize; ++i)
+        {
+            TimerEvent event;
+            queues.push("source", event);
+        }
+
+        // Drain the whole burst with one call
+        queues.popBatch(&processor, static_cast<u32>(batchSize));
+    }
+    state.SetItemsProcessed(state.iterations() * batchSize * 2);
+}
+BENCHMARK(BM_QueueThroughputBatchDrain)->Range(64, 4096);
+
+static void BM_QueueThroughputRingBuffer(benchmark::State &state)
+{
+    BenchmarkSetup setup;
+    // capacity equals the burst, so the producer never waits
+    IncomingQueues queues(IncomingQueues::RING_BUFFER_INGRESS, static_cast<size_t>(state.range(0)));
+    const int batchSize = state.range(0);
+
+    class NullProcessor : public InQueueProcessor
+    {
+    public:
+        bool process() override
+        {
+            return false;
+        }
+        u32 processBatch(u32) override
+        {
+            return 0;
+        }
+        void onEvent(const std::string &, const OrderEvent &) override {}
+        void onEvent(const std::string &, const OrderCancelEvent &) override {}
+        void onEvent(const std::string &, const OrderReplaceEvent &) override {}
+        void onEvent(const std::string &, const OrderChangeStateEvent &) override {}
+        void onEvent(const std::string &, const ProcessEvent &) override {}
+        void onEvent(const std::string &, const TimerEvent &) override {}
+    };
+    NullProcessor processor;
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < batchSize; ++i)
+        {
+            TimerEvent event;
+            queues.push("source", event);
+        }
+
+        queues.popBatch(&processor, static_cast<u32>(batchSize));
+    }
+    state.SetItemsProcessed(state.iterations() * batchSize * 2);
+}
+BENCHMARK(BM_QueueThroughputRingBuffer)->Range(64, 4096);
+
 // =============================================================================
 // Mixed Event Types Benchmark
 // =============================================================================
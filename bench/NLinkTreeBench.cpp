@@ -0,0 +1,145 @@
+/**
+ * Concurrent Order Processor library - Google Benchmark
+ *
+ * NLinkTree benchmarks: add/remove of independent transactions and of
+ * transactions chained through shared orders and instruments, with a
+ * window of in-flight transactions like the TransactionMgr keeps.
+ */
+
+#include <benchmark/benchmark.h>
+#include <deque>
+
+#include "NLinkedTree.h"
+#include "TransactionDef.h"
+#include "Logger.h"
+
+using namespace aux;
+using namespace COP;
+using namespace COP::ACID;
+
+namespace
+{
+
+const u32 BENCH_DATE = 20260119;
+
+/// NLinkTree logs through the ExchLogger singleton
+class TreeBenchmarkSetup
+{
+public:
+    TreeBenchmarkSetup()
+    {
+        ExchLogger::create();
+        ExchLogger::instance()->setDebugOn(false);
+    }
+
+    ~TreeBenchmarkSetup()
+    {
+        ExchLogger::destroy();
+    }
+};
+
+/// transaction touching one order, its instrument and a new execution
+void fillDependencies(u64 seq, u64 orders, u64 instruments, DependObjs *deps)
+{
+    deps->size_ = 0;
+    deps->list_[deps->size_++] = ObjectInTransaction(order_ObjectType, IdT(1 + seq % orders, BENCH_DATE));
+    deps->list_[deps->size_++] = ObjectInTransaction(instrument_ObjectType, IdT(1 + seq % instruments, BENCH_DATE));
+    deps->list_[deps->size_++] = ObjectInTransaction(execution_ObjectType, IdT(1 + seq, BENCH_DATE));
+}
+
+} // namespace
+
+// =============================================================================
+// Independent Transactions
+// =============================================================================
+
+static void BM_NLinkTreeAddRemoveIndependent(benchmark::State &state)
+{
+    TreeBenchmarkSetup setup;
+    NLinkTree tree;
+    DependObjs deps;
+    u64 seq = 0;
+    int ready = 0;
+
+    for (auto _ : state)
+    {
+        const IdT key(++seq, BENCH_DATE);
+        deps.size_ = 1;
+        deps.list_[0] = ObjectInTransaction(order_ObjectType, key);
+        tree.add(key, nullptr, deps, &ready);
+        tree.remove(key, &ready);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NLinkTreeAddRemoveIndependent);
+
+// =============================================================================
+// Chained Transactions With In-Flight Window
+// =============================================================================
+
+static void BM_NLinkTreeAddRemoveChained(benchmark::State &state)
+{
+    const size_t window = static_cast<size_t>(state.range(0));
+    const u64 orders = 64;
+    const u64 instruments = 4;
+
+    TreeBenchmarkSetup setup;
+    NLinkTree tree;
+    DependObjs deps;
+    std::deque<IdT> inFlight;
+    u64 seq = 0;
+    int ready = 0;
+
+    for (auto _ : state)
+    {
+        ++seq;
+        fillDependencies(seq, orders, instruments, &deps);
+        const IdT key(seq, BENCH_DATE);
+        tree.add(key, nullptr, deps, &ready);
+        inFlight.push_back(key);
+        if (window < inFlight.size())
+        {
+            // oldest transaction has no parents left, as TransactionMgr would remove it
+            tree.remove(inFlight.front(), &ready);
+            inFlight.pop_front();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NLinkTreeAddRemoveChained)->Arg(8)->Arg(64)->Arg(512);
+
+// =============================================================================
+// Ready Traversal
+// =============================================================================
+
+static void BM_NLinkTreeNextReady(benchmark::State &state)
+{
+    const u64 pending = static_cast<u64>(state.range(0));
+    TreeBenchmarkSetup setup;
+    NLinkTree tree;
+    DependObjs deps;
+    int ready = 0;
+    for (u64 i = 1; i <= pending; ++i)
+    {
+        deps.size_ = 1;
+        deps.list_[0] = ObjectInTransaction(order_ObjectType, IdT(i, BENCH_DATE));
+        tree.add(IdT(i, BENCH_DATE), nullptr, deps, &ready);
+    }
+
+    K key;
+    V value = nullptr;
+    for (auto _ : state)
+    {
+        // walks the whole ready list, next() fails once it passed the last node
+        u64 visited = 0;
+        const IdT first(1, BENCH_DATE);
+        key = first;
+        while (tree.next(key, &key, &value))
+        {
+            ++visited;
+        }
+        benchmark::DoNotOptimize(visited);
+    }
+    state.SetItemsProcessed(state.iterations() * pending);
+}
+BENCHMARK(BM_NLinkTreeNextReady)->Arg(16)->Arg(256);
@@ -0,0 +1,139 @@
+/**
+ * Concurrent Order Processor library - Google Benchmark
+ *
+ * OrderCodec benchmarks: the '.'-delimited format 1 record against the
+ * fixed-layout format 2 record, encoding and decoding.
+ */
+
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+
+#include "OrderCodec.h"
+#include "WideDataStorage.h"
+#include "Logger.h"
+
+using namespace COP;
+using namespace COP::Codec;
+using namespace COP::Store;
+
+namespace
+{
+
+/// order resolves its instrument through WideDataStorage
+class CodecBenchmarkSetup
+{
+public:
+    CodecBenchmarkSetup()
+    {
+        aux::ExchLogger::create();
+        WideDataStorage::create();
+
+        auto instr = new InstrumentEntry();
+        instr->symbol_ = "BENCH";
+        instr->securityId_ = "BENCHSEC";
+        instr->securityIdSource_ = "ISIN";
+        instrId_ = WideDataStorage::instance()->add(instr);
+    }
+
+    ~CodecBenchmarkSetup()
+    {
+        WideDataStorage::destroy();
+        aux::ExchLogger::destroy();
+    }
+
+    SourceIdT instrId_;
+};
+
+std::unique_ptr<OrderEntry> createBenchOrder(const SourceIdT &instrId)
+{
+    std::unique_ptr<OrderEntry> order(new OrderEntry(SourceIdT(1, 1), SourceIdT(2, 2), SourceIdT(3, 3),
+                                                     SourceIdT(4, 4), instrId, SourceIdT(6, 6), SourceIdT(7, 7),
+                                                     SourceIdT(8, 8)));
+    order->orderId_ = IdT(4444, 20260119);
+    order->price_ = 22.22;
+    order->status_ = NEW_ORDSTATUS;
+    order->side_ = BUY_SIDE;
+    order->ordType_ = LIMIT_ORDERTYPE;
+    order->tif_ = DAY_TIF;
+    order->orderQty_ = 1000;
+    order->leavesQty_ = 1000;
+    return order;
+}
+
+} // namespace
+
+// =============================================================================
+// Encoding
+// =============================================================================
+
+static void BM_OrderEncodeDelimited(benchmark::State &state)
+{
+    CodecBenchmarkSetup setup;
+    std::unique_ptr<OrderEntry> order = createBenchOrder(setup.instrId_);
+    IdT id;
+    u32 version = 0;
+
+    for (auto _ : state)
+    {
+        std::string buf;
+        OrderCodec::encodeDelimited(*order, &buf, &id, &version);
+        benchmark::DoNotOptimize(buf.data());
+    }
+}
+BENCHMARK(BM_OrderEncodeDelimited);
+
+static void BM_OrderEncodeRecord(benchmark::State &state)
+{
+    CodecBenchmarkSetup setup;
+    std::unique_ptr<OrderEntry> order = createBenchOrder(setup.instrId_);
+    // stands for the value reserved by LMDB
+    char reserved[OrderCodec::RECORD_SIZE];
+    IdT id;
+    u32 version = 0;
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(OrderCodec::encode(*order, reserved, &id, &version));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_OrderEncodeRecord);
+
+// =============================================================================
+// Decoding
+// =============================================================================
+
+static void BM_OrderDecodeDelimited(benchmark::State &state)
+{
+    CodecBenchmarkSetup setup;
+    std::unique_ptr<OrderEntry> order = createBenchOrder(setup.instrId_);
+    std::string buf;
+    IdT id;
+    u32 version = 0;
+    OrderCodec::encodeDelimited(*order, &buf, &id, &version);
+
+    for (auto _ : state)
+    {
+        std::unique_ptr<OrderEntry> decoded(OrderCodec::decode(id, version, buf.data(), buf.size()));
+        benchmark::DoNotOptimize(decoded.get());
+    }
+}
+BENCHMARK(BM_OrderDecodeDelimited);
+
+static void BM_OrderDecodeRecord(benchmark::State &state)
+{
+    CodecBenchmarkSetup setup;
+    std::unique_ptr<OrderEntry> order = createBenchOrder(setup.instrId_);
+    std::string buf;
+    IdT id;
+    u32 version = 0;
+    OrderCodec::encode(*order, &buf, &id, &version);
+
+    for (auto _ : state)
+    {
+        std::unique_ptr<OrderEntry> decoded(OrderCodec::decode(id, version, buf.data(), buf.size()));
+        benchmark::DoNotOptimize(decoded.get());
+    }
+}
+BENCHMARK(BM_OrderDecodeRecord);
@@ -38,7 +38,7 @@ namespace
 class OrderBookBenchmarkSetup
 {
 public:
-    OrderBookBenchmarkSetup()
+    explicit OrderBookBenchmarkSetup(OrderBookImpl::BookType type = OrderBookImpl::MULTIMAP_BOOKTYPE)
     {
         aux::ExchLogger::create();
         WideDataStorage::create();
@@ -56,7 +56,7 @@ public:
         OrderBookImpl::InstrumentsT instruments;
         instruments.insert(instrId_);
         orderBook_ = std::make_unique<OrderBookImpl>();
-        orderBook_->init(instruments, &orderSaver_);
+        orderBook_->init(instruments, &orderSaver_, type);
     }
 
     ~OrderBookBenchmarkSetup()
@@ -347,3 +347,85 @@ static void BM_OrderBookWorstCaseAdd(benchmark::State &state)
     state.SetItemsProcessed(state.iterations());
 }
 BENCHMARK(BM_OrderBookWorstCaseAdd)->Range(8, 8 << 10);
+
+// =============================================================================
+// Order Book Cancel-Heavy Flow Benchmarks
+// =============================================================================
+
+/// 90% of the flow cancels a random resting order and replaces it, the other 10%
+/// removes the top of the book as a fill would. Book depth stays constant.
+/// Arg 0: book type (MULTIMAP_BOOKTYPE / PRICELEVEL_BOOKTYPE), arg 1: resting orders.
+static void BM_OrderBookCancelHeavy(benchmark::State &state)
+{
+    OrderBookBenchmarkSetup setup(static_cast<OrderBookImpl::BookType>(state.range(0)));
+    const int64_t depth = state.range(1);
+    std::mt19937 gen(42);
+    // 20 price levels, so each level queues many orders
+    std::uniform_int_distribution<> levelDist(0, 19);
+
+    std::vector<OrderEntry *> resting;
+    resting.reserve(depth);
+    for (int64_t i = 0; i < depth; ++i)
+    {
+        OrderEntry *order = setup.createOrder(BUY_SIDE, 100.0 - levelDist(gen) * 0.01, 100);
+        setup.orderBook_->add(*order);
+        resting.push_back(order);
+    }
+
+    int64_t cancels = 0;
+    for (auto _ : state)
+    {
+        if (0 != gen() % 10)
+        {
+            size_t idx = gen() % resting.size();
+            OrderEntry *order = resting[idx];
+            setup.orderBook_->remove(*order);
+            order->price_ = 100.0 - levelDist(gen) * 0.01;
+            setup.orderBook_->add(*order);
+            ++cancels;
+        }
+        else
+        {
+            IdT topId = setup.orderBook_->getTop(setup.instrId_, BUY_SIDE);
+            OrderEntry *order = OrderStorage::instance()->locateByOrderId(topId);
+            setup.orderBook_->remove(*order);
+            setup.orderBook_->add(*order);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["cancels"] = benchmark::Counter(static_cast<double>(cancels), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_OrderBookCancelHeavy)
+    ->ArgNames({"book", "depth"})
+    ->Args({OrderBookImpl::MULTIMAP_BOOKTYPE, 1000})
+    ->Args({OrderBookImpl::PRICELEVEL_BOOKTYPE, 1000})
+    ->Args({OrderBookImpl::MULTIMAP_BOOKTYPE, 10000})
+    ->Args({OrderBookImpl::PRICELEVEL_BOOKTYPE, 10000});
+
+// =============================================================================
+// Order Book Snapshot Benchmarks
+// =============================================================================
+
+/// Top-10 snapshot of a book with the given number of resting orders per side.
+static void BM_OrderBookSnapshotTop10(benchmark::State &state)
+{
+    OrderBookBenchmarkSetup setup(static_cast<OrderBookImpl::BookType>(state.range(0)));
+    for (int64_t i = 0; i < state.range(1); ++i)
+    {
+        setup.orderBook_->add(*setup.createOrder(BUY_SIDE, 100.0 - (i % 100) * 0.01, 100));
+        setup.orderBook_->add(*setup.createOrder(SELL_SIDE, 101.0 + (i % 100) * 0.01, 100));
+    }
+
+    for (auto _ : state)
+    {
+        BookSnapshot snap = setup.orderBook_->getSnapshot(setup.instrId_, 10);
+        benchmark::DoNotOptimize(snap);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_OrderBookSnapshotTop10)
+    ->ArgNames({"book", "depth"})
+    ->Args({OrderBookImpl::MULTIMAP_BOOKTYPE, 1000})
+    ->Args({OrderBookImpl::PRICELEVEL_BOOKTYPE, 1000})
+    ->Args({OrderBookImpl::MULTIMAP_BOOKTYPE, 10000})
+    ->Args({OrderBookImpl::PRICELEVEL_BOOKTYPE, 10000});
@@ -3,18 +3,23 @@
  *
  * OrderParams hot/cold field layout benchmarks: measures sequential
  * access latency for hot-path fields vs cold fields to validate
- * the cache-line-aware struct reordering.
+ * the cache-line-aware struct reordering, and the matching scan over
+ * OrderEntry fields vs the hot RestingOrder fields kept by the book.
  */
 
 #include <benchmark/benchmark.h>
 #include <vector>
+#include <cstdio>
 #include <cstring>
 #include <memory>
 
 #include "DataModelDef.h"
+#include "OrderBookImpl.h"
+#include "OrderStorage.h"
 #include "WideDataStorage.h"
 #include "IdTGenerator.h"
 #include "Logger.h"
+#include "TestAux.h"
 
 using namespace COP;
 using namespace COP::Store;
@@ -91,6 +96,100 @@ public:
     }
 };
 
+/// Sell side of one instrument filled with resting orders kept in OrderStorage
+class MatchScanSetup
+{
+public:
+    MatchScanSetup(OrderBookImpl::BookType type, int count)
+    {
+        aux::ExchLogger::create();
+        WideDataStorage::create();
+        IdTGenerator::create();
+        OrderStorage::create();
+
+        auto *instr = new InstrumentEntry();
+        instr->symbol_ = "BENCH";
+        instr->securityId_ = "B1";
+        instr->securityIdSource_ = "SRC";
+        instrId_ = WideDataStorage::instance()->add(instr);
+
+        OrderBookImpl::InstrumentsT instruments;
+        instruments.insert(instrId_);
+        book_.init(instruments, &saver_, type);
+
+        // four orders per level
+        for (int i = 0; i < count; ++i)
+        {
+            char buf[32];
+            snprintf(buf, sizeof(buf), "SCAN%d", i);
+            SourceIdT srcId, destId, origClOrdId, accountId, clearingId, execList;
+            SourceIdT clOrdId = WideDataStorage::instance()->add(
+                new RawDataEntry(STRING_RAWDATATYPE, buf, static_cast<u32>(strlen(buf))));
+            OrderEntry order(srcId, destId, clOrdId, origClOrdId, instrId_, accountId, clearingId, execList);
+            order.side_ = SELL_SIDE;
+            order.price_ = 100.0 + (i / 4) * 0.01;
+            order.orderQty_ = 1000;
+            order.leavesQty_ = 1000;
+            order.ordType_ = LIMIT_ORDERTYPE;
+            order.status_ = NEW_ORDSTATUS;
+            order.tif_ = DAY_TIF;
+            book_.add(*OrderStorage::instance()->save(order, IdTGenerator::instance()));
+        }
+    }
+
+    ~MatchScanSetup()
+    {
+        OrderStorage::destroy();
+        IdTGenerator::destroy();
+        WideDataStorage::destroy();
+        aux::ExchLogger::destroy();
+    }
+
+    SourceIdT instrId_;
+    test::DummyOrderSaver saver_;
+    OrderBookImpl book_;
+};
+
+/// Walks the sell side with a buy limit below every resting price, so the whole side is visited.
+/// Entry layout reads the matching fields through RestingOrder::order_ as the
+/// match by OrderEntry does, resting layout only the hot fields of the book.
+class ScanFunctor : public OrderFunctor
+{
+public:
+    ScanFunctor(const SourceIdT &instr, bool readEntry) : instr_(instr), readEntry_(readEntry), visited_(0)
+    {
+        side_ = SELL_SIDE;
+    }
+
+    SourceIdT instrument() const override
+    {
+        return instr_;
+    }
+    bool match(const IdT &, bool *) const override
+    {
+        return false;
+    }
+    bool matchResting(const RestingOrder &order, bool *stop) const override
+    {
+        ++visited_;
+        *stop = false;
+        if (readEntry_)
+        {
+            const OrderEntry *entry = order.order_;
+            oneapi::tbb::spin_rw_mutex::scoped_lock lock(entry->entryMutex_, false);
+            benchmark::DoNotOptimize(entry->status_);
+            benchmark::DoNotOptimize(entry->tif_);
+            benchmark::DoNotOptimize(entry->cumQty_);
+            return (LIMIT_ORDERTYPE == entry->ordType_) && (entry->price_ <= 99.0) && (0 < entry->leavesQty_);
+        }
+        return (LIMIT_ORDERTYPE == order.ordType_) && (order.price_ <= 99.0) && (0 < order.leavesQty_);
+    }
+
+    SourceIdT instr_;
+    bool readEntry_;
+    mutable int visited_;
+};
+
 } // namespace
 
 // =============================================================================
@@ -228,3 +327,39 @@ static void BM_OrderParamsSizeInfo(benchmark::State &state)
     state.counters["alignof_OrderParams"] = static_cast<double>(alignof(OrderParams));
 }
 BENCHMARK(BM_OrderParamsSizeInfo);
+
+// =============================================================================
+// Matching Scan (OrderEntry fields vs hot RestingOrder fields of the book)
+// =============================================================================
+
+static void matchScan(benchmark::State &state, bool readEntry)
+{
+    const int count = static_cast<int>(state.range(0));
+    const OrderBookImpl::BookType type =
+        (0 == state.range(1)) ? OrderBookImpl::MULTIMAP_BOOKTYPE : OrderBookImpl::PRICELEVEL_BOOKTYPE;
+    MatchScanSetup setup(type, count);
+    ScanFunctor functor(setup.instrId_, readEntry);
+
+    for (auto _ : state)
+    {
+        IdT found = setup.book_.find(functor);
+        benchmark::DoNotOptimize(found);
+    }
+    if (count != functor.visited_ / static_cast<int>(state.iterations()))
+    {
+        state.SkipWithError("walk did not visit every resting order");
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+static void BM_MatchScanOrderEntry(benchmark::State &state)
+{
+    matchScan(state, true);
+}
+BENCHMARK(BM_MatchScanOrderEntry)->ArgsProduct({ { 256, 4096, 65536 }, { 0, 1 } });
+
+static void BM_MatchScanRestingOrder(benchmark::State &state)
+{
+    matchScan(state, false);
+}
+BENCHMARK(BM_MatchScanRestingOrder)->ArgsProduct({ { 256, 4096, 65536 }, { 0, 1 } });
@@ -0,0 +1,139 @@
+/**
+ * Concurrent Order Processor library - Google Benchmark
+ *
+ * Persistence benchmarks: synchronous LMDBStorage saves under every
+ * durability mode, saves queued through LMDBWriteBehind and saves
+ * appended to SegmentedLogStorage.
+ */
+
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <string>
+
+#include "LMDBStorage.h"
+#include "LMDBWriteBehind.h"
+#include "SegmentedLogStorage.h"
+#include "Logger.h"
+
+using namespace aux;
+using namespace COP;
+using namespace COP::Store;
+
+namespace
+{
+
+const u32 BENCH_DATE = 20260119;
+const size_t RECORD_SIZE = 256;
+
+/// LMDBWriteBehind reports failures through the ExchLogger singleton,
+/// the storage directory is removed when the benchmark finishes
+class PersistenceBenchmarkSetup
+{
+public:
+    explicit PersistenceBenchmarkSetup(const char *name)
+        : path_((std::filesystem::temp_directory_path() / name).string())
+    {
+        ExchLogger::create();
+        ExchLogger::instance()->setDebugOn(false);
+        std::filesystem::remove_all(path_);
+    }
+
+    ~PersistenceBenchmarkSetup()
+    {
+        std::filesystem::remove_all(path_);
+        ExchLogger::destroy();
+    }
+
+    const std::string &path() const
+    {
+        return path_;
+    }
+
+private:
+    std::string path_;
+};
+
+class NullObserver : public FileStorageObserver
+{
+public:
+    void startLoad() override {}
+    void onRecordLoaded(const IdT &, u32, const char *, size_t) override {}
+    void finishLoad() override {}
+};
+
+} // namespace
+
+// =============================================================================
+// Synchronous Saves
+// =============================================================================
+
+static void BM_LMDBSave(benchmark::State &state)
+{
+    PersistenceBenchmarkSetup setup("cop_persistence_bench_sync");
+    LMDBStorageParams params;
+    params.durability_ = static_cast<LMDBStorageParams::DurabilityMode>(state.range(0));
+    NullObserver observer;
+    LMDBStorage storage(setup.path(), &observer, params);
+    const std::string record(RECORD_SIZE, 'r');
+    u64 seq = 0;
+
+    for (auto _ : state)
+    {
+        storage.save(IdT(++seq, BENCH_DATE), record.data(), record.size());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LMDBSave)
+    ->Arg(LMDBStorageParams::FULL_SYNC_DURABILITY)
+    ->Arg(LMDBStorageParams::NO_META_SYNC_DURABILITY)
+    ->Arg(LMDBStorageParams::NO_SYNC_DURABILITY)
+    ->Arg(LMDBStorageParams::WRITE_MAP_ASYNC_DURABILITY);
+
+// =============================================================================
+// Write-Behind Saves
+// =============================================================================
+
+static void BM_LMDBWriteBehindSave(benchmark::State &state)
+{
+    PersistenceBenchmarkSetup setup("cop_persistence_bench_async");
+    NullObserver observer;
+    LMDBStorage storage(setup.path(), &observer);
+    LMDBWriteBehindParams params;
+    params.maxBatchSize_ = static_cast<u32>(state.range(0));
+    LMDBWriteBehind writer(&storage, params);
+    const std::string record(RECORD_SIZE, 'r');
+    u64 seq = 0;
+
+    for (auto _ : state)
+    {
+        writer.save(IdT(++seq, BENCH_DATE), record.data(), record.size());
+    }
+    // throughput counts the commit of everything queued
+    writer.flush();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LMDBWriteBehindSave)->Arg(16)->Arg(256);
+
+// =============================================================================
+// Segmented Log Saves
+// =============================================================================
+
+/// Arg: 1 - every save is synced, 0 - the log is synced in the background
+static void BM_SegmentedLogSave(benchmark::State &state)
+{
+    PersistenceBenchmarkSetup setup("cop_persistence_bench_log");
+    SegmentedLogParams params;
+    params.syncOnCommit_ = (0 != state.range(0));
+    NullObserver observer;
+    SegmentedLogStorage storage(setup.path(), &observer, params);
+    const std::string record(RECORD_SIZE, 'r');
+    u64 seq = 0;
+
+    for (auto _ : state)
+    {
+        storage.save(IdT(++seq, BENCH_DATE), record.data(), record.size());
+    }
+    storage.sync();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SegmentedLogSave)->Arg(1)->Arg(0);
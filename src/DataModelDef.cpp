@@ -199,9 +199,9 @@ OrderParams::OrderParams(const SourceIdT &dest, const SourceIdT &instrument, con
       ordType_(INVALID_ORDERTYPE), leavesQty_(0), cumQty_(0), orderQty_(0), tif_(INVALID_TIF), stopPx_(0.0),
       avgPx_(0.0), dayAvgPx_(0.0), creationTime_(0), lastUpdateTime_(0), expireTime_(0), settlDate_(0),
       settlType_(INVALID_SETTLTYPE), capacity_(INVALID_CAPACITY), currency_(INVALID_CURRENCY), minQty_(0),
-      dayOrderQty_(0), dayCumQty_(0), instrument_(instrument), account_(account), clearing_(clearing),
-      destination_(dest), execInstruct_(), clOrderId_(clOrderId), origClOrderId_(origClOrderID), source_(source),
-      executions_(executions)
+      dayOrderQty_(0), dayCumQty_(0), sourceHandle_(Queues::INVALID_SOURCE_HANDLE), instrument_(instrument),
+      account_(account), clearing_(clearing), destination_(dest), execInstruct_(), clOrderId_(clOrderId),
+      origClOrderId_(origClOrderID), source_(source), executions_(executions)
 {
     instrument_.load();
 }
@@ -212,11 +212,15 @@ OrderParams::OrderParams(const OrderParams &ord)
       orderQty_(ord.orderQty_), tif_(ord.tif_), stopPx_(ord.stopPx_), avgPx_(ord.avgPx_), dayAvgPx_(ord.dayAvgPx_),
       creationTime_(ord.creationTime_), lastUpdateTime_(ord.lastUpdateTime_), expireTime_(ord.expireTime_),
       settlDate_(ord.settlDate_), settlType_(ord.settlType_), capacity_(ord.capacity_), currency_(ord.currency_),
-      minQty_(ord.minQty_), dayOrderQty_(ord.dayOrderQty_), dayCumQty_(ord.dayCumQty_), instrument_(ord.instrument_),
-      account_(ord.account_), clearing_(ord.clearing_), destination_(ord.destination_),
-      execInstruct_(ord.execInstruct_), clOrderId_(ord.clOrderId_), origClOrderId_(ord.origClOrderId_),
-      source_(ord.source_), executions_(ord.executions_)
-{
+      minQty_(ord.minQty_), dayOrderQty_(ord.dayOrderQty_), dayCumQty_(ord.dayCumQty_),
+      stateMachinePersistance_(ord.stateMachinePersistance_), sourceHandle_(ord.sourceHandle_),
+      instrument_(ord.instrument_), account_(ord.account_), clearing_(ord.clearing_),
+      destination_(ord.destination_), execInstruct_(ord.execInstruct_),
+      clOrderId_(ord.clOrderId_), origClOrderId_(ord.origClOrderId_), source_(ord.source_),
+      executions_(ord.executions_)
+{
+    // state zones are copied, the copy is not bound to the state machine of the original
+    stateMachinePersistance_.orderData_ = nullptr;
     instrument_.load();
 }
 
@@ -486,7 +490,7 @@ ExecParams::ExecParams()
 
 ExecParams::ExecParams(const ExecParams &param)
     : type_(param.type_), transactTime_(param.transactTime_), orderId_(param.orderId_), execId_(param.execId_),
-      orderStatus_(param.orderStatus_)
+      orderStatus_(param.orderStatus_), market_(param.market_)
 {
 }
 
@@ -502,7 +506,7 @@ ExecutionEntry::ExecutionEntry(const ExecParams &param) : ExecParams(param) {}
 
 ExecutionEntry *ExecutionEntry::clone() const
 {
-    return new ExecutionEntry();
+    return new ExecutionEntry(*this);
 }
 
 TradeExecEntry::TradeExecEntry() {}
@@ -521,20 +525,20 @@ ExecutionEntry *TradeExecEntry::clone() const
 
 ExecutionEntry *RejectExecEntry::clone() const
 {
-    return new RejectExecEntry;
+    return new RejectExecEntry(*this);
 }
 
 ExecutionEntry *ExecCorrectExecEntry::clone() const
 {
-    return new ExecCorrectExecEntry;
+    return new ExecCorrectExecEntry(*this);
 }
 
 ExecutionEntry *ReplaceExecEntry::clone() const
 {
-    return new ReplaceExecEntry;
+    return new ReplaceExecEntry(*this);
 }
 
 ExecutionEntry *TradeCancelExecEntry::clone() const
 {
-    return new TradeCancelExecEntry;
+    return new TradeCancelExecEntry(*this);
 }
@@ -233,14 +233,18 @@ public:
 
     OrdState::OrderStatePersistence stateMachinePersistance_;
 
+    /// source_ interned in Queues::SourceRegistry, resolved on the first report
+    /// under the entry lock and not persisted
+    Queues::SourceHandle sourceHandle_;
+
     // --- Cold fields (lazy-loaded, rarely accessed after init) ---
-    WideDataLazyRef<InstrumentEntry> instrument_; //136
-    WideDataLazyRef<AccountEntry> account_;       //112
-    WideDataLazyRef<ClearingEntry> clearing_;     //72
-    WideDataLazyRef<StringT> destination_;        //~32 + 24
-    InstructionSetT execInstruct_;                //28
+    WideDataLazyRef<InstrumentEntry> instrument_; //24
+    WideDataLazyRef<AccountEntry> account_;
+    WideDataLazyRef<ClearingEntry> clearing_;
+    WideDataLazyRef<StringT> destination_;
+    InstructionSetT execInstruct_; //28
 
-    WideDataLazyRef<RawDataEntry> clOrderId_; //56
+    WideDataLazyRef<RawDataEntry> clOrderId_;
     WideDataLazyRef<RawDataEntry> origClOrderId_;
     WideDataLazyRef<StringT> source_;
 
@@ -276,6 +280,24 @@ private:
     const OrderEntry &operator=(const OrderEntry &);
 };
 
+/// Hot fields of the resting order, kept by the order book next to its price
+/// so the book walk does not have to locate and lock every OrderEntry it visits.
+struct RestingOrder
+{
+    IdT orderId_;
+    PriceT price_;
+    QuantityT leavesQty_;
+    OrderType ordType_;
+    OrderEntry *order_;
+
+    RestingOrder() : orderId_(), price_(0.0), leavesQty_(0), ordType_(INVALID_ORDERTYPE), order_(nullptr) {}
+    explicit RestingOrder(const OrderEntry &order)
+        : orderId_(order.orderId_), price_(order.price_), leavesQty_(order.leavesQty_), ordType_(order.ordType_),
+          order_(const_cast<OrderEntry *>(&order))
+    {
+    }
+};
+
 class OrderFunctor
 {
 public:
@@ -286,6 +308,11 @@ public:
         return side_;
     }
     virtual bool match(const IdT &order, bool *stop) const = 0;
+    /// called by the book for every resting order visited, by default matches by orderId
+    virtual bool matchResting(const RestingOrder &order, bool *stop) const
+    {
+        return match(order.orderId_, stop);
+    }
 
 protected:
     Side side_;
@@ -300,12 +327,21 @@ public:
 
     virtual void add(const OrderEntry &order) = 0;
     virtual void remove(const OrderEntry &order) = 0;
+    /// refreshes leavesQty of the resting order after trade or correction, no-op if order is not in the book
+    virtual void update(const OrderEntry &order) = 0;
     virtual IdT find(const OrderFunctor &functor) const = 0;
     virtual void findAll(const OrderFunctor &functor, OrdersT *result) const = 0;
 
     virtual IdT getTop(const SourceIdT &instrument, const Side &side) const = 0;
 
     virtual void restore(const OrderEntry &order) = 0;
+
+    /// true if the stored order rests in the book; canceled and replaced orders keep leavesQty
+    /// but are removed from the book, so only the status tells them apart
+    static bool isResting(const OrderEntry &order)
+    {
+        return ((NEW_ORDSTATUS == order.status_) || (PARTFILL_ORDSTATUS == order.status_)) && (0 < order.leavesQty_);
+    }
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -418,6 +454,8 @@ class OrderSaver
 public:
     virtual ~OrderSaver() {};
     virtual void save(const OrderEntry &order) = 0;
+    /// called once for every saved execution, executions are not persisted by default
+    virtual void save(const ExecutionEntry & /*exec*/) {}
 };
 
 } // namespace COP
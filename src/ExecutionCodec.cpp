@@ -0,0 +1,211 @@
+/**
+ Concurrent Order Processor library
+
+ Author: Sergey Mikhailik
+
+ Copyright (C) 2009-2026 Sergey Mikhailik
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#include <bit>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include "ExecutionCodec.h"
+
+using namespace std;
+using namespace COP;
+using namespace COP::Codec;
+
+namespace
+{
+const u32 EXECUTION_RECORD_MAGIC = 0x31434558; // "XEC1"
+const u32 EXECUTION_RECORD_FORMAT = 1;
+
+static_assert(std::endian::native == std::endian::little, "ExecutionRecord layout is little-endian!");
+static_assert(std::is_trivially_copyable<ExecutionRecord>::value, "ExecutionRecord should be POD!");
+static_assert(136 == sizeof(ExecutionRecord), "ExecutionRecord layout is changed, increase EXECUTION_RECORD_FORMAT!");
+
+void writeId(const IdT &id, ExecutionRecord::RecordId *rec)
+{
+    rec->id_ = id.id_;
+    rec->date_ = id.date_;
+    rec->reserved_ = 0;
+}
+
+IdT readId(const ExecutionRecord::RecordId &rec)
+{
+    return IdT(rec.id_, rec.date_);
+}
+
+void writeTrade(const ExecTradeParams &trade, ExecutionRecord *rec)
+{
+    rec->lastQty_ = trade.lastQty_;
+    rec->currency_ = static_cast<i32>(trade.currency_);
+    rec->lastPx_ = trade.lastPx_;
+    rec->tradeDate_ = trade.tradeDate_;
+}
+
+void readTrade(const ExecutionRecord &rec, ExecTradeParams *trade)
+{
+    trade->lastQty_ = rec.lastQty_;
+    trade->currency_ = static_cast<Currency>(rec.currency_);
+    trade->lastPx_ = rec.lastPx_;
+    trade->tradeDate_ = rec.tradeDate_;
+}
+
+} // namespace
+
+ExecutionCodec::ExecutionCodec(void) {}
+
+ExecutionCodec::~ExecutionCodec(void) {}
+
+void ExecutionCodec::encode(const ExecutionEntry &val, std::string *buf, IdT *id, u32 *version)
+{
+    assert(nullptr != buf);
+    assert(nullptr != id);
+    assert(nullptr != version);
+
+    *id = val.execId_;
+    *version = 0;
+
+    ExecutionRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.magic_ = EXECUTION_RECORD_MAGIC;
+    rec.formatVersion_ = EXECUTION_RECORD_FORMAT;
+    rec.kind_ = ExecutionRecord::PLAIN_KIND;
+    rec.type_ = static_cast<i32>(val.type_);
+    rec.transactTime_ = val.transactTime_;
+    writeId(val.orderId_, &rec.orderId_);
+    writeId(val.execId_, &rec.execId_);
+    rec.orderStatus_ = static_cast<i32>(val.orderStatus_);
+    rec.marketSize_ = static_cast<u32>(val.market_.size());
+
+    const StringT *reason = nullptr;
+    if (const TradeExecEntry *trade = dynamic_cast<const TradeExecEntry *>(&val))
+    {
+        rec.kind_ = ExecutionRecord::TRADE_KIND;
+        writeTrade(*trade, &rec);
+    }
+    else if (const RejectExecEntry *reject = dynamic_cast<const RejectExecEntry *>(&val))
+    {
+        rec.kind_ = ExecutionRecord::REJECT_KIND;
+        reason = &reject->rejectReason_;
+        rec.reasonSize_ = static_cast<u32>(reason->size());
+    }
+    else if (const ExecCorrectExecEntry *correct = dynamic_cast<const ExecCorrectExecEntry *>(&val))
+    {
+        rec.kind_ = ExecutionRecord::CORRECT_KIND;
+        rec.lastQty_ = correct->lastQty_;
+        rec.currency_ = static_cast<i32>(correct->currency_);
+        rec.lastPx_ = correct->lastPx_;
+        rec.tradeDate_ = correct->tradeDate_;
+        rec.cumQty_ = correct->cumQty_;
+        rec.leavesQty_ = correct->leavesQty_;
+        writeId(correct->execRefId_, &rec.execRefId_);
+        writeId(correct->origOrderId_, &rec.origOrderId_);
+    }
+    else if (const ReplaceExecEntry *replace = dynamic_cast<const ReplaceExecEntry *>(&val))
+    {
+        rec.kind_ = ExecutionRecord::REPLACE_KIND;
+        writeId(replace->origOrderId_, &rec.origOrderId_);
+    }
+    else if (const TradeCancelExecEntry *cancel = dynamic_cast<const TradeCancelExecEntry *>(&val))
+    {
+        rec.kind_ = ExecutionRecord::TRADE_CANCEL_KIND;
+        writeId(cancel->execRefId_, &rec.execRefId_);
+    }
+
+    buf->reserve(buf->size() + sizeof(rec) + rec.marketSize_ + rec.reasonSize_);
+    buf->append(reinterpret_cast<const char *>(&rec), sizeof(rec));
+    buf->append(val.market_);
+    if (nullptr != reason)
+    {
+        buf->append(*reason);
+    }
+}
+
+ExecutionEntry *ExecutionCodec::decode(const IdT &id, u32 /*version*/, const char *buf, size_t size)
+{
+    assert(nullptr != buf);
+
+    ExecutionRecord rec;
+    if (size < sizeof(rec))
+    {
+        throw std::runtime_error("Invalid format of the encoded ExecutionEntry - size less than required!");
+    }
+    memcpy(&rec, buf, sizeof(rec));
+    if ((EXECUTION_RECORD_MAGIC != rec.magic_) || (EXECUTION_RECORD_FORMAT != rec.formatVersion_))
+    {
+        throw std::runtime_error("Invalid format of the encoded ExecutionEntry - unknown record format!");
+    }
+    if (size != sizeof(rec) + static_cast<size_t>(rec.marketSize_) + rec.reasonSize_)
+    {
+        throw std::runtime_error("Invalid format of the encoded ExecutionEntry - record size differs from expected!");
+    }
+
+    std::unique_ptr<ExecutionEntry> val;
+    switch (rec.kind_)
+    {
+    case ExecutionRecord::PLAIN_KIND:
+        val.reset(new ExecutionEntry());
+        break;
+    case ExecutionRecord::TRADE_KIND:
+    {
+        std::unique_ptr<TradeExecEntry> trade(new TradeExecEntry());
+        readTrade(rec, trade.get());
+        val.reset(trade.release());
+    }
+    break;
+    case ExecutionRecord::REJECT_KIND:
+    {
+        std::unique_ptr<RejectExecEntry> reject(new RejectExecEntry());
+        reject->rejectReason_.assign(buf + sizeof(rec) + rec.marketSize_, rec.reasonSize_);
+        val.reset(reject.release());
+    }
+    break;
+    case ExecutionRecord::CORRECT_KIND:
+    {
+        std::unique_ptr<ExecCorrectExecEntry> correct(new ExecCorrectExecEntry());
+        correct->lastQty_ = rec.lastQty_;
+        correct->currency_ = static_cast<Currency>(rec.currency_);
+        correct->lastPx_ = rec.lastPx_;
+        correct->tradeDate_ = rec.tradeDate_;
+        correct->cumQty_ = rec.cumQty_;
+        correct->leavesQty_ = rec.leavesQty_;
+        correct->execRefId_ = readId(rec.execRefId_);
+        correct->origOrderId_ = readId(rec.origOrderId_);
+        val.reset(correct.release());
+    }
+    break;
+    case ExecutionRecord::REPLACE_KIND:
+    {
+        std::unique_ptr<ReplaceExecEntry> replace(new ReplaceExecEntry());
+        replace->origOrderId_ = readId(rec.origOrderId_);
+        val.reset(replace.release());
+    }
+    break;
+    case ExecutionRecord::TRADE_CANCEL_KIND:
+    {
+        std::unique_ptr<TradeCancelExecEntry> cancel(new TradeCancelExecEntry());
+        cancel->execRefId_ = readId(rec.execRefId_);
+        val.reset(cancel.release());
+    }
+    break;
+    default:
+        throw std::runtime_error("Invalid format of the encoded ExecutionEntry - unknown execution kind!");
+    };
+
+    val->type_ = static_cast<ExecType>(rec.type_);
+    val->transactTime_ = rec.transactTime_;
+    val->orderId_ = readId(rec.orderId_);
+    val->execId_ = id;
+    val->orderStatus_ = static_cast<OrderStatus>(rec.orderStatus_);
+    val->market_.assign(buf + sizeof(rec), rec.marketSize_);
+    return val.release();
+}
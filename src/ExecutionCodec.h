@@ -0,0 +1,88 @@
+/**
+ Concurrent Order Processor library
+
+ Author: Sergey Mikhailik
+
+ Copyright (C) 2009-2026 Sergey Mikhailik
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#pragma once
+
+#include "TypesDef.h"
+#include "DataModelDef.h"
+
+namespace COP
+{
+namespace Codec
+{
+
+/// Fixed part of the encoded execution, little-endian.
+/// Followed by market_ (marketSize_ bytes) and the reject reason (reasonSize_ bytes).
+/// Fields the kind of the execution does not have are zero.
+struct ExecutionRecord
+{
+    enum Kind
+    {
+        INVALID_KIND = 0,
+        PLAIN_KIND,
+        TRADE_KIND,
+        REJECT_KIND,
+        CORRECT_KIND,
+        REPLACE_KIND,
+        TRADE_CANCEL_KIND
+    };
+
+    struct RecordId
+    {
+        u64 id_;
+        u32 date_;
+        u32 reserved_;
+    };
+
+    u32 magic_;
+    u32 formatVersion_;
+    u32 kind_;
+    i32 type_;
+
+    u64 transactTime_;
+    RecordId orderId_;
+    RecordId execId_;
+    i32 orderStatus_;
+    u32 marketSize_;
+
+    /// trade and correct
+    u32 lastQty_;
+    i32 currency_;
+    double lastPx_;
+    u64 tradeDate_;
+    /// correct
+    u32 cumQty_;
+    u32 leavesQty_;
+    /// execRefId_ of correct and trade cancel
+    RecordId execRefId_;
+    /// origOrderId_ of correct and replace
+    RecordId origOrderId_;
+
+    /// reject
+    u32 reasonSize_;
+    u32 padding_;
+};
+
+class ExecutionCodec
+{
+public:
+    ExecutionCodec(void);
+    ~ExecutionCodec(void);
+
+public:
+    static void encode(const ExecutionEntry &val, std::string *buf, IdT *id, u32 *version);
+    /// returns the execution of the kind it was encoded from
+    static ExecutionEntry *decode(const IdT &id, u32 version, const char *buf, size_t size);
+};
+
+} // namespace Codec
+} // namespace COP
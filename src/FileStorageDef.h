@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "TypesDef.h"
 
 namespace COP
@@ -26,6 +28,16 @@ namespace Store
 
 class FileStorageObserver;
 
+/// writes the record straight into the buffer reserved by the storage
+class RecordEncoder
+{
+public:
+    virtual ~RecordEncoder() {}
+
+    /// fills exactly size bytes of buf
+    virtual void encode(char *buf, size_t size) const = 0;
+};
+
 /// interface to the file storage. allows to save records to the file or load, remove from file
 class FileSaver
 {
@@ -47,6 +59,15 @@ public:
     virtual void erase(const IdT &id, u32 version) = 0;
     /// erases all versions of record from file
     virtual void erase(const IdT &id) = 0;
+
+    /// saves record of the known size encoded by the encoder,
+    /// storages able to reserve the value let the encoder write into it
+    virtual void saveReserved(const IdT &id, size_t size, const RecordEncoder &encoder)
+    {
+        std::vector<char> buf(size);
+        encoder.encode(buf.data(), size);
+        save(id, buf.data(), size);
+    }
 };
 
 /// observer for the storage loader. handles loaded records and start/end loading events
@@ -66,6 +87,9 @@ class DataStorageRestore
 public:
     virtual ~DataStorageRestore() {}
 
+    /// restores between these calls may become visible together at finishRestore()
+    virtual void startRestore() {}
+    virtual void finishRestore() {}
     virtual void restore(InstrumentEntry *val) = 0;
     virtual void restore(const IdT &id, StringT *val) = 0;
     virtual void restore(RawDataEntry *val) = 0;
@@ -11,6 +11,7 @@
 */
 
 #include <cassert>
+#include <stdexcept>
 #include "IncomingQueues.h"
 #include "DataModelDef.h"
 #include "Logger.h"
@@ -19,8 +20,20 @@ using namespace std;
 using namespace COP;
 using namespace COP::Queues;
 
-IncomingQueues::IncomingQueues(void) : processor_(nullptr), observer_(nullptr), queueSize_(0)
+IncomingQueues::IncomingQueues(IngressBackend backend, size_t ringCapacity)
+    : processor_(nullptr), observer_(nullptr), sources_(SourceRegistry::instance()), backend_(backend),
+      backpressureCount_(0), overflowCount_(0), overflowSize_(0), queueSize_(0)
 {
+    switch (backend_)
+    {
+    case CONCURRENT_QUEUE_INGRESS:
+        break;
+    case RING_BUFFER_INGRESS:
+        ring_ = std::make_unique<BoundedRingBuffer<QueuedEvent>>(ringCapacity);
+        break;
+    default:
+        throw std::runtime_error("IncomingQueues: unsupported ingress backend!");
+    }
     aux::ExchLogger::instance()->note("IncomingQueues created.");
 }
 
@@ -60,6 +73,11 @@ InQueuesObserver *IncomingQueues::detach()
     return observer_.exchange(nullptr);
 }
 
+bool IncomingQueues::full() const
+{
+    return (RING_BUFFER_INGRESS == backend_) && (ring_->capacity() <= queueSize_.load(std::memory_order_acquire));
+}
+
 u32 IncomingQueues::size() const
 {
     return queueSize_.load(std::memory_order_acquire);
@@ -83,7 +101,7 @@ bool IncomingQueues::top(InQueueProcessor *obs)
     }
 
     // Try to get a new event from the queue
-    if (!eventQueue_.try_pop(event))
+    if (!dequeue(event))
     {
         return false;
     }
@@ -118,7 +136,7 @@ bool IncomingQueues::pop()
 
     // No pending event, try to pop directly from queue
     QueuedEvent event;
-    if (!eventQueue_.try_pop(event))
+    if (!dequeue(event))
     {
         return false;
     }
@@ -154,7 +172,7 @@ bool IncomingQueues::pop(InQueueProcessor *obs)
     // If no pending event, try to get from queue
     if (!hasPendingEvent)
     {
-        if (!eventQueue_.try_pop(event))
+        if (!dequeue(event))
         {
             return false;
         }
@@ -173,8 +191,152 @@ bool IncomingQueues::pop(InQueueProcessor *obs)
     return true;
 }
 
-void IncomingQueues::dispatchEvent(InQueueProcessor *obs, const std::string &source, const EventVariant &event)
+u32 IncomingQueues::popBatch(InQueueProcessor *obs, u32 maxEvents)
+{
+    assert(nullptr != obs);
+
+    /// publishes the amount of popped events once per batch, also when dispatch throws
+    struct PoppedGuard
+    {
+        CacheAlignedAtomic<u32> &queueSize_;
+        u32 popped_;
+
+        ~PoppedGuard()
+        {
+            if (0 < popped_)
+            {
+                queueSize_.fetch_sub(popped_, std::memory_order_release);
+            }
+        }
+    } guard{ queueSize_, 0 };
+
+    if (0 == maxEvents)
+    {
+        return 0;
+    }
+
+    QueuedEvent event;
+    bool hasEvent = false;
+
+    // Pending event from top() goes first, the lock is taken once per batch
+    {
+        oneapi::tbb::spin_mutex::scoped_lock lock(pendingLock_);
+        if (pendingEvent_.has_value())
+        {
+            event = std::move(pendingEvent_.value());
+            pendingEvent_.reset();
+            hasEvent = true;
+        }
+    }
+
+    while (guard.popped_ < maxEvents)
+    {
+        if (!hasEvent && !dequeue(event))
+        {
+            break;
+        }
+        hasEvent = false;
+        ++guard.popped_;
+
+        // Handle OrderEvent memory - ensure cleanup after dispatch
+        std::unique_ptr<OrderEntry> ordCleanup;
+        if (auto *orderEvt = std::get_if<OrderEvent>(&event.event_))
+        {
+            ordCleanup.reset(orderEvt->order_);
+        }
+
+        dispatchEvent(obs, event.source_, event.event_);
+    }
+    return guard.popped_;
+}
+
+void IncomingQueues::enqueue(QueuedEvent &&event)
+{
+    if (RING_BUFFER_INGRESS != backend_)
+    {
+        eventQueue_.push(std::move(event));
+        return;
+    }
+    // while anything is spilled, events follow it into the overflow to keep FIFO
+    if ((0 == overflowSize_.load(std::memory_order_acquire)) && ring_->tryPush(std::move(event))) [[likely]]
+    {
+        return;
+    }
+    // push() is also called by transactions running on the consumer threads,
+    // waiting here for a free slot could stall every consumer, so spill instead
+    overflowCount_.fetch_add(1, std::memory_order_relaxed);
+    if (aux::ExchLogger::instance()->isDebugOn())
+    {
+        aux::ExchLogger::instance()->debug("IncomingQueues ring is full, event goes to the overflow queue.");
+    }
+    spill(std::move(event));
+}
+
+void IncomingQueues::spill(QueuedEvent &&event)
+{
+    // counted before the push, so the overflow is never seen empty while the event is on its way
+    overflowSize_.fetch_add(1, std::memory_order_acq_rel);
+    eventQueue_.push(std::move(event));
+}
+
+bool IncomingQueues::tryEnqueue(QueuedEvent &&event)
+{
+    if (RING_BUFFER_INGRESS != backend_)
+    {
+        eventQueue_.push(std::move(event));
+        return true;
+    }
+    // overflowed events count against the bound as well
+    if (ring_->capacity() > queueSize_.load(std::memory_order_acquire))
+    {
+        if (0 < overflowSize_.load(std::memory_order_acquire))
+        {
+            spill(std::move(event));
+            return true;
+        }
+        if (ring_->tryPush(std::move(event)))
+        {
+            return true;
+        }
+    }
+    backpressureCount_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void IncomingQueues::onEnqueued()
+{
+    queueSize_.fetch_add(1, std::memory_order_release);
+
+    InQueuesObserver *obs = observer_.load(std::memory_order_acquire);
+    if (nullptr != obs)
+    {
+        obs->onNewEvent();
+    }
+}
+
+bool IncomingQueues::dequeue(QueuedEvent &event)
+{
+    if (RING_BUFFER_INGRESS != backend_)
+    {
+        return eventQueue_.try_pop(event);
+    }
+    // ring goes first, events are spilled only after it filled up and nothing
+    // enters the ring until the overflow is drained
+    if (ring_->tryPop(event))
+    {
+        return true;
+    }
+    if (eventQueue_.try_pop(event))
+    {
+        overflowSize_.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    }
+    return false;
+}
+
+void IncomingQueues::dispatchEvent(InQueueProcessor *obs, SourceHandle sourceHandle, const EventVariant &event)
 {
+    const std::string &source = sources_->name(sourceHandle);
     std::visit(
         [obs, &source](auto &&evt)
         {
@@ -211,75 +373,79 @@ void IncomingQueues::push(const std::string &source, const OrderEvent &evnt)
 {
     std::unique_ptr<OrderEntry> ord(evnt.order_);
 
-    eventQueue_.push(QueuedEvent(source, evnt));
+    enqueue(QueuedEvent(sources_->intern(source), evnt));
     ord.release();
-    queueSize_.fetch_add(1, std::memory_order_release);
-
-    InQueuesObserver *obs = observer_.load(std::memory_order_acquire);
-    if (nullptr != obs)
-    {
-        obs->onNewEvent();
-    }
+    onEnqueued();
 }
 
 void IncomingQueues::push(const std::string &source, const OrderCancelEvent &evnt)
 {
-    eventQueue_.push(QueuedEvent(source, evnt));
-    queueSize_.fetch_add(1, std::memory_order_release);
-
-    InQueuesObserver *obs = observer_.load(std::memory_order_acquire);
-    if (nullptr != obs)
-    {
-        obs->onNewEvent();
-    }
+    enqueue(QueuedEvent(sources_->intern(source), evnt));
+    onEnqueued();
 }
 
 void IncomingQueues::push(const std::string &source, const OrderReplaceEvent &evnt)
 {
-    eventQueue_.push(QueuedEvent(source, evnt));
-    queueSize_.fetch_add(1, std::memory_order_release);
-
-    InQueuesObserver *obs = observer_.load(std::memory_order_acquire);
-    if (nullptr != obs)
-    {
-        obs->onNewEvent();
-    }
+    enqueue(QueuedEvent(sources_->intern(source), evnt));
+    onEnqueued();
 }
 
 void IncomingQueues::push(const std::string &source, const OrderChangeStateEvent &evnt)
 {
-    eventQueue_.push(QueuedEvent(source, evnt));
-    queueSize_.fetch_add(1, std::memory_order_release);
+    enqueue(QueuedEvent(sources_->intern(source), evnt));
+    onEnqueued();
+}
 
-    InQueuesObserver *obs = observer_.load(std::memory_order_acquire);
-    if (nullptr != obs)
+void IncomingQueues::push(const std::string &source, const ProcessEvent &evnt)
+{
+    enqueue(QueuedEvent(sources_->intern(source), evnt));
+    onEnqueued();
+}
+
+void IncomingQueues::push(const std::string &source, const TimerEvent &evnt)
+{
+    enqueue(QueuedEvent(sources_->intern(source), evnt));
+    onEnqueued();
+}
+
+bool IncomingQueues::tryPush(const std::string &source, const OrderEvent &evnt)
+{
+    if (!tryEnqueue(QueuedEvent(sources_->intern(source), evnt)))
     {
-        obs->onNewEvent();
+        return false;
     }
+    onEnqueued();
+    return true;
 }
 
-void IncomingQueues::push(const std::string &source, const ProcessEvent &evnt)
+bool IncomingQueues::tryPush(const std::string &source, const OrderCancelEvent &evnt)
 {
-    eventQueue_.push(QueuedEvent(source, evnt));
-    queueSize_.fetch_add(1, std::memory_order_release);
-
-    InQueuesObserver *obs = observer_.load(std::memory_order_acquire);
-    if (nullptr != obs)
+    if (!tryEnqueue(QueuedEvent(sources_->intern(source), evnt)))
     {
-        obs->onNewEvent();
+        return false;
     }
+    onEnqueued();
+    return true;
 }
 
-void IncomingQueues::push(const std::string &source, const TimerEvent &evnt)
+bool IncomingQueues::tryPush(const std::string &source, const OrderReplaceEvent &evnt)
 {
-    eventQueue_.push(QueuedEvent(source, evnt));
-    queueSize_.fetch_add(1, std::memory_order_release);
+    if (!tryEnqueue(QueuedEvent(sources_->intern(source), evnt)))
+    {
+        return false;
+    }
+    onEnqueued();
+    return true;
+}
 
-    InQueuesObserver *obs = observer_.load(std::memory_order_acquire);
-    if (nullptr != obs)
+bool IncomingQueues::tryPush(const std::string &source, const OrderChangeStateEvent &evnt)
+{
+    if (!tryEnqueue(QueuedEvent(sources_->intern(source), evnt)))
     {
-        obs->onNewEvent();
+        return false;
     }
+    onEnqueued();
+    return true;
 }
 
 void IncomingQueues::clear()
@@ -301,7 +467,7 @@ void IncomingQueues::clear()
 
     // Drain the queue and cleanup OrderEntry pointers
     QueuedEvent event;
-    while (eventQueue_.try_pop(event))
+    while (dequeue(event))
     {
         if (auto *orderEvt = std::get_if<OrderEvent>(&event.event_))
         {
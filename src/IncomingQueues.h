@@ -13,6 +13,7 @@
 #pragma once
 
 #include <atomic>
+#include <memory>
 #include <optional>
 #include <variant>
 #include <oneapi/tbb/concurrent_queue.h>
@@ -20,6 +21,8 @@
 
 #include "QueuesDef.h"
 #include "CacheAlignedAtomic.h"
+#include "SourceRegistry.h"
+#include "RingBuffer.h"
 
 namespace COP
 {
@@ -29,9 +32,39 @@ namespace Queues
 class IncomingQueues : public InQueues, public InQueuesPublisher, public InQueuesContainer
 {
 public:
-    IncomingQueues(void);
+    /// storage used for the queued events
+    enum IngressBackend
+    {
+        INVALID_INGRESS = 0,
+        /// unbounded tbb::concurrent_queue, allocates inside TBB on push
+        CONCURRENT_QUEUE_INGRESS,
+        /// bounded ring of preallocated slots, tryPush() rejects events while it is full
+        RING_BUFFER_INGRESS
+    };
+    static const size_t DEFAULT_RING_CAPACITY = 16384;
+
+public:
+    explicit IncomingQueues(IngressBackend backend = CONCURRENT_QUEUE_INGRESS,
+                            size_t ringCapacity = DEFAULT_RING_CAPACITY);
     ~IncomingQueues(void);
 
+    IngressBackend backend() const
+    {
+        return backend_;
+    }
+    /// true if the ring is full and next tryPush() is rejected
+    virtual bool full() const;
+    /// amount of tryPush() calls rejected because the ring was full
+    u64 backpressureCount() const
+    {
+        return backpressureCount_.load(std::memory_order_relaxed);
+    }
+    /// amount of push() calls that found the ring full and went to the overflow queue
+    u64 overflowCount() const
+    {
+        return overflowCount_.load(std::memory_order_relaxed);
+    }
+
 public:
     /// reimplemented from InQueues
     virtual void push(const std::string &source, const OrderEvent &evnt);
@@ -40,6 +73,10 @@ public:
     virtual void push(const std::string &source, const OrderChangeStateEvent &evnt);
     virtual void push(const std::string &source, const ProcessEvent &evnt);
     virtual void push(const std::string &source, const TimerEvent &evnt);
+    virtual bool tryPush(const std::string &source, const OrderEvent &evnt);
+    virtual bool tryPush(const std::string &source, const OrderCancelEvent &evnt);
+    virtual bool tryPush(const std::string &source, const OrderReplaceEvent &evnt);
+    virtual bool tryPush(const std::string &source, const OrderChangeStateEvent &evnt);
     virtual InQueuesObserver *attach(InQueuesObserver *obs);
     virtual InQueuesObserver *detach();
 
@@ -54,6 +91,7 @@ public:
     virtual bool top(InQueueProcessor *obs);
     virtual bool pop();
     virtual bool pop(InQueueProcessor *obs);
+    virtual u32 popBatch(InQueueProcessor *obs, u32 maxEvents);
 
 private:
     std::atomic<InQueueProcessor *> processor_;
@@ -63,18 +101,30 @@ private:
     using EventVariant =
         std::variant<OrderEvent, OrderCancelEvent, OrderReplaceEvent, OrderChangeStateEvent, ProcessEvent, TimerEvent>;
 
-    /// Queued event containing source and the event data
+    /// Queued event containing interned source and the event data
     struct QueuedEvent
     {
-        std::string source_;
+        SourceHandle source_;
         EventVariant event_;
 
-        QueuedEvent() = default;
-        QueuedEvent(const std::string &src, EventVariant evt) : source_(src), event_(std::move(evt)) {}
+        QueuedEvent() : source_(0), event_() {}
+        QueuedEvent(SourceHandle src, EventVariant evt) : source_(src), event_(std::move(evt)) {}
     };
 
-    /// Lock-free concurrent queue (MPMC safe)
+    /// Interned source names, resolved back on dispatch
+    SourceRegistry *sources_;
+
+    IngressBackend backend_;
+
+    /// Lock-free concurrent queue (MPMC safe), CONCURRENT_QUEUE_INGRESS;
+    /// with RING_BUFFER_INGRESS holds the push() overflow and is drained after the ring
     oneapi::tbb::concurrent_queue<QueuedEvent> eventQueue_;
+    /// Bounded MPMC ring, RING_BUFFER_INGRESS
+    std::unique_ptr<BoundedRingBuffer<QueuedEvent>> ring_;
+    CacheAlignedAtomic<u64> backpressureCount_;
+    CacheAlignedAtomic<u64> overflowCount_;
+    /// events currently in the overflow, RING_BUFFER_INGRESS
+    CacheAlignedAtomic<u32> overflowSize_;
 
     /// Atomic size counter for O(1) size() queries - cache aligned
     CacheAlignedAtomic<u32> queueSize_;
@@ -85,7 +135,12 @@ private:
 
 private:
     void clear();
-    void dispatchEvent(InQueueProcessor *obs, const std::string &source, const EventVariant &event);
+    void enqueue(QueuedEvent &&event);
+    bool tryEnqueue(QueuedEvent &&event);
+    void spill(QueuedEvent &&event);
+    void onEnqueued();
+    bool dequeue(QueuedEvent &event);
+    void dispatchEvent(InQueueProcessor *obs, SourceHandle source, const EventVariant &event);
 };
 
 } // namespace Queues
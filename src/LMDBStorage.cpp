@@ -10,9 +10,11 @@
  See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
 */
 
+#include <cerrno>
 #include <cstring>
 #include <stdexcept>
 #include <cassert>
+#include <chrono>
 #include <sys/stat.h>
 
 #include "LMDBStorage.h"
@@ -23,17 +25,82 @@ using namespace COP::Store;
 namespace
 {
 
-const size_t DEFAULT_MAP_SIZE = 256UL * 1024UL * 1024UL; // 256 MB
+/// write did not fit into the map, it is retried after the map grows
+class MapFullError : public std::runtime_error
+{
+public:
+    explicit MapFullError(const std::string &msg) : std::runtime_error(msg) {}
+};
 
 void checkLMDB(int rc, const char *context)
 {
     if (rc != MDB_SUCCESS)
     {
         std::string msg = std::string(context) + ": " + mdb_strerror(rc);
+        if (rc == MDB_MAP_FULL)
+        {
+            throw MapFullError(msg);
+        }
         throw std::runtime_error(msg);
     }
 }
 
+const char *const JOURNAL_DB = "journal";
+const size_t SEQUENCE_SIZE = sizeof(u64);
+
+/// journal keys are big-endian, so the key order is the sequence order
+void writeSequence(u64 sequence, unsigned char *buf)
+{
+    for (size_t i = 0; i < SEQUENCE_SIZE; ++i)
+    {
+        buf[SEQUENCE_SIZE - 1 - i] = static_cast<unsigned char>(sequence >> (8 * i));
+    }
+}
+
+u64 readSequence(const MDB_val &val)
+{
+    assert(SEQUENCE_SIZE == val.mv_size);
+    const unsigned char *buf = static_cast<const unsigned char *>(val.mv_data);
+    u64 sequence = 0;
+    for (size_t i = 0; i < SEQUENCE_SIZE; ++i)
+    {
+        sequence = (sequence << 8) | buf[i];
+    }
+    return sequence;
+}
+
+/// copies the record passed to save() into the reserved value
+class CopyEncoder : public RecordEncoder
+{
+public:
+    explicit CopyEncoder(const char *buf) : buf_(buf) {}
+
+    void encode(char *buf, size_t size) const override
+    {
+        memcpy(buf, buf_, size);
+    }
+
+private:
+    const char *buf_;
+};
+
+unsigned int envFlags(LMDBStorageParams::DurabilityMode mode)
+{
+    switch (mode)
+    {
+    case LMDBStorageParams::FULL_SYNC_DURABILITY:
+        return 0;
+    case LMDBStorageParams::NO_META_SYNC_DURABILITY:
+        return MDB_NOMETASYNC;
+    case LMDBStorageParams::NO_SYNC_DURABILITY:
+        return MDB_NOSYNC;
+    case LMDBStorageParams::WRITE_MAP_ASYNC_DURABILITY:
+        return MDB_WRITEMAP | MDB_MAPASYNC;
+    default:
+        throw std::runtime_error("LMDBStorage::load: Invalid durability mode!");
+    };
+}
+
 } // namespace
 
 MDB_val LMDBStorage::makeKey(const CompositeKey &key)
@@ -52,10 +119,28 @@ LMDBStorage::CompositeKey LMDBStorage::readKey(const MDB_val &val)
     return key;
 }
 
-LMDBStorage::LMDBStorage() : env_(nullptr), dbi_(0), open_(false), generator_() {}
+LMDBStorage::LMDBStorage()
+    : params_(), env_(nullptr), dbi_(0), journalDbi_(0), open_(false), generator_(), currentMapSize_(0),
+      syncStopped_(false), lastSequence_(0), committedSequence_(0)
+{
+}
+
+LMDBStorage::LMDBStorage(const LMDBStorageParams &params)
+    : params_(params), env_(nullptr), dbi_(0), journalDbi_(0), open_(false), generator_(), currentMapSize_(0),
+      syncStopped_(false), lastSequence_(0), committedSequence_(0)
+{
+}
 
 LMDBStorage::LMDBStorage(const std::string &path, FileStorageObserver *observer)
-    : env_(nullptr), dbi_(0), open_(false), generator_()
+    : params_(), env_(nullptr), dbi_(0), journalDbi_(0), open_(false), generator_(), currentMapSize_(0),
+      syncStopped_(false), lastSequence_(0), committedSequence_(0)
+{
+    load(path, observer);
+}
+
+LMDBStorage::LMDBStorage(const std::string &path, FileStorageObserver *observer, const LMDBStorageParams &params)
+    : params_(params), env_(nullptr), dbi_(0), journalDbi_(0), open_(false), generator_(), currentMapSize_(0),
+      syncStopped_(false), lastSequence_(0), committedSequence_(0)
 {
     load(path, observer);
 }
@@ -67,9 +152,27 @@ LMDBStorage::~LMDBStorage()
 
 void LMDBStorage::close()
 {
+    {
+        std::lock_guard<std::mutex> guard(syncLock_);
+        syncStopped_ = true;
+    }
+    syncWakeUp_.notify_one();
+    if (syncThread_.joinable())
+    {
+        syncThread_.join();
+    }
     if (open_)
     {
+        if (LMDBStorageParams::FULL_SYNC_DURABILITY != params_.durability_)
+        {
+            // flush commits the periodic sync has not reached yet
+            mdb_env_sync(env_, 1);
+        }
         mdb_dbi_close(env_, dbi_);
+        if (params_.journal_)
+        {
+            mdb_dbi_close(env_, journalDbi_);
+        }
         open_ = false;
     }
     if (env_)
@@ -79,76 +182,348 @@ void LMDBStorage::close()
     }
 }
 
-void LMDBStorage::load(const std::string &path, FileStorageObserver *observer)
+void LMDBStorage::open(const std::string &path)
 {
     assert(nullptr == env_);
-    assert(nullptr != observer);
+    const unsigned int flags = envFlags(params_.durability_);
 
     // Ensure the directory exists
     mkdir(path.c_str(), 0755);
 
     int rc = mdb_env_create(&env_);
-    checkLMDB(rc, "LMDBStorage::load mdb_env_create");
+    checkLMDB(rc, "LMDBStorage::open mdb_env_create");
+
+    rc = mdb_env_set_mapsize(env_, params_.mapSize_);
+    checkLMDB(rc, "LMDBStorage::open mdb_env_set_mapsize");
 
-    rc = mdb_env_set_mapsize(env_, DEFAULT_MAP_SIZE);
-    checkLMDB(rc, "LMDBStorage::load mdb_env_set_mapsize");
+    if (params_.journal_)
+    {
+        rc = mdb_env_set_maxdbs(env_, 1);
+        checkLMDB(rc, "LMDBStorage::open mdb_env_set_maxdbs");
+    }
 
-    rc = mdb_env_open(env_, path.c_str(), 0, 0664);
+    rc = mdb_env_open(env_, path.c_str(), flags, 0664);
     if (rc != MDB_SUCCESS)
     {
         mdb_env_close(env_);
         env_ = nullptr;
-        checkLMDB(rc, "LMDBStorage::load mdb_env_open");
+        checkLMDB(rc, "LMDBStorage::open mdb_env_open");
     }
 
-    // Open the default (unnamed) database
+    // Open the default (unnamed) database and the journal
     MDB_txn *txn = nullptr;
     rc = mdb_txn_begin(env_, nullptr, 0, &txn);
     if (rc != MDB_SUCCESS)
     {
         mdb_env_close(env_);
         env_ = nullptr;
-        checkLMDB(rc, "LMDBStorage::load mdb_txn_begin");
+        checkLMDB(rc, "LMDBStorage::open mdb_txn_begin");
     }
 
     rc = mdb_dbi_open(txn, nullptr, MDB_CREATE, &dbi_);
+    if ((rc == MDB_SUCCESS) && params_.journal_)
+    {
+        rc = mdb_dbi_open(txn, JOURNAL_DB, MDB_CREATE, &journalDbi_);
+        if (rc == MDB_SUCCESS)
+        {
+            // sequence continues after the last journaled record
+            MDB_cursor *cursor = nullptr;
+            rc = mdb_cursor_open(txn, journalDbi_, &cursor);
+            if (rc == MDB_SUCCESS)
+            {
+                MDB_val key, data;
+                if (MDB_SUCCESS == mdb_cursor_get(cursor, &key, &data, MDB_LAST))
+                {
+                    lastSequence_ = readSequence(key);
+                }
+                mdb_cursor_close(cursor);
+            }
+        }
+    }
     if (rc != MDB_SUCCESS)
     {
         mdb_txn_abort(txn);
         mdb_env_close(env_);
         env_ = nullptr;
-        checkLMDB(rc, "LMDBStorage::load mdb_dbi_open");
+        checkLMDB(rc, "LMDBStorage::open mdb_dbi_open");
+    }
+
+    rc = mdb_txn_commit(txn);
+    if (rc != MDB_SUCCESS)
+    {
+        mdb_env_close(env_);
+        env_ = nullptr;
+        checkLMDB(rc, "LMDBStorage::open mdb_txn_commit");
+    }
+    committedSequence_.store(lastSequence_, std::memory_order_release);
+
+    MDB_envinfo info;
+    currentMapSize_ = (MDB_SUCCESS == mdb_env_info(env_, &info)) ? info.me_mapsize : params_.mapSize_;
+    open_ = true;
+    if ((0 != (flags & (MDB_NOSYNC | MDB_MAPASYNC))) && (0 < params_.syncIntervalMs_))
+    {
+        syncStopped_ = false;
+        syncThread_ = std::thread(&LMDBStorage::runSync, this);
     }
+}
+
+void LMDBStorage::load(const std::string &path, FileStorageObserver *observer)
+{
+    assert(nullptr != observer);
+    open(path);
 
     // Scan all existing records and notify observer
+    MDB_txn *txn = nullptr;
+    int rc = mdb_txn_begin(env_, nullptr, MDB_RDONLY, &txn);
+    checkLMDB(rc, "LMDBStorage::load mdb_txn_begin");
+
     observer->startLoad();
 
     MDB_cursor *cursor = nullptr;
     rc = mdb_cursor_open(txn, dbi_, &cursor);
     if (rc == MDB_SUCCESS)
     {
+        try
+        {
+            MDB_val key, data;
+            while (mdb_cursor_get(cursor, &key, &data, MDB_NEXT) == MDB_SUCCESS)
+            {
+                if (key.mv_size == sizeof(CompositeKey))
+                {
+                    CompositeKey ck = readKey(key);
+                    observer->onRecordLoaded(ck.id_, ck.version_, static_cast<const char *>(data.mv_data),
+                                             data.mv_size);
+                }
+            }
+        }
+        catch (...)
+        {
+            mdb_cursor_close(cursor);
+            mdb_txn_abort(txn);
+            throw;
+        }
+        mdb_cursor_close(cursor);
+    }
+    mdb_txn_abort(txn);
+
+    observer->finishLoad();
+}
+
+u64 LMDBStorage::replay(u64 afterSequence, FileStorageObserver *observer) const
+{
+    assert(nullptr != env_);
+    assert(nullptr != observer);
+    if (!params_.journal_)
+    {
+        throw std::runtime_error("LMDBStorage::replay: Unable to replay records, journal is off!");
+    }
+    std::shared_lock<std::shared_mutex> guard(resizeLock_);
+
+    MDB_txn *txn = nullptr;
+    int rc = mdb_txn_begin(env_, nullptr, MDB_RDONLY, &txn);
+    checkLMDB(rc, "LMDBStorage::replay mdb_txn_begin");
+
+    MDB_cursor *cursor = nullptr;
+    rc = mdb_cursor_open(txn, journalDbi_, &cursor);
+    if (rc != MDB_SUCCESS)
+    {
+        mdb_txn_abort(txn);
+        checkLMDB(rc, "LMDBStorage::replay mdb_cursor_open");
+    }
+
+    u64 last = afterSequence;
+    try
+    {
+        unsigned char seqBuf[SEQUENCE_SIZE];
+        writeSequence(afterSequence + 1, seqBuf);
         MDB_val key, data;
-        while (mdb_cursor_get(cursor, &key, &data, MDB_NEXT) == MDB_SUCCESS)
+        key.mv_size = SEQUENCE_SIZE;
+        key.mv_data = seqBuf;
+        rc = mdb_cursor_get(cursor, &key, &data, MDB_SET_RANGE);
+        while (rc == MDB_SUCCESS)
         {
-            if (key.mv_size == sizeof(CompositeKey))
+            if (data.mv_size == sizeof(CompositeKey))
             {
-                CompositeKey ck = readKey(key);
-                observer->onRecordLoaded(ck.id_, ck.version_, static_cast<const char *>(data.mv_data), data.mv_size);
+                CompositeKey ck = readKey(data);
+                MDB_val recKey = makeKey(ck);
+                MDB_val rec;
+                if (MDB_SUCCESS == mdb_get(txn, dbi_, &recKey, &rec))
+                {
+                    observer->onRecordLoaded(ck.id_, ck.version_, static_cast<const char *>(rec.mv_data),
+                                             rec.mv_size);
+                }
             }
+            last = readSequence(key);
+            rc = mdb_cursor_get(cursor, &key, &data, MDB_NEXT);
         }
+    }
+    catch (...)
+    {
         mdb_cursor_close(cursor);
+        mdb_txn_abort(txn);
+        throw;
     }
+    mdb_cursor_close(cursor);
+    mdb_txn_abort(txn);
+    return last;
+}
 
-    rc = mdb_txn_commit(txn);
+void LMDBStorage::truncateJournal(u64 upToSequence)
+{
+    if (!params_.journal_)
+    {
+        return;
+    }
+    withMapGrowth([&]() { removeJournal(upToSequence); });
+}
+
+void LMDBStorage::removeJournal(u64 upToSequence)
+{
+    assert(nullptr != env_);
+
+    MDB_txn *txn = nullptr;
+    int rc = mdb_txn_begin(env_, nullptr, 0, &txn);
+    checkLMDB(rc, "LMDBStorage::truncateJournal mdb_txn_begin");
+
+    MDB_cursor *cursor = nullptr;
+    rc = mdb_cursor_open(txn, journalDbi_, &cursor);
     if (rc != MDB_SUCCESS)
     {
-        mdb_env_close(env_);
-        env_ = nullptr;
-        checkLMDB(rc, "LMDBStorage::load mdb_txn_commit");
+        mdb_txn_abort(txn);
+        checkLMDB(rc, "LMDBStorage::truncateJournal mdb_cursor_open");
+    }
+    MDB_val key, data;
+    while (MDB_SUCCESS == mdb_cursor_get(cursor, &key, &data, MDB_FIRST))
+    {
+        const u64 sequence = readSequence(key);
+        // the last entry is kept, the sequence continues from it after a restart
+        if ((upToSequence < sequence) || (lastSequence_ <= sequence))
+        {
+            break;
+        }
+        rc = mdb_cursor_del(cursor, 0);
+        if (rc != MDB_SUCCESS)
+        {
+            mdb_cursor_close(cursor);
+            mdb_txn_abort(txn);
+            checkLMDB(rc, "LMDBStorage::truncateJournal mdb_cursor_del");
+        }
     }
+    mdb_cursor_close(cursor);
 
-    open_ = true;
-    observer->finishLoad();
+    rc = mdb_txn_commit(txn);
+    checkLMDB(rc, "LMDBStorage::truncateJournal mdb_txn_commit");
+}
+
+int LMDBStorage::journal(MDB_txn *txn, const CompositeKey &key)
+{
+    if (!params_.journal_)
+    {
+        return MDB_SUCCESS;
+    }
+    unsigned char seqBuf[SEQUENCE_SIZE];
+    writeSequence(lastSequence_ + 1, seqBuf);
+    MDB_val seqKey;
+    seqKey.mv_size = SEQUENCE_SIZE;
+    seqKey.mv_data = seqBuf;
+    MDB_val data = makeKey(key);
+    const int rc = mdb_put(txn, journalDbi_, &seqKey, &data, MDB_APPEND);
+    if (rc == MDB_SUCCESS)
+    {
+        // an aborted transaction leaves a gap, sequences never repeat
+        ++lastSequence_;
+    }
+    return rc;
+}
+
+void LMDBStorage::publishSequence(u64 sequence)
+{
+    u64 current = committedSequence_.load(std::memory_order_relaxed);
+    while ((current < sequence) &&
+           !committedSequence_.compare_exchange_weak(current, sequence, std::memory_order_release,
+                                                     std::memory_order_relaxed))
+    {
+    }
+}
+
+void LMDBStorage::runSync()
+{
+    std::unique_lock<std::mutex> guard(syncLock_);
+    while (!syncStopped_)
+    {
+        syncWakeUp_.wait_for(guard, std::chrono::milliseconds(params_.syncIntervalMs_));
+        if (syncStopped_)
+        {
+            break;
+        }
+        guard.unlock();
+        try
+        {
+            sync();
+        }
+        catch (const std::exception &)
+        {
+            // next period retries, close() syncs once more
+        }
+        guard.lock();
+    }
+}
+
+void LMDBStorage::sync()
+{
+    assert(nullptr != env_);
+    if (LMDBStorageParams::FULL_SYNC_DURABILITY == params_.durability_)
+    {
+        return;
+    }
+    std::shared_lock<std::shared_mutex> guard(resizeLock_);
+    checkLMDB(mdb_env_sync(env_, 1), "LMDBStorage::sync mdb_env_sync");
+}
+
+size_t LMDBStorage::mapSize() const
+{
+    std::shared_lock<std::shared_mutex> guard(resizeLock_);
+    return currentMapSize_;
+}
+
+void LMDBStorage::growMap(size_t failedMapSize)
+{
+    std::unique_lock<std::shared_mutex> guard(resizeLock_);
+    if (failedMapSize < currentMapSize_)
+    {
+        // grown by another writer meanwhile
+        return;
+    }
+    if ((0 != params_.maxMapSize_) && (params_.maxMapSize_ <= currentMapSize_))
+    {
+        throw std::runtime_error("LMDBStorage: Unable to save record, storage reached its maximal size!");
+    }
+    size_t newSize = 2 * currentMapSize_;
+    if ((0 != params_.maxMapSize_) && (params_.maxMapSize_ < newSize))
+    {
+        newSize = params_.maxMapSize_;
+    }
+    // no transaction of this process is active while resizeLock_ is held exclusively
+    checkLMDB(mdb_env_set_mapsize(env_, newSize), "LMDBStorage::growMap mdb_env_set_mapsize");
+    currentMapSize_ = newSize;
+}
+
+template <typename F> auto LMDBStorage::withMapGrowth(F f) -> decltype(f())
+{
+    for (;;)
+    {
+        size_t attemptedMapSize = 0;
+        try
+        {
+            std::shared_lock<std::shared_mutex> guard(resizeLock_);
+            attemptedMapSize = currentMapSize_;
+            return f();
+        }
+        catch (const MapFullError &)
+        {
+            growMap(attemptedMapSize);
+        }
+    }
 }
 
 IdT LMDBStorage::save(const char *buf, size_t size)
@@ -160,15 +535,58 @@ IdT LMDBStorage::save(const char *buf, size_t size)
 
 void LMDBStorage::save(const IdT &id, const char *buf, size_t size)
 {
-    assert(nullptr != env_);
     assert(nullptr != buf);
+    CopyEncoder encoder(buf);
+    withMapGrowth([&]() { saveRecord(id, size, encoder); });
+}
+
+void LMDBStorage::saveReserved(const IdT &id, size_t size, const RecordEncoder &encoder)
+{
+    withMapGrowth([&]() { saveRecord(id, size, encoder); });
+}
+
+u32 LMDBStorage::update(const IdT &id, const char *buf, size_t size)
+{
+    return withMapGrowth([&]() { return updateRecord(id, buf, size); });
+}
+
+u32 LMDBStorage::replace(const IdT &id, u32 version, const char *buf, size_t size)
+{
+    return withMapGrowth([&]() { return replaceRecord(id, version, buf, size); });
+}
+
+void LMDBStorage::erase(const IdT &id, u32 version)
+{
+    checkErasable();
+    withMapGrowth([&]() { eraseRecord(id, version); });
+}
+
+void LMDBStorage::erase(const IdT &id)
+{
+    checkErasable();
+    withMapGrowth([&]() { eraseRecords(id); });
+}
+
+void LMDBStorage::write(const WriteBatchT &batch)
+{
+    withMapGrowth([&]() { writeBatch(batch); });
+}
+
+size_t LMDBStorage::writeSkippingFailed(const WriteBatchT &batch, std::vector<size_t> *failed)
+{
+    return withMapGrowth([&]() { return writeBatchSkippingFailed(batch, failed); });
+}
+
+void LMDBStorage::saveRecord(const IdT &id, size_t size, const RecordEncoder &encoder)
+{
+    assert(nullptr != env_);
     assert(0 < size);
 
     CompositeKey ck(id, 0);
     MDB_val key = makeKey(ck);
     MDB_val data;
     data.mv_size = size;
-    data.mv_data = const_cast<char *>(buf);
+    data.mv_data = nullptr;
 
     MDB_txn *txn = nullptr;
     int rc = mdb_txn_begin(env_, nullptr, 0, &txn);
@@ -183,18 +601,33 @@ void LMDBStorage::save(const IdT &id, const char *buf, size_t size)
         throw std::runtime_error("LMDBStorage::save: Unable to save record, record with this Id already exists!");
     }
 
-    rc = mdb_put(txn, dbi_, &key, &data, 0);
+    rc = mdb_put(txn, dbi_, &key, &data, MDB_RESERVE);
+    if (rc == MDB_SUCCESS)
+    {
+        try
+        {
+            encoder.encode(static_cast<char *>(data.mv_data), size);
+        }
+        catch (...)
+        {
+            mdb_txn_abort(txn);
+            throw;
+        }
+        rc = journal(txn, ck);
+    }
     if (rc != MDB_SUCCESS)
     {
         mdb_txn_abort(txn);
         checkLMDB(rc, "LMDBStorage::save mdb_put");
     }
 
+    const u64 sequence = lastSequence_;
     rc = mdb_txn_commit(txn);
     checkLMDB(rc, "LMDBStorage::save mdb_txn_commit");
+    publishSequence(sequence);
 }
 
-u32 LMDBStorage::update(const IdT &id, const char *buf, size_t size)
+u32 LMDBStorage::updateRecord(const IdT &id, const char *buf, size_t size)
 {
     assert(nullptr != env_);
     assert(nullptr != buf);
@@ -242,19 +675,25 @@ u32 LMDBStorage::update(const IdT &id, const char *buf, size_t size)
     data.mv_data = const_cast<char *>(buf);
 
     rc = mdb_put(txn, dbi_, &key, &data, 0);
+    if (rc == MDB_SUCCESS)
+    {
+        rc = journal(txn, ck);
+    }
     if (rc != MDB_SUCCESS)
     {
         mdb_txn_abort(txn);
         checkLMDB(rc, "LMDBStorage::update mdb_put");
     }
 
+    const u64 sequence = lastSequence_;
     rc = mdb_txn_commit(txn);
     checkLMDB(rc, "LMDBStorage::update mdb_txn_commit");
+    publishSequence(sequence);
 
     return newVersion;
 }
 
-u32 LMDBStorage::replace(const IdT &id, u32 version, const char *buf, size_t size)
+u32 LMDBStorage::replaceRecord(const IdT &id, u32 version, const char *buf, size_t size)
 {
     assert(nullptr != env_);
     assert(nullptr != buf);
@@ -333,19 +772,33 @@ u32 LMDBStorage::replace(const IdT &id, u32 version, const char *buf, size_t siz
     data.mv_data = const_cast<char *>(buf);
 
     rc = mdb_put(txn, dbi_, &newKey, &data, 0);
+    if (rc == MDB_SUCCESS)
+    {
+        rc = journal(txn, newCk);
+    }
     if (rc != MDB_SUCCESS)
     {
         mdb_txn_abort(txn);
         checkLMDB(rc, "LMDBStorage::replace mdb_put");
     }
 
+    const u64 sequence = lastSequence_;
     rc = mdb_txn_commit(txn);
     checkLMDB(rc, "LMDBStorage::replace mdb_txn_commit");
+    publishSequence(sequence);
 
     return newVersion;
 }
 
-void LMDBStorage::erase(const IdT &id, u32 version)
+void LMDBStorage::checkErasable() const
+{
+    if (params_.journal_)
+    {
+        throw std::runtime_error("LMDBStorage::erase: Records are not erased while the journal is on!");
+    }
+}
+
+void LMDBStorage::eraseRecord(const IdT &id, u32 version)
 {
     assert(nullptr != env_);
 
@@ -367,7 +820,7 @@ void LMDBStorage::erase(const IdT &id, u32 version)
     checkLMDB(rc, "LMDBStorage::erase(version) mdb_txn_commit");
 }
 
-void LMDBStorage::erase(const IdT &id)
+void LMDBStorage::eraseRecords(const IdT &id)
 {
     assert(nullptr != env_);
 
@@ -375,14 +828,26 @@ void LMDBStorage::erase(const IdT &id)
     int rc = mdb_txn_begin(env_, nullptr, 0, &txn);
     checkLMDB(rc, "LMDBStorage::erase(all) mdb_txn_begin");
 
-    MDB_cursor *cursor = nullptr;
-    rc = mdb_cursor_open(txn, dbi_, &cursor);
+    rc = eraseAll(txn, id);
     if (rc != MDB_SUCCESS)
     {
         mdb_txn_abort(txn);
         checkLMDB(rc, "LMDBStorage::erase(all) mdb_cursor_open");
     }
 
+    rc = mdb_txn_commit(txn);
+    checkLMDB(rc, "LMDBStorage::erase(all) mdb_txn_commit");
+}
+
+int LMDBStorage::eraseAll(MDB_txn *txn, const IdT &id)
+{
+    MDB_cursor *cursor = nullptr;
+    int rc = mdb_cursor_open(txn, dbi_, &cursor);
+    if (rc != MDB_SUCCESS)
+    {
+        return rc;
+    }
+
     MDB_val curKey, curData;
     rc = mdb_cursor_get(cursor, &curKey, &curData, MDB_FIRST);
     while (rc == MDB_SUCCESS)
@@ -407,14 +872,128 @@ void LMDBStorage::erase(const IdT &id)
         }
     }
     mdb_cursor_close(cursor);
+    return MDB_SUCCESS;
+}
+
+IdT LMDBStorage::reserveId()
+{
+    return generator_.getId();
+}
+
+int LMDBStorage::apply(MDB_txn *txn, const WriteRecord &rec)
+{
+    switch (rec.kind_)
+    {
+    case WriteRecord::SAVE_WRITE:
+    {
+        assert(!rec.data_.empty());
+        CompositeKey ck(rec.id_, 0);
+        MDB_val key = makeKey(ck);
+        MDB_val data;
+        data.mv_size = rec.data_.size();
+        data.mv_data = const_cast<char *>(rec.data_.data());
+        const int rc = mdb_put(txn, dbi_, &key, &data, MDB_NOOVERWRITE);
+        return (rc == MDB_SUCCESS) ? journal(txn, ck) : rc;
+    }
+    case WriteRecord::ERASE_VERSION_WRITE:
+    {
+        if (params_.journal_)
+        {
+            return EPERM;
+        }
+        CompositeKey ck(rec.id_, rec.version_);
+        MDB_val key = makeKey(ck);
+        const int rc = mdb_del(txn, dbi_, &key, nullptr);
+        return (rc == MDB_NOTFOUND) ? MDB_SUCCESS : rc;
+    }
+    case WriteRecord::ERASE_ALL_WRITE:
+        return params_.journal_ ? EPERM : eraseAll(txn, rec.id_);
+    default:
+        throw std::runtime_error("LMDBStorage::write: Invalid write record kind!");
+    };
+}
 
+void LMDBStorage::writeBatch(const WriteBatchT &batch)
+{
+    assert(nullptr != env_);
+    if (batch.empty())
+    {
+        return;
+    }
+
+    MDB_txn *txn = nullptr;
+    int rc = mdb_txn_begin(env_, nullptr, 0, &txn);
+    checkLMDB(rc, "LMDBStorage::write mdb_txn_begin");
+
+    for (WriteBatchT::const_iterator it = batch.begin(); it != batch.end(); ++it)
+    {
+        rc = apply(txn, *it);
+        if (rc == MDB_KEYEXIST)
+        {
+            mdb_txn_abort(txn);
+            throw std::runtime_error("LMDBStorage::write: Unable to save record, record with this Id already exists!");
+        }
+        if (rc != MDB_SUCCESS)
+        {
+            mdb_txn_abort(txn);
+            checkLMDB(rc, "LMDBStorage::write apply");
+        }
+    }
+
+    const u64 sequence = lastSequence_;
     rc = mdb_txn_commit(txn);
-    checkLMDB(rc, "LMDBStorage::erase(all) mdb_txn_commit");
+    checkLMDB(rc, "LMDBStorage::write mdb_txn_commit");
+    publishSequence(sequence);
+}
+
+size_t LMDBStorage::writeBatchSkippingFailed(const WriteBatchT &batch, std::vector<size_t> *failed)
+{
+    assert(nullptr != env_);
+    if (nullptr != failed)
+    {
+        // the batch is applied again after the map grows
+        failed->clear();
+    }
+    if (batch.empty())
+    {
+        return 0;
+    }
+
+    MDB_txn *txn = nullptr;
+    int rc = mdb_txn_begin(env_, nullptr, 0, &txn);
+    checkLMDB(rc, "LMDBStorage::writeSkippingFailed mdb_txn_begin");
+
+    size_t skipped = 0;
+    for (WriteBatchT::const_iterator it = batch.begin(); it != batch.end(); ++it)
+    {
+        // failed put or del leaves the transaction usable, except a full map or transaction
+        rc = apply(txn, *it);
+        if ((rc == MDB_MAP_FULL) || (rc == MDB_TXN_FULL))
+        {
+            mdb_txn_abort(txn);
+            checkLMDB(rc, "LMDBStorage::writeSkippingFailed apply");
+        }
+        if (MDB_SUCCESS != rc)
+        {
+            ++skipped;
+            if (nullptr != failed)
+            {
+                failed->push_back(static_cast<size_t>(it - batch.begin()));
+            }
+        }
+    }
+
+    const u64 sequence = lastSequence_;
+    rc = mdb_txn_commit(txn);
+    checkLMDB(rc, "LMDBStorage::writeSkippingFailed mdb_txn_commit");
+    publishSequence(sequence);
+    return skipped;
 }
 
 bool LMDBStorage::isExists(const IdT &id) const
 {
     assert(nullptr != env_);
+    std::shared_lock<std::shared_mutex> guard(resizeLock_);
 
     MDB_txn *txn = nullptr;
     int rc = mdb_txn_begin(env_, nullptr, MDB_RDONLY, &txn);
@@ -450,6 +1029,7 @@ bool LMDBStorage::isExists(const IdT &id) const
 bool LMDBStorage::isExists(const IdT &id, u32 version) const
 {
     assert(nullptr != env_);
+    std::shared_lock<std::shared_mutex> guard(resizeLock_);
 
     CompositeKey ck(id, version);
     MDB_val key = makeKey(ck);
@@ -468,6 +1048,7 @@ bool LMDBStorage::isExists(const IdT &id, u32 version) const
 u32 LMDBStorage::getTopVersion(const IdT &id) const
 {
     assert(nullptr != env_);
+    std::shared_lock<std::shared_mutex> guard(resizeLock_);
 
     MDB_txn *txn = nullptr;
     int rc = mdb_txn_begin(env_, nullptr, MDB_RDONLY, &txn);
@@ -508,6 +1089,7 @@ u32 LMDBStorage::getTopVersion(const IdT &id) const
 size_t LMDBStorage::recordSize(const IdT &id, u32 version) const
 {
     assert(nullptr != env_);
+    std::shared_lock<std::shared_mutex> guard(resizeLock_);
 
     CompositeKey ck(id, version);
     MDB_val key = makeKey(ck);
@@ -527,6 +1109,7 @@ size_t LMDBStorage::recordSize(const IdT &id, u32 version) const
 bool LMDBStorage::loadRecord(const IdT &id, u32 version, std::vector<char> *buf)
 {
     assert(nullptr != env_);
+    std::shared_lock<std::shared_mutex> guard(resizeLock_);
     assert(nullptr != buf);
 
     CompositeKey ck(id, version);
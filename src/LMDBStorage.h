@@ -15,6 +15,11 @@
 #include <string>
 #include <vector>
 #include <cstring>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <atomic>
 #include <lmdb.h>
 
 #include "IdTGenerator.h"
@@ -25,20 +30,83 @@ namespace COP
 namespace Store
 {
 
+struct LMDBStorageParams
+{
+    /// how much of the latest commits may be lost on a system crash
+    enum DurabilityMode
+    {
+        INVALID_DURABILITY = 0,
+        /// every commit is synced, nothing is lost
+        FULL_SYNC_DURABILITY,
+        /// MDB_NOMETASYNC: data is synced, the meta page only with the next commit,
+        /// a crash may roll back the last commit
+        NO_META_SYNC_DURABILITY,
+        /// MDB_NOSYNC: commits are synced every syncIntervalMs_ only
+        NO_SYNC_DURABILITY,
+        /// MDB_WRITEMAP | MDB_MAPASYNC: writes go to the map directly and the OS
+        /// flushes it, synced every syncIntervalMs_
+        WRITE_MAP_ASYNC_DURABILITY
+    };
+
+    DurabilityMode durability_ = FULL_SYNC_DURABILITY;
+    /// initial map size, the map doubles when a write does not fit
+    size_t mapSize_ = 256UL * 1024UL * 1024UL;
+    /// map is not grown beyond this size, 0 - no limit
+    size_t maxMapSize_ = 0;
+    /// NO_SYNC_DURABILITY and WRITE_MAP_ASYNC_DURABILITY: period of mdb_env_sync, 0 - never
+    u32 syncIntervalMs_ = 100;
+    /// keeps the keys of committed records in commit order, replay() reads it.
+    /// Erases are not journaled and are rejected, a snapshot replayed on top would restore the record
+    bool journal_ = false;
+};
+
 class LMDBStorage final : public FileSaver
 {
+public:
+    /// record change applied by write()
+    struct WriteRecord
+    {
+        enum Kind
+        {
+            INVALID_WRITE = 0,
+            /// new record with version 0, fails if the id exists
+            SAVE_WRITE,
+            /// erase version_ of the record
+            ERASE_VERSION_WRITE,
+            /// erase all versions of the record
+            ERASE_ALL_WRITE
+        };
+
+        Kind kind_;
+        IdT id_;
+        u32 version_;
+        std::string data_;
+
+        WriteRecord() : kind_(INVALID_WRITE), id_(), version_(0), data_() {}
+        WriteRecord(Kind kind, const IdT &id, u32 version) : kind_(kind), id_(id), version_(version), data_() {}
+    };
+    typedef std::vector<WriteRecord> WriteBatchT;
+
 public:
     LMDBStorage();
+    explicit LMDBStorage(const LMDBStorageParams &params);
     LMDBStorage(const std::string &path, FileStorageObserver *observer);
+    LMDBStorage(const std::string &path, FileStorageObserver *observer, const LMDBStorageParams &params);
     ~LMDBStorage();
 
 public:
+    /// opens the storage without passing its records to an observer
+    void open(const std::string &path);
+
     /// reimplemented from FileSaver
     void load(const std::string &path, FileStorageObserver *observer) override;
     IdT save(const char *buf, size_t size) override;
     void save(const IdT &id, const char *buf, size_t size) override;
+    /// encodes the record into the value reserved by MDB_RESERVE
+    void saveReserved(const IdT &id, size_t size, const RecordEncoder &encoder) override;
     u32 update(const IdT &id, const char *buf, size_t size) override;
     u32 replace(const IdT &id, u32 version, const char *buf, size_t size) override;
+    /// throws if the journal is on, write() rejects erase records then
     void erase(const IdT &id, u32 version) override;
     void erase(const IdT &id) override;
 
@@ -55,6 +123,35 @@ public:
     /// return false if version of record not exists
     bool loadRecord(const IdT &id, u32 version, std::vector<char> *buf);
 
+    /// applies the records in one write transaction, either all of them or none
+    void write(const WriteBatchT &batch);
+    /// applies the records in one write transaction, a record that fails is skipped.
+    /// returns amount of skipped records, their positions in the batch go to failed if it is set
+    size_t writeSkippingFailed(const WriteBatchT &batch, std::vector<size_t> *failed = nullptr);
+    /// returns id for save(buf, size) issued later, ids are unique for this storage
+    IdT reserveId();
+
+    /// flushes commits that are not synced yet, no-op in FULL_SYNC_DURABILITY
+    void sync();
+    LMDBStorageParams::DurabilityMode durability() const
+    {
+        return params_.durability_;
+    }
+    /// current size of the memory map
+    size_t mapSize() const;
+
+    /// sequence of the last committed record, 0 if the journal is off or empty
+    u64 lastSequence() const
+    {
+        return committedSequence_.load(std::memory_order_acquire);
+    }
+    /// passes records committed after afterSequence to the observer in commit order,
+    /// only onRecordLoaded() is called. Versions replaced since are skipped, the new one is journaled.
+    /// returns sequence of the last passed record, afterSequence if there was none
+    u64 replay(u64 afterSequence, FileStorageObserver *observer) const;
+    /// drops journal entries up to the sequence, the records stay in the storage
+    void truncateJournal(u64 upToSequence);
+
 private:
     struct CompositeKey
     {
@@ -77,15 +174,54 @@ private:
     static CompositeKey readKey(const MDB_val &val);
 
     void close();
+    void runSync();
+    /// doubles the map after a write failed with MDB_MAP_FULL
+    void growMap(size_t failedMapSize);
+    /// retries the write with a grown map while it fails with MDB_MAP_FULL
+    template <typename F> auto withMapGrowth(F f) -> decltype(f());
+
+    void saveRecord(const IdT &id, size_t size, const RecordEncoder &encoder);
+    u32 updateRecord(const IdT &id, const char *buf, size_t size);
+    u32 replaceRecord(const IdT &id, u32 version, const char *buf, size_t size);
+    /// erases are not journaled, replay() after a snapshot would bring the erased record back
+    void checkErasable() const;
+    void eraseRecord(const IdT &id, u32 version);
+    void eraseRecords(const IdT &id);
+    void writeBatch(const WriteBatchT &batch);
+    size_t writeBatchSkippingFailed(const WriteBatchT &batch, std::vector<size_t> *failed);
+    /// applies one record inside txn, returns LMDB error code
+    int apply(MDB_txn *txn, const WriteRecord &rec);
+    int eraseAll(MDB_txn *txn, const IdT &id);
+    /// appends the key to the journal under the next sequence, no-op if the journal is off
+    int journal(MDB_txn *txn, const CompositeKey &key);
+    /// makes sequences up to the one journaled last visible after the commit
+    void publishSequence(u64 sequence);
+    void removeJournal(u64 upToSequence);
 
     LMDBStorage(const LMDBStorage &) = delete;
     LMDBStorage &operator=(const LMDBStorage &) = delete;
 
 private:
+    LMDBStorageParams params_;
     MDB_env *env_;
     MDB_dbi dbi_;
+    MDB_dbi journalDbi_;
     bool open_;
     IdTValueGenerator generator_;
+
+    /// transactions hold it shared, the map is resized only while it is held exclusively
+    mutable std::shared_mutex resizeLock_;
+    size_t currentMapSize_;
+
+    // periodic mdb_env_sync for the asynchronous durability modes
+    std::thread syncThread_;
+    std::mutex syncLock_;
+    std::condition_variable syncWakeUp_;
+    bool syncStopped_;
+
+    /// last journaled sequence, changed inside write transactions only, LMDB serialises them
+    u64 lastSequence_;
+    std::atomic<u64> committedSequence_;
 };
 
 } // namespace Store
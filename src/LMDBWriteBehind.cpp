@@ -0,0 +1,268 @@
+/**
+ Concurrent Order Processor library
+
+ Authors: dudleylane, Claude
+
+ Copyright (C) 2026 dudleylane
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#include <cassert>
+#include <algorithm>
+#include <iterator>
+#include <chrono>
+#include <stdexcept>
+
+#include "LMDBWriteBehind.h"
+#include "Logger.h"
+
+using namespace std;
+using namespace COP;
+using namespace COP::Store;
+
+LMDBWriteBehind::LMDBWriteBehind(LMDBStorage *storage, const LMDBWriteBehindParams &params)
+    : storage_(storage), maxBatchSize_(params.maxBatchSize_), maxDelayUs_(params.maxDelayUs_), stopped_(false),
+      enqueued_(0), durable_(0), reportedFailures_(0), totalBatches_(0), totalWritten_(0), totalErrors_(0)
+{
+    if (nullptr == storage_)
+    {
+        throw std::runtime_error("LMDBWriteBehind: storage is not assigned!");
+    }
+    if (0 == maxBatchSize_)
+    {
+        throw std::runtime_error("LMDBWriteBehind: batch size should be positive!");
+    }
+    pending_.reserve(maxBatchSize_);
+    thread_ = std::thread(&LMDBWriteBehind::run, this);
+}
+
+LMDBWriteBehind::~LMDBWriteBehind()
+{
+    shutdown();
+}
+
+void LMDBWriteBehind::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        stopped_ = true;
+    }
+    hasWork_.notify_one();
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+void LMDBWriteBehind::load(const std::string &path, FileStorageObserver *observer)
+{
+    storage_->load(path, observer);
+}
+
+IdT LMDBWriteBehind::save(const char *buf, size_t size)
+{
+    IdT id = storage_->reserveId();
+    save(id, buf, size);
+    return id;
+}
+
+void LMDBWriteBehind::save(const IdT &id, const char *buf, size_t size)
+{
+    assert(nullptr != buf);
+    assert(0 < size);
+    LMDBStorage::WriteRecord rec(LMDBStorage::WriteRecord::SAVE_WRITE, id, 0);
+    rec.data_.assign(buf, size);
+    enqueue(rec);
+}
+
+void LMDBWriteBehind::saveReserved(const IdT &id, size_t size, const RecordEncoder &encoder)
+{
+    assert(0 < size);
+    LMDBStorage::WriteRecord rec(LMDBStorage::WriteRecord::SAVE_WRITE, id, 0);
+    rec.data_.resize(size);
+    encoder.encode(rec.data_.data(), size);
+    enqueue(rec);
+}
+
+u32 LMDBWriteBehind::update(const IdT &id, const char *buf, size_t size)
+{
+    flush();
+    return storage_->update(id, buf, size);
+}
+
+u32 LMDBWriteBehind::replace(const IdT &id, u32 version, const char *buf, size_t size)
+{
+    flush();
+    return storage_->replace(id, version, buf, size);
+}
+
+void LMDBWriteBehind::erase(const IdT &id, u32 version)
+{
+    LMDBStorage::WriteRecord rec(LMDBStorage::WriteRecord::ERASE_VERSION_WRITE, id, version);
+    enqueue(rec);
+}
+
+void LMDBWriteBehind::erase(const IdT &id)
+{
+    LMDBStorage::WriteRecord rec(LMDBStorage::WriteRecord::ERASE_ALL_WRITE, id, 0);
+    enqueue(rec);
+}
+
+bool LMDBWriteBehind::waitDurable(TicketT ticket, int timeoutMs)
+{
+    // errors are counted before durable_ moves past the failed records
+    if ((ticket <= durable_.load(std::memory_order_acquire)) && (0 == totalErrors_.load(std::memory_order_relaxed)))
+    {
+        return true;
+    }
+    std::unique_lock<std::mutex> guard(lock_);
+    auto isDone = [this, ticket]() { return ticket <= durable_.load(std::memory_order_acquire); };
+    if (0 > timeoutMs)
+    {
+        committed_.wait(guard, isDone);
+    }
+    else if (!committed_.wait_for(guard, std::chrono::milliseconds(timeoutMs), isDone))
+    {
+        return false;
+    }
+    return !isFailed(ticket);
+}
+
+void LMDBWriteBehind::flush()
+{
+    const TicketT last = lastTicket();
+    std::unique_lock<std::mutex> guard(lock_);
+    committed_.wait(guard, [this, last]() { return last <= durable_.load(std::memory_order_acquire); });
+
+    TicketT failed = 0;
+    for (TicketRangesT::const_iterator it = failed_.begin(); it != failed_.end(); ++it)
+    {
+        if ((reportedFailures_ < it->second) && (it->first <= last))
+        {
+            failed = std::max(it->first, reportedFailures_ + 1);
+            break;
+        }
+    }
+    if (0 != failed)
+    {
+        reportedFailures_ = std::max(reportedFailures_, last);
+        throw std::runtime_error("LMDBWriteBehind: record with ticket " + to_string(failed) +
+                                 " was not written, records queued before flush are not durable!");
+    }
+}
+
+bool LMDBWriteBehind::isFailed(TicketT ticket) const
+{
+    // first range that starts after the ticket, the one before it may hold the ticket
+    TicketRangesT::const_iterator it =
+        std::upper_bound(failed_.begin(), failed_.end(), ticket,
+                         [](TicketT val, const std::pair<TicketT, TicketT> &range) { return val < range.first; });
+    return (failed_.begin() != it) && (ticket <= (it - 1)->second);
+}
+
+LMDBWriteBehind::TicketT LMDBWriteBehind::enqueue(LMDBStorage::WriteRecord &rec)
+{
+    TicketT ticket = 0;
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (stopped_) [[unlikely]]
+        {
+            throw std::runtime_error("LMDBWriteBehind: writer is stopped, record could not be saved!");
+        }
+        pending_.push_back(std::move(rec));
+        ticket = enqueued_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    }
+    hasWork_.notify_one();
+    return ticket;
+}
+
+void LMDBWriteBehind::run()
+{
+    LMDBStorage::WriteBatchT batch;
+    batch.reserve(maxBatchSize_);
+    TicketRangesT failed;
+    TicketT taken = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> guard(lock_);
+            hasWork_.wait(guard, [this]() { return stopped_ || !pending_.empty(); });
+            if (!stopped_ && (0 < maxDelayUs_) && (pending_.size() < maxBatchSize_))
+            {
+                // let the batch fill up, the delay bounds the latency it adds
+                hasWork_.wait_for(guard, std::chrono::microseconds(maxDelayUs_),
+                                  [this]() { return stopped_ || (maxBatchSize_ <= pending_.size()); });
+            }
+            if (pending_.empty())
+            {
+                assert(stopped_);
+                return;
+            }
+            // records are queued in ticket order, so the swapped batch holds the next tickets
+            batch.swap(pending_);
+        }
+
+        for (size_t first = 0; first < batch.size(); first += maxBatchSize_)
+        {
+            const size_t last = std::min(batch.size(), first + maxBatchSize_);
+            failed.clear();
+            if ((0 == first) && (last == batch.size()))
+            {
+                commit(batch, taken + 1, &failed);
+            }
+            else
+            {
+                LMDBStorage::WriteBatchT chunk(std::make_move_iterator(batch.begin() + first),
+                                               std::make_move_iterator(batch.begin() + last));
+                commit(chunk, taken + 1, &failed);
+            }
+            taken += last - first;
+            {
+                std::lock_guard<std::mutex> guard(lock_);
+                failed_.insert(failed_.end(), failed.begin(), failed.end());
+                durable_.store(taken, std::memory_order_release);
+            }
+            committed_.notify_all();
+        }
+        batch.clear();
+    }
+}
+
+void LMDBWriteBehind::commit(const LMDBStorage::WriteBatchT &batch, TicketT first, TicketRangesT *failed)
+{
+    assert(nullptr != failed);
+    totalBatches_.fetch_add(1, std::memory_order_relaxed);
+    try
+    {
+        storage_->write(batch);
+        totalWritten_.fetch_add(batch.size(), std::memory_order_relaxed);
+        return;
+    }
+    catch (const std::exception &ex)
+    {
+        aux::ExchLogger::instance()->error(
+            string("LMDBWriteBehind: batch commit failed, retrying without failed records: ") + ex.what());
+    }
+    // one bad record must not drop the rest of the batch
+    try
+    {
+        std::vector<size_t> skipped;
+        storage_->writeSkippingFailed(batch, &skipped);
+        for (size_t pos : skipped)
+        {
+            failed->push_back(std::make_pair(first + pos, first + pos));
+        }
+        totalErrors_.fetch_add(skipped.size(), std::memory_order_relaxed);
+        totalWritten_.fetch_add(batch.size() - skipped.size(), std::memory_order_relaxed);
+    }
+    catch (const std::exception &ex)
+    {
+        failed->clear();
+        failed->push_back(std::make_pair(first, first + batch.size() - 1));
+        totalErrors_.fetch_add(batch.size(), std::memory_order_relaxed);
+        aux::ExchLogger::instance()->error(string("LMDBWriteBehind: batch is lost: ") + ex.what());
+    }
+}
@@ -0,0 +1,142 @@
+/**
+ Concurrent Order Processor library
+
+ Authors: dudleylane, Claude
+
+ Copyright (C) 2026 dudleylane
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#pragma once
+
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "LMDBStorage.h"
+
+namespace COP
+{
+namespace Store
+{
+
+struct LMDBWriteBehindParams
+{
+    /// records committed by one LMDB write transaction at most
+    u32 maxBatchSize_ = 256;
+    /// how long the writer waits for a batch to fill up, 0 - commits whatever is queued
+    u32 maxDelayUs_ = 200;
+};
+
+/// Asynchronous persistence stage in front of LMDBStorage.
+/// save() and erase() only queue the record and return a ticket; a dedicated writer
+/// thread commits the queued records in one LMDB write transaction per batch, so
+/// the caller does not wait for the commit. waitDurable() blocks until the record
+/// with the ticket is committed. update() and replace() return a version computed
+/// from the stored data, they wait for the queue to drain and run synchronously.
+/// Tickets of records that could not be written are kept, they are never reported
+/// as durable.
+class LMDBWriteBehind final : public FileSaver
+{
+public:
+    typedef u64 TicketT;
+
+    LMDBWriteBehind(LMDBStorage *storage, const LMDBWriteBehindParams &params);
+    ~LMDBWriteBehind();
+
+    /// commits queued records and stops the writer, later saves fail
+    void shutdown();
+
+public:
+    /// reimplemented from FileSaver
+    void load(const std::string &path, FileStorageObserver *observer) override;
+    IdT save(const char *buf, size_t size) override;
+    void save(const IdT &id, const char *buf, size_t size) override;
+    /// encodes the record straight into the queued record
+    void saveReserved(const IdT &id, size_t size, const RecordEncoder &encoder) override;
+    u32 update(const IdT &id, const char *buf, size_t size) override;
+    u32 replace(const IdT &id, u32 version, const char *buf, size_t size) override;
+    void erase(const IdT &id, u32 version) override;
+    void erase(const IdT &id) override;
+
+public:
+    /// ticket of the last queued record, 0 if nothing was queued
+    TicketT lastTicket() const
+    {
+        return enqueued_.load(std::memory_order_acquire);
+    }
+    /// ticket of the last record the writer is done with, written or failed
+    TicketT durableTicket() const
+    {
+        return durable_.load(std::memory_order_acquire);
+    }
+    /// waits until the record with the ticket is committed
+    /// returns false if it is not committed during timeoutMs or could not be written,
+    /// timeoutMs = -1 means infinite
+    bool waitDurable(TicketT ticket, int timeoutMs = -1);
+    /// waits until everything queued so far is committed
+    /// throws if a record queued so far could not be written; a failure is reported by one flush
+    void flush();
+
+    u64 totalBatches() const
+    {
+        return totalBatches_.load(std::memory_order_relaxed);
+    }
+    u64 totalWritten() const
+    {
+        return totalWritten_.load(std::memory_order_relaxed);
+    }
+    u64 totalErrors() const
+    {
+        return totalErrors_.load(std::memory_order_relaxed);
+    }
+
+private:
+    /// first and last ticket of the records
+    typedef std::vector<std::pair<TicketT, TicketT>> TicketRangesT;
+
+    TicketT enqueue(LMDBStorage::WriteRecord &rec);
+    void run();
+    /// commits the records with tickets from first on, tickets of the records not written go to failed
+    void commit(const LMDBStorage::WriteBatchT &batch, TicketT first, TicketRangesT *failed);
+    /// lock_ should be held
+    bool isFailed(TicketT ticket) const;
+
+    LMDBWriteBehind(const LMDBWriteBehind &) = delete;
+    LMDBWriteBehind &operator=(const LMDBWriteBehind &) = delete;
+
+private:
+    LMDBStorage *storage_;
+    u32 maxBatchSize_;
+    u32 maxDelayUs_;
+
+    /// guards pending_ and the ticket assignment, so tickets follow the queue order
+    std::mutex lock_;
+    std::condition_variable hasWork_;
+    std::condition_variable committed_;
+    LMDBStorage::WriteBatchT pending_;
+    bool stopped_;
+
+    std::atomic<TicketT> enqueued_;
+    std::atomic<TicketT> durable_;
+    /// records not written, in ticket order; guarded by lock_
+    TicketRangesT failed_;
+    /// failures up to this ticket are reported by flush()
+    TicketT reportedFailures_;
+
+    std::atomic<u64> totalBatches_;
+    std::atomic<u64> totalWritten_;
+    std::atomic<u64> totalErrors_;
+
+    std::thread thread_;
+};
+
+} // namespace Store
+} // namespace COP
@@ -12,7 +12,6 @@
 
 #include <stdexcept>
 #include <cassert>
-#include <iterator>
 #include "NLinkedTree.h"
 #include "Logger.h"
 #include "ExchUtils.h"
@@ -24,28 +23,6 @@ using namespace aux;
 using namespace COP;
 using namespace COP::ACID;
 
-namespace
-{
-struct ChildElement
-{
-    K childId_;
-    K parentId_;
-
-    ChildElement() : childId_(), parentId_() {}
-    ChildElement(const K &chld, const K &prnt) : childId_(chld), parentId_(prnt) {}
-};
-inline bool operator<(const ChildElement &lft, const ChildElement &rght)
-{
-    if (lft.childId_ == rght.childId_)
-    {
-        return lft.parentId_ < rght.parentId_;
-    }
-    return lft.childId_ < rght.childId_;
-}
-
-typedef std::set<ChildElement> ChildrenT;
-} // namespace
-
 namespace
 {
 enum LogMessages
@@ -132,13 +109,92 @@ private:
 
 } // namespace
 
-NTreeNode::NTreeNode() : key_(), value_() {}
+namespace
+{
+inline bool writes(const NTreeNode *node, unsigned char slot)
+{
+    return !node->dependsOn_.list_[slot].isReadOnly();
+}
 
-NTreeNode::NTreeNode(const K &key, const V &value) : key_(key), value_(value) {}
+/// user has to wait for its previous user of the object
+inline bool mustWait(const NTreeNode *node, unsigned char slot)
+{
+    const NTreeNode *prev = node->prevUser_[slot];
+    if (nullptr == prev)
+    {
+        return false;
+    }
+    const unsigned char prevSlot = node->prevSlot_[slot];
+    return writes(node, slot) || writes(prev, prevSlot) || prev->blockedOn_[prevSlot];
+}
+} // namespace
+
+NTreeNode::NTreeNode()
+    : key_(), value_(nullptr), dependsOn_(), parentLinks_(0), ready_(false), readyPrev_(nullptr),
+      readyNext_(nullptr), nextFree_(nullptr)
+{
+}
+
+void NTreeNode::init(const K &key, const V &value)
+{
+    key_ = key;
+    value_ = value;
+    dependsOn_.size_ = 0;
+    parentLinks_ = 0;
+    ready_ = false;
+    readyPrev_ = nullptr;
+    readyNext_ = nullptr;
+    nextFree_ = nullptr;
+}
+
+NTreeNodeSlab::NTreeNodeSlab() : chunks_(), free_(nullptr) {}
+
+NTreeNode *NTreeNodeSlab::create(const K &key, const V &value)
+{
+    if (nullptr == free_) [[unlikely]]
+    {
+        addChunk();
+    }
+    NTreeNode *node = free_;
+    free_ = node->nextFree_;
+    node->init(key, value);
+    return node;
+}
+
+void NTreeNodeSlab::destroy(NTreeNode *node)
+{
+    assert(nullptr != node);
+    node->nextFree_ = free_;
+    free_ = node;
+}
+
+void NTreeNodeSlab::reset()
+{
+    free_ = nullptr;
+    for (ChunksT::reverse_iterator it = chunks_.rbegin(); it != chunks_.rend(); ++it)
+    {
+        for (size_t i = CHUNK_SIZE; 0 < i; --i)
+        {
+            (*it)[i - 1].nextFree_ = free_;
+            free_ = &(*it)[i - 1];
+        }
+    }
+}
+
+void NTreeNodeSlab::addChunk()
+{
+    chunks_.push_back(std::unique_ptr<NTreeNode[]>(new NTreeNode[CHUNK_SIZE]));
+    NTreeNode *chunk = chunks_.back().get();
+    for (size_t i = CHUNK_SIZE; 0 < i; --i)
+    {
+        chunk[i - 1].nextFree_ = free_;
+        free_ = &chunk[i - 1];
+    }
+}
 
 NLinkTree::NLinkTree()
-    : root_(), keys_(), depends_(), treeNodeAllocator_(2000), keyParamAllocator_(2000), objParamAllocator_(),
-      current_(nullptr)
+    : nodes_(), keys_(2048), lastUsers_(4096), readyHead_(nullptr), readyTail_(nullptr), readySize_(0),
+      lastAdded_(), current_(nullptr)
 {
 }
 
@@ -149,513 +205,405 @@ NLinkTree::~NLinkTree()
 
 void NLinkTree::clear()
 {
-    KParamsT tmpKeys;
-    OParamsT tmpDepends;
+    keys_.clear();
+    lastUsers_.clear();
+    nodes_.reset();
+    readyHead_ = nullptr;
+    readyTail_ = nullptr;
+    readySize_ = 0;
+    lastAdded_ = K();
+    current_ = nullptr;
+}
+
+void NLinkTree::pushReady(NTreeNode *node, int *readyToExecuteAdded, ReadyNodesT *ready)
+{
+    assert(!node->ready_);
+    node->ready_ = true;
+    node->readyPrev_ = readyTail_;
+    node->readyNext_ = nullptr;
+    if (nullptr != readyTail_)
+    {
+        readyTail_->readyNext_ = node;
+    }
+    else
     {
-        NTreeRootNode tmp;
-        std::swap(tmp, root_);
-        std::swap(tmpKeys, keys_);
-        std::swap(tmpDepends, depends_);
+        readyHead_ = node;
     }
+    readyTail_ = node;
+    ++readySize_;
+    ++(*readyToExecuteAdded);
+    if (nullptr != ready)
     {
-        for (OParamsT::iterator it = tmpDepends.begin(); it != tmpDepends.end(); ++it)
-        {
-            AllocAutoPtr<OParam> el(it->second, &objParamAllocator_); //std::unique_ptr<OParam> el(it->second);
-        }
+        ready->push_back(ReadyNode(node->key_, node->value_));
     }
+}
+
+void NLinkTree::unlinkReady(NTreeNode *node)
+{
+    assert(node->ready_);
+    if (node == current_)
+    {
+        // iteration continues from the previous ready node
+        current_ = node->readyPrev_;
+    }
+    if (nullptr != node->readyPrev_)
+    {
+        node->readyPrev_->readyNext_ = node->readyNext_;
+    }
+    else
     {
-        for (KParamsT::iterator it = tmpKeys.begin(); it != tmpKeys.end(); ++it)
+        readyHead_ = node->readyNext_;
+    }
+    if (nullptr != node->readyNext_)
+    {
+        node->readyNext_->readyPrev_ = node->readyPrev_;
+    }
+    else
+    {
+        readyTail_ = node->readyPrev_;
+    }
+    node->ready_ = false;
+    node->readyPrev_ = nullptr;
+    node->readyNext_ = nullptr;
+    --readySize_;
+}
+
+void NLinkTree::releaseUsers(NTreeNode *node, unsigned char slot, int *readyToExecuteAdded, ReadyNodesT *ready)
+{
+    // removal only unblocks: walk while users stop waiting, readers behind a released
+    // reader may run as well, users behind a writer keep waiting for it
+    while ((nullptr != node) && node->blockedOn_[slot] && !mustWait(node, slot))
+    {
+        node->blockedOn_[slot] = false;
+        assert(0 < node->parentLinks_);
+        if (0 == --node->parentLinks_)
         {
-            AllocAutoPtr<KParam> el(it->second, &keyParamAllocator_); //std::unique_ptr<KParam> el(it->second);
-            if (nullptr != it->second->node_)
-            {
-                AllocAutoPtr<NTreeNode> nd(it->second->node_,
-                                           &treeNodeAllocator_); //std::unique_ptr<NTreeNode> nd(it->second->node_);
-            }
+            pushReady(node, readyToExecuteAdded, ready);
         }
+        if (writes(node, slot))
+        {
+            break;
+        }
+        const unsigned char nextSlot = node->nextSlot_[slot];
+        node = node->nextUser_[slot];
+        slot = nextSlot;
     }
 }
 
-bool NLinkTree::add(const K &key, const V &value, const DependObjs &depend, int *readyToExecuteAdded)
+bool NLinkTree::add(const K &key, const V &value, const DependObjs &depend, int *readyToExecuteAdded,
+                    ReadyNodesT *ready)
 {
-    assert((keys_.empty()) || (keys_.rbegin()->first < key));
+    assert(keys_.empty() || (lastAdded_ < key));
     assert(nullptr != readyToExecuteAdded);
     if (aux::ExchLogger::instance()->isDebugOn())
     {
         aux::ExchLogger::instance()->debug("NLinkTree::add() start add");
     }
 
-    if (keys_.end() != keys_.find(key))
+    if (nullptr != keys_.find(key))
     {
         aux::ExchLogger::instance()->debug("NLinkTree::add() - key already exists");
         return false;
     }
 
     *readyToExecuteAdded = 0;
-    KSetT parents;
-    // update list of the based objects and get list of the parent keys
+    NTreeNode *node = nodes_.create(key, value);
+    // link the transaction behind the last user of each object
     for (size_t o = 0; o < static_cast<size_t>(depend.size_); ++o)
     {
         const O &obj = depend.list_[o];
         assert(obj.id_.isValid());
-        OParamsT::iterator depIt = depends_.find(obj);
-        if (depends_.end() == depIt)
+        bool duplicate = false;
+        for (size_t d = 0; (d < static_cast<size_t>(node->dependsOn_.size_)) && !duplicate; ++d)
+        {
+            duplicate = (obj == node->dependsOn_.list_[d]);
+            if (duplicate && !obj.isReadOnly())
+            {
+                node->dependsOn_.list_[d].access_ = COP::ACID::write_AccessMode;
+            }
+        }
+        if (duplicate)
         {
-            // if this object not used in transactions now - need to add it
-            AllocAutoPtr<OParam> el(objParamAllocator_.create(OParam()),
-                                    &objParamAllocator_); //std::unique_ptr<OParam> el(new OParam());
-            el->usedIn_.insert(key);
-            depends_.insert(OParamsT::value_type(obj, el.get()));
-            el.release();
+            continue;
         }
-        else
+        const unsigned char slot = node->dependsOn_.size_++;
+        node->dependsOn_.list_[slot] = obj;
+        node->nextUser_[slot] = nullptr;
+        node->prevUser_[slot] = nullptr;
+        node->blockedOn_[slot] = false;
+
+        LastUser *last = lastUsers_.find(obj);
+        if (nullptr == last)
         {
-            assert(nullptr != depIt->second);
-            // if this object used in some transaction - last transaction will be parent of this one
-            assert(!depIt->second->usedIn_.empty());
-            assert(*(depIt->second->usedIn_.rbegin()) < key);
-            parents.insert(*(depIt->second->usedIn_.rbegin()));
-            // add this transaction as a last that use this object
-            depIt->second->usedIn_.insert(key);
+            lastUsers_.insert(obj, LastUser(node, slot));
+            continue;
         }
+        NTreeNode *parent = last->node_;
+        assert(nullptr != parent);
+        assert(parent->key_ < key);
+        parent->nextUser_[last->slot_] = node;
+        parent->nextSlot_[last->slot_] = slot;
+        node->prevUser_[slot] = parent;
+        node->prevSlot_[slot] = last->slot_;
+        *last = LastUser(node, slot);
     }
-
-    AllocAutoPtr<NTreeNode> node(treeNodeAllocator_.create(NTreeNode(key, value)), &treeNodeAllocator_);
-    // update tree - add new transaction as a child to all parents or root
-    if (!parents.empty())
+    // access modes are final only after all duplicates were merged
+    for (unsigned char slot = 0; slot < node->dependsOn_.size_; ++slot)
     {
-        for (KSetT::const_iterator pIt = parents.begin(); pIt != parents.end(); ++pIt)
+        node->blockedOn_[slot] = mustWait(node, slot);
+        if (node->blockedOn_[slot])
         {
-            KParamsT::iterator kIt = keys_.find(*pIt);
-            if (keys_.end() == kIt)
-            {
-                ///Todo: error about broken structure!
-            }
-            else
-            {
-                assert(nullptr != kIt->second);
-                assert(nullptr != kIt->second->node_);
-                // remember parent
-                node->parents_.insert(kIt->second->node_);
-                // add this element into the parent's childrens
-                kIt->second->node_->children_.insert(node.get());
-            }
+            ++node->parentLinks_;
         }
     }
-    else
+
+    keys_.insert(key, node);
+    lastAdded_ = key;
+    if (0 == node->parentLinks_)
     {
-        // if no parents - than root parent
-        root_.children_.push_back(node.get());
-        ++(*readyToExecuteAdded);
+        pushReady(node, readyToExecuteAdded, ready);
     }
 
-    // add into the list of the keys
-    AllocAutoPtr<KParam> keyParams(keyParamAllocator_.create(KParam()),
-                                   &keyParamAllocator_); //std::unique_ptr<KParam> keyParams(new KParam());
-    keyParams->node_ = node.get();
-    keyParams->dependsOn_ = depend;
-    keys_.insert(KParamsT::value_type(key, keyParams.get()));
-    keyParams.release();
-
-    node.release();
-
     if (aux::ExchLogger::instance()->isDebugOn())
     {
-        NLTLogMessage l(ADDNODE_FINAL_MSG, key, root_.children_.size(), *readyToExecuteAdded);
+        NLTLogMessage l(ADDNODE_FINAL_MSG, key, readySize_, *readyToExecuteAdded);
         aux::ExchLogger::instance()->debug(l);
     }
     return true;
 }
 
-bool NLinkTree::remove(const K &key, int *readyToExecuteAdded)
+bool NLinkTree::remove(const K &key, int *readyToExecuteAdded, ReadyNodesT *ready)
 {
     assert(nullptr != readyToExecuteAdded);
     if (aux::ExchLogger::instance()->isDebugOn())
     {
-        NLTLogMessage l(REMOVENODE_START_MSG, key, root_.children_.size(), 0);
+        NLTLogMessage l(REMOVENODE_START_MSG, key, readySize_, 0);
         aux::ExchLogger::instance()->debug(l);
     }
 
     *readyToExecuteAdded = 0;
-    AllocAutoPtr<KParam> keyParams;
-    AllocAutoPtr<NTreeNode> nd;
-    { /// locate parameters of this transaction and remove it from keys_
-        KParamsT::iterator kIt = keys_.find(key);
-        if (keys_.end() == kIt)
-        {
-            aux::ExchLogger::instance()->debug("NLinkTree::remove() - remove failed, unable to locate object");
-            return false;
-        }
-        assert(nullptr != kIt->second);
-        assert(nullptr != kIt->second->node_);
-        keyParams.reset(kIt->second, &keyParamAllocator_);
-        nd.reset(keyParams->node_, &treeNodeAllocator_);
-        keys_.erase(kIt);
+    NTreeNode *const *found = keys_.find(key);
+    if (nullptr == found)
+    {
+        aux::ExchLogger::instance()->debug("NLinkTree::remove() - remove failed, unable to locate object");
+        return false;
     }
+    NTreeNode *node = *found;
+    assert(nullptr != node);
+    keys_.erase(key);
 
-    { /// search for this transaction in root_ and remove it
-        /// this transaction will be in root element, if it does not contains any parents
-        if (keyParams->node_->parents_.empty())
-        {
-            if (root_.children_.empty())
-            {
-                aux::ExchLogger::instance()->debug(
-                    "NLinkTree::remove() - remove failed, hasn't parents but root is empty.");
-                return false;
-            }
-            if (keyParams->node_ == current_)
-            {
-                TreeNodesListT::iterator erIt = root_.children_.begin();
-                if (*erIt == current_)
-                {
-                    current_ = nullptr;
-                }
-                else
-                {
-                    for (; erIt != root_.children_.end(); ++erIt)
-                    {
-                        if (*erIt == current_)
-                        {
-                            TreeNodesListT::const_iterator i = erIt;
-                            --i;
-                            current_ = *i;
-                            break;
-                        }
-                    }
-                }
-                if (root_.children_.end() != erIt)
-                {
-                    root_.children_.erase(erIt);
-                }
-            }
-            else
-            {
-                for (TreeNodesListT::iterator erIt = root_.children_.begin(); erIt != root_.children_.end(); ++erIt)
-                {
-                    if (*erIt == keyParams->node_)
-                    {
-                        root_.children_.erase(erIt);
-                        break;
-                    }
-                }
-                //root_.children_.erase(keyParams->node_);
-            }
-        }
+    if (node->ready_)
+    {
+        unlinkReady(node);
     }
 
-    ChildrenT childn;
-    { // for all objects - remove this transaction and bind next element in usedIn_ (that child of this transaction)
-        // with previous usedIn_ element (that parent of this transaction).
-        // remove this transaction from all objects that used in it
-        for (size_t o = 0; o < static_cast<size_t>(keyParams->dependsOn_.size_); ++o)
+    // bind the previous and the next user of every object, the next user
+    // without parents left becomes ready
+    for (size_t o = 0; o < static_cast<size_t>(node->dependsOn_.size_); ++o)
+    {
+        NTreeNode *parent = node->prevUser_[o];
+        NTreeNode *child = node->nextUser_[o];
+        if (nullptr != parent)
         {
-            const O &obj = keyParams->dependsOn_.list_[o];
-            OParamsT::iterator depIt = depends_.find(obj);
-            if (depends_.end() != depIt)
-            {
-                assert(nullptr != depIt->second);
-                if (depIt->second->usedIn_.empty())
-                {
-                    continue; ///ToDo: notify about error
-                }
-                K child = K(), prnt = K();
-                if (key == *(depIt->second->usedIn_.begin()))
-                {
-                    /// it this transaction first - than child should become next
-                    KSetT::const_iterator c = ++(depIt->second->usedIn_.begin());
-                    if (depIt->second->usedIn_.end() != c)
-                    {
-                        child = *c;
-                    }
-                    depIt->second->usedIn_.erase(depIt->second->usedIn_.begin());
-                }
-                else
-                {
-                    KSetT::iterator kIt = depIt->second->usedIn_.find(key);
-                    if (depIt->second->usedIn_.end() != kIt)
-                    {
-                        KSetT::const_iterator i = kIt;
-                        ++i;
-                        if (depIt->second->usedIn_.end() != i)
-                        {
-                            child = *i;
-                        }
-                        i = kIt;
-                        --i;
-                        prnt = *i;
-                        depIt->second->usedIn_.erase(kIt);
-                    }
-                }
-                if ((K() != child) || (K() != prnt))
-                {
-                    childn.insert(ChildElement(child, prnt));
-                }
-                if (depIt->second->usedIn_.empty())
-                {
-                    AllocAutoPtr<OParam> el(depIt->second,
-                                            &objParamAllocator_); //std::unique_ptr<OParam> el(depIt->second);
-                    depends_.erase(depIt);
-                }
-            }
-            else
-            {
-                /// todo: notify about error
-            }
+            parent->nextUser_[node->prevSlot_[o]] = child;
+            parent->nextSlot_[node->prevSlot_[o]] = node->nextSlot_[o];
         }
-    }
-
-    { // for the all children - update parent
-        for (ChildrenT::const_iterator cIt = childn.begin(); cIt != childn.end(); ++cIt)
+        if (nullptr != child)
         {
-            KParamsT::iterator prntIt = keys_.end();
-            if (K() != cIt->parentId_)
+            child->prevUser_[node->nextSlot_[o]] = parent;
+            child->prevSlot_[node->nextSlot_[o]] = node->prevSlot_[o];
+            releaseUsers(child, node->nextSlot_[o], readyToExecuteAdded, ready);
+        }
+        else
+        {
+            // node was the last user of the object
+            if (nullptr != parent)
             {
-                prntIt = keys_.find(cIt->parentId_);
-                if (keys_.end() != prntIt)
-                {
-                    assert(nullptr != prntIt->second);
-                    assert(nullptr != prntIt->second->node_);
-                    prntIt->second->node_->children_.erase(keyParams->node_);
-                }
-                else
-                {
-                    true; /// todo: note about broken structure
-                }
+                LastUser *last = lastUsers_.find(node->dependsOn_.list_[o]);
+                assert(nullptr != last);
+                *last = LastUser(parent, node->prevSlot_[o]);
             }
-
-            if (K() != cIt->childId_)
+            else
             {
-                KParamsT::iterator chldIt = keys_.find(cIt->childId_);
-                if (keys_.end() == chldIt)
-                {
-                    /// todo: note about broken structure
-                    continue;
-                }
-                assert(nullptr != chldIt->second);
-                assert(nullptr != chldIt->second->node_);
-                chldIt->second->node_->parents_.erase(keyParams->node_);
-
-                if (keys_.end() != prntIt)
-                {
-                    chldIt->second->node_->parents_.insert(prntIt->second->node_);
-                }
-                else
-                {
-                    // check that child has not another parents and add it into the Root
-                    if (chldIt->second->node_->parents_.empty())
-                    {
-                        ChildrenT::const_iterator nxtIt = cIt;
-                        ++nxtIt;
-                        if ((childn.end() == nxtIt) || (cIt->childId_ != nxtIt->childId_))
-                        {
-                            root_.children_.push_back(chldIt->second->node_);
-                            ++(*readyToExecuteAdded);
-                        }
-                    }
-                }
+                lastUsers_.erase(node->dependsOn_.list_[o]);
             }
         }
     }
+    nodes_.destroy(node);
 
     if (aux::ExchLogger::instance()->isDebugOn())
     {
-        NLTLogMessage l(REMOVENODE_FINAL_MSG, key, root_.children_.size(), *readyToExecuteAdded);
+        NLTLogMessage l(REMOVENODE_FINAL_MSG, key, readySize_, *readyToExecuteAdded);
         aux::ExchLogger::instance()->debug(l);
     }
     return true;
 }
 
-bool NLinkTree::getParents(const K &key, KSetT *parents) const
+bool NLinkTree::find(const K &key, V *value) const
 {
-    assert(nullptr != parents);
+    assert(nullptr != value);
+    NTreeNode *const *node = keys_.find(key);
+    if (nullptr == node)
     {
-        KParamsT::const_iterator kIt = keys_.find(key);
-        if (keys_.end() == kIt)
-        {
-            return false;
-        }
-        assert(nullptr != kIt->second);
-        assert(nullptr != kIt->second->node_);
-        for (TreeNodesT::const_iterator it = kIt->second->node_->parents_.begin();
-             it != kIt->second->node_->parents_.end(); ++it)
-        {
-            parents->insert((*it)->key_);
-        }
+        return false;
     }
+    assert(nullptr != *node);
+    *value = (*node)->value_;
     return true;
 }
 
-bool NLinkTree::getChildren(const K &key, KSetT *children) const
+bool NLinkTree::getParents(const K &key, KSetT *parents) const
 {
-    assert(nullptr != children);
+    assert(nullptr != parents);
+    NTreeNode *const *found = keys_.find(key);
+    if (nullptr == found)
     {
-        KParamsT::const_iterator kIt = keys_.find(key);
-        if (keys_.end() == kIt)
-        {
-            return false;
-        }
-        assert(nullptr != kIt->second);
-        assert(nullptr != kIt->second->node_);
-        for (TreeNodesT::const_iterator it = kIt->second->node_->children_.begin();
-             it != kIt->second->node_->children_.end(); ++it)
-        {
-            children->insert((*it)->key_);
-        }
+        return false;
     }
-    return true;
-}
-
-bool NLinkTree::next(const K &after, K *key, V *value)
-{
-    /*for(TreeNodesT::const_iterator it = root_.children_.begin(); 
-		it != root_.children_.end(); ++it){
-		cout<< (*it)->key_<< ", "<< (*it)->value_<< endl;
-	}*/
+    const NTreeNode *node = *found;
+    for (unsigned char o = 0; o < node->dependsOn_.size_; ++o)
     {
-        NTreeNode *node = nullptr;
-        if (K() == after)
-        {
-            if (root_.children_.empty())
-            {
-                return false;
-            }
-            node = *(root_.children_.begin());
-        }
-        else
+        // writer depends on the readers just before it or on the previous writer,
+        // reader depends on the nearest writer before it
+        const bool writer = writes(node, o);
+        const NTreeNode *prev = node->prevUser_[o];
+        unsigned char slot = node->prevSlot_[o];
+        while (nullptr != prev)
         {
-            bool found = false;
-            for (TreeNodesListT::const_iterator it = root_.children_.begin(); it != root_.children_.end(); ++it)
+            const bool prevWriter = writes(prev, slot);
+            if (prevWriter)
             {
-                assert(nullptr != *it);
-                found = (after == (*it)->key_);
-                if (found)
+                if (!writer || (prev == node->prevUser_[o]))
                 {
-                    ++it;
-                    if (root_.children_.end() == it)
-                    {
-                        return false;
-                    }
-                    node = *(it);
-                    break;
+                    parents->insert(prev->key_);
                 }
+                break;
             }
-            if (!found)
+            if (writer)
             {
-                return false;
+                parents->insert(prev->key_);
             }
+            const unsigned char s = prev->prevSlot_[slot];
+            prev = prev->prevUser_[slot];
+            slot = s;
         }
-        assert(nullptr != node);
-        *key = node->key_;
-        *value = node->value_;
     }
     return true;
 }
 
-bool NLinkTree::next(K *key, V *value)
+bool NLinkTree::getChildren(const K &key, KSetT *children) const
 {
+    assert(nullptr != children);
+    NTreeNode *const *found = keys_.find(key);
+    if (nullptr == found)
     {
-        NTreeNode *node = nullptr;
-        if (nullptr == current_)
-        {
-            if (root_.children_.empty())
-            {
-                aux::ExchLogger::instance()->debug("NLinkTree::next() - root has no childrent.");
-                return false;
-            }
-            node = *(root_.children_.begin());
-        }
-        else
+        return false;
+    }
+    const NTreeNode *node = *found;
+    for (unsigned char o = 0; o < node->dependsOn_.size_; ++o)
+    {
+        // writer is followed by the readers after it or by the next writer,
+        // reader is followed by the nearest writer after it
+        const bool writer = writes(node, o);
+        const NTreeNode *next = node->nextUser_[o];
+        unsigned char slot = node->nextSlot_[o];
+        bool first = true;
+        while (nullptr != next)
         {
-            bool found = false;
-            for (TreeNodesListT::const_iterator it = root_.children_.begin(); it != root_.children_.end(); ++it)
+            const bool nextWriter = writes(next, slot);
+            if (nextWriter)
             {
-                assert(nullptr != *it);
-                // Prefetch next list node's target to reduce cache misses
-                auto peek = std::next(it);
-                if (peek != root_.children_.end())
-                {
-                    __builtin_prefetch(*peek, 0, 1);
-                }
-                found = (*it == current_);
-                if (found)
+                if (!writer || first)
                 {
-                    ++it;
-                    if (root_.children_.end() == it)
-                    {
-                        aux::ExchLogger::instance()->debug("NLinkTree::next() - last child.");
-                        return false;
-                    }
-                    node = *(it);
-                    break;
+                    children->insert(next->key_);
                 }
+                break;
             }
-            if (!found)
+            if (writer)
             {
-                aux::ExchLogger::instance()->debug("NLinkTree::next() - not found.");
-                return false;
+                children->insert(next->key_);
             }
+            first = false;
+            const unsigned char s = next->nextSlot_[slot];
+            next = next->nextUser_[slot];
+            slot = s;
         }
-        assert(nullptr != node);
-        *key = node->key_;
-        *value = node->value_;
-        current_ = node;
     }
-    if (aux::ExchLogger::instance()->isDebugOn())
+    return true;
+}
+
+bool NLinkTree::next(const K &after, K *key, V *value)
+{
+    NTreeNode *node = nullptr;
+    if (K() == after)
     {
-        NLTLogMessage l(NEXT_FINAL_MSG, *key, 0, 0);
-        aux::ExchLogger::instance()->debug(l);
+        node = readyHead_;
+    }
+    else
+    {
+        NTreeNode *const *found = keys_.find(after);
+        if ((nullptr == found) || !(*found)->ready_)
+        {
+            return false;
+        }
+        node = (*found)->readyNext_;
+    }
+    if (nullptr == node)
+    {
+        return false;
     }
+    *key = node->key_;
+    *value = node->value_;
     return true;
 }
 
-bool NLinkTree::current(K *key, V *value) const
+bool NLinkTree::next(K *key, V *value)
 {
+    NTreeNode *node = nullptr;
+    if (nullptr == current_)
     {
-        NTreeNode *node = nullptr;
-        if (nullptr == current_)
+        if (nullptr == readyHead_)
         {
+            aux::ExchLogger::instance()->debug("NLinkTree::next() - root has no childrent.");
             return false;
         }
-        else
+        node = readyHead_;
+    }
+    else
+    {
+        assert(current_->ready_);
+        node = current_->readyNext_;
+        if (nullptr == node)
         {
-            bool found = false;
-            for (TreeNodesListT::const_iterator it = root_.children_.begin(); it != root_.children_.end(); ++it)
-            {
-                assert(nullptr != *it);
-                found = (*it == current_);
-                if (found)
-                {
-                    node = *(it);
-                    break;
-                }
-            }
-            if (!found)
-            {
-                return false;
-            }
+            aux::ExchLogger::instance()->debug("NLinkTree::next() - last child.");
+            return false;
         }
-        assert(nullptr != node);
-        *key = node->key_;
-        *value = node->value_;
+    }
+    *key = node->key_;
+    *value = node->value_;
+    current_ = node;
+    if (aux::ExchLogger::instance()->isDebugOn())
+    {
+        NLTLogMessage l(NEXT_FINAL_MSG, *key, 0, 0);
+        aux::ExchLogger::instance()->debug(l);
     }
     return true;
 }
 
-bool NLinkTree::isCurrentValid() const
+bool NLinkTree::current(K *key, V *value) const
 {
     if (nullptr == current_)
     {
         return false;
     }
-    for (TreeNodesListT::const_iterator it = root_.children_.begin(); it != root_.children_.end(); ++it)
-    {
-        assert(nullptr != *it);
-        if (*it == current_)
-        {
-            return true;
-        }
-    }
-    return false;
+    *key = current_->key_;
+    *value = current_->value_;
+    return true;
+}
+
+bool NLinkTree::isCurrentValid() const
+{
+    return nullptr != current_;
 }
 
 void NLinkTree::dumpTree()
@@ -664,46 +612,44 @@ void NLinkTree::dumpTree()
     buf[0] = 0;
     aux::toStr(buf, keys_.size());
     aux::ExchLogger::instance()->fatal(string("Start duming tree: tree contains elements ") + buf);
-    string keyVal;
-    for (KParamsT::const_iterator it = keys_.begin(); it != keys_.end(); ++it)
-    {
-        if (nullptr == it->second)
-        {
-            break;
-        }
-        keyVal.clear();
-        it->first.toString(keyVal);
-        string text = "El '" + keyVal + "' depends on: ";
-        for (int i = 0; i < it->second->dependsOn_.size_; ++i)
+    keys_.forEach(
+        [this, &buf](const K &key, NTreeNode *node)
         {
-            keyVal.clear();
-            it->second->dependsOn_.list_[i].id_.toString(keyVal);
-            text += "[" + keyVal + ", ";
-            buf[0] = 0;
-            aux::toStr(buf, static_cast<int>(it->second->dependsOn_.list_[i].type_));
-            text += buf;
-            text += "]";
-        }
+            assert(nullptr != node);
+            string keyVal;
+            key.toString(keyVal);
+            string text = "El '" + keyVal + "' depends on: ";
+            for (int i = 0; i < node->dependsOn_.size_; ++i)
+            {
+                keyVal.clear();
+                node->dependsOn_.list_[i].id_.toString(keyVal);
+                text += "[" + keyVal + ", ";
+                buf[0] = 0;
+                aux::toStr(buf, static_cast<int>(node->dependsOn_.list_[i].type_));
+                text += buf;
+                text += "]";
+            }
 
-        assert(nullptr != it->second->node_);
-        text += ". Parents: ";
-        for (TreeNodesT::const_iterator iit = it->second->node_->parents_.begin();
-             iit != it->second->node_->parents_.end(); ++iit)
-        {
-            keyVal.clear();
-            (*iit)->key_.toString(keyVal);
-            text += "[" + keyVal + "] ";
-        }
-        text += ". Children: ";
-        for (TreeNodesT::const_iterator iit = it->second->node_->children_.begin();
-             iit != it->second->node_->children_.end(); ++iit)
-        {
-            keyVal.clear();
-            (*iit)->key_.toString(keyVal);
-            text += "[" + keyVal + "] ";
-        }
+            KSetT related;
+            getParents(key, &related);
+            text += ". Parents: ";
+            for (KSetT::const_iterator it = related.begin(); it != related.end(); ++it)
+            {
+                keyVal.clear();
+                it->toString(keyVal);
+                text += "[" + keyVal + "] ";
+            }
+            related.clear();
+            getChildren(key, &related);
+            text += ". Children: ";
+            for (KSetT::const_iterator it = related.begin(); it != related.end(); ++it)
+            {
+                keyVal.clear();
+                it->toString(keyVal);
+                text += "[" + keyVal + "] ";
+            }
 
-        aux::ExchLogger::instance()->fatal(text);
-    }
+            aux::ExchLogger::instance()->fatal(text);
+        });
     aux::ExchLogger::instance()->fatal(string("Finished duming tree"));
-}
\ No newline at end of file
+}
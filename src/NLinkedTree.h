@@ -13,13 +13,10 @@
 #pragma once
 
 #include <memory>
-#include <deque>
 #include <set>
-#include <map>
-#include <flat_map>
-#include <list>
+#include <vector>
 
-#include "AllocateCache.h"
+#include "OpenHashTable.h"
 #include "TypesDef.h"
 #include "TransactionDef.h"
 
@@ -42,53 +39,96 @@ typedef COP::ACID::Transaction *V;
 typedef std::set<O> OSetT;
 typedef std::set<K> KSetT;
 
-struct NTreeNode;
-
-struct SortedByKey
+/// Transaction in the dependency graph. Every object of the transaction links
+/// to its previous and next user, so edges are kept inline, DEPENDANT_OBJECT_LIMIT
+/// per direction. A writer waits for every earlier user of the object, a reader
+/// waits only for an earlier writer, so consecutive readers run concurrently.
+struct NTreeNode
 {
-    bool operator()(const NTreeNode *lft, const NTreeNode *rgt) const;
-};
+    K key_;
+    V value_;
+    /// objects of the transaction, without duplicates
+    DependObjs dependsOn_;
 
-typedef std::set<NTreeNode *, SortedByKey> TreeNodesT;
-typedef std::list<NTreeNode *> TreeNodesListT;
+    NTreeNode *prevUser_[COP::ACID::DEPENDANT_OBJECT_LIMIT];
+    NTreeNode *nextUser_[COP::ACID::DEPENDANT_OBJECT_LIMIT];
+    /// index of the same object in dependsOn_ of prevUser_/nextUser_
+    unsigned char prevSlot_[COP::ACID::DEPENDANT_OBJECT_LIMIT];
+    unsigned char nextSlot_[COP::ACID::DEPENDANT_OBJECT_LIMIT];
+    /// true while an earlier user of the object has to finish first
+    bool blockedOn_[COP::ACID::DEPENDANT_OBJECT_LIMIT];
+    /// amount of blockedOn_ set, transaction is ready to execute at 0
+    unsigned parentLinks_;
 
-struct NTreeRootNode
-{
-    TreeNodesListT children_;
+    /// list of ready to execute transactions, in the order they became ready
+    bool ready_;
+    NTreeNode *readyPrev_;
+    NTreeNode *readyNext_;
+
+    /// next free node of the slab
+    NTreeNode *nextFree_;
 
-    NTreeRootNode() {}
+    NTreeNode();
+    void init(const K &key, const V &value);
 };
 
-struct NTreeNode
+/// Fixed size chunks of nodes, freed nodes are reused and memory is returned
+/// only when the slab is destroyed.
+class NTreeNodeSlab
 {
-    TreeNodesT parents_;
-    TreeNodesT children_;
+public:
+    enum
+    {
+        CHUNK_SIZE = 1024
+    };
 
-    K key_;
-    V value_;
+public:
+    NTreeNodeSlab();
 
-    NTreeNode();
-    NTreeNode(const K &key, const V &value);
+    NTreeNode *create(const K &key, const V &value);
+    void destroy(NTreeNode *node);
+    /// makes every node free, memory is kept
+    void reset();
+
+private:
+    void addChunk();
+
+    typedef std::vector<std::unique_ptr<NTreeNode[]>> ChunksT;
+    ChunksT chunks_;
+    NTreeNode *free_;
+
+    NTreeNodeSlab(const NTreeNodeSlab &);
+    const NTreeNodeSlab &operator=(const NTreeNodeSlab &);
 };
 
-inline bool SortedByKey::operator()(const NTreeNode *lft, const NTreeNode *rgt) const
+struct ObjectInTransactionHash
 {
-    return lft->key_ < rgt->key_;
-}
+    size_t operator()(const O &obj) const
+    {
+        return COP::IdTHash()(obj.id_) ^ (static_cast<size_t>(obj.type_) << 56);
+    }
+};
 
-struct KParam
+/// last transaction that uses the object
+struct LastUser
 {
-    DependObjs dependsOn_;
-
     NTreeNode *node_;
+    unsigned char slot_;
+
+    LastUser() : node_(nullptr), slot_(0) {}
+    LastUser(NTreeNode *node, unsigned char slot) : node_(node), slot_(slot) {}
 };
-typedef std::flat_map<K, KParam *> KParamsT;
 
-struct OParam
+/// transaction which became ready to execute (got into the root)
+struct ReadyNode
 {
-    KSetT usedIn_;
+    K key_;
+    V value_;
+
+    ReadyNode() : key_(), value_(nullptr) {}
+    ReadyNode(const K &key, const V &value) : key_(key), value_(value) {}
 };
-typedef std::flat_map<O, OParam *> OParamsT;
+typedef std::vector<ReadyNode> ReadyNodesT;
 
 class NLinkTree
 {
@@ -96,8 +136,11 @@ public:
     NLinkTree();
     ~NLinkTree();
 
-    bool add(const K &key, const V &value, const DependObjs &depend, int *readyToExecuteAdded);
-    bool remove(const K &key, int *readyToExecuteAdded);
+    /// ready, if not null, receives transactions that became ready to execute
+    bool add(const K &key, const V &value, const DependObjs &depend, int *readyToExecuteAdded,
+             ReadyNodesT *ready = nullptr);
+    bool remove(const K &key, int *readyToExecuteAdded, ReadyNodesT *ready = nullptr);
+    bool find(const K &key, V *value) const;
     bool getParents(const K &key, KSetT *parents) const;
     bool getChildren(const K &key, KSetT *children) const;
 
@@ -111,14 +154,25 @@ public:
     void dumpTree();
 
 private:
-    NTreeRootNode root_;
-    ///contains object and set of the objects that it depends on
-    KParamsT keys_;
-    ///contains list of objects that depends on key object
-    OParamsT depends_;
-    AllocateCache<NTreeNode> treeNodeAllocator_;
-    AllocateCache<KParam> keyParamAllocator_;
-    AllocateCache<OParam> objParamAllocator_;
+    void pushReady(NTreeNode *node, int *readyToExecuteAdded, ReadyNodesT *ready);
+    /// unblocks users of the object starting from node, after an earlier user was removed
+    void releaseUsers(NTreeNode *node, unsigned char slot, int *readyToExecuteAdded, ReadyNodesT *ready);
+    void unlinkReady(NTreeNode *node);
+
+private:
+    typedef OpenHashTable<K, NTreeNode *, COP::IdTHash> KeysT;
+    typedef OpenHashTable<O, LastUser, ObjectInTransactionHash> LastUsersT;
+
+    NTreeNodeSlab nodes_;
+    KeysT keys_;
+    /// object -> transaction which used it last, new users become its children
+    LastUsersT lastUsers_;
+
+    NTreeNode *readyHead_;
+    NTreeNode *readyTail_;
+    size_t readySize_;
+    K lastAdded_;
+
     NTreeNode *current_;
 
 protected:
@@ -126,4 +180,4 @@ protected:
     const NLinkTree &operator=(const NLinkTree &);
 };
 
-} // namespace aux
\ No newline at end of file
+} // namespace aux
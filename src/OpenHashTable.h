@@ -0,0 +1,193 @@
+/**
+ Concurrent Order Processor library
+
+ Author: Sergey Mikhailik
+
+ Copyright (C) 2009-2026 Sergey Mikhailik
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cassert>
+
+namespace aux
+{
+
+/// Single-threaded open addressing hash table with linear probing.
+/// Slots live in one array, so lookups touch consecutive memory and insert/erase
+/// allocate only when the table grows. Erase shifts the following entries back
+/// instead of leaving tombstones. Key and Value have to be default constructible.
+template <typename Key, typename Value, typename Hash> class OpenHashTable
+{
+public:
+    /// capacity is rounded up to a power of two
+    explicit OpenHashTable(size_t capacity = 1024) : size_(0), shift_(0)
+    {
+        reset(capacity);
+    }
+
+    Value *find(const Key &key)
+    {
+        size_t idx = 0;
+        return locate(key, &idx) ? &slots_[idx].value_ : nullptr;
+    }
+    const Value *find(const Key &key) const
+    {
+        size_t idx = 0;
+        return locate(key, &idx) ? &slots_[idx].value_ : nullptr;
+    }
+
+    /// returns false if the key is already present
+    bool insert(const Key &key, const Value &value)
+    {
+        // load factor is kept below 1/2, probe sequences stay short
+        if (slots_.size() <= 2 * (size_ + 1)) [[unlikely]]
+        {
+            grow();
+        }
+        size_t idx = 0;
+        if (locate(key, &idx))
+        {
+            return false;
+        }
+        slots_[idx].key_ = key;
+        slots_[idx].value_ = value;
+        slots_[idx].used_ = true;
+        ++size_;
+        return true;
+    }
+
+    bool erase(const Key &key)
+    {
+        size_t idx = 0;
+        if (!locate(key, &idx))
+        {
+            return false;
+        }
+        const size_t mask = slots_.size() - 1;
+        size_t hole = idx;
+        for (size_t next = (hole + 1) & mask; slots_[next].used_; next = (next + 1) & mask)
+        {
+            // entry may fill the hole if its home slot is not between the hole and itself
+            const size_t home = homeOf(slots_[next].key_);
+            if (((next - home) & mask) >= ((next - hole) & mask))
+            {
+                slots_[hole] = slots_[next];
+                hole = next;
+            }
+        }
+        slots_[hole] = Slot();
+        --size_;
+        return true;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+    bool empty() const
+    {
+        return 0 == size_;
+    }
+
+    void clear()
+    {
+        for (typename SlotsT::iterator it = slots_.begin(); it != slots_.end(); ++it)
+        {
+            *it = Slot();
+        }
+        size_ = 0;
+    }
+
+    /// calls f(key, value) for every entry, in no particular order
+    template <typename F> void forEach(F f) const
+    {
+        for (typename SlotsT::const_iterator it = slots_.begin(); it != slots_.end(); ++it)
+        {
+            if (it->used_)
+            {
+                f(it->key_, it->value_);
+            }
+        }
+    }
+
+private:
+    struct Slot
+    {
+        Key key_;
+        Value value_;
+        bool used_;
+
+        Slot() : key_(), value_(), used_(false) {}
+    };
+    typedef std::vector<Slot> SlotsT;
+
+    size_t homeOf(const Key &key) const
+    {
+        // Fibonacci hashing spreads sequential ids over the whole table
+        return static_cast<size_t>((static_cast<std::uint64_t>(Hash()(key)) * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    /// returns true and the slot of the key, or false and the free slot for it
+    bool locate(const Key &key, size_t *idx) const
+    {
+        const size_t mask = slots_.size() - 1;
+        for (size_t i = homeOf(key);; i = (i + 1) & mask)
+        {
+            if (!slots_[i].used_)
+            {
+                *idx = i;
+                return false;
+            }
+            if (slots_[i].key_ == key)
+            {
+                *idx = i;
+                return true;
+            }
+        }
+    }
+
+    void reset(size_t capacity)
+    {
+        size_t size = 2;
+        unsigned bits = 1;
+        while (size < capacity)
+        {
+            size <<= 1;
+            ++bits;
+        }
+        slots_.assign(size, Slot());
+        shift_ = 64 - bits;
+        size_ = 0;
+    }
+
+    void grow()
+    {
+        SlotsT old;
+        old.swap(slots_);
+        reset(2 * old.size());
+        for (typename SlotsT::const_iterator it = old.begin(); it != old.end(); ++it)
+        {
+            if (it->used_)
+            {
+                size_t idx = 0;
+                locate(it->key_, &idx);
+                slots_[idx] = *it;
+                ++size_;
+            }
+        }
+    }
+
+private:
+    SlotsT slots_;
+    size_t size_;
+    unsigned shift_;
+};
+
+} // namespace aux
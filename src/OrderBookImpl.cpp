@@ -11,8 +11,8 @@
 */
 
 #include <stdexcept>
+#include <algorithm>
 #include "OrderBookImpl.h"
-#include "OrderStorage.h"
 #include "FileStorageDef.h"
 #include "Logger.h"
 
@@ -92,9 +92,58 @@ private:
     const IdT &id_;
 };
 
+template <typename DepthT> void addToDepth(DepthT *depth, const RestingOrder &order)
+{
+    BookLevel &lvl = (*depth)[order.price_];
+    lvl.price = order.price_;
+    lvl.totalQty += order.leavesQty_;
+    ++lvl.orderCount;
+}
+
+template <typename DepthT> void removeFromDepth(DepthT *depth, const RestingOrder &order)
+{
+    typename DepthT::iterator it = depth->find(order.price_);
+    assert(depth->end() != it);
+    if (depth->end() == it)
+    {
+        return;
+    }
+    it->second.totalQty -= order.leavesQty_;
+    if (0 == --it->second.orderCount)
+    {
+        depth->erase(it);
+    }
+}
+
+template <typename DepthT> void copyDepth(const DepthT &depth, size_t maxLevels, std::vector<BookLevel> *levels)
+{
+    size_t count = (0 == maxLevels) ? depth.size() : std::min(maxLevels, depth.size());
+    levels->reserve(count);
+    for (typename DepthT::const_iterator it = depth.begin(); 0 < count; ++it, --count)
+    {
+        levels->push_back(it->second);
+    }
+}
+
+template <typename SideT> void copyLevels(const SideT &side, size_t maxLevels, std::vector<BookLevel> *levels)
+{
+    size_t count = (0 == maxLevels) ? side.levelCount() : std::min(maxLevels, side.levelCount());
+    levels->reserve(count);
+    side.forEachLevel(
+        [levels, &count](const PriceLevel &lvl)
+        {
+            if (0 == count)
+            {
+                return false;
+            }
+            levels->push_back(BookLevel{lvl.price_, lvl.totalQty_, lvl.orderCount_});
+            return 0 < --count;
+        });
+}
+
 } // namespace
 
-OrderBookImpl::OrderBookImpl(void) : storage_(nullptr) {}
+OrderBookImpl::OrderBookImpl(void) : storage_(nullptr), type_(INVALID_BOOKTYPE) {}
 
 OrderBookImpl::~OrderBookImpl(void)
 {
@@ -106,11 +155,16 @@ OrderBookImpl::~OrderBookImpl(void)
     }
 }
 
-void OrderBookImpl::init(const InstrumentsT &instr, OrderSaver *storage)
+void OrderBookImpl::init(const InstrumentsT &instr, OrderSaver *storage, BookType type)
 {
     assert(nullptr != storage);
     assert(nullptr == storage_);
+    if (MULTIMAP_BOOKTYPE != type && PRICELEVEL_BOOKTYPE != type)
+    {
+        throw std::runtime_error("Unable to init OrderBook - book type is not supported!");
+    }
     storage_ = storage;
+    type_ = type;
 
     for (InstrumentsT::const_iterator it = instr.begin(); it != instr.end(); ++it)
     {
@@ -120,6 +174,42 @@ void OrderBookImpl::init(const InstrumentsT &instr, OrderSaver *storage)
     }
 }
 
+void OrderBookImpl::insert(OrdersGroup *grp, const OrderEntry &order)
+{
+    if (BUY_SIDE == order.side_)
+    {
+        tbb::mutex::scoped_lock lock(grp->buyLock_);
+        if (PRICELEVEL_BOOKTYPE == type_)
+        {
+            grp->buyLevels_.add(RestingOrder(order));
+        }
+        else
+        {
+            OrdersByPriceDescT::iterator oit =
+                grp->buyOrder_.insert(OrdersByPriceDescT::value_type(order.price_, RestingOrder(order)));
+            addToDepth(&grp->buyDepth_, oit->second);
+        }
+    }
+    else if (SELL_SIDE == order.side_)
+    {
+        tbb::mutex::scoped_lock lock(grp->sellLock_);
+        if (PRICELEVEL_BOOKTYPE == type_)
+        {
+            grp->sellLevels_.add(RestingOrder(order));
+        }
+        else
+        {
+            OrdersByPriceAscT::iterator oit =
+                grp->sellOrder_.insert(OrdersByPriceAscT::value_type(order.price_, RestingOrder(order)));
+            addToDepth(&grp->sellDepth_, oit->second);
+        }
+    }
+    else
+    {
+        throw std::runtime_error("side is not supported!");
+    }
+}
+
 void OrderBookImpl::add(const OrderEntry &order)
 {
     assert(order.orderId_.isValid());
@@ -129,20 +219,11 @@ void OrderBookImpl::add(const OrderEntry &order)
     {
         throw std::runtime_error("Unable to add order into book - instrument not registered!");
     }
-    if (BUY_SIDE == order.side_)
-    {
-        tbb::mutex::scoped_lock lock(it->second->buyLock_);
-        it->second->buyOrder_.insert(OrdersByPriceAscT::value_type(order.price_, order.orderId_));
-    }
-    else if (SELL_SIDE == order.side_)
-    {
-        tbb::mutex::scoped_lock lock(it->second->sellLock_);
-        it->second->sellOrder_.insert(OrdersByPriceAscT::value_type(order.price_, order.orderId_));
-    }
-    else
+    if (BUY_SIDE != order.side_ && SELL_SIDE != order.side_)
     {
         throw std::runtime_error("Unable to add order into book - side is not supported!");
     }
+    insert(it->second, order);
 
     if (nullptr != storage_)
     {
@@ -164,20 +245,11 @@ void OrderBookImpl::restore(const OrderEntry &order)
     {
         throw std::runtime_error("Unable to restore order into book - instrument not registered!");
     }
-    if (BUY_SIDE == order.side_)
-    {
-        tbb::mutex::scoped_lock lock(it->second->buyLock_);
-        it->second->buyOrder_.insert(OrdersByPriceAscT::value_type(order.price_, order.orderId_));
-    }
-    else if (SELL_SIDE == order.side_)
-    {
-        tbb::mutex::scoped_lock lock(it->second->sellLock_);
-        it->second->sellOrder_.insert(OrdersByPriceAscT::value_type(order.price_, order.orderId_));
-    }
-    else
+    if (BUY_SIDE != order.side_ && SELL_SIDE != order.side_)
     {
         throw std::runtime_error("Unable to restore order into book - side is not supported!");
     }
+    insert(it->second, order);
 
     if (aux::ExchLogger::instance()->isNoteOn())
     {
@@ -204,18 +276,26 @@ void OrderBookImpl::remove(const OrderEntry &order)
     if (BUY_SIDE == order.side_)
     {
         tbb::mutex::scoped_lock lock(it->second->buyLock_);
-        // buyOrder_ uses descending order (highest price first for buy side)
-        // lower_bound finds first element with key <= price in descending order
-        OrdersByPriceDescT::iterator oit = it->second->buyOrder_.lower_bound(order.price_);
-        while ((it->second->buyOrder_.end() != oit) && (order.price_ == oit->first))
+        if (PRICELEVEL_BOOKTYPE == type_)
+        {
+            found = it->second->buyLevels_.remove(order.orderId_);
+        }
+        else
         {
-            found = oit->second == order.orderId_;
-            if (found)
+            // buyOrder_ uses descending order (highest price first for buy side)
+            // lower_bound finds first element with key <= price in descending order
+            OrdersByPriceDescT::iterator oit = it->second->buyOrder_.lower_bound(order.price_);
+            while ((it->second->buyOrder_.end() != oit) && (order.price_ == oit->first))
             {
-                it->second->buyOrder_.erase(oit);
-                break;
+                found = oit->second.orderId_ == order.orderId_;
+                if (found)
+                {
+                    removeFromDepth(&it->second->buyDepth_, oit->second);
+                    it->second->buyOrder_.erase(oit);
+                    break;
+                }
+                ++oit;
             }
-            ++oit;
         }
         if (!found)
         {
@@ -225,16 +305,24 @@ void OrderBookImpl::remove(const OrderEntry &order)
     else if (SELL_SIDE == order.side_)
     {
         tbb::mutex::scoped_lock lock(it->second->sellLock_);
-        OrdersByPriceAscT::iterator oit = it->second->sellOrder_.lower_bound(order.price_);
-        while ((it->second->sellOrder_.end() != oit) && (order.price_ == oit->first))
+        if (PRICELEVEL_BOOKTYPE == type_)
+        {
+            found = it->second->sellLevels_.remove(order.orderId_);
+        }
+        else
         {
-            found = oit->second == order.orderId_;
-            if (found)
+            OrdersByPriceAscT::iterator oit = it->second->sellOrder_.lower_bound(order.price_);
+            while ((it->second->sellOrder_.end() != oit) && (order.price_ == oit->first))
             {
-                it->second->sellOrder_.erase(oit);
-                break;
+                found = oit->second.orderId_ == order.orderId_;
+                if (found)
+                {
+                    removeFromDepth(&it->second->sellDepth_, oit->second);
+                    it->second->sellOrder_.erase(oit);
+                    break;
+                }
+                ++oit;
             }
-            ++oit;
         }
         if (!found)
         {
@@ -253,108 +341,138 @@ void OrderBookImpl::remove(const OrderEntry &order)
     }
 }
 
-IdT OrderBookImpl::find(const OrderFunctor &functor) const
+void OrderBookImpl::update(const OrderEntry &order)
 {
-    OrderGroupsByInstrumentT::const_iterator it = orderGroups_.find(functor.instrument());
-    if (orderGroups_.end() != it)
+    OrderGroupsByInstrumentT::iterator it = orderGroups_.find(order.instrument_.getId());
+    if (orderGroups_.end() == it)
+    {
+        return;
+    }
+    if (BUY_SIDE == order.side_)
     {
-        if (BUY_SIDE == functor.side())
+        tbb::mutex::scoped_lock lock(it->second->buyLock_);
+        if (PRICELEVEL_BOOKTYPE == type_)
         {
-            bool stop = false;
-            tbb::mutex::scoped_lock lock(it->second->buyLock_);
-            for (OrdersByPriceDescT::const_iterator oit = it->second->buyOrder_.begin();
-                 oit != it->second->buyOrder_.end(); ++oit)
-            {
-                if (functor.match(oit->second, &stop))
-                {
-                    return oit->second;
-                }
-                if (stop)
-                {
-                    break;
-                }
-            }
+            it->second->buyLevels_.update(order.orderId_, order.leavesQty_);
+            return;
         }
-        else if (SELL_SIDE == functor.side())
+        OrdersByPriceDescT::iterator oit = it->second->buyOrder_.lower_bound(order.price_);
+        for (; (it->second->buyOrder_.end() != oit) && (order.price_ == oit->first); ++oit)
         {
-            bool stop = false;
-            tbb::mutex::scoped_lock lock(it->second->sellLock_);
-            for (OrdersByPriceAscT::const_iterator oit = it->second->sellOrder_.begin();
-                 oit != it->second->sellOrder_.end(); ++oit)
+            if (oit->second.orderId_ == order.orderId_)
             {
-                if (functor.match(oit->second, &stop))
-                {
-                    return oit->second;
-                }
-                if (stop)
-                {
-                    break;
-                }
+                BookLevel &lvl = it->second->buyDepth_[order.price_];
+                lvl.totalQty = lvl.totalQty - oit->second.leavesQty_ + order.leavesQty_;
+                oit->second.leavesQty_ = order.leavesQty_;
+                return;
             }
         }
-        else
-        {
-            throw std::runtime_error("Invalid Side for the order's search");
-        }
     }
-    else
+    else if (SELL_SIDE == order.side_)
     {
-        throw std::runtime_error("Unknown instrument for the order's search");
+        tbb::mutex::scoped_lock lock(it->second->sellLock_);
+        if (PRICELEVEL_BOOKTYPE == type_)
+        {
+            it->second->sellLevels_.update(order.orderId_, order.leavesQty_);
+            return;
+        }
+        OrdersByPriceAscT::iterator oit = it->second->sellOrder_.lower_bound(order.price_);
+        for (; (it->second->sellOrder_.end() != oit) && (order.price_ == oit->first); ++oit)
+        {
+            if (oit->second.orderId_ == order.orderId_)
+            {
+                BookLevel &lvl = it->second->sellDepth_[order.price_];
+                lvl.totalQty = lvl.totalQty - oit->second.leavesQty_ + order.leavesQty_;
+                oit->second.leavesQty_ = order.leavesQty_;
+                return;
+            }
+        }
     }
-    return IdT();
 }
 
-void OrderBookImpl::findAll(const OrderFunctor &functor, OrdersT *result) const
+template <typename F> void OrderBookImpl::walk(const OrderFunctor &functor, F f) const
 {
-    assert(nullptr != result);
     OrderGroupsByInstrumentT::const_iterator it = orderGroups_.find(functor.instrument());
-    if (orderGroups_.end() != it)
+    if (orderGroups_.end() == it)
+    {
+        throw std::runtime_error("Unknown instrument for the order's search");
+    }
+    if (BUY_SIDE == functor.side())
     {
-        if (BUY_SIDE == functor.side())
+        tbb::mutex::scoped_lock lock(it->second->buyLock_);
+        if (PRICELEVEL_BOOKTYPE == type_)
+        {
+            it->second->buyLevels_.forEachOrder(f);
+        }
+        else
         {
-            bool stop = false;
-            tbb::mutex::scoped_lock lock(it->second->buyLock_);
             for (OrdersByPriceDescT::const_iterator oit = it->second->buyOrder_.begin();
                  oit != it->second->buyOrder_.end(); ++oit)
             {
-                if (functor.match(oit->second, &stop))
-                {
-                    result->push_back(oit->second);
-                }
-                if (stop)
+                if (!f(oit->second))
                 {
                     break;
                 }
             }
         }
-        else if (SELL_SIDE == functor.side())
+    }
+    else if (SELL_SIDE == functor.side())
+    {
+        tbb::mutex::scoped_lock lock(it->second->sellLock_);
+        if (PRICELEVEL_BOOKTYPE == type_)
+        {
+            it->second->sellLevels_.forEachOrder(f);
+        }
+        else
         {
-            bool stop = false;
-            tbb::mutex::scoped_lock lock(it->second->sellLock_);
             for (OrdersByPriceAscT::const_iterator oit = it->second->sellOrder_.begin();
                  oit != it->second->sellOrder_.end(); ++oit)
             {
-                if (functor.match(oit->second, &stop))
-                {
-                    result->push_back(oit->second);
-                }
-                if (stop)
+                if (!f(oit->second))
                 {
                     break;
                 }
             }
         }
-        else
-        {
-            throw std::runtime_error("Invalid Side for the order's search");
-        }
     }
     else
     {
-        throw std::runtime_error("Unknown instrument for the order's search");
+        throw std::runtime_error("Invalid Side for the order's search");
     }
 }
 
+IdT OrderBookImpl::find(const OrderFunctor &functor) const
+{
+    IdT result;
+    walk(functor,
+         [&functor, &result](const RestingOrder &order)
+         {
+             bool stop = false;
+             if (functor.matchResting(order, &stop))
+             {
+                 result = order.orderId_;
+                 return false;
+             }
+             return !stop;
+         });
+    return result;
+}
+
+void OrderBookImpl::findAll(const OrderFunctor &functor, OrdersT *result) const
+{
+    assert(nullptr != result);
+    walk(functor,
+         [&functor, result](const RestingOrder &order)
+         {
+             bool stop = false;
+             if (functor.matchResting(order, &stop))
+             {
+                 result->push_back(order.orderId_);
+             }
+             return !stop;
+         });
+}
+
 IdT OrderBookImpl::getTop(const SourceIdT &instrument, const Side &side) const
 {
     OrderGroupsByInstrumentT::const_iterator it = orderGroups_.find(instrument);
@@ -363,17 +481,25 @@ IdT OrderBookImpl::getTop(const SourceIdT &instrument, const Side &side) const
         if (BUY_SIDE == side)
         {
             tbb::mutex::scoped_lock lock(it->second->buyLock_);
+            if (PRICELEVEL_BOOKTYPE == type_)
+            {
+                return it->second->buyLevels_.top();
+            }
             if (0 < it->second->buyOrder_.size())
             {
-                return it->second->buyOrder_.begin()->second;
+                return it->second->buyOrder_.begin()->second.orderId_;
             }
         }
         else if (SELL_SIDE == side)
         {
             tbb::mutex::scoped_lock lock(it->second->sellLock_);
+            if (PRICELEVEL_BOOKTYPE == type_)
+            {
+                return it->second->sellLevels_.top();
+            }
             if (0 < it->second->sellOrder_.size())
             {
-                return it->second->sellOrder_.begin()->second;
+                return it->second->sellOrder_.begin()->second.orderId_;
             }
         }
         else
@@ -388,7 +514,7 @@ IdT OrderBookImpl::getTop(const SourceIdT &instrument, const Side &side) const
     return IdT();
 }
 
-BookSnapshot OrderBookImpl::getSnapshot(const SourceIdT &instrument, const Store::OrderDataStorage *storage) const
+BookSnapshot OrderBookImpl::getSnapshot(const SourceIdT &instrument, size_t maxLevels) const
 {
     BookSnapshot snap;
     OrderGroupsByInstrumentT::const_iterator it = orderGroups_.find(instrument);
@@ -397,51 +523,28 @@ BookSnapshot OrderBookImpl::getSnapshot(const SourceIdT &instrument, const Store
         return snap;
     }
 
-    // Aggregate bids (descending price)
+    /// depth is aggregated incrementally on add/remove/update, snapshot is a copy of the top levels
     {
         tbb::mutex::scoped_lock lock(it->second->buyLock_);
-        std::map<PriceT, BookLevel, PriceTDescend> levels;
-        for (const auto &[price, orderId] : it->second->buyOrder_)
+        if (PRICELEVEL_BOOKTYPE == type_)
         {
-            OrderEntry *order = storage->locateByOrderId(orderId);
-            if (!order)
-            {
-                continue;
-            }
-            auto &lvl = levels[price];
-            lvl.price = price;
-            lvl.totalQty += order->leavesQty_;
-            lvl.orderCount++;
+            copyLevels(it->second->buyLevels_, maxLevels, &snap.bids);
         }
-        snap.bids.reserve(levels.size());
-        for (auto &[p, lvl] : levels)
+        else
         {
-            snap.bids.push_back(lvl);
+            copyDepth(it->second->buyDepth_, maxLevels, &snap.bids);
         }
     }
-
-    // Aggregate asks (ascending price)
     {
         tbb::mutex::scoped_lock lock(it->second->sellLock_);
-        std::map<PriceT, BookLevel, PriceTAscend> levels;
-        for (const auto &[price, orderId] : it->second->sellOrder_)
+        if (PRICELEVEL_BOOKTYPE == type_)
         {
-            OrderEntry *order = storage->locateByOrderId(orderId);
-            if (!order)
-            {
-                continue;
-            }
-            auto &lvl = levels[price];
-            lvl.price = price;
-            lvl.totalQty += order->leavesQty_;
-            lvl.orderCount++;
+            copyLevels(it->second->sellLevels_, maxLevels, &snap.asks);
         }
-        snap.asks.reserve(levels.size());
-        for (auto &[p, lvl] : levels)
+        else
         {
-            snap.asks.push_back(lvl);
+            copyDepth(it->second->sellDepth_, maxLevels, &snap.asks);
         }
     }
-
     return snap;
 }
@@ -17,15 +17,11 @@
 #include <oneapi/tbb/mutex.h>
 
 #include "DataModelDef.h"
+#include "PriceLevelBook.h"
 
 namespace COP
 {
 
-namespace Store
-{
-class OrderDataStorage;
-}
-
 struct BookLevel
 {
     PriceT price;
@@ -44,15 +40,31 @@ class OrderBookImpl : public OrderBook
 public:
     typedef std::set<SourceIdT> InstrumentsT;
 
+    /// storage used for the resting orders of each book side
+    enum BookType
+    {
+        INVALID_BOOKTYPE = 0,
+        /// std::multimap keyed by price
+        MULTIMAP_BOOKTYPE,
+        /// sorted price levels with FIFO queues and O(1) cancel by handle
+        PRICELEVEL_BOOKTYPE
+    };
+
 public:
     OrderBookImpl(void);
     ~OrderBookImpl(void);
 
-    void init(const InstrumentsT &instr, OrderSaver *storage);
+    void init(const InstrumentsT &instr, OrderSaver *storage, BookType type = MULTIMAP_BOOKTYPE);
+
+    BookType type() const
+    {
+        return type_;
+    }
 
 public:
     virtual void add(const OrderEntry &order);
     virtual void remove(const OrderEntry &order);
+    virtual void update(const OrderEntry &order);
     virtual IdT find(const OrderFunctor &functor) const;
     virtual void findAll(const OrderFunctor &functor, OrdersT *result) const;
 
@@ -60,25 +72,38 @@ public:
 
     virtual void restore(const OrderEntry &order);
 
-    BookSnapshot getSnapshot(const SourceIdT &instrument, const Store::OrderDataStorage *storage) const;
+    /// copies aggregated depth maintained by the book, maxLevels == 0 means full depth
+    BookSnapshot getSnapshot(const SourceIdT &instrument, size_t maxLevels = 0) const;
 
 private:
-    typedef std::multimap<PriceT, IdT, PriceTAscend> OrdersByPriceAscT;
-    typedef std::multimap<PriceT, IdT, PriceTDescend> OrdersByPriceDescT;
+    typedef std::multimap<PriceT, RestingOrder, PriceTAscend> OrdersByPriceAscT;
+    typedef std::multimap<PriceT, RestingOrder, PriceTDescend> OrdersByPriceDescT;
+    typedef std::map<PriceT, BookLevel, PriceTAscend> DepthAscT;
+    typedef std::map<PriceT, BookLevel, PriceTDescend> DepthDescT;
     struct OrdersGroup
     {
         mutable oneapi::tbb::mutex buyLock_;
         OrdersByPriceDescT buyOrder_;
+        DepthDescT buyDepth_;
 
         mutable oneapi::tbb::mutex sellLock_;
         OrdersByPriceAscT sellOrder_;
+        DepthAscT sellDepth_;
+
+        /// used instead of buyOrder_/sellOrder_ when book type is PRICELEVEL_BOOKTYPE
+        PriceLevelBookSide<PriceTDescend> buyLevels_;
+        PriceLevelBookSide<PriceTAscend> sellLevels_;
     };
 
     typedef std::map<IdT, OrdersGroup *> OrderGroupsByInstrumentT;
 
+    void insert(OrdersGroup *grp, const OrderEntry &order);
+    template <typename F> void walk(const OrderFunctor &functor, F f) const;
+
     OrderGroupsByInstrumentT orderGroups_;
 
     OrderSaver *storage_;
+    BookType type_;
 };
 
 } // namespace COP
@@ -10,8 +10,11 @@
  See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
 */
 
+#include <bit>
 #include <cstring>
+#include <memory>
 #include <stdexcept>
+#include <type_traits>
 #include "OrderCodec.h"
 #include "StringTCodec.h"
 
@@ -22,13 +25,165 @@ using namespace COP::Codec;
 namespace
 {
 const int BUFFER_SIZE = 256;
+const u32 ORDER_RECORD_MAGIC = 0x3244524f; // "ORD2"
+const u32 ORDER_RECORD_FORMAT = 2;
+const size_t FORMAT_OFFSET = 4;
+
+static_assert(std::endian::native == std::endian::little, "OrderRecord layout is little-endian!");
+static_assert(std::is_trivially_copyable<OrderRecord>::value, "OrderRecord should be POD!");
+static_assert(288 == sizeof(OrderRecord), "OrderRecord layout is changed, increase ORDER_RECORD_FORMAT!");
+
+void writeId(const IdT &id, OrderRecord::RecordId *rec)
+{
+    rec->id_ = id.id_;
+    rec->date_ = id.date_;
+    rec->reserved_ = 0;
+}
+
+IdT readId(const OrderRecord::RecordId &rec)
+{
+    return IdT(rec.id_, rec.date_);
 }
 
+} // namespace
+
 OrderCodec::OrderCodec(void) {}
 
 OrderCodec::~OrderCodec(void) {}
 
 void OrderCodec::encode(const OrderEntry &val, std::string *buf, IdT *id, u32 *version)
+{
+    assert(nullptr != buf);
+
+    const size_t offset = buf->size();
+    buf->resize(offset + RECORD_SIZE);
+    encode(val, buf->data() + offset, id, version);
+}
+
+char *OrderCodec::encode(const OrderEntry &val, char *buf, IdT *id, u32 *version)
+{
+    assert(nullptr != buf);
+    assert(nullptr != id);
+    assert(nullptr != version);
+
+    *id = val.orderId_;
+    *version = 0;
+
+    OrderRecord rec;
+    rec.magic_ = ORDER_RECORD_MAGIC;
+    rec.formatVersion_ = ORDER_RECORD_FORMAT;
+    rec.size_ = static_cast<u32>(RECORD_SIZE);
+    rec.reserved_ = 0;
+
+    writeId(val.instrument_.getId(), &rec.instrument_);
+    writeId(val.account_.getId(), &rec.account_);
+    writeId(val.clearing_.getId(), &rec.clearing_);
+    writeId(val.destination_.getId(), &rec.destination_);
+    writeId(val.clOrderId_.getId(), &rec.clOrderId_);
+    writeId(val.origClOrderId_.getId(), &rec.origClOrderId_);
+    writeId(val.source_.getId(), &rec.source_);
+    writeId(val.executions_.getId(), &rec.executions_);
+    writeId(val.origOrderId_, &rec.origOrderId_);
+
+    rec.creationTime_ = val.creationTime_;
+    rec.lastUpdateTime_ = val.lastUpdateTime_;
+    rec.expireTime_ = val.expireTime_;
+    rec.settlDate_ = val.settlDate_;
+
+    rec.price_ = val.price_;
+    rec.stopPx_ = val.stopPx_;
+    rec.avgPx_ = val.avgPx_;
+    rec.dayAvgPx_ = val.dayAvgPx_;
+
+    rec.status_ = static_cast<i32>(val.status_);
+    rec.side_ = static_cast<i32>(val.side_);
+    rec.ordType_ = static_cast<i32>(val.ordType_);
+    rec.tif_ = static_cast<i32>(val.tif_);
+    rec.settlType_ = static_cast<i32>(val.settlType_);
+    rec.capacity_ = static_cast<i32>(val.capacity_);
+    rec.currency_ = static_cast<i32>(val.currency_);
+
+    rec.minQty_ = val.minQty_;
+    rec.orderQty_ = val.orderQty_;
+    rec.leavesQty_ = val.leavesQty_;
+    rec.cumQty_ = val.cumQty_;
+    rec.dayOrderQty_ = val.dayOrderQty_;
+    rec.dayCumQty_ = val.dayCumQty_;
+
+    rec.stateZone1Id_ = val.stateMachinePersistance_.stateZone1Id_;
+    rec.stateZone2Id_ = val.stateMachinePersistance_.stateZone2Id_;
+    rec.padding_ = 0;
+
+    memcpy(buf, &rec, sizeof(rec));
+    return buf + sizeof(rec);
+}
+
+OrderEntry *OrderCodec::decode(const IdT &id, u32 /*version*/, const char *buf, size_t size)
+{
+    assert(nullptr != buf);
+    assert(0 < size);
+
+    if ((FORMAT_OFFSET < size) && (':' == buf[FORMAT_OFFSET]))
+    {
+        return decodeDelimited(id, buf, size);
+    }
+    return decodeRecord(id, buf, size);
+}
+
+OrderEntry *OrderCodec::decodeRecord(const IdT &id, const char *buf, size_t size)
+{
+    if (RECORD_SIZE != size)
+    {
+        throw std::runtime_error("Invalid format of the encoded OrderEntry - record size differs from expected!");
+    }
+    // storage values are not aligned, the record is read with one copy
+    OrderRecord rec;
+    memcpy(&rec, buf, sizeof(rec));
+    if ((ORDER_RECORD_MAGIC != rec.magic_) || (ORDER_RECORD_FORMAT != rec.formatVersion_) ||
+        (RECORD_SIZE != rec.size_))
+    {
+        throw std::runtime_error("Invalid format of the encoded OrderEntry - unknown record format!");
+    }
+
+    std::unique_ptr<OrderEntry> val(new OrderEntry(readId(rec.source_), readId(rec.destination_),
+                                                   readId(rec.clOrderId_), readId(rec.origClOrderId_),
+                                                   readId(rec.instrument_), readId(rec.account_),
+                                                   readId(rec.clearing_), readId(rec.executions_)));
+    val->orderId_ = id;
+    val->origOrderId_ = readId(rec.origOrderId_);
+
+    val->creationTime_ = rec.creationTime_;
+    val->lastUpdateTime_ = rec.lastUpdateTime_;
+    val->expireTime_ = rec.expireTime_;
+    val->settlDate_ = rec.settlDate_;
+
+    val->price_ = rec.price_;
+    val->stopPx_ = rec.stopPx_;
+    val->avgPx_ = rec.avgPx_;
+    val->dayAvgPx_ = rec.dayAvgPx_;
+
+    val->status_ = static_cast<OrderStatus>(rec.status_);
+    val->side_ = static_cast<Side>(rec.side_);
+    val->ordType_ = static_cast<OrderType>(rec.ordType_);
+    val->tif_ = static_cast<TimeInForce>(rec.tif_);
+    val->settlType_ = static_cast<SettlTypeBase>(rec.settlType_);
+    val->capacity_ = static_cast<Capacity>(rec.capacity_);
+    val->currency_ = static_cast<Currency>(rec.currency_);
+
+    val->minQty_ = rec.minQty_;
+    val->orderQty_ = rec.orderQty_;
+    val->leavesQty_ = rec.leavesQty_;
+    val->cumQty_ = rec.cumQty_;
+    val->dayOrderQty_ = rec.dayOrderQty_;
+    val->dayCumQty_ = rec.dayCumQty_;
+
+    val->stateMachinePersistance_.stateZone1Id_ = rec.stateZone1Id_;
+    val->stateMachinePersistance_.stateZone2Id_ = rec.stateZone2Id_;
+
+    return val.release();
+}
+
+void OrderCodec::encodeDelimited(const OrderEntry &val, std::string *buf, IdT *id, u32 *version)
 {
     assert(nullptr != buf);
     assert(nullptr != id);
@@ -158,169 +313,8 @@ void OrderCodec::encode(const OrderEntry &val, std::string *buf, IdT *id, u32 *v
     val.stateMachinePersistance_.serialize(*buf);
 }
 
-char *OrderCodec::encode(const OrderEntry &val, char *buf, IdT *id, u32 *version)
+OrderEntry *OrderCodec::decodeDelimited(const IdT &id, const char *buf, size_t size)
 {
-    assert(nullptr != buf);
-    assert(nullptr != id);
-    assert(nullptr != version);
-
-    *id = val.orderId_;
-    *version = 0;
-
-    char *p = buf;
-    p = val.instrument_.getId().serialize(p);
-    *p = '.';
-    ++p;
-
-    p = val.account_.getId().serialize(p);
-    *p = '.';
-    ++p;
-
-    p = val.clearing_.getId().serialize(p);
-    *p = '.';
-    ++p;
-
-    p = val.destination_.getId().serialize(p);
-    *p = '.';
-    ++p;
-
-    // todo: implement
-    //val.execInstruct_.id_.serialize(*buf);
-    //buf->append(1, '.');
-
-    p = val.clOrderId_.getId().serialize(p);
-    *p = '.';
-    ++p;
-
-    p = val.origClOrderId_.getId().serialize(p);
-    *p = '.';
-    ++p;
-
-    p = val.source_.getId().serialize(p);
-    *p = '.';
-    ++p;
-
-    p = val.executions_.getId().serialize(p);
-    *p = '.';
-    ++p;
-
-    p = val.origOrderId_.serialize(p);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.creationTime_), sizeof(val.creationTime_));
-    p += sizeof(val.creationTime_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.lastUpdateTime_), sizeof(val.lastUpdateTime_));
-    p += sizeof(val.lastUpdateTime_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.expireTime_), sizeof(val.expireTime_));
-    p += sizeof(val.expireTime_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.settlDate_), sizeof(val.settlDate_));
-    p += sizeof(val.settlDate_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.price_), sizeof(val.price_));
-    p += sizeof(val.price_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.stopPx_), sizeof(val.stopPx_));
-    p += sizeof(val.stopPx_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.avgPx_), sizeof(val.avgPx_));
-    p += sizeof(val.avgPx_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.dayAvgPx_), sizeof(val.dayAvgPx_));
-    p += sizeof(val.dayAvgPx_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.status_), sizeof(val.status_));
-    p += sizeof(val.status_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.side_), sizeof(val.side_));
-    p += sizeof(val.side_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.ordType_), sizeof(val.ordType_));
-    p += sizeof(val.ordType_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.tif_), sizeof(val.tif_));
-    p += sizeof(val.tif_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.settlType_), sizeof(val.settlType_));
-    p += sizeof(val.settlType_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.capacity_), sizeof(val.capacity_));
-    p += sizeof(val.capacity_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.currency_), sizeof(val.currency_));
-    p += sizeof(val.currency_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.minQty_), sizeof(val.minQty_));
-    p += sizeof(val.minQty_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.orderQty_), sizeof(val.orderQty_));
-    p += sizeof(val.orderQty_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.leavesQty_), sizeof(val.leavesQty_));
-    p += sizeof(val.leavesQty_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.cumQty_), sizeof(val.cumQty_));
-    p += sizeof(val.cumQty_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.dayOrderQty_), sizeof(val.dayOrderQty_));
-    p += sizeof(val.dayOrderQty_);
-    *p = '.';
-    ++p;
-
-    memcpy(p, &(val.dayCumQty_), sizeof(val.dayCumQty_));
-    p += sizeof(val.dayCumQty_);
-    *p = '.';
-    ++p;
-
-    p = val.stateMachinePersistance_.serialize(p);
-    return p;
-}
-
-OrderEntry *OrderCodec::decode(const IdT &id, u32 /*version*/, const char *buf, size_t size)
-{
-    assert(nullptr != buf);
-    assert(0 < size);
 
     SourceIdT sourceId, destId, clOrderId, origClOrderID, instrumentId, accountId, clearingId, executionsId;
 
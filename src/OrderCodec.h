@@ -20,16 +20,86 @@ namespace COP
 namespace Codec
 {
 
+/// Fixed layout of the encoded order, format 2: little-endian, no separators.
+/// Byte 4 of the format 1 record is always ':' (separator of the instrument IdT),
+/// low byte of formatVersion_ is there in format 2, so the formats are told apart by it.
+struct OrderRecord
+{
+    struct RecordId
+    {
+        u64 id_;
+        u32 date_;
+        u32 reserved_;
+    };
+
+    u32 magic_;
+    u32 formatVersion_;
+    u32 size_;
+    u32 reserved_;
+
+    RecordId instrument_;
+    RecordId account_;
+    RecordId clearing_;
+    RecordId destination_;
+    RecordId clOrderId_;
+    RecordId origClOrderId_;
+    RecordId source_;
+    RecordId executions_;
+    RecordId origOrderId_;
+
+    u64 creationTime_;
+    u64 lastUpdateTime_;
+    u64 expireTime_;
+    u64 settlDate_;
+
+    double price_;
+    double stopPx_;
+    double avgPx_;
+    double dayAvgPx_;
+
+    i32 status_;
+    i32 side_;
+    i32 ordType_;
+    i32 tif_;
+    i32 settlType_;
+    i32 capacity_;
+    i32 currency_;
+
+    u32 minQty_;
+    u32 orderQty_;
+    u32 leavesQty_;
+    u32 cumQty_;
+    u32 dayOrderQty_;
+    u32 dayCumQty_;
+
+    i32 stateZone1Id_;
+    i32 stateZone2Id_;
+    u32 padding_;
+};
+
 class OrderCodec
 {
 public:
     OrderCodec(void);
     ~OrderCodec(void);
 
+    /// size of the record written by encode()
+    static const size_t RECORD_SIZE = sizeof(OrderRecord);
+
 public:
+    /// appends the format 2 record
     static void encode(const OrderEntry &val, std::string *buf, IdT *id, u32 *version);
+    /// writes the format 2 record, buf should have RECORD_SIZE bytes.
+    /// buf could be the value reserved by the storage. returns end of the record
     static char *encode(const OrderEntry &val, char *buf, IdT *id, u32 *version);
+    /// appends the '.'-delimited format 1 record, kept to produce records of the older storages
+    static void encodeDelimited(const OrderEntry &val, std::string *buf, IdT *id, u32 *version);
+    /// decodes both formats
     static OrderEntry *decode(const IdT &id, u32 version, const char *buf, size_t size);
+
+private:
+    static OrderEntry *decodeRecord(const IdT &id, const char *buf, size_t size);
+    static OrderEntry *decodeDelimited(const IdT &id, const char *buf, size_t size);
 };
 
 } // namespace Codec
@@ -34,14 +34,28 @@ using namespace COP::Store;
 
 namespace
 {
-class FindOpositeOrder : public OrderFunctor
+/// Walks the opposite side of the book once and collects every fill available
+/// for the order up to its limit price and leavesQty. Fills go to trades_, no
+/// order is selected, so the walk runs until the functor stops it.
+class SweepOpositeOrders : public OrderFunctor
 {
 public:
-    FindOpositeOrder(OrderEntry *order, OrderDataStorage *orderStorage) : order_(order), orderStorage_(orderStorage)
+    SweepOpositeOrders(OrderEntry *order, OrderDataStorage *orderStorage, TradesT *trades)
+        : order_(order), orderStorage_(orderStorage), trades_(trades), remainingQty_(0), price_(0.0),
+          ordType_(INVALID_ORDERTYPE), orderSide_(INVALID_SIDE)
     {
         assert(nullptr != order_);
         assert(nullptr != orderStorage_);
-        if (BUY_SIDE == order_->side_)
+        assert(nullptr != trades_);
+        {
+            /// snapshot the fields of the matched order once, contra orders are locked one by one
+            oneapi::tbb::spin_rw_mutex::scoped_lock lock(order_->entryMutex_, false);
+            remainingQty_ = order_->leavesQty_;
+            price_ = order_->price_;
+            ordType_ = order_->ordType_;
+            orderSide_ = order_->side_;
+        }
+        if (BUY_SIDE == orderSide_)
         {
             side_ = SELL_SIDE;
         }
@@ -52,63 +66,112 @@ public:
     }
     virtual SourceIdT instrument() const;
     virtual bool match(const IdT &order, bool *stop) const;
+    virtual bool matchResting(const RestingOrder &order, bool *stop) const;
+
+    QuantityT remainingQty() const
+    {
+        return remainingQty_;
+    }
+
+private:
+    bool crosses(const PriceT &contrPrice, OrderType contrOrdType) const;
 
 private:
     OrderEntry *order_;
     OrderDataStorage *orderStorage_;
+    TradesT *trades_;
+    mutable QuantityT remainingQty_;
+    PriceT price_;
+    OrderType ordType_;
+    Side orderSide_;
 };
 
-SourceIdT FindOpositeOrder::instrument() const
+SourceIdT SweepOpositeOrders::instrument() const
 {
     return order_->instrument_.getId();
 }
 
-bool FindOpositeOrder::match(const IdT &order, bool *stop) const
+bool SweepOpositeOrders::crosses(const PriceT &contrPrice, OrderType contrOrdType) const
+{
+    if (MARKET_ORDERTYPE == ordType_)
+    {
+        return true;
+    }
+    if (MARKET_ORDERTYPE == contrOrdType)
+    {
+        return true;
+    }
+    if (BUY_SIDE == orderSide_)
+    {
+        return price_ >= contrPrice;
+    }
+    return price_ <= contrPrice;
+}
+
+bool SweepOpositeOrders::match(const IdT &order, bool *stop) const
 {
     OrderEntry *contrOrd = orderStorage_->locateByOrderId(order);
     if (nullptr == contrOrd)
     {
         return false;
     }
+    RestingOrder resting;
+    {
+        oneapi::tbb::spin_rw_mutex::scoped_lock contrLock(contrOrd->entryMutex_, false);
+        resting = RestingOrder(*contrOrd);
+    }
+    return matchResting(resting, stop);
+}
 
-    // read lock on contra order during field reads
-    oneapi::tbb::spin_rw_mutex::scoped_lock contrLock(contrOrd->entryMutex_, false);
+bool SweepOpositeOrders::matchResting(const RestingOrder &order, bool *stop) const
+{
+    assert(nullptr != stop);
+    assert(nullptr != order.order_);
+    if (0 == remainingQty_) [[unlikely]]
+    {
+        *stop = true;
+        return false;
+    }
 
-    if (0 == contrOrd->leavesQty_)
+    /// hot fields kept by the book are enough to skip and stop the walk
+    if (0 == order.leavesQty_)
     {
         return false;
     }
-    if (MARKET_ORDERTYPE == order_->ordType_)
+    if (!crosses(order.price_, order.ordType_))
     {
-        return true;
+        /// book side is sorted by price, nothing behind this order crosses either
+        *stop = true;
+        return false;
     }
-    if (MARKET_ORDERTYPE == contrOrd->ordType_)
+
+    /// the order is going to trade - take leavesQty from the entry itself
+    OrderEntry *contrOrd = order.order_;
+    QuantityT contrLeavesQty = 0;
     {
-        return true;
+        oneapi::tbb::spin_rw_mutex::scoped_lock contrLock(contrOrd->entryMutex_, false);
+        contrLeavesQty = contrOrd->leavesQty_;
     }
-    if (BUY_SIDE == order_->side_)
+    if (0 == contrLeavesQty)
     {
-        if (order_->price_ >= contrOrd->price_)
-        {
-            return true;
-        }
-        else
-        {
-            *stop = true;
-        }
+        return false;
     }
-    else
+
+    TradeParams trade;
+    trade.order_ = contrOrd;
+    trade.lastQty_ = std::min(remainingQty_, contrLeavesQty);
+    trade.lastPx_ = (0 < order.price_) ? order.price_ : price_;
+    if (0 == trade.lastPx_)
     {
-        if (order_->price_ <= contrOrd->price_)
-        {
-            return true;
-        }
-        else
-        {
-            *stop = true;
-        }
+        throw std::runtime_error("OrderMatcher: cannot match two market orders - no reference price available!");
+    }
+    trades_->push_back(trade);
+
+    remainingQty_ -= trade.lastQty_;
+    if (0 == remainingQty_)
+    {
+        *stop = true;
     }
-    assert(nullptr != stop);
     return false;
 }
 } // namespace
@@ -139,17 +202,21 @@ void OrderMatcher::match(OrderEntry *order, const Context &ctxt)
     assert(nullptr != ctxt.orderBook_);
     assert(nullptr != ctxt.orderStorage_);
 
-    IdT id = ctxt.orderBook_->find(FindOpositeOrder(order, ctxt.orderStorage_));
-    if (!id.isValid())
+    /// single pass over the opposite side, all fills are delivered by one execution event
+    std::unique_ptr<ExecutionDeferedEvent> defEvnt(new ExecutionDeferedEvent(order));
+    SweepOpositeOrders sweep(order, ctxt.orderStorage_, &defEvnt->trades_);
+    ctxt.orderBook_->find(sweep);
+
+    if (defEvnt->trades_.empty())
     {
         if (MARKET_ORDERTYPE == order->ordType_)
         {
             /// if market not available - market order should be canceled
             aux::ExchLogger::instance()->error("Unable to find oposite order for Market order during order matching.");
-            std::unique_ptr<CancelOrderDeferedEvent> defEvnt(new CancelOrderDeferedEvent(order));
-            defEvnt->cancelReason_ = "Unable to find oposite order for Market order during order matching.";
-            defEvnt->order_ = order;
-            defered_->addDeferedEvent(defEvnt.release());
+            std::unique_ptr<CancelOrderDeferedEvent> cancelEvnt(new CancelOrderDeferedEvent(order));
+            cancelEvnt->cancelReason_ = "Unable to find oposite order for Market order during order matching.";
+            cancelEvnt->order_ = order;
+            defered_->addDeferedEvent(cancelEvnt.release());
         }
         else
         {
@@ -161,46 +228,14 @@ void OrderMatcher::match(OrderEntry *order, const Context &ctxt)
         return;
     }
 
-    OrderEntry *contrOrd = ctxt.orderStorage_->locateByOrderId(id);
-    if (nullptr == contrOrd)
-    {
-        throw std::runtime_error("Unable to retrive order from OrderStorage after search!");
-    }
-
-    /// read lock both orders with deadlock prevention (ascending orderId_)
-    OrderEntry *first = order;
-    OrderEntry *second = contrOrd;
-    if (contrOrd->orderId_ < order->orderId_)
-    {
-        std::swap(first, second);
-    }
-    oneapi::tbb::spin_rw_mutex::scoped_lock firstLock(first->entryMutex_, false);
-    oneapi::tbb::spin_rw_mutex::scoped_lock secondLock(second->entryMutex_, false);
-
-    /// add trade event
-    std::unique_ptr<ExecutionDeferedEvent> defEvnt(new ExecutionDeferedEvent(order));
-    TradeParams trade;
-    trade.order_ = contrOrd;
-    trade.lastQty_ = std::min(order->leavesQty_, contrOrd->leavesQty_);
-    trade.lastPx_ = contrOrd->price_;
-    if (0 == trade.lastPx_ && 0 == order->price_)
-    {
-        throw std::runtime_error("OrderMatcher: cannot match two market orders - no reference price available!");
-    }
-    defEvnt->trades_.push_back(trade);
-
-    QuantityT remainingQty = order->leavesQty_ - trade.lastQty_;
-
-    secondLock.release();
-    firstLock.release();
-
     defered_->addDeferedEvent(defEvnt.release());
 
-    /// add another match event to continue matching
-    if (remainingQty > 0)
+    /// market order must not rest in the book after the available liquidity is exhausted
+    if (MARKET_ORDERTYPE == order->ordType_ && 0 < sweep.remainingQty())
     {
-        std::unique_ptr<MatchOrderDeferedEvent> defEvnt(new MatchOrderDeferedEvent(order));
-        defEvnt->order_ = order;
-        defered_->addDeferedEvent(defEvnt.release());
+        std::unique_ptr<CancelOrderDeferedEvent> cancelEvnt(new CancelOrderDeferedEvent(order));
+        cancelEvnt->cancelReason_ = "Market order liquidity exhausted during order matching.";
+        cancelEvnt->order_ = order;
+        defered_->addDeferedEvent(cancelEvnt.release());
     }
 }
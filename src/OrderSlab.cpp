@@ -0,0 +1,214 @@
+/**
+ Concurrent Order Processor library
+
+ Authors: dudleylane, Claude
+
+ Copyright (C) 2026 dudleylane
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#include <new>
+#include <stdexcept>
+
+#include "OrderSlab.h"
+#include "DataModelDef.h"
+#include "HugePages.h"
+#include "NumaAllocator.h"
+
+using namespace COP;
+using namespace COP::Store;
+
+namespace
+{
+u32 log2Ceil(u32 val)
+{
+    u32 shift = 0;
+    while ((1U << shift) < val)
+    {
+        ++shift;
+    }
+    return shift;
+}
+} // namespace
+
+OrderEntry *OrderSlab::Chunk::order(u32 idx) const
+{
+    return reinterpret_cast<OrderEntry *>(memory_ + static_cast<size_t>(idx) * sizeof(OrderEntry));
+}
+
+OrderSlab::OrderSlab(const OrderSlabParams &params)
+    : params_(params), chunkShift_(0), slotMask_(0), chunks_(new std::atomic<Chunk *>[MAX_CHUNKS]), nextSlot_(0),
+      size_(0)
+{
+    if (0 == params_.chunkSlots_)
+    {
+        throw std::runtime_error("OrderSlab: chunk should have at least one slot!");
+    }
+    chunkShift_ = log2Ceil(params_.chunkSlots_);
+    if (32 <= chunkShift_ + log2Ceil(MAX_CHUNKS))
+    {
+        throw std::runtime_error("OrderSlab: chunk size is too large!");
+    }
+    params_.chunkSlots_ = 1U << chunkShift_;
+    slotMask_ = params_.chunkSlots_ - 1;
+    for (u32 i = 0; i < MAX_CHUNKS; ++i)
+    {
+        chunks_[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+OrderSlab::~OrderSlab()
+{
+    for (u32 i = 0; i < MAX_CHUNKS; ++i)
+    {
+        Chunk *chunk = chunks_[i].load(std::memory_order_relaxed);
+        if (nullptr == chunk)
+        {
+            continue;
+        }
+        for (u32 idx = 0; idx < params_.chunkSlots_; ++idx)
+        {
+            if (0 != (chunk->generations_[idx].load(std::memory_order_relaxed) & 1))
+            {
+                chunk->order(idx)->~OrderEntry();
+            }
+        }
+        freeChunk(chunk);
+    }
+}
+
+OrderHandle OrderSlab::emplace(const OrderEntry &order)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    u32 slot = 0;
+    if (!freeSlots_.empty())
+    {
+        slot = freeSlots_.back();
+    }
+    else
+    {
+        if (static_cast<u64>(MAX_CHUNKS) * params_.chunkSlots_ <= nextSlot_)
+        {
+            throw std::runtime_error("OrderSlab: no free slots left!");
+        }
+        slot = nextSlot_;
+    }
+    Chunk *chunk = chunkOf(slot);
+    const u32 idx = slot & slotMask_;
+    new (chunk->order(idx)) OrderEntry(order);
+
+    // the slot is taken only once the order is constructed
+    if (!freeSlots_.empty())
+    {
+        freeSlots_.pop_back();
+    }
+    else
+    {
+        ++nextSlot_;
+    }
+    const u32 generation = chunk->generations_[idx].load(std::memory_order_relaxed) + 1;
+    chunk->generations_[idx].store(generation, std::memory_order_release);
+    ++size_;
+    return OrderHandle(slot, generation);
+}
+
+void OrderSlab::release(const OrderHandle &handle)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    OrderEntry *order = get(handle);
+    if (nullptr == order)
+    {
+        throw std::runtime_error("OrderSlab: unable to release order - handle is not valid.");
+    }
+    Chunk *chunk = chunks_[handle.slot_ >> chunkShift_].load(std::memory_order_relaxed);
+    // even generation, the handle stops resolving before the order is destroyed
+    chunk->generations_[handle.slot_ & slotMask_].store(handle.generation_ + 1, std::memory_order_release);
+    order->~OrderEntry();
+    // the slot is retired once its generation wraps around, old handles could resolve again
+    if (0 != handle.generation_ + 1)
+    {
+        freeSlots_.push_back(handle.slot_);
+    }
+    --size_;
+}
+
+size_t OrderSlab::size() const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    return size_;
+}
+
+size_t OrderSlab::capacity() const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    size_t chunks = 0;
+    for (u32 i = 0; i < MAX_CHUNKS; ++i)
+    {
+        if (nullptr != chunks_[i].load(std::memory_order_relaxed))
+        {
+            ++chunks;
+        }
+    }
+    return chunks * params_.chunkSlots_;
+}
+
+OrderSlab::Chunk *OrderSlab::chunkOf(u32 slot)
+{
+    std::atomic<Chunk *> &entry = chunks_[slot >> chunkShift_];
+    Chunk *chunk = entry.load(std::memory_order_relaxed);
+    if (nullptr != chunk)
+    {
+        return chunk;
+    }
+
+    std::unique_ptr<Chunk> created(new Chunk());
+    created->bytes_ = static_cast<size_t>(params_.chunkSlots_) * sizeof(OrderEntry);
+    created->generations_.reset(new std::atomic<u32>[params_.chunkSlots_]);
+    for (u32 idx = 0; idx < params_.chunkSlots_; ++idx)
+    {
+        created->generations_[idx].store(0, std::memory_order_relaxed);
+    }
+    void *memory = nullptr;
+    if (params_.hugePages_)
+    {
+        memory = HugePages::allocate(created->bytes_);
+    }
+    else if (0 <= params_.numaNode_)
+    {
+        memory = NumaAllocator::allocateOnNode(created->bytes_, params_.numaNode_);
+    }
+    else
+    {
+        memory = ::operator new(created->bytes_, std::align_val_t(alignof(OrderEntry)), std::nothrow);
+    }
+    if (nullptr == memory)
+    {
+        throw std::bad_alloc();
+    }
+    created->memory_ = static_cast<char *>(memory);
+
+    // published after the generations are zeroed, get() of the new slots fails until emplace() ends
+    chunk = created.release();
+    entry.store(chunk, std::memory_order_release);
+    return chunk;
+}
+
+void OrderSlab::freeChunk(Chunk *chunk)
+{
+    if (params_.hugePages_)
+    {
+        HugePages::deallocate(chunk->memory_, chunk->bytes_);
+    }
+    else if (0 <= params_.numaNode_)
+    {
+        NumaAllocator::deallocate(chunk->memory_, chunk->bytes_);
+    }
+    else
+    {
+        ::operator delete(chunk->memory_, std::align_val_t(alignof(OrderEntry)));
+    }
+    delete chunk;
+}
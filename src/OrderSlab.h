@@ -0,0 +1,140 @@
+/**
+ Concurrent Order Processor library
+
+ Authors: dudleylane, Claude
+
+ Copyright (C) 2026 dudleylane
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "TypesDef.h"
+
+namespace COP
+{
+struct OrderEntry;
+
+namespace Store
+{
+
+/// Slot of the order in the OrderSlab. Generation changes every time the slot
+/// is taken or released, so a handle of a released order does not resolve.
+struct OrderHandle
+{
+    u32 slot_;
+    /// odd while the slot is used, 0 - invalid handle
+    u32 generation_;
+
+    OrderHandle() : slot_(0), generation_(0) {}
+    OrderHandle(u32 slot, u32 generation) : slot_(slot), generation_(generation) {}
+
+    bool isValid() const
+    {
+        return 0 != (generation_ & 1);
+    }
+};
+
+inline bool operator==(const OrderHandle &lft, const OrderHandle &rght)
+{
+    return (lft.slot_ == rght.slot_) && (lft.generation_ == rght.generation_);
+}
+
+struct OrderSlabParams
+{
+    /// slots allocated at once, rounded up to a power of two
+    u32 chunkSlots_ = 16384;
+    /// chunks are backed by huge pages, regular pages are used if none are free
+    bool hugePages_ = false;
+    /// NUMA node the chunks are bound to, -1 - no binding. Ignored with hugePages_
+    int numaNode_ = -1;
+};
+
+/// Orders in preallocated chunks of slots, addressed by OrderHandle.
+/// Chunks are never moved or freed while the slab lives, so get() is two array
+/// indexes and one load of the slot generation, without a lock.
+/// emplace() and release() are serialised by the slab; releasing an order
+/// while it is used by another thread is up to the caller to prevent.
+class OrderSlab
+{
+public:
+    explicit OrderSlab(const OrderSlabParams &params = OrderSlabParams());
+    ~OrderSlab();
+
+    /// copies the order into a free slot
+    OrderHandle emplace(const OrderEntry &order);
+    /// destroys the order, the handle and its copies stop resolving
+    void release(const OrderHandle &handle);
+
+    /// nullptr if the handle does not refer to a live order
+    OrderEntry *get(const OrderHandle &handle) const
+    {
+        const u32 chunkIdx = handle.slot_ >> chunkShift_;
+        if (MAX_CHUNKS <= chunkIdx) [[unlikely]]
+        {
+            return nullptr;
+        }
+        const Chunk *chunk = chunks_[chunkIdx].load(std::memory_order_acquire);
+        if (nullptr == chunk) [[unlikely]]
+        {
+            return nullptr;
+        }
+        const u32 idx = handle.slot_ & slotMask_;
+        if (handle.generation_ != chunk->generations_[idx].load(std::memory_order_acquire)) [[unlikely]]
+        {
+            return nullptr;
+        }
+        return chunk->order(idx);
+    }
+
+    /// live orders
+    size_t size() const;
+    /// slots of the allocated chunks
+    size_t capacity() const;
+    bool hugePages() const
+    {
+        return params_.hugePages_;
+    }
+
+private:
+    static constexpr u32 MAX_CHUNKS = 4096;
+
+    struct Chunk
+    {
+        char *memory_;
+        size_t bytes_;
+        std::unique_ptr<std::atomic<u32>[]> generations_;
+
+        OrderEntry *order(u32 idx) const;
+    };
+
+    /// allocates the chunk of the slot if it is not there yet, lock_ should be held
+    Chunk *chunkOf(u32 slot);
+    void freeChunk(Chunk *chunk);
+
+    OrderSlab(const OrderSlab &) = delete;
+    OrderSlab &operator=(const OrderSlab &) = delete;
+
+private:
+    OrderSlabParams params_;
+    u32 chunkShift_;
+    u32 slotMask_;
+    std::unique_ptr<std::atomic<Chunk *>[]> chunks_;
+
+    mutable std::mutex lock_;
+    /// slots never used start from nextSlot_
+    u32 nextSlot_;
+    std::vector<u32> freeSlots_;
+    size_t size_;
+};
+
+} // namespace Store
+} // namespace COP
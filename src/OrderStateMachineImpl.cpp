@@ -391,6 +391,8 @@ void OrdStateImpl::processFill(OrderEntry *orderData, OrdState::onTradeExecution
 
     TradeExecEntry tradeEntry(ex, *trade);
     tradeEntry.tradeDate_ = 1;
+    // status is known before the save, the execution is persisted as saved
+    tradeEntry.orderStatus_ = (trade->lastQty_ == orderData->leavesQty_) ? FILLED_ORDSTATUS : PARTFILL_ORDSTATUS;
 
     ExecutionEntry *tr = evnt.orderStorage_->save(tradeEntry, evnt.generator_);
     assert(nullptr != tr);
@@ -400,11 +402,13 @@ void OrdStateImpl::processFill(OrderEntry *orderData, OrdState::onTradeExecution
     {
         assert(nullptr != evnt.orderBook_);
         evnt.orderBook_->remove(*orderData);
-        tr->orderStatus_ = FILLED_ORDSTATUS;
     }
     else
     {
-        tr->orderStatus_ = PARTFILL_ORDSTATUS;
+        if (nullptr != evnt.orderBook_)
+        {
+            evnt.orderBook_->update(*orderData);
+        }
     }
 }
 
@@ -445,6 +449,10 @@ void OrdStateImpl::processCorrected(OrderEntry *orderData, OrdState::onTradeCrct
     orderData->leavesQty_ = crct->leavesQty_;
     orderData->cumQty_ = crct->cumQty_;
     orderData->currency_ = crct->currency_;
+    if (nullptr != evnt.orderBook_)
+    {
+        evnt.orderBook_->update(*orderData);
+    }
 }
 
 void OrdStateImpl::processCorrectedWithoutRestore(OrderEntry *orderData, OrdState::onTradeCrctCncl const &evnt)
@@ -459,6 +467,10 @@ void OrdStateImpl::processCorrectedWithoutRestore(OrderEntry *orderData, OrdStat
     orderData->leavesQty_ = crct->leavesQty_;
     orderData->cumQty_ = crct->cumQty_;
     orderData->currency_ = crct->currency_;
+    if (nullptr != evnt.orderBook_)
+    {
+        evnt.orderBook_->update(*orderData);
+    }
 }
 
 void OrdStateImpl::processRejectNew(OrderEntry *orderData, OrdState::onOrderRejected const &evnt)
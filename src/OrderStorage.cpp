@@ -25,6 +25,12 @@ OrderDataStorage::OrderDataStorage() : saver_(nullptr)
     aux::ExchLogger::instance()->note("OrderDataStorage created");
 }
 
+OrderDataStorage::OrderDataStorage(const OrderSlabParams &params) : slab_(params), saver_(nullptr)
+{
+    aux::ExchLogger::instance()->note(std::string("OrderDataStorage created") +
+                                      (params.hugePages_ ? " with huge pages" : ""));
+}
+
 void OrderDataStorage::attach(OrderSaver *saver)
 {
     assert(nullptr == saver_);
@@ -35,17 +41,12 @@ OrderDataStorage::~OrderDataStorage(void)
 {
     aux::ExchLogger::instance()->note("OrderDataStorage destroying");
 
-    // Clean up orders with exclusive write lock
-    OrdersByIDT tmp;
+    // orders are destroyed with the slab
     {
         oneapi::tbb::spin_rw_mutex::scoped_lock lock(orderRwLock_, true);
-        std::swap(tmp, ordersById_);
+        ordersById_.clear();
         ordersByClId_.clear();
     }
-    for (OrdersByIDT::iterator it = tmp.begin(); it != tmp.end(); ++it)
-    {
-        delete it->second;
-    }
 
     // Clean up executions - iterate through concurrent_hash_map
     // No lock needed for iteration during destruction (single-threaded)
@@ -59,7 +60,8 @@ OrderDataStorage::~OrderDataStorage(void)
 }
 
 // ============================================================================
-// Order operations - use reader-writer lock for concurrent reads
+// Order operations - inserts and ClOrderId lookups use the reader-writer lock,
+// OrderId lookups use concurrent_hash_map
 // ============================================================================
 
 OrderEntry *OrderDataStorage::locateByClOrderId(const RawDataEntry &clOrderId) const
@@ -71,19 +73,23 @@ OrderEntry *OrderDataStorage::locateByClOrderId(const RawDataEntry &clOrderId) c
     {
         return nullptr;
     }
-    return it->second;
+    return slab_.get(it->second);
 }
 
 OrderEntry *OrderDataStorage::locateByOrderId(const IdT &orderId) const
 {
-    // Shared read lock - allows concurrent lookups
-    oneapi::tbb::spin_rw_mutex::scoped_lock lock(orderRwLock_, false);
-    OrdersByIDT::const_iterator it = ordersById_.find(orderId);
-    if (ordersById_.end() == it) [[unlikely]]
+    return slab_.get(handleByOrderId(orderId));
+}
+
+OrderHandle OrderDataStorage::handleByOrderId(const IdT &orderId) const
+{
+    // does not wait for inserts, orders are never erased while the storage is used
+    OrdersByIDT::const_accessor accessor;
+    if (!ordersById_.find(accessor, orderId)) [[unlikely]]
     {
-        return nullptr;
+        return OrderHandle();
     }
-    return it->second;
+    return accessor->second;
 }
 
 OrderEntry *OrderDataStorage::save(const OrderEntry &order, IdTValueGenerator *idGenerator)
@@ -99,7 +105,7 @@ OrderEntry *OrderDataStorage::save(const OrderEntry &order, IdTValueGenerator *i
     {
         // Exclusive write lock - atomic dual-map insert
         oneapi::tbb::spin_rw_mutex::scoped_lock lock(orderRwLock_, true);
-        if ((order.orderId_.isValid()) && (ordersById_.end() != ordersById_.find(order.orderId_)))
+        if ((order.orderId_.isValid()) && (0 < ordersById_.count(order.orderId_)))
         {
             throw std::runtime_error("Unable to save order - order with same OrderId already exists.");
         }
@@ -113,32 +119,8 @@ OrderEntry *OrderDataStorage::save(const OrderEntry &order, IdTValueGenerator *i
             throw std::runtime_error("Unable to save order - order with same ClOrderId already exists.");
         }
 
-        std::unique_ptr<OrderEntry> cp(order.clone());
-        if (!cp->orderId_.isValid())
-        {
-            cp->orderId_ = idGenerator->getId();
-        }
-        int st = 0;
-        try
-        {
-            ordersById_.insert(OrdersByIDT::value_type(cp->orderId_, cp.get()));
-            st = 1;
-            ordersByClId_.insert(OrdersByClientIDT::value_type(cp->clOrderId_.get(), cp.get()));
-            st = 2;
-            result = cp.release();
-        }
-        catch (...)
-        {
-            switch (st)
-            {
-            case 2:
-                ordersByClId_.erase(order.clOrderId_.get());
-                [[fallthrough]];
-            case 1:
-                ordersById_.erase(cp->orderId_);
-            }
-            throw;
-        }
+        const IdT orderId = order.orderId_.isValid() ? order.orderId_ : idGenerator->getId();
+        result = slab_.get(insertOrder(order, orderId));
     }
     // Call saver outside of lock to avoid potential deadlock
     if (nullptr != saver_ && nullptr != result)
@@ -148,59 +130,114 @@ OrderEntry *OrderDataStorage::save(const OrderEntry &order, IdTValueGenerator *i
     return result;
 }
 
-void OrderDataStorage::restore(OrderEntry *order)
+OrderEntry *OrderDataStorage::restore(OrderEntry *order)
 {
     if (aux::ExchLogger::instance()->isNoteOn())
     {
         aux::ExchLogger::instance()->note("OrderDataStorage restoring order");
     }
 
-    bool shouldSave = false;
+    OrderEntry *stored = nullptr;
     {
         // Exclusive write lock - atomic dual-map insert
         oneapi::tbb::spin_rw_mutex::scoped_lock lock(orderRwLock_, true);
-        if ((order->orderId_.isValid()) && (ordersById_.end() != ordersById_.find(order->orderId_)))
-        {
-            throw std::runtime_error("Unable to restore order - order with same OrderId already exists.");
-        }
-        if (0 == order->clOrderId_.get().length_)
-        {
-            throw std::runtime_error("Unable to restore order - order contains empty ClOrderId.");
-        }
-        if (ordersByClId_.end() != ordersByClId_.find(order->clOrderId_.get()))
-        {
-            throw std::runtime_error("Unable to restore order - order with same ClOrderId already exists.");
-        }
+        stored = slab_.get(insertRestored(*order));
+    }
+    delete order;
+    // Call saver outside of lock to avoid potential deadlock
+    if (nullptr != saver_)
+    {
+        saver_->save(*stored);
+    }
+    return stored;
+}
+
+void OrderDataStorage::restore(std::vector<OrderEntry *> *orders)
+{
+    assert(nullptr != orders);
+    if (aux::ExchLogger::instance()->isNoteOn())
+    {
+        aux::ExchLogger::instance()->note("OrderDataStorage restoring orders: " + std::to_string(orders->size()));
+    }
 
-        int st = 0;
+    std::vector<OrderHandle> handles;
+    handles.reserve(orders->size());
+    {
+        // one exclusive lock for the whole batch, the batch is restored completely or not at all
+        oneapi::tbb::spin_rw_mutex::scoped_lock lock(orderRwLock_, true);
         try
         {
-            ordersById_.insert(OrdersByIDT::value_type(order->orderId_, order));
-            st = 1;
-            ordersByClId_.insert(OrdersByClientIDT::value_type(order->clOrderId_.get(), order));
-            st = 2;
-            shouldSave = true;
+            for (const OrderEntry *order : *orders)
+            {
+                handles.push_back(insertRestored(*order));
+            }
         }
         catch (...)
         {
-            switch (st)
+            // the batch is being restored at startup, nobody looks the orders up yet
+            for (size_t i = 0; i < handles.size(); ++i)
             {
-            case 2:
-                ordersByClId_.erase(order->clOrderId_.get());
-                [[fallthrough]];
-            case 1:
-                ordersById_.erase(order->orderId_);
+                ordersByClId_.erase((*orders)[i]->clOrderId_.get());
+                ordersById_.erase((*orders)[i]->orderId_);
+                slab_.release(handles[i]);
             }
             throw;
         }
     }
-    // Call saver outside of lock to avoid potential deadlock
-    if (nullptr != saver_ && shouldSave)
+    for (size_t i = 0; i < handles.size(); ++i)
+    {
+        delete (*orders)[i];
+        (*orders)[i] = slab_.get(handles[i]);
+    }
+    if (nullptr != saver_)
     {
-        saver_->save(*order);
+        for (const OrderEntry *order : *orders)
+        {
+            saver_->save(*order);
+        }
     }
 }
 
+OrderHandle OrderDataStorage::insertRestored(const OrderEntry &order)
+{
+    if ((order.orderId_.isValid()) && (0 < ordersById_.count(order.orderId_)))
+    {
+        throw std::runtime_error("Unable to restore order - order with same OrderId already exists.");
+    }
+    if (0 == order.clOrderId_.get().length_)
+    {
+        throw std::runtime_error("Unable to restore order - order contains empty ClOrderId.");
+    }
+    if (ordersByClId_.end() != ordersByClId_.find(order.clOrderId_.get()))
+    {
+        throw std::runtime_error("Unable to restore order - order with same ClOrderId already exists.");
+    }
+    return insertOrder(order, order.orderId_);
+}
+
+OrderHandle OrderDataStorage::insertOrder(const OrderEntry &order, const IdT &orderId)
+{
+    const OrderHandle handle = slab_.emplace(order);
+    slab_.get(handle)->orderId_ = orderId;
+    int st = 0;
+    try
+    {
+        ordersByClId_.insert(OrdersByClientIDT::value_type(order.clOrderId_.get(), handle));
+        st = 1;
+        ordersById_.insert(OrdersByIDT::value_type(orderId, handle));
+    }
+    catch (...)
+    {
+        if (1 == st)
+        {
+            ordersByClId_.erase(order.clOrderId_.get());
+        }
+        slab_.release(handle);
+        throw;
+    }
+    return handle;
+}
+
 // ============================================================================
 // Execution operations - use concurrent_hash_map for fine-grained locking
 // ============================================================================
@@ -223,14 +260,23 @@ void OrderDataStorage::save(const ExecutionEntry *exec)
         aux::ExchLogger::instance()->note("OrderDataStorage saving execution");
     }
 
-    // Use accessor to check and insert atomically
-    ExecByIDT::accessor accessor;
-    if (!executionsById_.insert(accessor, exec->execId_))
+    ExecutionEntry *stored = nullptr;
     {
-        // Key already exists
-        throw std::runtime_error("Unable to save execution - execution with same ExecId already exists.");
+        oneapi::tbb::spin_rw_mutex::scoped_lock iterLock(execIterLock_, false);
+        // Use accessor to check and insert atomically
+        ExecByIDT::accessor accessor;
+        if (!executionsById_.insert(accessor, exec->execId_))
+        {
+            // Key already exists
+            throw std::runtime_error("Unable to save execution - execution with same ExecId already exists.");
+        }
+        accessor->second = exec->clone();
+        stored = accessor->second;
+    }
+    if (nullptr != saver_)
+    {
+        saver_->save(*stored);
     }
-    accessor->second = exec->clone();
 }
 
 ExecutionEntry *OrderDataStorage::save(const ExecutionEntry &exec, IdTValueGenerator *idGenerator)
@@ -248,13 +294,35 @@ ExecutionEntry *OrderDataStorage::save(const ExecutionEntry &exec, IdTValueGener
         cp->execId_ = idGenerator->getId();
     }
 
-    // Use accessor to check and insert atomically
+    {
+        oneapi::tbb::spin_rw_mutex::scoped_lock iterLock(execIterLock_, false);
+        // Use accessor to check and insert atomically
+        ExecByIDT::accessor accessor;
+        if (!executionsById_.insert(accessor, cp->execId_))
+        {
+            // Key already exists
+            throw std::runtime_error("Unable to save execution - execution with same ExecId already exists.");
+        }
+        accessor->second = cp.get();
+    }
+    ExecutionEntry *stored = cp.release();
+    // saver only queues the record, no write per execution
+    if (nullptr != saver_)
+    {
+        saver_->save(*stored);
+    }
+    return stored;
+}
+
+void OrderDataStorage::restore(ExecutionEntry *exec)
+{
+    assert(nullptr != exec);
+
+    oneapi::tbb::spin_rw_mutex::scoped_lock iterLock(execIterLock_, false);
     ExecByIDT::accessor accessor;
-    if (!executionsById_.insert(accessor, cp->execId_))
+    if (!executionsById_.insert(accessor, exec->execId_))
     {
-        // Key already exists
-        throw std::runtime_error("Unable to save execution - execution with same ExecId already exists.");
+        throw std::runtime_error("Unable to restore execution - execution with same ExecId already exists.");
     }
-    accessor->second = cp.get();
-    return cp.release();
+    accessor->second = exec;
 }
@@ -17,7 +17,9 @@
 #include <oneapi/tbb/spin_rw_mutex.h>
 #include <oneapi/tbb/concurrent_hash_map.h>
 #include <map>
+#include <vector>
 #include "DataModelDef.h"
+#include "OrderSlab.h"
 
 namespace COP
 {
@@ -28,10 +30,12 @@ class IdTValueGenerator;
 namespace Store
 {
 
+/// Orders live in the OrderSlab, the indexes map OrderId and ClOrderId to their handles.
 class OrderDataStorage
 {
 public:
     explicit OrderDataStorage();
+    explicit OrderDataStorage(const OrderSlabParams &params);
     ~OrderDataStorage(void);
 
     void attach(OrderSaver *saver);
@@ -39,32 +43,61 @@ public:
 public:
     OrderEntry *locateByClOrderId(const RawDataEntry &clOrderId) const;
     OrderEntry *locateByOrderId(const IdT &orderId) const;
+    /// invalid handle if there is no such order
+    OrderHandle handleByOrderId(const IdT &orderId) const;
+    /// nullptr if the handle does not refer to a stored order
+    OrderEntry *locate(const OrderHandle &handle) const
+    {
+        return slab_.get(handle);
+    }
     OrderEntry *save(const OrderEntry &order, IdTValueGenerator *idGenerator);
-    void restore(OrderEntry *order);
-
+    /// copies the loaded order into the slab and deletes it, returns the stored entry.
+    /// The loaded order is left to the caller if it is rejected
+    OrderEntry *restore(OrderEntry *order);
+    /// restores all orders under one lock, throws and restores none if one of them is rejected.
+    /// Loaded orders are replaced by the stored entries and deleted
+    void restore(std::vector<OrderEntry *> *orders);
+
+    /// fn is called under the lock blocking order saves, orders are passed in no particular order
     template <typename Fn> void forEachOrder(Fn &&fn) const
     {
         oneapi::tbb::spin_rw_mutex::scoped_lock lock(orderRwLock_, false);
-        for (const auto &[id, entry] : ordersById_)
+        for (const auto &[id, handle] : ordersById_)
         {
-            fn(id, *entry);
+            fn(id, *slab_.get(handle));
         }
     }
 
+    size_t orderCount() const
+    {
+        return slab_.size();
+    }
+
     ExecutionEntry *locateByExecId(const IdT &execId) const;
+    /// saved executions are passed to the attached saver
     void save(const ExecutionEntry *exec);
     ExecutionEntry *save(const ExecutionEntry &exec, IdTValueGenerator *idGenerator);
+    /// takes ownership of the loaded execution, throws if its ExecId is already used
+    void restore(ExecutionEntry *exec);
 
-private:
-    /// Reader-writer lock for order maps (dual-map inserts require atomicity)
-    /// Allows concurrent reads, exclusive writes
-    mutable oneapi::tbb::spin_rw_mutex orderRwLock_;
-
-    typedef std::map<IdT, OrderEntry *> OrdersByIDT;
-    OrdersByIDT ordersById_;
+    /// fn is called under the lock blocking execution saves
+    template <typename Fn> void forEachExecution(Fn &&fn) const
+    {
+        oneapi::tbb::spin_rw_mutex::scoped_lock lock(execIterLock_, true);
+        for (const auto &[id, entry] : executionsById_)
+        {
+            fn(id, *entry);
+        }
+    }
 
-    typedef std::map<RawDataEntry, OrderEntry *> OrdersByClientIDT;
-    OrdersByClientIDT ordersByClId_;
+private:
+    /// checks and stores a restored order, orderRwLock_ should be held exclusively
+    OrderHandle insertRestored(const OrderEntry &order);
+    /// copies the order into the slab under orderId and inserts it into both indexes,
+    /// orderRwLock_ should be held exclusively.
+    /// OrderId index is inserted last: locateByOrderId() does not take orderRwLock_,
+    /// so an order becomes visible by OrderId once it is fully indexed
+    OrderHandle insertOrder(const OrderEntry &order, const IdT &orderId);
 
     /// Hash functor for SourceIdT in concurrent_hash_map
     struct SourceIdTHash
@@ -80,9 +113,26 @@ private:
         }
     };
 
+    /// Reader-writer lock for order inserts (dual-index inserts require atomicity)
+    /// and the ClOrderId index. OrderId lookups do not take it.
+    mutable oneapi::tbb::spin_rw_mutex orderRwLock_;
+
+    /// owns the orders, destroyed after the indexes
+    OrderSlab slab_;
+
+    /// Concurrent hash map for orders, lookups take the bucket lock only
+    typedef oneapi::tbb::concurrent_hash_map<SourceIdT, OrderHandle, SourceIdTHash> OrdersByIDT;
+    OrdersByIDT ordersById_;
+
+    typedef std::map<RawDataEntry, OrderHandle> OrdersByClientIDT;
+    OrdersByClientIDT ordersByClId_;
+
     /// Lock-free concurrent hash map for executions (single-map operations)
     typedef oneapi::tbb::concurrent_hash_map<SourceIdT, ExecutionEntry *, SourceIdTHash> ExecByIDT;
     ExecByIDT executionsById_;
+    /// concurrent_hash_map could not be traversed while inserted into:
+    /// inserts hold it shared, forEachExecution() exclusively
+    mutable oneapi::tbb::spin_rw_mutex execIterLock_;
 
     OrderSaver *saver_;
 };
@@ -16,7 +16,7 @@
 using namespace std;
 using namespace COP::Queues;
 
-OutgoingQueues::OutgoingQueues(void)
+OutgoingQueues::OutgoingQueues(void) : targets_(SourceRegistry::instance())
 {
     aux::ExchLogger::instance()->note("OutgoingQueues created.");
 }
@@ -46,7 +46,7 @@ void OutgoingQueues::push(const ExecReportEvent &evnt, const std::string &target
     }
 
     // Lock-free push to concurrent queue
-    eventQueue_.push(QueuedOutEvent(target, evnt));
+    eventQueue_.push(QueuedOutEvent(targets_->intern(target), evnt));
 
     if (aux::ExchLogger::instance()->isNoteOn())
     {
@@ -62,7 +62,7 @@ void OutgoingQueues::push(const CancelRejectEvent &evnt, const std::string &targ
     }
 
     // Lock-free push to concurrent queue
-    eventQueue_.push(QueuedOutEvent(target, evnt));
+    eventQueue_.push(QueuedOutEvent(targets_->intern(target), evnt));
 
     if (aux::ExchLogger::instance()->isNoteOn())
     {
@@ -78,7 +78,7 @@ void OutgoingQueues::push(const BusinessRejectEvent &evnt, const std::string &ta
     }
 
     // Lock-free push to concurrent queue
-    eventQueue_.push(QueuedOutEvent(target, evnt));
+    eventQueue_.push(QueuedOutEvent(targets_->intern(target), evnt));
 
     if (aux::ExchLogger::instance()->isNoteOn())
     {
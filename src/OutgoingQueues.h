@@ -18,6 +18,7 @@
 #include <oneapi/tbb/concurrent_hash_map.h>
 
 #include "QueuesDef.h"
+#include "SourceRegistry.h"
 
 namespace COP
 {
@@ -41,16 +42,19 @@ private:
     using OutEventVariant = std::variant<std::monostate, // Default state for empty initialization
                                          ExecReportEvent, CancelRejectEvent, BusinessRejectEvent>;
 
-    /// Queued outgoing event with target
+    /// Queued outgoing event with interned target
     struct QueuedOutEvent
     {
-        std::string target_;
+        SourceHandle target_;
         OutEventVariant event_;
 
-        QueuedOutEvent() = default;
-        QueuedOutEvent(const std::string &tgt, OutEventVariant evt) : target_(tgt), event_(std::move(evt)) {}
+        QueuedOutEvent() : target_(0), event_() {}
+        QueuedOutEvent(SourceHandle tgt, OutEventVariant evt) : target_(tgt), event_(std::move(evt)) {}
     };
 
+    /// Interned target names
+    SourceRegistry *targets_;
+
     /// Lock-free concurrent queue for all outgoing events (MPSC pattern)
     oneapi::tbb::concurrent_queue<QueuedOutEvent> eventQueue_;
 
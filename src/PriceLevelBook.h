@@ -0,0 +1,290 @@
+/**
+ Concurrent Order Processor library
+
+ Author: Sergey Mikhailik
+
+ Copyright (C) 2009-2026 Sergey Mikhailik
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#pragma once
+
+#include <cassert>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+
+#include "DataModelDef.h"
+
+namespace COP
+{
+
+/// Resting order with its hot fields, linked into the FIFO queue of its price level.
+/// Slots of a book side live in one array, so the book walk reads them
+/// without touching the OrderEntry or the price level of the order.
+struct BookOrderSlot
+{
+    static constexpr u32 NO_SLOT = 0xFFFFFFFF;
+
+    RestingOrder entry_;
+    u32 prev_;
+    u32 next_;
+};
+
+/// Orders resting at one price, oldest first, with their aggregated leavesQty.
+struct PriceLevel
+{
+    PriceT price_;
+    QuantityT totalQty_;
+    u32 orderCount_;
+    /// slots of the oldest and the newest order
+    u32 head_;
+    u32 tail_;
+};
+
+/// One side of the price-level order book.
+/// Levels are kept in a sorted array with the best price at the back, so that
+/// activity at the top of the book does not shift the array. The array holds the
+/// price next to the index of the level in levelPool_, so the binary search reads
+/// one dense array only. Every resting order is reachable through its slot, which
+/// makes cancel O(1) regardless of how many orders share the price.
+/// Hot fields of the resting orders and their FIFO links are kept in slots_,
+/// the level of every slot in slotLevels_, which the walk does not read.
+template <typename PriceCompare> class PriceLevelBookSide
+{
+public:
+    static constexpr u32 NO_LEVEL = 0xFFFFFFFF;
+
+    PriceLevelBookSide() : size_(0) {}
+
+    PriceLevelBookSide(const PriceLevelBookSide &) = delete;
+    PriceLevelBookSide &operator=(const PriceLevelBookSide &) = delete;
+
+    /// appends order to the tail of the FIFO at its price, returns its slot
+    u32 add(const RestingOrder &order);
+    /// returns false if order does not rest on this side
+    bool remove(const IdT &orderId);
+    /// returns false if order does not rest on this side
+    bool update(const IdT &orderId, QuantityT leavesQty);
+
+    IdT top() const
+    {
+        if (levels_.empty())
+        {
+            return IdT();
+        }
+        return slots_[levelPool_[levels_.back().level_].head_].entry_.orderId_;
+    }
+    size_t size() const
+    {
+        return size_;
+    }
+    size_t levelCount() const
+    {
+        return levels_.size();
+    }
+
+    /// visits orders in price-time priority, stops when functor returns false
+    template <typename F> void forEachOrder(F f) const
+    {
+        for (typename LevelsT::const_reverse_iterator lit = levels_.rbegin(); lit != levels_.rend(); ++lit)
+        {
+            for (u32 idx = levelPool_[lit->level_].head_; BookOrderSlot::NO_SLOT != idx; idx = slots_[idx].next_)
+            {
+                if (!f(slots_[idx].entry_))
+                {
+                    return;
+                }
+            }
+        }
+    }
+    /// visits levels from the best price, stops when functor returns false
+    template <typename F> void forEachLevel(F f) const
+    {
+        for (typename LevelsT::const_reverse_iterator lit = levels_.rbegin(); lit != levels_.rend(); ++lit)
+        {
+            if (!f(levelPool_[lit->level_]))
+            {
+                return;
+            }
+        }
+    }
+
+private:
+    /// entry of the sorted level array, price is copied to keep the search in the array
+    struct LevelRef
+    {
+        PriceT price_;
+        u32 level_;
+    };
+    typedef std::vector<LevelRef> LevelsT;
+    typedef std::unordered_map<IdT, u32, IdTHash> HandlesT;
+
+    /// position of the first level that is not worse than price
+    typename LevelsT::iterator locateLevel(const PriceT &price)
+    {
+        return std::lower_bound(levels_.begin(), levels_.end(), price,
+                                [this](const LevelRef &ref, const PriceT &p) { return compare_(p, ref.price_); });
+    }
+
+    u32 allocSlot();
+    u32 allocLevel();
+
+private:
+    PriceCompare compare_;
+    LevelsT levels_;
+    HandlesT handles_;
+    size_t size_;
+
+    std::vector<BookOrderSlot> slots_;
+    std::vector<u32> slotLevels_;
+    std::vector<u32> freeSlots_;
+    std::vector<PriceLevel> levelPool_;
+    std::vector<u32> freeLevels_;
+};
+
+template <typename PriceCompare> u32 PriceLevelBookSide<PriceCompare>::add(const RestingOrder &order)
+{
+    const PriceT &price = order.price_;
+    std::pair<typename HandlesT::iterator, bool> res = handles_.emplace(order.orderId_, BookOrderSlot::NO_SLOT);
+    if (!res.second) [[unlikely]]
+    {
+        throw std::runtime_error("Unable to add order into book - order already added!");
+    }
+
+    u32 lvlIdx = NO_LEVEL;
+    typename LevelsT::iterator lit = locateLevel(price);
+    if (levels_.end() != lit && !compare_(lit->price_, price))
+    {
+        lvlIdx = lit->level_;
+    }
+    else
+    {
+        lvlIdx = allocLevel();
+        levelPool_[lvlIdx].price_ = price;
+        levels_.insert(lit, LevelRef{ price, lvlIdx });
+    }
+    PriceLevel &lvl = levelPool_[lvlIdx];
+
+    const u32 idx = allocSlot();
+    BookOrderSlot &slot = slots_[idx];
+    slot.entry_ = order;
+    slot.next_ = BookOrderSlot::NO_SLOT;
+    slot.prev_ = lvl.tail_;
+    slotLevels_[idx] = lvlIdx;
+    if (BookOrderSlot::NO_SLOT != lvl.tail_)
+    {
+        slots_[lvl.tail_].next_ = idx;
+    }
+    else
+    {
+        lvl.head_ = idx;
+    }
+    lvl.tail_ = idx;
+    ++lvl.orderCount_;
+    lvl.totalQty_ += order.leavesQty_;
+
+    res.first->second = idx;
+    ++size_;
+    return idx;
+}
+
+template <typename PriceCompare> bool PriceLevelBookSide<PriceCompare>::remove(const IdT &orderId)
+{
+    typename HandlesT::iterator it = handles_.find(orderId);
+    if (handles_.end() == it)
+    {
+        return false;
+    }
+    const u32 idx = it->second;
+    handles_.erase(it);
+
+    const BookOrderSlot &slot = slots_[idx];
+    const u32 lvlIdx = slotLevels_[idx];
+    assert(NO_LEVEL != lvlIdx);
+    PriceLevel &lvl = levelPool_[lvlIdx];
+    if (BookOrderSlot::NO_SLOT != slot.prev_)
+    {
+        slots_[slot.prev_].next_ = slot.next_;
+    }
+    else
+    {
+        lvl.head_ = slot.next_;
+    }
+    if (BookOrderSlot::NO_SLOT != slot.next_)
+    {
+        slots_[slot.next_].prev_ = slot.prev_;
+    }
+    else
+    {
+        lvl.tail_ = slot.prev_;
+    }
+    --lvl.orderCount_;
+    lvl.totalQty_ -= slot.entry_.leavesQty_;
+    slotLevels_[idx] = NO_LEVEL;
+    freeSlots_.push_back(idx);
+    --size_;
+
+    if (0 == lvl.orderCount_)
+    {
+        typename LevelsT::iterator lit = locateLevel(lvl.price_);
+        assert(levels_.end() != lit && lvlIdx == lit->level_);
+        levels_.erase(lit);
+        freeLevels_.push_back(lvlIdx);
+    }
+    return true;
+}
+
+template <typename PriceCompare> bool PriceLevelBookSide<PriceCompare>::update(const IdT &orderId, QuantityT leavesQty)
+{
+    typename HandlesT::iterator it = handles_.find(orderId);
+    if (handles_.end() == it)
+    {
+        return false;
+    }
+    BookOrderSlot &slot = slots_[it->second];
+    PriceLevel &lvl = levelPool_[slotLevels_[it->second]];
+    lvl.totalQty_ = lvl.totalQty_ - slot.entry_.leavesQty_ + leavesQty;
+    slot.entry_.leavesQty_ = leavesQty;
+    return true;
+}
+
+template <typename PriceCompare> u32 PriceLevelBookSide<PriceCompare>::allocSlot()
+{
+    if (freeSlots_.empty())
+    {
+        slots_.emplace_back();
+        slotLevels_.push_back(NO_LEVEL);
+        return static_cast<u32>(slots_.size() - 1);
+    }
+    const u32 idx = freeSlots_.back();
+    freeSlots_.pop_back();
+    return idx;
+}
+
+template <typename PriceCompare> u32 PriceLevelBookSide<PriceCompare>::allocLevel()
+{
+    u32 idx = NO_LEVEL;
+    if (freeLevels_.empty())
+    {
+        levelPool_.emplace_back();
+        idx = static_cast<u32>(levelPool_.size() - 1);
+    }
+    else
+    {
+        idx = freeLevels_.back();
+        freeLevels_.pop_back();
+    }
+    PriceLevel &lvl = levelPool_[idx];
+    lvl.totalQty_ = 0;
+    lvl.orderCount_ = 0;
+    lvl.head_ = BookOrderSlot::NO_SLOT;
+    lvl.tail_ = BookOrderSlot::NO_SLOT;
+    return idx;
+}
+
+} // namespace COP
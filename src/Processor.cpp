@@ -112,6 +112,13 @@ bool Processor::process()
     return rez;
 }
 
+u32 Processor::processBatch(u32 maxEvents)
+{
+    assert(nullptr != inQueue_);
+    // events of the batch run back-to-back on this thread and reuse its state machine
+    return inQueue_->popBatch(this, maxEvents);
+}
+
 void Processor::onEvent(const std::string & /*source*/, const OrderEvent &evnt)
 {
     if (nullptr == evnt.order_) [[unlikely]]
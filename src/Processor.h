@@ -105,6 +105,8 @@ public:
     /// reimplemented from InQueueProcessor
     /// retrives new event from inQueues, process it in transaction
     virtual bool process();
+    /// retrives up to maxEvents from inQueues, processes each in its own transaction
+    virtual u32 processBatch(u32 maxEvents);
     virtual void onEvent(const std::string &source, const Queues::OrderEvent &evnt);
     virtual void onEvent(const std::string &source, const Queues::OrderCancelEvent &evnt);
     virtual void onEvent(const std::string &source, const Queues::OrderReplaceEvent &evnt);
@@ -148,6 +148,36 @@ public:
     virtual void push(const std::string &source, const OrderChangeStateEvent &evnt) = 0;
     virtual void push(const std::string &source, const ProcessEvent &evnt) = 0;
     virtual void push(const std::string &source, const TimerEvent &evnt) = 0;
+
+    /// Bounded push for external producers, push() above never waits and is used
+    /// for events enqueued by the processing itself. Returns false if the event
+    /// was rejected, ownership of the carried orders stays with the caller then.
+    virtual bool tryPush(const std::string &source, const OrderEvent &evnt)
+    {
+        push(source, evnt);
+        return true;
+    }
+    virtual bool tryPush(const std::string &source, const OrderCancelEvent &evnt)
+    {
+        push(source, evnt);
+        return true;
+    }
+    virtual bool tryPush(const std::string &source, const OrderReplaceEvent &evnt)
+    {
+        push(source, evnt);
+        return true;
+    }
+    virtual bool tryPush(const std::string &source, const OrderChangeStateEvent &evnt)
+    {
+        push(source, evnt);
+        return true;
+    }
+    /// true if tryPush() would reject the event now, lets producers check before
+    /// they create data that could not be released on rejection
+    virtual bool full() const
+    {
+        return false;
+    }
 };
 
 class InQueueProcessor
@@ -155,6 +185,8 @@ class InQueueProcessor
 public:
     virtual ~InQueueProcessor() {};
     virtual bool process() = 0;
+    /// processes up to maxEvents back-to-back, returns amount of processed events
+    virtual u32 processBatch(u32 maxEvents) = 0;
     virtual void onEvent(const std::string &source, const OrderEvent &evnt) = 0;
     virtual void onEvent(const std::string &source, const OrderCancelEvent &evnt) = 0;
     virtual void onEvent(const std::string &source, const OrderReplaceEvent &evnt) = 0;
@@ -191,6 +223,8 @@ public:
     virtual bool pop() = 0;
     /// pop front and process it by the observer
     virtual bool pop(InQueueProcessor *obs) = 0;
+    /// pop up to maxEvents from front and process them by the observer, returns amount of popped events
+    virtual u32 popBatch(InQueueProcessor *obs, u32 maxEvents) = 0;
 
     virtual InQueuesObserver *attach(InQueuesObserver *obs) = 0;
     virtual InQueuesObserver *detach() = 0;
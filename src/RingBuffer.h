@@ -0,0 +1,142 @@
+/**
+ Concurrent Order Processor library
+
+ Author: Sergey Mikhailik
+
+ Copyright (C) 2009-2026 Sergey Mikhailik
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <stdexcept>
+
+#include "CacheAlignedAtomic.h"
+
+namespace COP
+{
+
+/// Bounded multi-producer multi-consumer ring buffer with preallocated slots.
+/// Every slot sits on its own cache line and carries a sequence number that tells
+/// producers and consumers whose turn it is, so push and pop are a single CAS on
+/// the cache-aligned position counters and never allocate.
+template <typename T> class BoundedRingBuffer
+{
+public:
+    /// capacity is rounded up to a power of two
+    explicit BoundedRingBuffer(size_t capacity);
+
+    BoundedRingBuffer(const BoundedRingBuffer &) = delete;
+    BoundedRingBuffer &operator=(const BoundedRingBuffer &) = delete;
+
+    /// returns false if the buffer is full, value is not consumed then
+    bool tryPush(T &&value);
+    /// returns false if the buffer is empty
+    bool tryPop(T &value);
+
+    size_t capacity() const
+    {
+        return mask_ + 1;
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Slot
+    {
+        std::atomic<size_t> sequence_;
+        T value_;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+
+    CacheAlignedAtomic<size_t> enqueuePos_;
+    CacheAlignedAtomic<size_t> dequeuePos_;
+};
+
+template <typename T>
+BoundedRingBuffer<T>::BoundedRingBuffer(size_t capacity) : mask_(0), enqueuePos_(0), dequeuePos_(0)
+{
+    if (0 == capacity)
+    {
+        throw std::runtime_error("BoundedRingBuffer: capacity should be positive!");
+    }
+    size_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+    mask_ = size - 1;
+    slots_.reset(new Slot[size]);
+    for (size_t i = 0; i < size; ++i)
+    {
+        slots_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T> bool BoundedRingBuffer<T>::tryPush(T &&value)
+{
+    Slot *slot = nullptr;
+    size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        slot = &slots_[pos & mask_];
+        const size_t seq = slot->sequence_.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (0 == diff)
+        {
+            if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (0 > diff)
+        {
+            return false;
+        }
+        else
+        {
+            pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+    }
+    slot->value_ = std::move(value);
+    slot->sequence_.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T> bool BoundedRingBuffer<T>::tryPop(T &value)
+{
+    Slot *slot = nullptr;
+    size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        slot = &slots_[pos & mask_];
+        const size_t seq = slot->sequence_.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        if (0 == diff)
+        {
+            if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (0 > diff)
+        {
+            return false;
+        }
+        else
+        {
+            pos = dequeuePos_.load(std::memory_order_relaxed);
+        }
+    }
+    value = std::move(slot->value_);
+    slot->sequence_.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+}
+
+} // namespace COP
@@ -0,0 +1,1225 @@
+/**
+ Concurrent Order Processor library
+
+ Authors: dudleylane, Claude
+
+ Copyright (C) 2026 dudleylane
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+#include "SegmentedLogStorage.h"
+#include "Logger.h"
+
+using namespace std;
+using namespace COP;
+using namespace COP::Store;
+
+namespace
+{
+
+static_assert(std::endian::native == std::endian::little, "Segment layout is little-endian!");
+
+/// O_DIRECT transfers are multiples of the block, at block-aligned offsets
+const size_t BLOCK_SIZE = 4096;
+const size_t RECORD_ALIGNMENT = 8;
+const char SEGMENT_MAGIC[8] = {'C', 'O', 'P', 'S', 'L', 'O', 'G', '\0'};
+const u32 SEGMENT_FORMAT_VERSION = 1;
+const u32 RECORD_MAGIC = 0x31524c53; // "SLR1"
+const char *const SEGMENT_SUFFIX = ".seg";
+const size_t SEGMENT_NAME_DIGITS = 8;
+const size_t RECORD_HEADER_SIZE = 40;
+
+/// first block of a segment file
+struct SegmentHeader
+{
+    char magic_[8];
+    u32 formatVersion_;
+    u32 number_;
+    u64 capacity_;
+    /// end of the records of a sealed segment, 0 while the segment is active
+    u64 sealedEnd_;
+};
+
+u64 alignDown(u64 offset)
+{
+    return offset & ~static_cast<u64>(BLOCK_SIZE - 1);
+}
+
+u64 alignUp(u64 offset)
+{
+    return alignDown(offset + BLOCK_SIZE - 1);
+}
+
+/// bytes a record takes in the segment
+size_t recordBytes(size_t size)
+{
+    const size_t total = RECORD_HEADER_SIZE + size;
+    return (total + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+}
+
+#if !defined(__SSE4_2__)
+struct Crc32cTable
+{
+    u32 values_[256];
+
+    Crc32cTable()
+    {
+        for (u32 i = 0; i < 256; ++i)
+        {
+            u32 crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc & 1) ? (crc >> 1) ^ 0x82f63b78 : (crc >> 1);
+            }
+            values_[i] = crc;
+        }
+    }
+};
+#endif
+
+/// CRC-32C, SSE4.2 instruction if the build targets it
+u32 crc32c(u32 crc, const char *buf, size_t size)
+{
+    crc = ~crc;
+#if defined(__SSE4_2__)
+    u64 crc64 = crc;
+    for (; size >= sizeof(u64); buf += sizeof(u64), size -= sizeof(u64))
+    {
+        u64 val;
+        memcpy(&val, buf, sizeof(val));
+        crc64 = _mm_crc32_u64(crc64, val);
+    }
+    crc = static_cast<u32>(crc64);
+    for (; 0 < size; ++buf, --size)
+    {
+        crc = _mm_crc32_u8(crc, static_cast<unsigned char>(*buf));
+    }
+#else
+    static const Crc32cTable table;
+    for (; 0 < size; ++buf, --size)
+    {
+        crc = table.values_[(crc ^ static_cast<unsigned char>(*buf)) & 0xff] ^ (crc >> 8);
+    }
+#endif
+    return ~crc;
+}
+
+/// writes whole blocks, returns 0 or errno
+int writeBlocks(int fd, const char *buf, size_t size, u64 offset)
+{
+    while (0 < size)
+    {
+        const ssize_t rc = pwrite(fd, buf, size, static_cast<off_t>(offset));
+        if (0 > rc)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return errno;
+        }
+        buf += rc;
+        size -= static_cast<size_t>(rc);
+        offset += static_cast<u64>(rc);
+    }
+    return 0;
+}
+
+void syncData(int fd, const char *context)
+{
+    if (0 != fdatasync(fd))
+    {
+        throw std::runtime_error(string(context) + ": fdatasync failed - " + strerror(errno));
+    }
+}
+
+void syncDirectory(const std::string &path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY);
+    if (0 <= fd)
+    {
+        fsync(fd);
+        ::close(fd);
+    }
+}
+
+/// copies the record passed to save() into the write buffer
+class CopyEncoder : public RecordEncoder
+{
+public:
+    explicit CopyEncoder(const char *buf) : buf_(buf) {}
+
+    void encode(char *buf, size_t size) const override
+    {
+        memcpy(buf, buf_, size);
+    }
+
+private:
+    const char *buf_;
+};
+
+struct MappedSegment
+{
+    void *addr_;
+    size_t size_;
+
+    MappedSegment(void *addr, size_t size) : addr_(addr), size_(size) {}
+    MappedSegment(MappedSegment &&other) noexcept : addr_(other.addr_), size_(other.size_)
+    {
+        other.addr_ = nullptr;
+    }
+    ~MappedSegment()
+    {
+        if (nullptr != addr_)
+        {
+            munmap(addr_, size_);
+        }
+    }
+
+    const char *data() const
+    {
+        return static_cast<const char *>(addr_);
+    }
+};
+
+} // namespace
+
+// =============================================================================
+// AlignedBuffer
+// =============================================================================
+
+SegmentedLogStorage::AlignedBuffer::AlignedBuffer(AlignedBuffer &&other) noexcept
+    : data_(other.data_), size_(other.size_), capacity_(other.capacity_)
+{
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.capacity_ = 0;
+}
+
+SegmentedLogStorage::AlignedBuffer &SegmentedLogStorage::AlignedBuffer::operator=(AlignedBuffer &&other) noexcept
+{
+    if (this != &other)
+    {
+        free(data_);
+        data_ = other.data_;
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.capacity_ = 0;
+    }
+    return *this;
+}
+
+SegmentedLogStorage::AlignedBuffer::~AlignedBuffer()
+{
+    free(data_);
+}
+
+void SegmentedLogStorage::AlignedBuffer::resize(size_t size)
+{
+    if (size > capacity_)
+    {
+        const size_t capacity = alignUp(std::max(size, 2 * capacity_));
+        void *data = nullptr;
+        if (0 != posix_memalign(&data, BLOCK_SIZE, capacity))
+        {
+            throw std::bad_alloc();
+        }
+        if (0 < size_)
+        {
+            memcpy(data, data_, size_);
+        }
+        free(data_);
+        data_ = static_cast<char *>(data);
+        capacity_ = capacity;
+    }
+    if (size > size_)
+    {
+        memset(data_ + size_, 0, size - size_);
+    }
+    size_ = size;
+}
+
+void SegmentedLogStorage::AlignedBuffer::assign(const char *buf, size_t size)
+{
+    size_ = 0;
+    resize(size);
+    if (0 < size)
+    {
+        memcpy(data_, buf, size);
+    }
+}
+
+// =============================================================================
+// SegmentedLogStorage
+// =============================================================================
+
+SegmentedLogStorage::SegmentedLogStorage() : SegmentedLogStorage(SegmentedLogParams()) {}
+
+SegmentedLogStorage::SegmentedLogStorage(const SegmentedLogParams &params)
+    : params_(params), path_(), open_(false), directIo_(params.directIo_),
+      segmentCapacity_(std::max<size_t>(alignUp(params.segmentSize_), 2 * BLOCK_SIZE)), generator_(), index_(),
+      segments_(), active_(nullptr), nextSegment_(1), buffer_(), bufferStart_(0), pendingWrites_(), appended_(0),
+      spare_(), written_(0), synced_(0), failed_(false), totalCompacted_(0), maintenanceStopped_(false)
+{
+    static_assert(RECORD_HEADER_SIZE == sizeof(RecordHeader), "RecordHeader size is the part of the segment format!");
+}
+
+SegmentedLogStorage::SegmentedLogStorage(const std::string &path, FileStorageObserver *observer)
+    : SegmentedLogStorage(path, observer, SegmentedLogParams())
+{
+}
+
+SegmentedLogStorage::SegmentedLogStorage(const std::string &path, FileStorageObserver *observer,
+                                         const SegmentedLogParams &params)
+    : SegmentedLogStorage(params)
+{
+    load(path, observer);
+}
+
+SegmentedLogStorage::~SegmentedLogStorage()
+{
+    close();
+}
+
+void SegmentedLogStorage::close()
+{
+    {
+        std::lock_guard<std::mutex> guard(maintenanceLock_);
+        maintenanceStopped_ = true;
+    }
+    maintenanceWakeUp_.notify_one();
+    if (maintenanceThread_.joinable())
+    {
+        maintenanceThread_.join();
+    }
+    if (!open_)
+    {
+        return;
+    }
+    try
+    {
+        flush(true);
+    }
+    catch (const std::exception &ex)
+    {
+        aux::ExchLogger::instance()->error(string("SegmentedLogStorage: final sync failed: ") + ex.what());
+    }
+    for (auto &seg : segments_)
+    {
+        ::close(seg.second->fd_);
+    }
+    segments_.clear();
+    index_.clear();
+    pendingWrites_.clear();
+    active_ = nullptr;
+    open_ = false;
+}
+
+std::string SegmentedLogStorage::segmentPath(u32 number) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%08u%s", number, SEGMENT_SUFFIX);
+    return path_ + "/" + name;
+}
+
+void SegmentedLogStorage::checkUsable() const
+{
+    if (!open_)
+    {
+        throw std::runtime_error("SegmentedLogStorage: storage is not open!");
+    }
+    if (failed_.load(std::memory_order_acquire))
+    {
+        throw std::runtime_error("SegmentedLogStorage: write failed earlier, storage is not usable!");
+    }
+}
+
+void SegmentedLogStorage::open(const std::string &path)
+{
+    assert(!open_);
+    path_ = path;
+    std::filesystem::create_directories(path_);
+    recoverSegments(nullptr);
+}
+
+void SegmentedLogStorage::load(const std::string &path, FileStorageObserver *observer)
+{
+    assert(nullptr != observer);
+    assert(!open_);
+    path_ = path;
+    std::filesystem::create_directories(path_);
+    recoverSegments(observer);
+}
+
+void SegmentedLogStorage::recoverSegments(FileStorageObserver *observer)
+{
+    vector<u32> numbers;
+    for (const auto &entry : std::filesystem::directory_iterator(path_))
+    {
+        const string name = entry.path().filename().string();
+        if ((SEGMENT_NAME_DIGITS + strlen(SEGMENT_SUFFIX) == name.size()) &&
+            (SEGMENT_NAME_DIGITS == name.find_first_not_of("0123456789")) &&
+            (0 == name.compare(SEGMENT_NAME_DIGITS, string::npos, SEGMENT_SUFFIX)))
+        {
+            numbers.push_back(static_cast<u32>(std::stoul(name.substr(0, SEGMENT_NAME_DIGITS))));
+        }
+    }
+    std::sort(numbers.begin(), numbers.end());
+
+    vector<MappedSegment> mapped;
+    mapped.reserve(numbers.size());
+    for (size_t n = 0; n < numbers.size(); ++n)
+    {
+        const u32 number = numbers[n];
+        const string segPath = segmentPath(number);
+        const int fd = ::open(segPath.c_str(), O_RDWR | O_CLOEXEC);
+        struct stat st;
+        if ((0 > fd) || (0 != fstat(fd, &st)))
+        {
+            if (0 <= fd)
+            {
+                ::close(fd);
+            }
+            throw std::runtime_error("SegmentedLogStorage: unable to open segment '" + segPath + "'!");
+        }
+        const size_t fileSize = static_cast<size_t>(st.st_size);
+        SegmentHeader header;
+        memset(&header, 0, sizeof(header));
+        if ((fileSize >= BLOCK_SIZE) && (sizeof(header) != pread(fd, &header, sizeof(header), 0)))
+        {
+            ::close(fd);
+            throw std::runtime_error("SegmentedLogStorage: unable to read segment '" + segPath + "'!");
+        }
+        if ((fileSize < BLOCK_SIZE) || (0 != memcmp(header.magic_, SEGMENT_MAGIC, sizeof(header.magic_))))
+        {
+            // the last segment could be interrupted before its header was written
+            ::close(fd);
+            if (n + 1 != numbers.size())
+            {
+                throw std::runtime_error("SegmentedLogStorage: segment '" + segPath + "' is damaged!");
+            }
+            unlink(segPath.c_str());
+            syncDirectory(path_);
+            break;
+        }
+        if ((SEGMENT_FORMAT_VERSION != header.formatVersion_) || (number != header.number_) ||
+            (header.sealedEnd_ > fileSize))
+        {
+            ::close(fd);
+            throw std::runtime_error("SegmentedLogStorage: segment '" + segPath + "' is damaged!");
+        }
+        void *addr = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (MAP_FAILED == addr)
+        {
+            ::close(fd);
+            throw std::runtime_error("SegmentedLogStorage: unable to map segment '" + segPath + "'!");
+        }
+        mapped.emplace_back(addr, fileSize);
+        madvise(addr, fileSize, MADV_SEQUENTIAL);
+
+        std::unique_ptr<Segment> seg(new Segment{number, fd, BLOCK_SIZE, BLOCK_SIZE, 0, 0});
+        Segment *segment = seg.get();
+        segments_[number] = std::move(seg);
+
+        const char *data = mapped.back().data();
+        const u64 limit = (0 < header.sealedEnd_) ? header.sealedEnd_ : fileSize;
+        u64 pos = BLOCK_SIZE;
+        bool interrupted = false;
+        while (pos + sizeof(RecordHeader) <= limit)
+        {
+            RecordHeader rec;
+            memcpy(&rec, data + pos, sizeof(rec));
+            if (0 == rec.magic_)
+            {
+                // zeroed space after the last record
+                break;
+            }
+            const u64 total = recordBytes(rec.size_);
+            interrupted =
+                (RECORD_MAGIC != rec.magic_) || (pos + total > limit) || (SAVE_RECORD > rec.kind_) ||
+                (ERASE_ALL_RECORD < rec.kind_) ||
+                (rec.crc_ != crc32c(0, data + pos + 2 * sizeof(u32), sizeof(rec) - 2 * sizeof(u32) + rec.size_));
+            if (interrupted)
+            {
+                break;
+            }
+            segment->end_ = pos + total;
+            segment->dataBytes_ += total;
+            apply(static_cast<RecordKind>(rec.kind_), IdT(rec.id_, rec.date_), rec.version_, rec.replacedVersion_,
+                  Location{number, rec.size_, pos});
+            pos += total;
+        }
+        segment->writtenEnd_ = segment->end_;
+        nextSegment_ = number + 1;
+
+        if (0 < header.sealedEnd_)
+        {
+            if (segment->end_ != header.sealedEnd_)
+            {
+                throw std::runtime_error("SegmentedLogStorage: sealed segment '" + segPath + "' is damaged!");
+            }
+            continue;
+        }
+        // tail of an interrupted write is zeroed, so that the next scan stops at the same record
+        const u64 tail = alignDown(segment->end_);
+        if (tail < fileSize)
+        {
+            AlignedBuffer block;
+            block.resize(BLOCK_SIZE);
+            memcpy(block.data(), data + tail, segment->end_ - tail);
+            if (0 != writeBlocks(fd, block.data(), BLOCK_SIZE, tail))
+            {
+                throw std::runtime_error("SegmentedLogStorage: unable to repair segment '" + segPath + "'!");
+            }
+            syncData(fd, "SegmentedLogStorage::load");
+        }
+        writeHeader(*segment, segment->end_);
+        if (interrupted)
+        {
+            aux::ExchLogger::instance()->warn("SegmentedLogStorage: segment '" + segPath +
+                                              "' ends with an interrupted write at " + to_string(pos));
+        }
+    }
+
+    if (nullptr != observer)
+    {
+        struct LiveRecord
+        {
+            IdT id_;
+            u32 version_;
+            u32 size_;
+            const char *data_;
+        };
+        vector<LiveRecord> live;
+        // positions in live of the ids with several versions
+        unordered_map<IdT, vector<size_t>, IdTHash> versioned;
+        size_t n = 0;
+        for (const auto &entry : segments_)
+        {
+            const Segment &segment = *entry.second;
+            const char *data = mapped[n++].data();
+            for (u64 pos = BLOCK_SIZE; pos < segment.end_;)
+            {
+                RecordHeader rec;
+                memcpy(&rec, data + pos, sizeof(rec));
+                const IdT id(rec.id_, rec.date_);
+                const Location *loc = find(id, rec.version_);
+                if ((nullptr != loc) && (loc->segment_ == segment.number_) && (loc->offset_ == pos))
+                {
+                    if (1 < index_.find(id)->second.size())
+                    {
+                        versioned[id].push_back(live.size());
+                    }
+                    live.push_back(LiveRecord{ id, rec.version_, rec.size_, data + pos + sizeof(rec) });
+                }
+                pos += recordBytes(rec.size_);
+            }
+        }
+        // compaction copies an old version behind the newer ones, the versions of an id
+        // take its positions in ascending order, so the version loaded last is the latest
+        for (const auto &entry : versioned)
+        {
+            vector<LiveRecord> records;
+            records.reserve(entry.second.size());
+            for (size_t idx : entry.second)
+            {
+                records.push_back(live[idx]);
+            }
+            std::sort(records.begin(), records.end(),
+                      [](const LiveRecord &l, const LiveRecord &r) { return l.version_ < r.version_; });
+            for (size_t i = 0; i < records.size(); ++i)
+            {
+                live[entry.second[i]] = records[i];
+            }
+        }
+
+        observer->startLoad();
+        for (const LiveRecord &rec : live)
+        {
+            observer->onRecordLoaded(rec.id_, rec.version_, rec.data_, rec.size_);
+        }
+        observer->finishLoad();
+    }
+    mapped.clear();
+
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        createSegment();
+    }
+    open_ = true;
+    const bool periodicSync = !params_.syncOnCommit_ && (0 < params_.syncIntervalMs_);
+    if (periodicSync || (0 < params_.compactionIntervalMs_))
+    {
+        maintenanceStopped_ = false;
+        maintenanceThread_ = std::thread(&SegmentedLogStorage::runMaintenance, this);
+    }
+}
+
+void SegmentedLogStorage::writeHeader(const Segment &segment, u64 sealedEnd)
+{
+    AlignedBuffer block;
+    block.resize(BLOCK_SIZE);
+    SegmentHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic_, SEGMENT_MAGIC, sizeof(header.magic_));
+    header.formatVersion_ = SEGMENT_FORMAT_VERSION;
+    header.number_ = segment.number_;
+    header.capacity_ = segmentCapacity_;
+    header.sealedEnd_ = sealedEnd;
+    memcpy(block.data(), &header, sizeof(header));
+
+    int rc = writeBlocks(segment.fd_, block.data(), BLOCK_SIZE, 0);
+    if ((EINVAL == rc) && directIo_.load(std::memory_order_relaxed))
+    {
+        // file system accepted O_DIRECT on open but not on write
+        const int flags = fcntl(segment.fd_, F_GETFL);
+        if ((0 <= flags) && (0 == fcntl(segment.fd_, F_SETFL, flags & ~O_DIRECT)))
+        {
+            directIo_.store(false, std::memory_order_relaxed);
+            aux::ExchLogger::instance()->warn("SegmentedLogStorage: O_DIRECT refused, buffered writes are used");
+            rc = writeBlocks(segment.fd_, block.data(), BLOCK_SIZE, 0);
+        }
+    }
+    if (0 != rc)
+    {
+        throw std::runtime_error("SegmentedLogStorage: unable to write header of segment '" +
+                                 segmentPath(segment.number_) + "' - " + strerror(rc));
+    }
+    syncData(segment.fd_, "SegmentedLogStorage::writeHeader");
+}
+
+void SegmentedLogStorage::createSegment()
+{
+    const u32 number = nextSegment_++;
+    const string segPath = segmentPath(number);
+    const int flags = O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC;
+    int fd = -1;
+    if (directIo_.load(std::memory_order_relaxed))
+    {
+        fd = ::open(segPath.c_str(), flags | O_DIRECT, 0664);
+        if ((0 > fd) && (EINVAL == errno))
+        {
+            directIo_.store(false, std::memory_order_relaxed);
+            aux::ExchLogger::instance()->warn("SegmentedLogStorage: O_DIRECT refused, buffered writes are used");
+        }
+    }
+    if (0 > fd)
+    {
+        fd = ::open(segPath.c_str(), flags, 0664);
+    }
+    if (0 > fd)
+    {
+        throw std::runtime_error("SegmentedLogStorage: unable to create segment '" + segPath + "' - " +
+                                 strerror(errno));
+    }
+    // appends do not change the file size, so fdatasync() does not write metadata
+    if ((0 != fallocate(fd, 0, 0, static_cast<off_t>(segmentCapacity_))) &&
+        (0 != ftruncate(fd, static_cast<off_t>(segmentCapacity_))))
+    {
+        ::close(fd);
+        unlink(segPath.c_str());
+        throw std::runtime_error("SegmentedLogStorage: unable to preallocate segment '" + segPath + "'!");
+    }
+    std::unique_ptr<Segment> seg(new Segment{number, fd, BLOCK_SIZE, BLOCK_SIZE, 0, 0});
+    try
+    {
+        writeHeader(*seg, 0);
+    }
+    catch (...)
+    {
+        ::close(fd);
+        unlink(segPath.c_str());
+        throw;
+    }
+    syncDirectory(path_);
+
+    active_ = seg.get();
+    segments_[number] = std::move(seg);
+    buffer_.resize(0);
+    bufferStart_ = BLOCK_SIZE;
+}
+
+const SegmentedLogStorage::Location *SegmentedLogStorage::find(const IdT &id, u32 version) const
+{
+    IndexT::const_iterator it = index_.find(id);
+    if (index_.end() == it)
+    {
+        return nullptr;
+    }
+    VersionsT::const_iterator ver = it->second.find(version);
+    return (it->second.end() == ver) ? nullptr : &ver->second;
+}
+
+void SegmentedLogStorage::dropLocation(const Location &loc)
+{
+    Segment &segment = *segments_.at(loc.segment_);
+    assert(segment.liveBytes_ >= recordBytes(loc.size_));
+    segment.liveBytes_ -= recordBytes(loc.size_);
+}
+
+void SegmentedLogStorage::apply(RecordKind kind, const IdT &id, u32 version, u32 replacedVersion,
+                                const Location &loc)
+{
+    switch (kind)
+    {
+    case REPLACE_RECORD:
+    case SAVE_RECORD:
+    {
+        VersionsT &versions = index_[id];
+        if (REPLACE_RECORD == kind)
+        {
+            VersionsT::iterator replaced = versions.find(replacedVersion);
+            if (versions.end() != replaced)
+            {
+                dropLocation(replaced->second);
+                versions.erase(replaced);
+            }
+        }
+        auto res = versions.emplace(version, loc);
+        if (!res.second)
+        {
+            dropLocation(res.first->second);
+            res.first->second = loc;
+        }
+        segments_.at(loc.segment_)->liveBytes_ += recordBytes(loc.size_);
+        break;
+    }
+    case ERASE_VERSION_RECORD:
+    {
+        IndexT::iterator it = index_.find(id);
+        if (index_.end() == it)
+        {
+            break;
+        }
+        VersionsT::iterator ver = it->second.find(version);
+        if (it->second.end() != ver)
+        {
+            dropLocation(ver->second);
+            it->second.erase(ver);
+        }
+        if (it->second.empty())
+        {
+            index_.erase(it);
+        }
+        break;
+    }
+    case ERASE_ALL_RECORD:
+    {
+        IndexT::iterator it = index_.find(id);
+        if (index_.end() == it)
+        {
+            break;
+        }
+        for (const auto &ver : it->second)
+        {
+            dropLocation(ver.second);
+        }
+        index_.erase(it);
+        break;
+    }
+    default:
+        throw std::runtime_error("SegmentedLogStorage: Invalid record kind!");
+    };
+}
+
+u64 SegmentedLogStorage::append(RecordKind kind, const IdT &id, u32 version, u32 replacedVersion, size_t size,
+                                const RecordEncoder *encoder)
+{
+    checkUsable();
+    const size_t total = recordBytes(size);
+    if (total > segmentCapacity_ - BLOCK_SIZE)
+    {
+        throw std::runtime_error("SegmentedLogStorage: record does not fit into a segment!");
+    }
+    if (active_->end_ + total > segmentCapacity_)
+    {
+        // the full segment is sealed by the next flush
+        pendingWrites_.push_back(PendingWrite{active_, bufferStart_, std::move(buffer_), true});
+        buffer_ = AlignedBuffer();
+        try
+        {
+            createSegment();
+        }
+        catch (...)
+        {
+            failed_.store(true, std::memory_order_release);
+            throw;
+        }
+    }
+
+    const u64 offset = active_->end_;
+    const size_t at = static_cast<size_t>(offset - bufferStart_);
+    buffer_.resize(at + total);
+    char *rec = buffer_.data() + at;
+    if (nullptr != encoder)
+    {
+        try
+        {
+            encoder->encode(rec + sizeof(RecordHeader), size);
+        }
+        catch (...)
+        {
+            buffer_.resize(at);
+            throw;
+        }
+    }
+    RecordHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic_ = RECORD_MAGIC;
+    header.kind_ = kind;
+    header.version_ = version;
+    header.id_ = id.id_;
+    header.date_ = id.date_;
+    header.size_ = static_cast<u32>(size);
+    header.replacedVersion_ = replacedVersion;
+    memcpy(rec, &header, sizeof(header));
+    header.crc_ = crc32c(0, rec + 2 * sizeof(u32), sizeof(header) - 2 * sizeof(u32) + size);
+    memcpy(rec + sizeof(u32), &header.crc_, sizeof(header.crc_));
+
+    active_->end_ += total;
+    active_->dataBytes_ += total;
+    appended_ += total;
+    apply(kind, id, version, replacedVersion, Location{active_->number_, static_cast<u32>(size), offset});
+    return appended_;
+}
+
+void SegmentedLogStorage::commit(u64 position)
+{
+    if (params_.syncOnCommit_ && (synced_.load(std::memory_order_acquire) < position))
+    {
+        flush(true);
+    }
+}
+
+void SegmentedLogStorage::flush(bool sync)
+{
+    std::lock_guard<std::mutex> flushGuard(flushLock_);
+    vector<PendingWrite> writes;
+    vector<u64> ends;
+    u64 target = 0;
+    Segment *active = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        checkUsable();
+        target = appended_;
+        active = active_;
+        if (written_ < target)
+        {
+            writes.swap(pendingWrites_);
+            if (active_->end_ > active_->writtenEnd_)
+            {
+                // the partial last block stays in the buffer and is written again with the next records
+                const u64 keepFrom = alignDown(active_->end_);
+                writes.push_back(PendingWrite{active_, bufferStart_, std::move(buffer_), false});
+                buffer_ = std::move(spare_);
+                buffer_.assign(writes.back().data_.data() + (keepFrom - bufferStart_),
+                               static_cast<size_t>(active_->end_ - keepFrom));
+                bufferStart_ = keepFrom;
+            }
+        }
+        else if (!sync || (synced_.load(std::memory_order_relaxed) >= target))
+        {
+            return;
+        }
+    }
+
+    try
+    {
+        for (PendingWrite &w : writes)
+        {
+            const u64 end = w.offset_ + w.data_.size();
+            ends.push_back(end);
+            w.data_.resize(static_cast<size_t>(alignUp(w.data_.size())));
+            const int rc = writeBlocks(w.segment_->fd_, w.data_.data(), w.data_.size(), w.offset_);
+            if (0 != rc)
+            {
+                throw std::runtime_error("SegmentedLogStorage: unable to write segment '" +
+                                         segmentPath(w.segment_->number_) + "' - " + strerror(rc));
+            }
+            if (w.seal_)
+            {
+                syncData(w.segment_->fd_, "SegmentedLogStorage::flush");
+                writeHeader(*w.segment_, end);
+            }
+        }
+        if (sync)
+        {
+            syncData(active->fd_, "SegmentedLogStorage::flush");
+        }
+    }
+    catch (...)
+    {
+        // records of the callers are lost, later changes could not be ordered after them
+        failed_.store(true, std::memory_order_release);
+        throw;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        for (size_t i = 0; i < writes.size(); ++i)
+        {
+            writes[i].segment_->writtenEnd_ = ends[i];
+        }
+    }
+    for (PendingWrite &w : writes)
+    {
+        if (!w.seal_)
+        {
+            spare_ = std::move(w.data_);
+        }
+    }
+    written_ = target;
+    if (sync)
+    {
+        synced_.store(target, std::memory_order_release);
+    }
+}
+
+void SegmentedLogStorage::sync()
+{
+    flush(true);
+}
+
+IdT SegmentedLogStorage::save(const char *buf, size_t size)
+{
+    IdT id = generator_.getId();
+    save(id, buf, size);
+    return id;
+}
+
+void SegmentedLogStorage::save(const IdT &id, const char *buf, size_t size)
+{
+    assert(nullptr != buf);
+    CopyEncoder encoder(buf);
+    saveReserved(id, size, encoder);
+}
+
+void SegmentedLogStorage::saveReserved(const IdT &id, size_t size, const RecordEncoder &encoder)
+{
+    assert(0 < size);
+    u64 position = 0;
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (nullptr != find(id, 0))
+        {
+            throw std::runtime_error(
+                "SegmentedLogStorage::save: Unable to save record, record with this Id already exists!");
+        }
+        position = append(SAVE_RECORD, id, 0, 0, size, &encoder);
+    }
+    commit(position);
+}
+
+u32 SegmentedLogStorage::update(const IdT &id, const char *buf, size_t size)
+{
+    assert(nullptr != buf);
+    assert(0 < size);
+    CopyEncoder encoder(buf);
+    u32 version = 0;
+    u64 position = 0;
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        IndexT::const_iterator it = index_.find(id);
+        if (index_.end() != it)
+        {
+            version = it->second.rbegin()->first + 1;
+        }
+        position = append(SAVE_RECORD, id, version, 0, size, &encoder);
+    }
+    commit(position);
+    return version;
+}
+
+u32 SegmentedLogStorage::replace(const IdT &id, u32 version, const char *buf, size_t size)
+{
+    assert(nullptr != buf);
+    assert(0 < size);
+    CopyEncoder encoder(buf);
+    u32 newVersion = 0;
+    u64 position = 0;
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        IndexT::const_iterator it = index_.find(id);
+        if (index_.end() == it)
+        {
+            throw std::runtime_error(
+                "SegmentedLogStorage::replace: Unable to replace record, record with this Id not exists!");
+        }
+        if (it->second.end() == it->second.find(version))
+        {
+            throw std::runtime_error(
+                "SegmentedLogStorage::replace: Unable to replace record, record with this version not exists!");
+        }
+        newVersion = it->second.rbegin()->first + 1;
+        // one record erases the old version and saves the new one, a crash keeps either both or none
+        position = append(REPLACE_RECORD, id, newVersion, version, size, &encoder);
+    }
+    commit(position);
+    return newVersion;
+}
+
+void SegmentedLogStorage::erase(const IdT &id, u32 version)
+{
+    u64 position = 0;
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (nullptr == find(id, version))
+        {
+            return;
+        }
+        position = append(ERASE_VERSION_RECORD, id, version, 0, 0, nullptr);
+    }
+    commit(position);
+}
+
+void SegmentedLogStorage::erase(const IdT &id)
+{
+    u64 position = 0;
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (index_.end() == index_.find(id))
+        {
+            return;
+        }
+        position = append(ERASE_ALL_RECORD, id, 0, 0, 0, nullptr);
+    }
+    commit(position);
+}
+
+bool SegmentedLogStorage::isExists(const IdT &id) const
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    return index_.end() != index_.find(id);
+}
+
+bool SegmentedLogStorage::isExists(const IdT &id, u32 version) const
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    return nullptr != find(id, version);
+}
+
+u32 SegmentedLogStorage::getTopVersion(const IdT &id) const
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    IndexT::const_iterator it = index_.find(id);
+    return (index_.end() == it) ? 0 : it->second.rbegin()->first;
+}
+
+size_t SegmentedLogStorage::recordSize(const IdT &id, u32 version) const
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    const Location *loc = find(id, version);
+    return (nullptr == loc) ? 0 : loc->size_;
+}
+
+bool SegmentedLogStorage::loadRecord(const IdT &id, u32 version, std::vector<char> *buf)
+{
+    assert(nullptr != buf);
+    for (;;)
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            const Location *loc = find(id, version);
+            if (nullptr == loc)
+            {
+                return false;
+            }
+            const Segment &segment = *segments_.at(loc->segment_);
+            const u64 body = loc->offset_ + sizeof(RecordHeader);
+            if ((&segment == active_) && (loc->offset_ >= bufferStart_))
+            {
+                const char *data = buffer_.data() + (body - bufferStart_);
+                buf->assign(data, data + loc->size_);
+                return true;
+            }
+            if (loc->offset_ + recordBytes(loc->size_) <= segment.writtenEnd_)
+            {
+                // aligned read works for the O_DIRECT descriptor as well
+                const u64 from = alignDown(body);
+                AlignedBuffer blocks;
+                blocks.resize(static_cast<size_t>(alignUp(body + loc->size_) - from));
+                if (static_cast<ssize_t>(blocks.size()) !=
+                    pread(segment.fd_, blocks.data(), blocks.size(), static_cast<off_t>(from)))
+                {
+                    throw std::runtime_error("SegmentedLogStorage::loadRecord: unable to read segment '" +
+                                             segmentPath(segment.number_) + "'!");
+                }
+                const char *data = blocks.data() + (body - from);
+                buf->assign(data, data + loc->size_);
+                return true;
+            }
+        }
+        // the record is in a buffer being written
+        flush(false);
+    }
+}
+
+size_t SegmentedLogStorage::segmentCount() const
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    return segments_.size();
+}
+
+u64 SegmentedLogStorage::liveBytes() const
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    u64 bytes = 0;
+    for (const auto &seg : segments_)
+    {
+        bytes += seg.second->liveBytes_;
+    }
+    return bytes;
+}
+
+size_t SegmentedLogStorage::compact()
+{
+    std::lock_guard<std::mutex> compactGuard(compactLock_);
+    // sealed segments get written, so that they could be read back
+    flush(false);
+    size_t removed = 0;
+    while (compactOldest())
+    {
+        ++removed;
+    }
+    return removed;
+}
+
+bool SegmentedLogStorage::compactOldest()
+{
+    Segment *segment = nullptr;
+    u64 end = 0;
+    u64 live = 0;
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        checkUsable();
+        segment = segments_.begin()->second.get();
+        if ((segment == active_) || (segment->writtenEnd_ < segment->end_))
+        {
+            return false;
+        }
+        if ((0 < segment->dataBytes_) && (static_cast<double>(segment->liveBytes_) >=
+                                          params_.compactionThreshold_ * static_cast<double>(segment->dataBytes_)))
+        {
+            return false;
+        }
+        end = segment->end_;
+        live = segment->liveBytes_;
+    }
+
+    size_t moved = 0;
+    if (0 < live)
+    {
+        // sealed segment is not written any more and only compaction removes it
+        AlignedBuffer data;
+        data.resize(static_cast<size_t>(alignUp(end)));
+        if (static_cast<ssize_t>(data.size()) != pread(segment->fd_, data.data(), data.size(), 0))
+        {
+            throw std::runtime_error("SegmentedLogStorage::compact: unable to read segment '" +
+                                     segmentPath(segment->number_) + "'!");
+        }
+        std::lock_guard<std::mutex> guard(lock_);
+        for (u64 pos = BLOCK_SIZE; pos < end;)
+        {
+            RecordHeader rec;
+            memcpy(&rec, data.data() + pos, sizeof(rec));
+            const IdT id(rec.id_, rec.date_);
+            const Location *loc = find(id, rec.version_);
+            if ((nullptr != loc) && (loc->segment_ == segment->number_) && (loc->offset_ == pos))
+            {
+                CopyEncoder encoder(data.data() + pos + sizeof(rec));
+                append(SAVE_RECORD, id, rec.version_, 0, rec.size_, &encoder);
+                ++moved;
+            }
+            pos += recordBytes(rec.size_);
+        }
+    }
+    // copies are durable before the segment is removed
+    flush(true);
+    {
+        std::lock_guard<std::mutex> flushGuard(flushLock_);
+        std::lock_guard<std::mutex> guard(lock_);
+        assert(0 == segment->liveBytes_);
+        ::close(segment->fd_);
+        unlink(segmentPath(segment->number_).c_str());
+        segments_.erase(segment->number_);
+    }
+    syncDirectory(path_);
+    totalCompacted_.fetch_add(1, std::memory_order_relaxed);
+
+    if (aux::ExchLogger::instance()->isNoteOn())
+    {
+        aux::ExchLogger::instance()->note("SegmentedLogStorage: compacted segment, live records moved: " +
+                                          to_string(moved));
+    }
+    return true;
+}
+
+void SegmentedLogStorage::runMaintenance()
+{
+    typedef std::chrono::steady_clock ClockT;
+    const bool periodicSync = !params_.syncOnCommit_ && (0 < params_.syncIntervalMs_);
+    const bool periodicCompaction = (0 < params_.compactionIntervalMs_);
+    const std::chrono::milliseconds syncInterval(params_.syncIntervalMs_);
+    const std::chrono::milliseconds compactionInterval(params_.compactionIntervalMs_);
+    ClockT::time_point nextSync = ClockT::now() + syncInterval;
+    ClockT::time_point nextCompaction = ClockT::now() + compactionInterval;
+
+    std::unique_lock<std::mutex> guard(maintenanceLock_);
+    while (!maintenanceStopped_)
+    {
+        ClockT::time_point wakeUp = periodicSync ? nextSync : nextCompaction;
+        if (periodicSync && periodicCompaction)
+        {
+            wakeUp = std::min(nextSync, nextCompaction);
+        }
+        maintenanceWakeUp_.wait_until(guard, wakeUp, [this]() { return maintenanceStopped_; });
+        if (maintenanceStopped_)
+        {
+            break;
+        }
+        guard.unlock();
+        try
+        {
+            const ClockT::time_point now = ClockT::now();
+            if (periodicSync && (nextSync <= now))
+            {
+                flush(true);
+                nextSync = now + syncInterval;
+            }
+            if (periodicCompaction && (nextCompaction <= now))
+            {
+                compact();
+                nextCompaction = now + compactionInterval;
+            }
+        }
+        catch (const std::exception &ex)
+        {
+            aux::ExchLogger::instance()->error(string("SegmentedLogStorage: background write failed: ") +
+                                               ex.what());
+        }
+        guard.lock();
+    }
+}
@@ -0,0 +1,278 @@
+/**
+ Concurrent Order Processor library
+
+ Authors: dudleylane, Claude
+
+ Copyright (C) 2026 dudleylane
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "IdTGenerator.h"
+#include "FileStorageDef.h"
+
+namespace COP
+{
+namespace Store
+{
+
+struct SegmentedLogParams
+{
+    /// bytes preallocated for every segment file, a record never spans segments
+    size_t segmentSize_ = 64UL * 1024UL * 1024UL;
+    /// writes bypass the page cache; buffered writes are used if the file system refuses O_DIRECT
+    bool directIo_ = false;
+    /// every change returns after its record is synced,
+    /// records appended by concurrent callers are written and synced together
+    bool syncOnCommit_ = true;
+    /// !syncOnCommit_: period of the background write and sync, 0 - sync() only
+    u32 syncIntervalMs_ = 100;
+    /// the oldest segment is compacted while its live records take less than this share of it
+    double compactionThreshold_ = 0.5;
+    /// period of the background compaction, 0 - compact() only
+    u32 compactionIntervalMs_ = 0;
+};
+
+/// Append-only storage of records in preallocated segment files.
+/// Every change is a record appended to the active segment:
+///   <RecordHeader - 40 bytes><body> padded to 8 bytes, CRC-32C covers both.
+/// Records are collected in a block-aligned buffer and written with whole-block
+/// pwrite(), so the buffer could be written with O_DIRECT.
+/// The in-memory index keeps the location of every live version, load() passes
+/// the live versions to the observer in the log order.
+/// A full segment is sealed: its header gets the end of its records. A record failing
+/// its CRC ends an unsealed segment, it is the tail of an interrupted write;
+/// in a sealed segment it is damage and load() throws.
+/// Compaction copies live records of the oldest segment to the active one and
+/// removes the segment. Only the oldest one is compacted, so dropped erase records
+/// never uncover an older version.
+class SegmentedLogStorage final : public FileSaver
+{
+public:
+    SegmentedLogStorage();
+    explicit SegmentedLogStorage(const SegmentedLogParams &params);
+    SegmentedLogStorage(const std::string &path, FileStorageObserver *observer);
+    SegmentedLogStorage(const std::string &path, FileStorageObserver *observer, const SegmentedLogParams &params);
+    ~SegmentedLogStorage();
+
+public:
+    /// opens the storage without passing its records to an observer
+    void open(const std::string &path);
+
+    /// reimplemented from FileSaver
+    void load(const std::string &path, FileStorageObserver *observer) override;
+    IdT save(const char *buf, size_t size) override;
+    void save(const IdT &id, const char *buf, size_t size) override;
+    /// encodes the record straight into the write buffer
+    void saveReserved(const IdT &id, size_t size, const RecordEncoder &encoder) override;
+    u32 update(const IdT &id, const char *buf, size_t size) override;
+    u32 replace(const IdT &id, u32 version, const char *buf, size_t size) override;
+    void erase(const IdT &id, u32 version) override;
+    void erase(const IdT &id) override;
+
+public:
+    /// return true if record exists
+    bool isExists(const IdT &id) const;
+    /// return true if version of record exists
+    bool isExists(const IdT &id, u32 version) const;
+    /// returns latest version of the record
+    u32 getTopVersion(const IdT &id) const;
+    /// returns size of the record with version
+    size_t recordSize(const IdT &id, u32 version) const;
+    /// loads record into the buf
+    /// return false if version of record not exists
+    bool loadRecord(const IdT &id, u32 version, std::vector<char> *buf);
+
+    /// writes and syncs every record appended so far
+    void sync();
+    /// compacts the oldest segments while they are below the threshold,
+    /// returns amount of removed segments
+    size_t compact();
+
+    /// false if O_DIRECT was requested and refused by the file system
+    bool directIo() const
+    {
+        return directIo_.load(std::memory_order_relaxed);
+    }
+    size_t segmentCount() const;
+    /// bytes of the live versions in all segments
+    u64 liveBytes() const;
+    u64 totalCompactedSegments() const
+    {
+        return totalCompacted_.load(std::memory_order_relaxed);
+    }
+
+private:
+    enum RecordKind
+    {
+        INVALID_RECORD = 0,
+        /// version of the record
+        SAVE_RECORD,
+        /// version of the record that erases replacedVersion_
+        REPLACE_RECORD,
+        /// erases version_ of the record
+        ERASE_VERSION_RECORD,
+        /// erases all versions of the record
+        ERASE_ALL_RECORD
+    };
+
+    struct RecordHeader
+    {
+        u32 magic_;
+        /// CRC-32C of the header after this field and of the body
+        u32 crc_;
+        u32 kind_;
+        u32 version_;
+        u64 id_;
+        u32 date_;
+        u32 size_;
+        u32 replacedVersion_;
+        u32 reserved_;
+    };
+
+    /// block-aligned memory, so that it could be written with O_DIRECT
+    class AlignedBuffer
+    {
+    public:
+        AlignedBuffer() : data_(nullptr), size_(0), capacity_(0) {}
+        AlignedBuffer(AlignedBuffer &&other) noexcept;
+        AlignedBuffer &operator=(AlignedBuffer &&other) noexcept;
+        ~AlignedBuffer();
+
+        char *data() const
+        {
+            return data_;
+        }
+        size_t size() const
+        {
+            return size_;
+        }
+        /// bytes added are zeroed
+        void resize(size_t size);
+        void assign(const char *buf, size_t size);
+
+    private:
+        AlignedBuffer(const AlignedBuffer &) = delete;
+        AlignedBuffer &operator=(const AlignedBuffer &) = delete;
+
+        char *data_;
+        size_t size_;
+        size_t capacity_;
+    };
+
+    struct Segment
+    {
+        u32 number_;
+        int fd_;
+        /// end of the appended records
+        u64 end_;
+        /// end of the records already written to the file
+        u64 writtenEnd_;
+        /// bytes of the records, live or not
+        u64 dataBytes_;
+        u64 liveBytes_;
+    };
+
+    struct Location
+    {
+        u32 segment_;
+        u32 size_;
+        u64 offset_;
+    };
+    typedef std::map<u32, Location> VersionsT;
+    typedef std::unordered_map<IdT, VersionsT, IdTHash> IndexT;
+
+    /// buffer of the sealed segment waiting for the write
+    struct PendingWrite
+    {
+        Segment *segment_;
+        u64 offset_;
+        AlignedBuffer data_;
+        bool seal_;
+    };
+
+    void close();
+    void runMaintenance();
+    void checkUsable() const;
+    std::string segmentPath(u32 number) const;
+    /// scans the segment files, applies their records to the index and seals them,
+    /// then passes the live versions to the observer if it is not nullptr
+    void recoverSegments(FileStorageObserver *observer);
+    /// creates the next segment and makes it active, lock_ should be held
+    void createSegment();
+    /// writes the segment header, sealedEnd - 0 if the segment is active
+    void writeHeader(const Segment &segment, u64 sealedEnd);
+
+    /// appends the record to the active segment and applies it to the index,
+    /// lock_ should be held. Returns the log position to commit
+    u64 append(RecordKind kind, const IdT &id, u32 version, u32 replacedVersion, size_t size,
+               const RecordEncoder *encoder);
+    /// applies the record to the index and to the live bytes of the segments
+    void apply(RecordKind kind, const IdT &id, u32 version, u32 replacedVersion, const Location &loc);
+    void dropLocation(const Location &loc);
+    /// location of the live version, nullptr if there is none; lock_ should be held
+    const Location *find(const IdT &id, u32 version) const;
+    /// returns once the record at the log position is synced, syncOnCommit_ only
+    void commit(u64 position);
+    /// writes the appended records, syncs them if sync is true
+    void flush(bool sync);
+    /// compacts the oldest segment if it is below the threshold, returns false otherwise
+    bool compactOldest();
+
+    SegmentedLogStorage(const SegmentedLogStorage &) = delete;
+    SegmentedLogStorage &operator=(const SegmentedLogStorage &) = delete;
+
+private:
+    SegmentedLogParams params_;
+    std::string path_;
+    bool open_;
+    std::atomic<bool> directIo_;
+    size_t segmentCapacity_;
+    IdTValueGenerator generator_;
+
+    /// index, segments and the write buffer
+    mutable std::mutex lock_;
+    IndexT index_;
+    std::map<u32, std::unique_ptr<Segment>> segments_;
+    Segment *active_;
+    u32 nextSegment_;
+    /// records of the active segment from bufferStart_, a block-aligned file offset
+    AlignedBuffer buffer_;
+    u64 bufferStart_;
+    std::vector<PendingWrite> pendingWrites_;
+    /// bytes appended since open, positions of the records in the log
+    u64 appended_;
+
+    /// one flush at a time; segments are removed only while it is held
+    std::mutex flushLock_;
+    AlignedBuffer spare_;
+    u64 written_;
+    std::atomic<u64> synced_;
+    std::atomic<bool> failed_;
+
+    /// one compaction at a time
+    std::mutex compactLock_;
+    std::atomic<u64> totalCompacted_;
+
+    std::thread maintenanceThread_;
+    std::mutex maintenanceLock_;
+    std::condition_variable maintenanceWakeUp_;
+    bool maintenanceStopped_;
+};
+
+} // namespace Store
+} // namespace COP
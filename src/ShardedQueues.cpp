@@ -0,0 +1,145 @@
+/**
+ Concurrent Order Processor library
+
+ Author: Sergey Mikhailik
+
+ Copyright (C) 2009-2026 Sergey Mikhailik
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#include <cassert>
+#include <stdexcept>
+
+#include "ShardedQueues.h"
+#include "OrderStorage.h"
+#include "DataModelDef.h"
+#include "Logger.h"
+
+using namespace std;
+using namespace COP;
+using namespace COP::Queues;
+
+ShardedInQueues::ShardedInQueues(size_t shardCount, Store::OrderDataStorage *orderStorage)
+    : orderStorage_(orderStorage)
+{
+    if (0 == shardCount)
+    {
+        throw std::runtime_error("ShardedInQueues: shard count should be positive!");
+    }
+    assert(nullptr != orderStorage_);
+    shards_.reserve(shardCount);
+    for (size_t i = 0; i < shardCount; ++i)
+    {
+        shards_.push_back(std::make_unique<IncomingQueues>());
+    }
+    aux::ExchLogger::instance()->note("ShardedInQueues created.");
+}
+
+ShardedInQueues::~ShardedInQueues(void)
+{
+    shards_.clear();
+    aux::ExchLogger::instance()->note("ShardedInQueues destroyed.");
+}
+
+size_t ShardedInQueues::shardOf(const SourceIdT &instrument) const
+{
+    return IdTHash()(instrument) % shards_.size();
+}
+
+size_t ShardedInQueues::shardOfOrder(const IdT &orderId) const
+{
+    if (!orderId.isValid())
+    {
+        return 0;
+    }
+    const OrderEntry *ord = orderStorage_->locateByOrderId(orderId);
+    if (nullptr == ord)
+    {
+        return 0;
+    }
+    // instrument of the stored order is never changed, no need to lock the entry
+    return shardOf(ord->instrument_.getId());
+}
+
+u32 ShardedInQueues::size() const
+{
+    u32 total = 0;
+    for (ShardsT::const_iterator it = shards_.begin(); it != shards_.end(); ++it)
+    {
+        total += (*it)->size();
+    }
+    return total;
+}
+
+void ShardedInQueues::push(const std::string &source, const OrderEvent &evnt)
+{
+    if (nullptr == evnt.order_) [[unlikely]]
+    {
+        throw std::runtime_error("ShardedInQueues::push(OrderEvent): order pointer is null!");
+    }
+    shards_[shardOf(evnt.order_->instrument_.getId())]->push(source, evnt);
+}
+
+void ShardedInQueues::push(const std::string &source, const OrderCancelEvent &evnt)
+{
+    shards_[shardOfOrder(evnt.id_)]->push(source, evnt);
+}
+
+void ShardedInQueues::push(const std::string &source, const OrderReplaceEvent &evnt)
+{
+    shards_[shardOfOrder(evnt.id_)]->push(source, evnt);
+}
+
+void ShardedInQueues::push(const std::string &source, const OrderChangeStateEvent &evnt)
+{
+    shards_[shardOfOrder(evnt.id_)]->push(source, evnt);
+}
+
+void ShardedInQueues::push(const std::string &source, const ProcessEvent &evnt)
+{
+    shards_[shardOfOrder(evnt.id_)]->push(source, evnt);
+}
+
+void ShardedInQueues::push(const std::string &source, const TimerEvent &evnt)
+{
+    shards_[shardOfOrder(evnt.id_)]->push(source, evnt);
+}
+
+bool ShardedInQueues::full() const
+{
+    for (ShardsT::const_iterator it = shards_.begin(); it != shards_.end(); ++it)
+    {
+        if ((*it)->full())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ShardedInQueues::tryPush(const std::string &source, const OrderEvent &evnt)
+{
+    if (nullptr == evnt.order_) [[unlikely]]
+    {
+        throw std::runtime_error("ShardedInQueues::tryPush(OrderEvent): order pointer is null!");
+    }
+    return shards_[shardOf(evnt.order_->instrument_.getId())]->tryPush(source, evnt);
+}
+
+bool ShardedInQueues::tryPush(const std::string &source, const OrderCancelEvent &evnt)
+{
+    return shards_[shardOfOrder(evnt.id_)]->tryPush(source, evnt);
+}
+
+bool ShardedInQueues::tryPush(const std::string &source, const OrderReplaceEvent &evnt)
+{
+    return shards_[shardOfOrder(evnt.id_)]->tryPush(source, evnt);
+}
+
+bool ShardedInQueues::tryPush(const std::string &source, const OrderChangeStateEvent &evnt)
+{
+    return shards_[shardOfOrder(evnt.id_)]->tryPush(source, evnt);
+}
@@ -0,0 +1,83 @@
+/**
+ Concurrent Order Processor library
+
+ Author: Sergey Mikhailik
+
+ Copyright (C) 2009-2026 Sergey Mikhailik
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include "QueuesDef.h"
+#include "IncomingQueues.h"
+
+namespace COP
+{
+
+namespace Store
+{
+class OrderDataStorage;
+}
+
+namespace Queues
+{
+
+/// Routes incoming events to per-instrument shards.
+/// Every instrument is hashed to exactly one shard, so all events of an instrument
+/// land in the same IncomingQueues and are processed in arrival order by the
+/// shard owning it. Events that refer to an existing order are routed by the
+/// instrument of that order; events for an unknown order go to the first shard,
+/// where the processor rejects them as in the unsharded mode.
+class ShardedInQueues : public InQueues
+{
+public:
+    ShardedInQueues(size_t shardCount, Store::OrderDataStorage *orderStorage);
+    ~ShardedInQueues(void);
+
+    size_t shardCount() const
+    {
+        return shards_.size();
+    }
+    IncomingQueues *shard(size_t idx) const
+    {
+        return shards_.at(idx).get();
+    }
+    size_t shardOf(const SourceIdT &instrument) const;
+
+    /// total amount of events in all shards
+    u32 size() const;
+
+public:
+    /// reimplemented from InQueues
+    virtual void push(const std::string &source, const OrderEvent &evnt);
+    virtual void push(const std::string &source, const OrderCancelEvent &evnt);
+    virtual void push(const std::string &source, const OrderReplaceEvent &evnt);
+    virtual void push(const std::string &source, const OrderChangeStateEvent &evnt);
+    virtual void push(const std::string &source, const ProcessEvent &evnt);
+    virtual void push(const std::string &source, const TimerEvent &evnt);
+    virtual bool tryPush(const std::string &source, const OrderEvent &evnt);
+    virtual bool tryPush(const std::string &source, const OrderCancelEvent &evnt);
+    virtual bool tryPush(const std::string &source, const OrderReplaceEvent &evnt);
+    virtual bool tryPush(const std::string &source, const OrderChangeStateEvent &evnt);
+    /// true if any shard is full, the shard of the next event is not known yet
+    virtual bool full() const;
+
+private:
+    size_t shardOfOrder(const IdT &orderId) const;
+
+private:
+    typedef std::vector<std::unique_ptr<IncomingQueues>> ShardsT;
+    ShardsT shards_;
+
+    Store::OrderDataStorage *orderStorage_;
+};
+
+} // namespace Queues
+} // namespace COP
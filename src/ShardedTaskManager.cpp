@@ -0,0 +1,312 @@
+/**
+ Concurrent Order Processor library
+
+ Author: Sergey Mikhailik
+
+ Copyright (C) 2009-2026 Sergey Mikhailik
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#include <cassert>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+
+#include "Logger.h"
+#include "ExchUtils.h"
+#include "ShardedTaskManager.h"
+#include "TransactionMgr.h"
+#include "Processor.h"
+#include "CacheAlignedAtomic.h"
+#include "CpuAffinity.h"
+
+using namespace std;
+using namespace COP;
+using namespace COP::ACID;
+using namespace COP::Tasks;
+using namespace COP::Queues;
+
+/// Incoming queue, book slice, transaction manager and processor served by one thread.
+class ShardedTaskManager::Shard : public InQueuesObserver
+{
+public:
+    Shard(IncomingQueues *queue, const ShardedTaskManagerParams &params, const OrderBookImpl::InstrumentsT &instr)
+        : queue_(queue), signaled_(false), stopped_(false), busy_(false), eventsProcessed_(0),
+          transactionsProcessed_(0)
+    {
+        assert(nullptr != queue_);
+        orderBook_.init(instr, params.orderSaver_, params.bookType_);
+        transactMgr_.init(TransactionMgrParams(params.generator_));
+        transactIt_ = transactMgr_.iterator();
+        processor_.init(Proc::ProcessorParams(params.generator_, params.orderStorage_, &orderBook_, params.inQueues_,
+                                              params.outQueues_, queue_, &transactMgr_));
+    }
+
+    ~Shard()
+    {
+        stop();
+        transactMgr_.stop();
+    }
+
+    void start(int core)
+    {
+        queue_->attach(this);
+        thread_ = std::thread([this, core]() { run(core); });
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            stopped_ = true;
+        }
+        wakeUp_.notify_one();
+        if (thread_.joinable())
+        {
+            thread_.join();
+        }
+        queue_->detach();
+    }
+
+    bool idle() const
+    {
+        return (0 == queue_->size()) && !busy_.load();
+    }
+
+    OrderBookImpl *orderBook()
+    {
+        return &orderBook_;
+    }
+    int eventsProcessed() const noexcept
+    {
+        return eventsProcessed_.load(std::memory_order_relaxed);
+    }
+    int transactionsProcessed() const noexcept
+    {
+        return transactionsProcessed_.load(std::memory_order_relaxed);
+    }
+
+public:
+    /// reimplemented from InQueuesObserver
+    virtual void onNewEvent()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            signaled_ = true;
+        }
+        wakeUp_.notify_one();
+    }
+
+private:
+    void run(int core)
+    {
+        if (0 <= core)
+        {
+            CpuAffinity::pinThreadToCore(core % CpuAffinity::getAvailableCores());
+        }
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> guard(lock_);
+                wakeUp_.wait(guard, [this]() { return signaled_ || stopped_; });
+                if (stopped_)
+                {
+                    return;
+                }
+                signaled_ = false;
+            }
+            busy_.store(true);
+            while (processEvent())
+            {
+                executeTransactions();
+            }
+            busy_.store(false);
+        }
+    }
+
+    bool processEvent()
+    {
+        try
+        {
+            if (!processor_.process())
+            {
+                return false;
+            }
+        }
+        catch (const std::exception &ex)
+        {
+            aux::ExchLogger::instance()->error(string("ShardedTaskManager: event processing failed: ") + ex.what());
+        }
+        eventsProcessed_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// executes transactions produced by the event, including the ones unblocked by them.
+    /// Everything ready at once is independent, it is executed and removed as one group.
+    void executeTransactions()
+    {
+        for (;;)
+        {
+            batch_.clear();
+            if (0 == transactIt_->nextBatch(batch_.max_size(), &batch_))
+            {
+                return;
+            }
+            for (TransactionBatchT::const_iterator it = batch_.begin(); it != batch_.end(); ++it)
+            {
+                assert(nullptr != it->tr_);
+                try
+                {
+                    processor_.process(it->id_, it->tr_);
+                }
+                catch (const std::exception &ex)
+                {
+                    aux::ExchLogger::instance()->error(string("ShardedTaskManager: transaction execution failed: ") +
+                                                       ex.what());
+                }
+            }
+            transactMgr_.removeTransactions(batch_);
+            transactionsProcessed_.fetch_add(static_cast<int>(batch_.size()), std::memory_order_relaxed);
+        }
+    }
+
+private:
+    IncomingQueues *queue_;
+    OrderBookImpl orderBook_;
+    TransactionMgr transactMgr_;
+    TransactionIterator *transactIt_;
+    Proc::Processor processor_;
+    TransactionBatchT batch_;
+
+    std::mutex lock_;
+    std::condition_variable wakeUp_;
+    bool signaled_;
+    bool stopped_;
+    std::atomic<bool> busy_;
+
+    CacheAlignedAtomic<int> eventsProcessed_;
+    CacheAlignedAtomic<int> transactionsProcessed_;
+
+    std::thread thread_;
+};
+
+ShardedTaskManager::ShardedTaskManager(const ShardedTaskManagerParams &params) : inQueues_(params.inQueues_)
+{
+    assert(nullptr != params.generator_);
+    assert(nullptr != params.orderStorage_);
+    assert(nullptr != params.outQueues_);
+    assert(nullptr != params.orderSaver_);
+    if (nullptr == inQueues_)
+    {
+        throw std::runtime_error("ShardedTaskManager: sharded incoming queues are not assigned!");
+    }
+
+    const size_t count = inQueues_->shardCount();
+    std::vector<OrderBookImpl::InstrumentsT> slices(count);
+    for (OrderBookImpl::InstrumentsT::const_iterator it = params.instruments_.begin();
+         it != params.instruments_.end(); ++it)
+    {
+        slices[inQueues_->shardOf(*it)].insert(*it);
+    }
+
+    shards_.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        shards_.push_back(std::make_unique<Shard>(inQueues_->shard(i), params, slices[i]));
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        shards_[i]->start((0 <= params.cpuAffinityStart_) ? params.cpuAffinityStart_ + 1 + static_cast<int>(i) : -1);
+    }
+
+    aux::ExchLogger::instance()->note("ShardedTaskManager created.");
+}
+
+ShardedTaskManager::~ShardedTaskManager(void)
+{
+    stop();
+    shards_.clear();
+    aux::ExchLogger::instance()->note("ShardedTaskManager destroyed.");
+}
+
+void ShardedTaskManager::stop()
+{
+    for (ShardsT::iterator it = shards_.begin(); it != shards_.end(); ++it)
+    {
+        (*it)->stop();
+    }
+}
+
+bool ShardedTaskManager::idle() const
+{
+    for (ShardsT::const_iterator it = shards_.begin(); it != shards_.end(); ++it)
+    {
+        if (!(*it)->idle())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ShardedTaskManager::waitUntilTransactionsFinished(int waitIntervalSeconds) const
+{
+    // shards poll for idle state every 10 milliseconds
+    const int pollsPerSecond = 100;
+    int interval = waitIntervalSeconds * pollsPerSecond;
+    bool onceSucceed = false;
+    do
+    {
+        bool finished = idle();
+        if (finished && !onceSucceed && (0 != waitIntervalSeconds))
+        {
+            finished = false;
+            onceSucceed = true;
+        }
+        if ((finished) || (0 == waitIntervalSeconds))
+        {
+            return finished;
+        }
+        aux::WaitInterval(1000 / pollsPerSecond);
+        if (-1 != waitIntervalSeconds)
+        {
+            --interval;
+        }
+    } while (0 <= interval);
+    return false;
+}
+
+OrderBookImpl *ShardedTaskManager::orderBook(const SourceIdT &instrument) const
+{
+    return shards_[inQueues_->shardOf(instrument)]->orderBook();
+}
+
+OrderBookImpl *ShardedTaskManager::shardOrderBook(size_t idx) const
+{
+    return shards_.at(idx)->orderBook();
+}
+
+int ShardedTaskManager::eventsProcessed() const noexcept
+{
+    int total = 0;
+    for (ShardsT::const_iterator it = shards_.begin(); it != shards_.end(); ++it)
+    {
+        total += (*it)->eventsProcessed();
+    }
+    return total;
+}
+
+int ShardedTaskManager::transactionsProcessed() const noexcept
+{
+    int total = 0;
+    for (ShardsT::const_iterator it = shards_.begin(); it != shards_.end(); ++it)
+    {
+        total += (*it)->transactionsProcessed();
+    }
+    return total;
+}
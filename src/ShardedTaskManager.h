@@ -0,0 +1,101 @@
+/**
+ Concurrent Order Processor library
+
+ Author: Sergey Mikhailik
+
+ Copyright (C) 2009-2026 Sergey Mikhailik
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include "OrderBookImpl.h"
+#include "ShardedQueues.h"
+
+namespace COP
+{
+
+class IdTValueGenerator;
+
+namespace Store
+{
+class OrderDataStorage;
+}
+
+namespace Tasks
+{
+
+struct ShardedTaskManagerParams
+{
+    IdTValueGenerator *generator_;
+    Store::OrderDataStorage *orderStorage_;
+    Queues::OutQueues *outQueues_;
+    /// router owning the per-shard incoming queues, should outlive the manager
+    Queues::ShardedInQueues *inQueues_;
+
+    /// instruments distributed between the book slices of the shards
+    OrderBookImpl::InstrumentsT instruments_;
+    OrderSaver *orderSaver_;
+    OrderBookImpl::BookType bookType_;
+
+    /// shard i is pinned to core cpuAffinityStart_ + 1 + i, -1 disables pinning
+    int cpuAffinityStart_ = -1;
+
+    ShardedTaskManagerParams()
+        : generator_(nullptr), orderStorage_(nullptr), outQueues_(nullptr), inQueues_(nullptr), instruments_(),
+          orderSaver_(nullptr), bookType_(OrderBookImpl::MULTIMAP_BOOKTYPE)
+    {
+    }
+};
+
+/// Optional processing mode with single-writer order books.
+/// Each shard owns an incoming queue, a Processor, a transaction manager and the
+/// book slice with its instruments, and runs them on one dedicated thread: the
+/// thread pops an event, then executes the transactions it produced before the
+/// next event. Events of an instrument are therefore handled by exactly one core
+/// and the book locks are never contended.
+/// Library-only, the server in app/ runs TaskManager and a single OrderBookImpl.
+class ShardedTaskManager
+{
+public:
+    explicit ShardedTaskManager(const ShardedTaskManagerParams &params);
+    ~ShardedTaskManager(void);
+
+    /// stops shard threads, events left in the queues are not processed
+    void stop();
+
+    /// method waits until all incoming events and transactions finished processing
+    /// returns false, if events and transactions not finished during waitIntervalSeconds
+    /// waitIntervalSeconds = -1, means infinite
+    bool waitUntilTransactionsFinished(int waitIntervalSeconds) const;
+
+    size_t shardCount() const
+    {
+        return shards_.size();
+    }
+    /// book slice of the shard owning instrument
+    OrderBookImpl *orderBook(const SourceIdT &instrument) const;
+    OrderBookImpl *shardOrderBook(size_t idx) const;
+
+    int eventsProcessed() const noexcept;
+    int transactionsProcessed() const noexcept;
+
+private:
+    class Shard;
+    typedef std::vector<std::unique_ptr<Shard>> ShardsT;
+
+    bool idle() const;
+
+private:
+    Queues::ShardedInQueues *inQueues_;
+    ShardsT shards_;
+};
+
+} // namespace Tasks
+} // namespace COP
@@ -15,6 +15,7 @@
 
 #include <cassert>
 #include <memory>
+#include <utility>
 
 namespace aux
 {
@@ -23,14 +24,14 @@ template <typename T> struct Singleton
 {
     static std::unique_ptr<T> instance_;
 
-    static void create()
+    template <typename... Args> static void create(Args &&...args)
     {
         assert(!instance_);
         if (instance_) [[unlikely]]
         {
             throw std::runtime_error("Singleton initialised twice!");
         }
-        instance_ = std::make_unique<T>();
+        instance_ = std::make_unique<T>(std::forward<Args>(args)...);
     }
     static void destroy() noexcept
     {
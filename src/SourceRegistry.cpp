@@ -0,0 +1,91 @@
+/**
+ Concurrent Order Processor library
+
+ Author: Sergey Mikhailik
+
+ Copyright (C) 2009-2026 Sergey Mikhailik
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#include <stdexcept>
+#include <functional>
+#include <algorithm>
+
+#include "SourceRegistry.h"
+
+using namespace std;
+using namespace COP;
+using namespace COP::Queues;
+
+SourceRegistry *SourceRegistry::instance()
+{
+    static SourceRegistry registry;
+    return &registry;
+}
+
+SourceRegistry::SourceRegistry() : chunks_(), size_(0) {}
+
+SourceRegistry::~SourceRegistry()
+{
+    for (std::atomic<std::string *> &chunk : chunks_)
+    {
+        delete[] chunk.load(std::memory_order_relaxed);
+    }
+}
+
+SourceHandle SourceRegistry::intern(const std::string &name)
+{
+    // names handed out by the registry are recognized by address
+    const size_t count = size_.load(std::memory_order_acquire);
+    std::less<const std::string *> before;
+    for (size_t base = 0; base < count; base += SOURCES_PER_CHUNK)
+    {
+        const std::string *first = chunks_[base / SOURCES_PER_CHUNK].load(std::memory_order_relaxed);
+        if (!before(&name, first) && before(&name, first + std::min<size_t>(count - base, SOURCES_PER_CHUNK)))
+        {
+            return static_cast<SourceHandle>(base + (&name - first));
+        }
+    }
+
+    {
+        oneapi::tbb::spin_rw_mutex::scoped_lock lock(lock_, false);
+        HandlesT::const_iterator it = handles_.find(name);
+        if (handles_.end() != it) [[likely]]
+        {
+            return it->second;
+        }
+    }
+
+    oneapi::tbb::spin_rw_mutex::scoped_lock lock(lock_, true);
+    HandlesT::const_iterator it = handles_.find(name);
+    if (handles_.end() != it)
+    {
+        return it->second;
+    }
+    const size_t idx = size_.load(std::memory_order_relaxed);
+    if (MAX_SOURCES <= idx) [[unlikely]]
+    {
+        throw std::runtime_error("SourceRegistry: too many event sources registered!");
+    }
+    std::atomic<std::string *> &chunk = chunks_[idx / SOURCES_PER_CHUNK];
+    if (0 == idx % SOURCES_PER_CHUNK)
+    {
+        chunk.store(new std::string[SOURCES_PER_CHUNK], std::memory_order_relaxed);
+    }
+    chunk.load(std::memory_order_relaxed)[idx % SOURCES_PER_CHUNK] = name;
+    handles_.emplace(name, static_cast<SourceHandle>(idx));
+    size_.store(idx + 1, std::memory_order_release);
+    return static_cast<SourceHandle>(idx);
+}
+
+const std::string &SourceRegistry::name(SourceHandle handle) const
+{
+    if (size_.load(std::memory_order_acquire) <= handle) [[unlikely]]
+    {
+        throw std::runtime_error("SourceRegistry: unknown source handle!");
+    }
+    return chunks_[handle / SOURCES_PER_CHUNK].load(std::memory_order_relaxed)[handle % SOURCES_PER_CHUNK];
+}
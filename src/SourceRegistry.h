@@ -0,0 +1,77 @@
+/**
+ Concurrent Order Processor library
+
+ Author: Sergey Mikhailik
+
+ Copyright (C) 2009-2026 Sergey Mikhailik
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#pragma once
+
+#include <string>
+#include <array>
+#include <atomic>
+#include <unordered_map>
+#include <oneapi/tbb/spin_rw_mutex.h>
+
+#include "TypesDef.h"
+
+namespace COP
+{
+namespace Queues
+{
+
+/// Process-wide table of event source/target names.
+/// Queues keep a SourceHandle per event instead of a std::string copy. A name is
+/// interned once and never removed, so the string returned by name() stays valid
+/// for the process lifetime. Passing that string back to intern() resolves the
+/// handle from its address without hashing.
+/// The table grows by chunks of SOURCES_PER_CHUNK names, intern() throws once
+/// MAX_SOURCES names are registered.
+class SourceRegistry
+{
+public:
+    enum
+    {
+        SOURCES_PER_CHUNK = 1024,
+        MAX_CHUNKS = 4096,
+        MAX_SOURCES = SOURCES_PER_CHUNK * MAX_CHUNKS
+    };
+
+public:
+    static SourceRegistry *instance();
+
+    /// returns handle of the name, registers it on first use
+    SourceHandle intern(const std::string &name);
+    /// throws if handle was not issued by intern()
+    const std::string &name(SourceHandle handle) const;
+
+    size_t size() const
+    {
+        return size_.load(std::memory_order_acquire);
+    }
+
+private:
+    SourceRegistry();
+    ~SourceRegistry();
+
+    SourceRegistry(const SourceRegistry &) = delete;
+    SourceRegistry &operator=(const SourceRegistry &) = delete;
+
+private:
+    typedef std::unordered_map<std::string, SourceHandle> HandlesT;
+
+    mutable oneapi::tbb::spin_rw_mutex lock_;
+    HandlesT handles_;
+
+    /// names are never moved, handle is the index; a chunk is published before size_ covers it
+    std::array<std::atomic<std::string *>, MAX_CHUNKS> chunks_;
+    std::atomic<size_t> size_;
+};
+
+} // namespace Queues
+} // namespace COP
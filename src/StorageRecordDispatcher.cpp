@@ -10,6 +10,7 @@
  See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
 */
 
+#include <cassert>
 #include <cstring>
 #include <stdexcept>
 #include "StorageRecordDispatcher.h"
@@ -20,6 +21,7 @@
 #include "ClearingCodec.h"
 #include "RawDataCodec.h"
 #include "OrderCodec.h"
+#include "ExecutionCodec.h"
 #include "OrderStorage.h"
 
 #ifdef BUILD_PG
@@ -34,7 +36,30 @@ using namespace COP::Store;
 namespace
 {
 const int MINIMAL_SIZE = 4;
-}
+
+/// writes <type><OrderRecord> into the value reserved by the storage
+class OrderRecordEncoder : public RecordEncoder
+{
+public:
+    static const size_t SIZE = sizeof(int) + Codec::OrderCodec::RECORD_SIZE;
+
+    explicit OrderRecordEncoder(const OrderEntry &val) : val_(val) {}
+
+    void encode(char *buf, size_t size) const override
+    {
+        assert(SIZE == size);
+        const int t = StorageRecordDispatcher::ORDER_RECORDTYPE;
+        memcpy(buf, &t, sizeof(t));
+        IdT id;
+        u32 version;
+        Codec::OrderCodec::encode(val_, buf + sizeof(t), &id, &version);
+    }
+
+private:
+    const OrderEntry &val_;
+};
+
+} // namespace
 
 StorageRecordDispatcher::StorageRecordDispatcher(void)
     : storage_(nullptr), orderBook_(nullptr), fileStorage_(nullptr), orderStorage_(nullptr)
@@ -113,16 +138,26 @@ void StorageRecordDispatcher::onRecordLoaded(const IdT &id, u32 version, const c
     }
     break;
     case EXECUTION_RECORDTYPE:
-        break;
+    {
+        std::unique_ptr<ExecutionEntry> exec(
+            Codec::ExecutionCodec::decode(id, version, buf + sizeof(type), size - sizeof(type)));
+        orderStorage_->restore(exec.get());
+        exec.release();
+    }
+    break;
     case EXECUTIONS_RECORDTYPE:
         break;
     case ORDER_RECORDTYPE:
     {
         std::unique_ptr<OrderEntry> order(
             Codec::OrderCodec::decode(id, version, buf + sizeof(type), size - sizeof(type)));
-        orderBook_->restore(*order.get());
-        orderStorage_->restore(order.get());
+        /// storage copies the order into its slab, the book keeps a pointer to the stored entry
+        OrderEntry *restored = orderStorage_->restore(order.get());
         order.release();
+        if (OrderBook::isResting(*restored))
+        {
+            orderBook_->restore(*restored);
+        }
     }
     break;
     default:
@@ -242,19 +277,25 @@ void StorageRecordDispatcher::save(const ExecutionsT &val)
     fileStorage_->save(id, buffer.c_str(), buffer.size());
 }
 
-void StorageRecordDispatcher::save(const OrderEntry &val)
+void StorageRecordDispatcher::save(const ExecutionEntry &val)
 {
     string buffer;
     {
         char typebuf[36];
-        int t = StorageRecordDispatcher::ORDER_RECORDTYPE;
+        int t = StorageRecordDispatcher::EXECUTION_RECORDTYPE;
         memcpy(typebuf, &t, sizeof(t));
         buffer.append(typebuf, sizeof(t));
     }
     IdT id;
     u32 version;
-    Codec::OrderCodec::encode(val, &buffer, &id, &version);
+    Codec::ExecutionCodec::encode(val, &buffer, &id, &version);
     fileStorage_->save(id, buffer.c_str(), buffer.size());
+}
+
+void StorageRecordDispatcher::save(const OrderEntry &val)
+{
+    OrderRecordEncoder encoder(val);
+    fileStorage_->saveReserved(val.orderId_, OrderRecordEncoder::SIZE, encoder);
 #ifdef BUILD_PG
     if (pgWriter_)
     {
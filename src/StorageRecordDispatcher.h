@@ -63,6 +63,7 @@ public:
 public:
     /// reimplemented from OrderSaver
     virtual void save(const OrderEntry &val);
+    virtual void save(const ExecutionEntry &val);
 
 #ifdef BUILD_PG
 public:
@@ -0,0 +1,387 @@
+/**
+ Concurrent Order Processor library
+
+ Author: Sergey Mikhailik
+
+ Copyright (C) 2009-2026 Sergey Mikhailik
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#include <cassert>
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/parallel_invoke.h>
+
+#include "StorageRecovery.h"
+
+#include "InstrumentCodec.h"
+#include "StringTCodec.h"
+#include "AccountCodec.h"
+#include "ClearingCodec.h"
+#include "RawDataCodec.h"
+#include "OrderCodec.h"
+#include "ExecutionCodec.h"
+#include "OrderStorage.h"
+#include "Logger.h"
+
+using namespace std;
+using namespace COP;
+using namespace COP::Store;
+
+namespace
+{
+const int MINIMAL_SIZE = 4;
+/// records decoded by one task at least
+const size_t DECODE_GRAIN = 256;
+
+/// decodes records [0, count) in parallel, result keeps the record order
+template <typename T, typename Decode> void decodeParallel(size_t count, vector<unique_ptr<T>> *result, Decode decode)
+{
+    result->resize(count);
+    oneapi::tbb::parallel_for(oneapi::tbb::blocked_range<size_t>(0, count, DECODE_GRAIN),
+                              [&](const oneapi::tbb::blocked_range<size_t> &r)
+                              {
+                                  for (size_t i = r.begin(); i != r.end(); ++i)
+                                  {
+                                      (*result)[i] = decode(i);
+                                  }
+                              });
+}
+
+} // namespace
+
+StorageRecovery::StorageRecovery(DataStorageRestore *storage, OrderDataStorage *orderStorage)
+    : storage_(storage), orderStorage_(orderStorage)
+{
+    assert(nullptr != storage_);
+    assert(nullptr != orderStorage_);
+    memset(counts_, 0, sizeof(counts_));
+}
+
+StorageRecovery::~StorageRecovery(void) {}
+
+void StorageRecovery::clear()
+{
+    for (Partition &part : partitions_)
+    {
+        vector<RecordRef>().swap(part.records_);
+        vector<char>().swap(part.data_);
+    }
+}
+
+void StorageRecovery::startLoad()
+{
+    clear();
+    orders_.clear();
+    executions_.clear();
+    memset(counts_, 0, sizeof(counts_));
+}
+
+void StorageRecovery::onRecordLoaded(const IdT &id, u32 version, const char *buf, size_t size)
+{
+    assert(nullptr != buf);
+
+    if (MINIMAL_SIZE > size)
+    {
+        throw std::runtime_error("Record size invalid, record could not be restored!");
+    }
+
+    StorageRecordDispatcher::RecordType type;
+    memcpy(&type, buf, sizeof(type));
+    if ((StorageRecordDispatcher::INVALID_RECORDTYPE >= type) || (StorageRecordDispatcher::TOTAL_RECORDTYPE <= type))
+    {
+        throw std::runtime_error("Invalid record type, unable to decode record!");
+    }
+    ++counts_[type];
+    if (StorageRecordDispatcher::EXECUTIONS_RECORDTYPE == type)
+    {
+        // not restored, as by StorageRecordDispatcher
+        return;
+    }
+
+    // the buffer is valid during the callback only
+    Partition &part = partitions_[type];
+    RecordRef rec;
+    rec.id_ = id;
+    rec.version_ = version;
+    rec.offset_ = part.data_.size();
+    rec.size_ = size - sizeof(type);
+    part.data_.insert(part.data_.end(), buf + sizeof(type), buf + size);
+    part.records_.push_back(rec);
+}
+
+void StorageRecovery::dropSuperseded(Partition *part)
+{
+    vector<RecordRef> &records = part->records_;
+    bool sorted = true;
+    bool unique = true;
+    for (size_t i = 1; i < records.size(); ++i)
+    {
+        sorted = sorted && !(records[i].id_ < records[i - 1].id_);
+        unique = unique && !(records[i].id_ == records[i - 1].id_);
+    }
+    if (sorted && unique)
+    {
+        return;
+    }
+    vector<bool> keep(records.size(), true);
+    if (sorted)
+    {
+        // full scan passes the versions of a record one after another
+        for (size_t i = 1; i < records.size(); ++i)
+        {
+            if (records[i].id_ == records[i - 1].id_)
+            {
+                keep[i - 1] = false;
+            }
+        }
+    }
+    else
+    {
+        vector<size_t> byId(records.size());
+        iota(byId.begin(), byId.end(), 0);
+        stable_sort(byId.begin(), byId.end(),
+                    [&records](size_t lft, size_t rght) { return records[lft].id_ < records[rght].id_; });
+        for (size_t i = 1; i < byId.size(); ++i)
+        {
+            if (records[byId[i]].id_ == records[byId[i - 1]].id_)
+            {
+                keep[byId[i - 1]] = false;
+            }
+        }
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        if (keep[i])
+        {
+            records[kept++] = records[i];
+        }
+    }
+    records.resize(kept);
+}
+
+void StorageRecovery::finishLoad()
+{
+    for (Partition &part : partitions_)
+    {
+        dropSuperseded(&part);
+    }
+
+    const Partition &instrPart = partitions_[StorageRecordDispatcher::INSTRUMENT_RECORDTYPE];
+    const Partition &strPart = partitions_[StorageRecordDispatcher::STRING_RECORDTYPE];
+    const Partition &acctPart = partitions_[StorageRecordDispatcher::ACCOUNT_RECORDTYPE];
+    const Partition &clrPart = partitions_[StorageRecordDispatcher::CLEARING_RECORDTYPE];
+    const Partition &rawPart = partitions_[StorageRecordDispatcher::RAWDATA_RECORDTYPE];
+    const Partition &orderPart = partitions_[StorageRecordDispatcher::ORDER_RECORDTYPE];
+    const Partition &execPart = partitions_[StorageRecordDispatcher::EXECUTION_RECORDTYPE];
+
+    vector<unique_ptr<InstrumentEntry>> instruments;
+    vector<unique_ptr<StringT>> strings;
+    vector<unique_ptr<AccountEntry>> accounts;
+    vector<unique_ptr<ClearingEntry>> clearings;
+    vector<unique_ptr<RawDataEntry>> rawDatas;
+
+    // codecs do not touch the storages, so every partition is decoded at once
+    oneapi::tbb::parallel_invoke(
+        [&]()
+        {
+            decodeParallel(instrPart.records_.size(), &instruments,
+                           [&](size_t i)
+                           {
+                               const RecordRef &rec = instrPart.records_[i];
+                               unique_ptr<InstrumentEntry> val(new InstrumentEntry());
+                               Codec::InstrumentCodec::decode(rec.id_, rec.version_, instrPart.body(rec), rec.size_,
+                                                              val.get());
+                               return val;
+                           });
+        },
+        [&]()
+        {
+            decodeParallel(strPart.records_.size(), &strings,
+                           [&](size_t i)
+                           {
+                               const RecordRef &rec = strPart.records_[i];
+                               unique_ptr<StringT> val(new StringT());
+                               Codec::StringTCodec::decode(strPart.body(rec), rec.size_, val.get());
+                               return val;
+                           });
+        },
+        [&]()
+        {
+            decodeParallel(acctPart.records_.size(), &accounts,
+                           [&](size_t i)
+                           {
+                               const RecordRef &rec = acctPart.records_[i];
+                               unique_ptr<AccountEntry> val(new AccountEntry());
+                               Codec::AccountCodec::decode(rec.id_, rec.version_, acctPart.body(rec), rec.size_,
+                                                           val.get());
+                               return val;
+                           });
+        },
+        [&]()
+        {
+            decodeParallel(clrPart.records_.size(), &clearings,
+                           [&](size_t i)
+                           {
+                               const RecordRef &rec = clrPart.records_[i];
+                               unique_ptr<ClearingEntry> val(new ClearingEntry());
+                               Codec::ClearingCodec::decode(rec.id_, rec.version_, clrPart.body(rec), rec.size_,
+                                                            val.get());
+                               return val;
+                           });
+        },
+        [&]()
+        {
+            decodeParallel(rawPart.records_.size(), &rawDatas,
+                           [&](size_t i)
+                           {
+                               const RecordRef &rec = rawPart.records_[i];
+                               unique_ptr<RawDataEntry> val(new RawDataEntry());
+                               Codec::RawDataCodec::decode(rec.id_, rec.version_, rawPart.body(rec), rec.size_,
+                                                           val.get());
+                               return val;
+                           });
+        },
+        [&]()
+        {
+            decodeParallel(orderPart.records_.size(), &orders_,
+                           [&](size_t i)
+                           {
+                               const RecordRef &rec = orderPart.records_[i];
+                               return unique_ptr<OrderEntry>(
+                                   Codec::OrderCodec::decode(rec.id_, rec.version_, orderPart.body(rec), rec.size_));
+                           });
+        },
+        [&]()
+        {
+            decodeParallel(execPart.records_.size(), &executions_,
+                           [&](size_t i)
+                           {
+                               const RecordRef &rec = execPart.records_[i];
+                               return unique_ptr<ExecutionEntry>(Codec::ExecutionCodec::decode(
+                                   rec.id_, rec.version_, execPart.body(rec), rec.size_));
+                           });
+        });
+
+    // reference data is restored in the load order, storage takes ownership
+    storage_->startRestore();
+    for (auto &val : instruments)
+    {
+        storage_->restore(val.get());
+        val.release();
+    }
+    for (size_t i = 0; i < strings.size(); ++i)
+    {
+        storage_->restore(strPart.records_[i].id_, strings[i].get());
+        strings[i].release();
+    }
+    for (auto &val : accounts)
+    {
+        storage_->restore(val.get());
+        val.release();
+    }
+    for (auto &val : clearings)
+    {
+        storage_->restore(val.get());
+        val.release();
+    }
+    for (auto &val : rawDatas)
+    {
+        storage_->restore(val.get());
+        val.release();
+    }
+    storage_->finishRestore();
+    clear();
+
+    if (aux::ExchLogger::instance()->isNoteOn())
+    {
+        aux::ExchLogger::instance()->note(
+            "StorageRecovery restored reference data, instruments: " + to_string(instruments.size()) +
+            ", accounts: " + to_string(accounts.size()) + ", orders decoded: " + to_string(orders_.size()) +
+            ", executions decoded: " + to_string(executions_.size()));
+    }
+}
+
+void StorageRecovery::restoreOrders(OrderBook *orderBook)
+{
+    restoreExecutions();
+    if (orders_.empty())
+    {
+        return;
+    }
+    vector<OrderEntry *> batch;
+    batch.reserve(orders_.size());
+    for (const auto &order : orders_)
+    {
+        batch.push_back(order.get());
+    }
+    orderStorage_->restore(&batch);
+    // storage deleted the decoded orders, batch points to the stored ones
+    for (auto &order : orders_)
+    {
+        order.release();
+    }
+    orders_.clear();
+
+    if (nullptr == orderBook)
+    {
+        return;
+    }
+    // book locks each instrument separately, one task per instrument does not contend
+    typedef map<SourceIdT, vector<const OrderEntry *>> OrdersByInstrumentT;
+    OrdersByInstrumentT byInstrument;
+    for (const OrderEntry *order : batch)
+    {
+        if (OrderBook::isResting(*order))
+        {
+            byInstrument[order->instrument_.getId()].push_back(order);
+        }
+    }
+    vector<const vector<const OrderEntry *> *> groups;
+    groups.reserve(byInstrument.size());
+    for (const auto &grp : byInstrument)
+    {
+        groups.push_back(&grp.second);
+    }
+    oneapi::tbb::parallel_for(oneapi::tbb::blocked_range<size_t>(0, groups.size()),
+                              [&](const oneapi::tbb::blocked_range<size_t> &r)
+                              {
+                                  for (size_t i = r.begin(); i != r.end(); ++i)
+                                  {
+                                      for (const OrderEntry *order : *groups[i])
+                                      {
+                                          orderBook->restore(*order);
+                                      }
+                                  }
+                              });
+}
+
+void StorageRecovery::restoreExecutions()
+{
+    // executions do not refer to the book, storage takes them one by one
+    for (auto &exec : executions_)
+    {
+        orderStorage_->restore(exec.get());
+        exec.release();
+    }
+    executions_.clear();
+}
+
+size_t StorageRecovery::recordCount(StorageRecordDispatcher::RecordType type) const
+{
+    if ((StorageRecordDispatcher::INVALID_RECORDTYPE >= type) || (StorageRecordDispatcher::TOTAL_RECORDTYPE <= type))
+    {
+        return 0;
+    }
+    return counts_[type];
+}
@@ -0,0 +1,113 @@
+/**
+ Concurrent Order Processor library
+
+ Author: Sergey Mikhailik
+
+ Copyright (C) 2009-2026 Sergey Mikhailik
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "FileStorageDef.h"
+#include "DataModelDef.h"
+#include "StorageRecordDispatcher.h"
+
+namespace COP
+{
+
+class OrderBook;
+
+namespace Store
+{
+
+class OrderDataStorage;
+
+/// Restores the storage content with one scan of the records.
+/// Records could be passed by several loads, e.g. a snapshot followed by the journal replay,
+/// the record passed last wins for an id.
+/// onRecordLoaded() only copies the record into the partition of its RecordType,
+/// finishLoad() decodes all partitions in parallel and restores the reference data.
+/// Decoded orders and executions are kept until restoreOrders(), because the order book is
+/// initialised from the restored instruments.
+/// buffer format is the one StorageRecordDispatcher writes: <type - 32 bit><body>
+class StorageRecovery : public FileStorageObserver
+{
+public:
+    StorageRecovery(DataStorageRestore *storage, OrderDataStorage *orderStorage);
+    virtual ~StorageRecovery(void);
+
+    /// restores the decoded orders into the order storage and then into the book,
+    /// orders of different instruments are restored into the book concurrently.
+    /// Decoded executions are restored into the order storage as well
+    /// orderBook could be nullptr, then orders are restored into the storage only
+    void restoreOrders(OrderBook *orderBook);
+
+    /// records of the type found by the last load
+    size_t recordCount(StorageRecordDispatcher::RecordType type) const;
+    /// decoded orders waiting for restoreOrders()
+    size_t pendingOrders() const
+    {
+        return orders_.size();
+    }
+    /// decoded executions waiting for restoreOrders()
+    size_t pendingExecutions() const
+    {
+        return executions_.size();
+    }
+
+public:
+    /// reimplemented from FileStorageObserver
+    virtual void startLoad();
+    virtual void onRecordLoaded(const IdT &id, u32 version, const char *buf, size_t size);
+    virtual void finishLoad();
+
+private:
+    struct RecordRef
+    {
+        IdT id_;
+        u32 version_;
+        size_t offset_;
+        size_t size_;
+    };
+
+    /// record bodies of one type share one buffer, type prefix is stripped
+    struct Partition
+    {
+        std::vector<RecordRef> records_;
+        std::vector<char> data_;
+
+        const char *body(const RecordRef &rec) const
+        {
+            return data_.data() + rec.offset_;
+        }
+    };
+
+    void clear();
+    void restoreExecutions();
+    /// keeps the record loaded last for every id: the top version of the record,
+    /// or the record replayed after a snapshot
+    static void dropSuperseded(Partition *part);
+
+    StorageRecovery(const StorageRecovery &) = delete;
+    StorageRecovery &operator=(const StorageRecovery &) = delete;
+
+private:
+    DataStorageRestore *storage_;
+    OrderDataStorage *orderStorage_;
+
+    Partition partitions_[StorageRecordDispatcher::TOTAL_RECORDTYPE];
+    size_t counts_[StorageRecordDispatcher::TOTAL_RECORDTYPE];
+
+    std::vector<std::unique_ptr<OrderEntry>> orders_;
+    std::vector<std::unique_ptr<ExecutionEntry>> executions_;
+};
+
+} // namespace Store
+} // namespace COP
@@ -0,0 +1,419 @@
+/**
+ Concurrent Order Processor library
+
+ Authors: dudleylane, Claude
+
+ Copyright (C) 2026 dudleylane
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <bit>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "StorageSnapshot.h"
+#include "StorageRecordDispatcher.h"
+#include "WideDataStorage.h"
+#include "OrderStorage.h"
+#include "LMDBStorage.h"
+#include "LMDBWriteBehind.h"
+#include "DataModelDef.h"
+#include "Logger.h"
+
+using namespace std;
+using namespace COP;
+using namespace COP::Store;
+
+namespace
+{
+
+static_assert(std::endian::native == std::endian::little, "Snapshot layout is little-endian!");
+
+const char SNAPSHOT_MAGIC[8] = {'C', 'O', 'P', 'S', 'N', 'A', 'P', '\0'};
+const u32 SNAPSHOT_FORMAT_VERSION = 1;
+const size_t RECORD_ALIGNMENT = 8;
+const u64 FNV_OFFSET = 14695981039346656037ULL;
+const u64 FNV_PRIME = 1099511628211ULL;
+
+u64 fnv1a(u64 hash, const char *buf, size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= static_cast<unsigned char>(buf[i]);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+size_t paddedSize(size_t size)
+{
+    return (size + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+}
+
+/// FileSaver appending the records StorageRecordDispatcher encodes to the snapshot file
+class SnapshotFileWriter : public FileSaver
+{
+public:
+    explicit SnapshotFileWriter(FILE *file)
+        : file_(file), scratch_(), recordCount_(0), dataSize_(0), checksum_(FNV_OFFSET)
+    {
+    }
+
+    void load(const std::string & /*path*/, FileStorageObserver * /*observer*/) override
+    {
+        throw std::runtime_error("StorageSnapshot: snapshot writer could not load records!");
+    }
+    IdT save(const char * /*buf*/, size_t /*size*/) override
+    {
+        throw std::runtime_error("StorageSnapshot: record without Id could not be saved!");
+    }
+    void save(const IdT &id, const char *buf, size_t size) override
+    {
+        StorageSnapshot::RecordHeader rec;
+        memset(&rec, 0, sizeof(rec));
+        rec.id_ = id.id_;
+        rec.date_ = id.date_;
+        rec.version_ = 0;
+        rec.size_ = size;
+        put(reinterpret_cast<const char *>(&rec), sizeof(rec));
+        put(buf, size);
+        static const char padding[RECORD_ALIGNMENT] = {};
+        put(padding, paddedSize(size) - size);
+        ++recordCount_;
+    }
+    u32 update(const IdT & /*id*/, const char * /*buf*/, size_t /*size*/) override
+    {
+        throw std::runtime_error("StorageSnapshot: records could not be updated!");
+    }
+    u32 replace(const IdT & /*id*/, u32 /*version*/, const char * /*buf*/, size_t /*size*/) override
+    {
+        throw std::runtime_error("StorageSnapshot: records could not be replaced!");
+    }
+    void erase(const IdT & /*id*/, u32 /*version*/) override
+    {
+        throw std::runtime_error("StorageSnapshot: records could not be erased!");
+    }
+    void erase(const IdT & /*id*/) override
+    {
+        throw std::runtime_error("StorageSnapshot: records could not be erased!");
+    }
+    void saveReserved(const IdT &id, size_t size, const RecordEncoder &encoder) override
+    {
+        scratch_.resize(size);
+        encoder.encode(scratch_.data(), size);
+        save(id, scratch_.data(), size);
+    }
+
+    u64 recordCount() const
+    {
+        return recordCount_;
+    }
+    u64 dataSize() const
+    {
+        return dataSize_;
+    }
+    u64 checksum() const
+    {
+        return checksum_;
+    }
+
+private:
+    void put(const char *buf, size_t size)
+    {
+        if (0 == size)
+        {
+            return;
+        }
+        if (size != fwrite(buf, 1, size, file_))
+        {
+            throw std::runtime_error("StorageSnapshot: fwrite failed - not all bytes written!");
+        }
+        dataSize_ += size;
+        checksum_ = fnv1a(checksum_, buf, size);
+    }
+
+private:
+    FILE *file_;
+    /// orders are encoded here, one at a time
+    std::vector<char> scratch_;
+    u64 recordCount_;
+    u64 dataSize_;
+    u64 checksum_;
+};
+
+/// unmaps the snapshot when the load finishes
+struct MappedSnapshot
+{
+    void *addr_;
+    size_t size_;
+
+    ~MappedSnapshot()
+    {
+        munmap(addr_, size_);
+    }
+};
+
+void syncDirectory(const std::string &path)
+{
+    std::string dir = std::filesystem::path(path).parent_path().string();
+    if (dir.empty())
+    {
+        dir = ".";
+    }
+    const int fd = ::open(dir.c_str(), O_RDONLY);
+    if (0 <= fd)
+    {
+        ::fsync(fd);
+        ::close(fd);
+    }
+}
+
+} // namespace
+
+u64 StorageSnapshot::write(const std::string &path, u64 sequence, const WideParamsDataStorage &dataStorage,
+                           const OrderDataStorage &orderStorage)
+{
+    const std::string tmpPath = path + ".tmp";
+    FILE *f = fopen(tmpPath.c_str(), "wb");
+    if (nullptr == f)
+    {
+        throw std::runtime_error("StorageSnapshot: unable to create snapshot file '" + tmpPath + "'!");
+    }
+    std::unique_ptr<FILE, int (*)(FILE *)> file(f, &fclose);
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic_, SNAPSHOT_MAGIC, sizeof(header.magic_));
+    header.formatVersion_ = SNAPSHOT_FORMAT_VERSION;
+    header.sequence_ = sequence;
+    u64 recordCount = 0;
+    try
+    {
+        if (1 != fwrite(&header, sizeof(header), 1, f))
+        {
+            throw std::runtime_error("StorageSnapshot: fwrite failed - header not written!");
+        }
+
+        SnapshotFileWriter writer(f);
+        StorageRecordDispatcher encoder;
+        encoder.init(nullptr, nullptr, &writer, nullptr);
+
+        dataStorage.forEachInstrument([&](const SourceIdT &, const InstrumentEntry &val) { encoder.save(val); });
+        dataStorage.forEachString([&](const SourceIdT &id, const StringT &val) { encoder.save(id, val); });
+        dataStorage.forEachAccount([&](const SourceIdT &, const AccountEntry &val) { encoder.save(val); });
+        dataStorage.forEachClearing([&](const SourceIdT &, const ClearingEntry &val) { encoder.save(val); });
+        dataStorage.forEachRawData([&](const SourceIdT &, const RawDataEntry &val) { encoder.save(val); });
+
+        // orders and executions are encoded outside the order storage locks, its entries are never removed.
+        // Processing threads change orders in place under the entry lock, so every order is copied under it
+        std::vector<const OrderEntry *> orders;
+        orderStorage.forEachOrder([&](const IdT &, const OrderEntry &order) { orders.push_back(&order); });
+        for (const OrderEntry *order : orders)
+        {
+            std::unique_ptr<OrderEntry> copy;
+            {
+                oneapi::tbb::spin_rw_mutex::scoped_lock lock(order->entryMutex_, false);
+                copy.reset(new OrderEntry(*order));
+            }
+            encoder.save(*copy);
+        }
+        std::vector<const ExecutionEntry *> executions;
+        orderStorage.forEachExecution([&](const IdT &, const ExecutionEntry &exec) { executions.push_back(&exec); });
+        for (const ExecutionEntry *exec : executions)
+        {
+            encoder.save(*exec);
+        }
+
+        header.recordCount_ = writer.recordCount();
+        header.dataSize_ = writer.dataSize();
+        header.checksum_ = writer.checksum();
+        if ((0 != fseek(f, 0, SEEK_SET)) || (1 != fwrite(&header, sizeof(header), 1, f)) || (0 != fflush(f)) ||
+            (0 != fsync(fileno(f))))
+        {
+            throw std::runtime_error("StorageSnapshot: unable to flush snapshot file '" + tmpPath + "'!");
+        }
+        recordCount = header.recordCount_;
+        if (0 != fclose(file.release()))
+        {
+            throw std::runtime_error("StorageSnapshot: unable to close snapshot file '" + tmpPath + "'!");
+        }
+        if (0 != rename(tmpPath.c_str(), path.c_str()))
+        {
+            throw std::runtime_error("StorageSnapshot: unable to rename snapshot file to '" + path + "'!");
+        }
+    }
+    catch (...)
+    {
+        file.reset();
+        remove(tmpPath.c_str());
+        throw;
+    }
+    syncDirectory(path);
+    return recordCount;
+}
+
+bool StorageSnapshot::load(const std::string &path, FileStorageObserver *observer, u64 *sequence)
+{
+    assert(nullptr != observer);
+    assert(nullptr != sequence);
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (0 > fd)
+    {
+        if (ENOENT == errno)
+        {
+            return false;
+        }
+        throw std::runtime_error("StorageSnapshot: unable to open snapshot file '" + path + "'!");
+    }
+    struct stat st;
+    if ((0 != fstat(fd, &st)) || (static_cast<size_t>(st.st_size) < sizeof(Header)))
+    {
+        ::close(fd);
+        throw std::runtime_error("StorageSnapshot: snapshot file '" + path + "' is damaged!");
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == addr)
+    {
+        throw std::runtime_error("StorageSnapshot: unable to map snapshot file '" + path + "'!");
+    }
+    MappedSnapshot mapped{addr, size};
+    madvise(addr, size, MADV_SEQUENTIAL);
+
+    const char *base = static_cast<const char *>(addr);
+    Header header;
+    memcpy(&header, base, sizeof(header));
+    const size_t dataSize = size - sizeof(Header);
+    const char *data = base + sizeof(Header);
+    if ((0 != memcmp(header.magic_, SNAPSHOT_MAGIC, sizeof(header.magic_))) ||
+        (SNAPSHOT_FORMAT_VERSION != header.formatVersion_) || (dataSize != header.dataSize_) ||
+        (header.checksum_ != fnv1a(FNV_OFFSET, data, dataSize)))
+    {
+        throw std::runtime_error("StorageSnapshot: snapshot file '" + path + "' is damaged!");
+    }
+
+    u64 count = 0;
+    size_t offset = 0;
+    while (offset < dataSize)
+    {
+        RecordHeader rec;
+        if (dataSize - offset < sizeof(rec))
+        {
+            throw std::runtime_error("StorageSnapshot: snapshot file '" + path + "' is damaged!");
+        }
+        memcpy(&rec, data + offset, sizeof(rec));
+        offset += sizeof(rec);
+        if (dataSize - offset < paddedSize(rec.size_))
+        {
+            throw std::runtime_error("StorageSnapshot: snapshot file '" + path + "' is damaged!");
+        }
+        observer->onRecordLoaded(IdT(rec.id_, rec.date_), rec.version_, data + offset, rec.size_);
+        offset += paddedSize(rec.size_);
+        ++count;
+    }
+    if (count != header.recordCount_)
+    {
+        throw std::runtime_error("StorageSnapshot: snapshot file '" + path + "' is damaged!");
+    }
+    *sequence = header.sequence_;
+    return true;
+}
+
+StorageSnapshotter::StorageSnapshotter(LMDBStorage *storage, LMDBWriteBehind *writeBehind,
+                                       const WideParamsDataStorage *dataStorage, const OrderDataStorage *orderStorage,
+                                       const StorageSnapshotParams &params)
+    : storage_(storage), writeBehind_(writeBehind), dataStorage_(dataStorage), orderStorage_(orderStorage),
+      params_(params), stopped_(false), totalSnapshots_(0)
+{
+    if ((nullptr == storage_) || (nullptr == dataStorage_) || (nullptr == orderStorage_))
+    {
+        throw std::runtime_error("StorageSnapshotter: storages are not assigned!");
+    }
+    if (params_.path_.empty())
+    {
+        throw std::runtime_error("StorageSnapshotter: snapshot path is empty!");
+    }
+    if (0 < params_.intervalSec_)
+    {
+        thread_ = std::thread(&StorageSnapshotter::run, this);
+    }
+}
+
+StorageSnapshotter::~StorageSnapshotter()
+{
+    shutdown();
+}
+
+void StorageSnapshotter::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        stopped_ = true;
+    }
+    wakeUp_.notify_one();
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+u64 StorageSnapshotter::takeSnapshot()
+{
+    std::lock_guard<std::mutex> guard(snapshotLock_);
+    if (nullptr != writeBehind_)
+    {
+        // records queued so far get sequences the snapshot covers
+        writeBehind_->flush();
+    }
+    const u64 sequence = storage_->lastSequence();
+    const u64 records = StorageSnapshot::write(params_.path_, sequence, *dataStorage_, *orderStorage_);
+    storage_->truncateJournal(sequence);
+    totalSnapshots_.fetch_add(1, std::memory_order_relaxed);
+
+    if (aux::ExchLogger::instance()->isNoteOn())
+    {
+        aux::ExchLogger::instance()->note("StorageSnapshotter: snapshot of " + to_string(records) +
+                                          " records covers journal up to " + to_string(sequence));
+    }
+    return sequence;
+}
+
+void StorageSnapshotter::run()
+{
+    std::unique_lock<std::mutex> guard(lock_);
+    while (!stopped_)
+    {
+        wakeUp_.wait_for(guard, std::chrono::seconds(params_.intervalSec_), [this]() { return stopped_; });
+        if (stopped_)
+        {
+            break;
+        }
+        guard.unlock();
+        try
+        {
+            takeSnapshot();
+        }
+        catch (const std::exception &ex)
+        {
+            // journal is kept, the next period retries
+            aux::ExchLogger::instance()->error(string("StorageSnapshotter: snapshot failed: ") + ex.what());
+        }
+        guard.lock();
+    }
+}
@@ -0,0 +1,133 @@
+/**
+ Concurrent Order Processor library
+
+ Authors: dudleylane, Claude
+
+ Copyright (C) 2026 dudleylane
+
+ Distributed under the GNU Affero General Public License (AGPL).
+
+ See http://orderprocessor.sourceforge.net updates, documentation, and revision history.
+*/
+
+#pragma once
+
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "FileStorageDef.h"
+
+namespace COP
+{
+namespace Store
+{
+
+class WideParamsDataStorage;
+class OrderDataStorage;
+class LMDBStorage;
+class LMDBWriteBehind;
+
+/// Binary image of the in-memory reference data, orders and executions.
+/// File layout, little-endian:
+///   Header, then per record: RecordHeader and the record body padded to 8 bytes.
+///   Body is the one StorageRecordDispatcher saves: <type - 32 bit><codec body>.
+/// The file is mapped on load and record bodies are passed to the observer
+/// straight from the mapping.
+class StorageSnapshot
+{
+public:
+    struct Header
+    {
+        char magic_[8];
+        u32 formatVersion_;
+        u32 reserved_;
+        /// storage journal sequence the image includes
+        u64 sequence_;
+        u64 recordCount_;
+        /// bytes of records following the header
+        u64 dataSize_;
+        /// FNV-1a of the records
+        u64 checksum_;
+    };
+
+    struct RecordHeader
+    {
+        u64 id_;
+        u32 date_;
+        u32 version_;
+        u64 size_;
+    };
+
+    /// writes the storages into path, the file is replaced atomically.
+    /// sequence - storage journal sequence included by the storages
+    /// returns amount of written records
+    static u64 write(const std::string &path, u64 sequence, const WideParamsDataStorage &dataStorage,
+                     const OrderDataStorage &orderStorage);
+
+    /// passes records of the snapshot to the observer, only onRecordLoaded() is called.
+    /// returns false if there is no snapshot, throws if the snapshot is damaged
+    static bool load(const std::string &path, FileStorageObserver *observer, u64 *sequence);
+};
+
+struct StorageSnapshotParams
+{
+    /// snapshot file
+    std::string path_;
+    /// period of snapshots, 0 - snapshots are taken by takeSnapshot() only
+    u32 intervalSec_ = 0;
+};
+
+/// Takes snapshots of the storages and drops the storage journal they cover.
+/// Restart loads the latest snapshot and replays the journal after its sequence.
+/// Snapshot is taken while orders change; every order is copied under its entry
+/// lock, so the image holds a consistent state of each order. Order state changes
+/// are not journaled, the state copied into the latest snapshot is the one restored.
+/// An order saved while the snapshot is written is journaled after its sequence and
+/// replayed over the snapshot copy.
+class StorageSnapshotter
+{
+public:
+    /// writeBehind could be nullptr, queued records are flushed before the snapshot otherwise
+    StorageSnapshotter(LMDBStorage *storage, LMDBWriteBehind *writeBehind, const WideParamsDataStorage *dataStorage,
+                       const OrderDataStorage *orderStorage, const StorageSnapshotParams &params);
+    ~StorageSnapshotter();
+
+    /// takes a snapshot now, returns the journal sequence it covers
+    u64 takeSnapshot();
+    /// stops periodic snapshots
+    void shutdown();
+
+    u64 totalSnapshots() const
+    {
+        return totalSnapshots_.load(std::memory_order_relaxed);
+    }
+
+private:
+    void run();
+
+    StorageSnapshotter(const StorageSnapshotter &) = delete;
+    StorageSnapshotter &operator=(const StorageSnapshotter &) = delete;
+
+private:
+    LMDBStorage *storage_;
+    LMDBWriteBehind *writeBehind_;
+    const WideParamsDataStorage *dataStorage_;
+    const OrderDataStorage *orderStorage_;
+    StorageSnapshotParams params_;
+
+    /// one snapshot at a time
+    std::mutex snapshotLock_;
+
+    std::mutex lock_;
+    std::condition_variable wakeUp_;
+    bool stopped_;
+    std::atomic<u64> totalSnapshots_;
+
+    std::thread thread_;
+};
+
+} // namespace Store
+} // namespace COP
@@ -12,10 +12,14 @@
 
 #include <cassert>
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
 
 #include "Logger.h"
 #include "TaskManager.h"
 #include "ExchUtils.h"
+#include "TransactionScopePool.h"
 
 using namespace std;
 using namespace COP;
@@ -32,10 +36,24 @@ oneapi::tbb::task_group TaskManager::taskGroup_;
 static std::atomic<int> g_nextWorkerCore{ 0 };
 
 TaskManager::TaskManager(const TaskManagerParams &params)
-    : transactMgr_(nullptr), transactIt_(nullptr), cpuAffinityStart_(-1), lastAvailableTransactProcessor_(0),
-      lastAvailableEvntProcessor_(0), totalAvailableTransactProcessor_(0), totalAvailableEvntProcessor_(0), created_(0),
-      processed_(0), finished_(0), createdTr_(0), processedTr_(0), finishedTr_(0)
+    : transactMgr_(nullptr), transactIt_(nullptr), cpuAffinityStart_(-1), eventBatchSize_(1), transactionBatchSize_(1),
+      executionMode_(params.executionMode_), spinIterations_(params.spinIterations_),
+      parkTimeoutUs_(params.parkTimeoutUs_), stopped_(false), wakeUps_(0), parkedWorkers_(0), busyWorkers_(0),
+      lastAvailableTransactProcessor_(0), lastAvailableEvntProcessor_(0), totalAvailableTransactProcessor_(0),
+      totalAvailableEvntProcessor_(0), created_(0), processed_(0), finished_(0), createdTr_(0), processedTr_(0),
+      finishedTr_(0)
 {
+    // validated before the observers are attached, processors stay with the caller on failure
+    if ((TaskManagerParams::TASK_GROUP_EXECUTION != executionMode_) &&
+        (TaskManagerParams::BUSY_POLL_EXECUTION != executionMode_))
+    {
+        throw std::runtime_error("TaskManager: unsupported execution mode!");
+    }
+    if ((TaskManagerParams::BUSY_POLL_EXECUTION == executionMode_) &&
+        (std::min(params.transactProcessors_.size(), params.evntProcessors_.size()) < params.busyPollWorkers_))
+    {
+        throw std::runtime_error("TaskManager: busy-poll worker needs own event and transaction processor!");
+    }
     assert(nullptr != params.transactMgr_);
     transactMgr_ = params.transactMgr_;
     transactIt_ = transactMgr_->iterator();
@@ -57,6 +75,11 @@ TaskManager::TaskManager(const TaskManagerParams &params)
     inQueues_ = params.inQueues_;
     inQueues_->attach(this);
 
+    assert(0 < params.eventBatchSize_);
+    eventBatchSize_ = params.eventBatchSize_;
+    assert(0 < params.transactionBatchSize_);
+    transactionBatchSize_ = params.transactionBatchSize_;
+
     cpuAffinityStart_ = params.cpuAffinityStart_;
     if (cpuAffinityStart_ >= 0)
     {
@@ -64,11 +87,17 @@ TaskManager::TaskManager(const TaskManagerParams &params)
         g_nextWorkerCore.store(cpuAffinityStart_ + 1, std::memory_order_relaxed);
     }
 
+    if (TaskManagerParams::BUSY_POLL_EXECUTION == executionMode_)
+    {
+        startWorkers(params.busyPollWorkers_);
+    }
+
     aux::ExchLogger::instance()->note("TaskManager created.");
 }
 
 TaskManager::~TaskManager(void)
 {
+    stopWorkers();
     assert(nullptr != transactMgr_);
     transactMgr_->detach();
     transactIt_ = nullptr;
@@ -138,7 +167,7 @@ bool TaskManager::waitUntilTransactionsFinished(int waitIntervalSeconds) const
             oneapi::tbb::mutex::scoped_lock lock2(eventLock_);
             finished = (lastAvailableTransactProcessor_.load() == totalAvailableTransactProcessor_.load()) &&
                        (lastAvailableEvntProcessor_.load() == totalAvailableEvntProcessor_.load()) &&
-                       (0 == inQueues_->size());
+                       (0 == busyWorkers_.load(std::memory_order_acquire)) && (0 == inQueues_->size());
         }
         if (finished && !onceSucceed && (0 != waitIntervalSeconds))
         {
@@ -165,9 +194,13 @@ void TaskManager::addTask(const TransactionId & /*id*/)
 
 void TaskManager::onReadyToExecute()
 {
+    if (TaskManagerParams::BUSY_POLL_EXECUTION == executionMode_)
+    {
+        wakeUpWorkers();
+        return;
+    }
     TransactionProcessor *proc = nullptr;
-    TransactionId id;
-    Transaction *tr = nullptr;
+    TransactionBatchT batch;
     {
         oneapi::tbb::mutex::scoped_lock lock(transactLock_);
         int lastIdx = lastAvailableTransactProcessor_.load();
@@ -176,7 +209,8 @@ void TaskManager::onReadyToExecute()
             return;
         }
         assert(nullptr != transactIt_);
-        if (!transactIt_->next(&id, &tr))
+        // transactions ready at the same time touch disjoint objects, one task executes them all
+        if (0 == transactIt_->nextBatch(transactionBatchSize_, &batch))
         {
             return;
         }
@@ -188,7 +222,7 @@ void TaskManager::onReadyToExecute()
     taskCreatedTr();
 
     taskGroup_.run(
-        [this, id, tr, proc]()
+        [this, batch = std::move(batch), proc]()
         {
             // Pin this TBB worker thread to a dedicated core (once per thread)
             if (cpuAffinityStart_ >= 0)
@@ -203,34 +237,53 @@ void TaskManager::onReadyToExecute()
                 }
             }
 
-            assert(nullptr != tr);
             assert(nullptr != proc);
-            proc->process(id, tr);
+            executeBatch(proc, batch);
             taskProcessedTr();
 
-            finishTransaction(id, tr, proc);
+            finishTransactions(batch, proc);
             onReadyToExecute();
             taskFinishedTr();
         });
 }
 
-bool TaskManager::finishTransaction(const ACID::TransactionId &id, ACID::Transaction *tr, TransactionProcessor *proc)
+void TaskManager::executeBatch(TransactionProcessor *proc, const TransactionBatchT &batch)
+{
+    assert(nullptr != proc);
+    for (TransactionBatchT::const_iterator it = batch.begin(); it != batch.end(); ++it)
+    {
+        assert(nullptr != it->tr_);
+        // failed transaction must not keep the rest of the batch from being removed
+        try
+        {
+            proc->process(it->id_, it->tr_);
+        }
+        catch (const std::exception &ex)
+        {
+            aux::ExchLogger::instance()->error(string("TaskManager: transaction execution failed: ") + ex.what());
+        }
+    }
+}
+
+size_t TaskManager::finishTransactions(const TransactionBatchT &batch, TransactionProcessor *proc)
 {
     assert(nullptr != proc);
-    assert(nullptr != tr);
-    bool rez = false;
     {
         oneapi::tbb::mutex::scoped_lock lock(transactLock_);
         int v = lastAvailableTransactProcessor_.fetch_add(1);
         transactProcessors_[v + 1] = proc;
     }
     assert(nullptr != transactMgr_);
-    rez = transactMgr_->removeTransaction(id, tr);
-    return rez;
+    return transactMgr_->removeTransactions(batch);
 }
 
 void TaskManager::onNewEvent()
 {
+    if (TaskManagerParams::BUSY_POLL_EXECUTION == executionMode_)
+    {
+        wakeUpWorkers();
+        return;
+    }
     InQueueProcessor *proc = nullptr;
     {
         oneapi::tbb::mutex::scoped_lock lock(eventLock_);
@@ -264,7 +317,7 @@ void TaskManager::onNewEvent()
             }
 
             assert(nullptr != proc);
-            bool rez = proc->process();
+            bool rez = (0 < proc->processBatch(eventBatchSize_));
             taskProcessed();
 
             finishEvent(proc);
@@ -284,6 +337,149 @@ void TaskManager::finishEvent(Queues::InQueueProcessor *proc)
     evntProcessors_[v + 1] = proc;
 }
 
+void TaskManager::startWorkers(u32 workerAmount)
+{
+    const size_t pairs = std::min(transactProcessors_.size(), evntProcessors_.size());
+    if (0 == workerAmount)
+    {
+        workerAmount = static_cast<u32>(pairs);
+    }
+    assert(workerAmount <= pairs);
+    workers_.reserve(workerAmount);
+    for (size_t i = 0; i < workerAmount; ++i)
+    {
+        int core = -1;
+        if (cpuAffinityStart_ >= 0)
+        {
+            core = g_nextWorkerCore.fetch_add(1, std::memory_order_relaxed) % CpuAffinity::getAvailableCores();
+        }
+        workers_.emplace_back([this, i, core]() { runWorker(i, core); });
+    }
+}
+
+void TaskManager::stopWorkers()
+{
+    if (workers_.empty())
+    {
+        return;
+    }
+    stopped_.store(true);
+    wakeUpWorkers();
+    for (size_t i = 0; i < workers_.size(); ++i)
+    {
+        workers_[i].join();
+    }
+    workers_.clear();
+}
+
+void TaskManager::runWorker(size_t idx, int core)
+{
+    if (0 <= core)
+    {
+        CpuAffinity::pinThreadToCore(core);
+    }
+    // processors stay in the pools, the worker is their only user
+    TransactionProcessor *trProc = transactProcessors_[idx];
+    InQueueProcessor *evntProc = evntProcessors_[idx];
+    assert(nullptr != trProc);
+    assert(nullptr != evntProc);
+
+    while (!stopped_.load())
+    {
+        const u32 seen = wakeUps_.load(std::memory_order_acquire);
+        busyWorkers_.fetch_add(1, std::memory_order_acq_rel);
+        bool worked = false;
+        for (;;)
+        {
+            // transactions first, they unblock the ones queued behind them
+            bool found = pollTransaction(trProc);
+            found = pollEvents(evntProc) || found;
+            if (!found)
+            {
+                break;
+            }
+            worked = true;
+        }
+        busyWorkers_.fetch_sub(1, std::memory_order_acq_rel);
+        if (!worked)
+        {
+            waitForWork(seen);
+        }
+    }
+}
+
+bool TaskManager::pollTransaction(TransactionProcessor *proc)
+{
+    // the iterator pops a concurrent ready queue, workers call it without transactLock_
+    thread_local TransactionBatchT batch;
+    batch.clear();
+    if (0 == transactIt_->nextBatch(transactionBatchSize_, &batch))
+    {
+        return false;
+    }
+    taskCreatedTr();
+    executeBatch(proc, batch);
+    taskProcessedTr();
+    transactMgr_->removeTransactions(batch);
+    taskFinishedTr();
+    return true;
+}
+
+bool TaskManager::pollEvents(InQueueProcessor *proc)
+{
+    if (0 == inQueues_->size())
+    {
+        return false;
+    }
+    bool rez = false;
+    taskCreated();
+    try
+    {
+        rez = (0 < proc->processBatch(eventBatchSize_));
+    }
+    catch (const std::exception &ex)
+    {
+        aux::ExchLogger::instance()->error(string("TaskManager: event processing failed: ") + ex.what());
+        rez = true;
+    }
+    taskProcessed();
+    taskFinished();
+    return rez;
+}
+
+void TaskManager::waitForWork(u32 seenWakeUps)
+{
+    for (u32 i = 0; i < spinIterations_; ++i)
+    {
+        if ((seenWakeUps != wakeUps_.load(std::memory_order_acquire)) || (0 < inQueues_->size()) ||
+            stopped_.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        cpu_pause();
+    }
+    // parkedWorkers_ is raised before the wake up counter is checked under the lock,
+    // wakeUpWorkers() bumps the counter before it looks at parkedWorkers_
+    parkedWorkers_.fetch_add(1, std::memory_order_seq_cst);
+    {
+        std::unique_lock<std::mutex> guard(parkLock_);
+        parked_.wait_for(guard, std::chrono::microseconds(parkTimeoutUs_),
+                         [this, seenWakeUps]()
+                         { return (seenWakeUps != wakeUps_.load(std::memory_order_seq_cst)) || stopped_.load(); });
+    }
+    parkedWorkers_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void TaskManager::wakeUpWorkers()
+{
+    wakeUps_.fetch_add(1, std::memory_order_seq_cst);
+    if (0 < parkedWorkers_.load(std::memory_order_seq_cst))
+    {
+        std::lock_guard<std::mutex> guard(parkLock_);
+        parked_.notify_all();
+    }
+}
+
 void TaskManager::taskCreated()
 {
     // Relaxed ordering - statistics counters don't need memory synchronization
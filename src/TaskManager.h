@@ -15,6 +15,9 @@
 #include <vector>
 #include <atomic>
 #include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <oneapi/tbb/mutex.h>
 #include <oneapi/tbb/global_control.h>
 #include <oneapi/tbb/task_group.h>
@@ -33,12 +36,34 @@ namespace Tasks
 
 struct TaskManagerParams
 {
+    /// how events and transactions are scheduled
+    enum ExecutionMode
+    {
+        INVALID_EXECUTION = 0,
+        /// every event batch and transaction is a task in the TBB arena
+        TASK_GROUP_EXECUTION,
+        /// fixed set of worker threads poll the queue and transaction iterator directly
+        BUSY_POLL_EXECUTION
+    };
+
     ACID::TransactionManager *transactMgr_;
     ACID::ProcessorPoolT transactProcessors_;
     Queues::InQueueProcessorsPoolT evntProcessors_;
     Queues::InQueuesContainer *inQueues_;
 
     int cpuAffinityStart_ = -1;
+    /// events drained by one event task before it is rescheduled
+    u32 eventBatchSize_ = 1;
+    /// ready transactions executed by one task and removed from the manager together
+    u32 transactionBatchSize_ = 1;
+
+    ExecutionMode executionMode_ = TASK_GROUP_EXECUTION;
+    /// BUSY_POLL_EXECUTION: worker threads, 0 - one per event/transaction processor pair
+    u32 busyPollWorkers_ = 0;
+    /// BUSY_POLL_EXECUTION: empty polls before an idle worker parks, 0 - park at once
+    u32 spinIterations_ = 10000;
+    /// BUSY_POLL_EXECUTION: longest park, the worker polls again after it
+    u32 parkTimeoutUs_ = 1000;
 
     TaskManagerParams() : transactMgr_(nullptr), transactProcessors_(), evntProcessors_(), inQueues_(nullptr) {}
 };
@@ -57,9 +82,19 @@ public:
     /// waitIntervalSeconds = -1, means infinite
     bool waitUntilTransactionsFinished(int waitIntervalSeconds) const;
 
-    bool finishTransaction(const ACID::TransactionId &id, ACID::Transaction *tr, ACID::TransactionProcessor *proc);
+    /// returns processor to the pool and removes the executed batch in one manager call
+    size_t finishTransactions(const ACID::TransactionBatchT &batch, ACID::TransactionProcessor *proc);
     void finishEvent(Queues::InQueueProcessor *proc);
 
+    TaskManagerParams::ExecutionMode executionMode() const
+    {
+        return executionMode_;
+    }
+    size_t busyPollWorkers() const
+    {
+        return workers_.size();
+    }
+
 public:
     /// reimplemented from ExecTaskManager
     virtual void addTask(const ACID::TransactionId &id);
@@ -122,6 +157,16 @@ public:
         return totalAvailableTransactProcessor_.load(std::memory_order_relaxed);
     }
 
+private:
+    void startWorkers(u32 workerAmount);
+    void stopWorkers();
+    void runWorker(size_t idx, int core);
+    bool pollTransaction(ACID::TransactionProcessor *proc);
+    void executeBatch(ACID::TransactionProcessor *proc, const ACID::TransactionBatchT &batch);
+    bool pollEvents(Queues::InQueueProcessor *proc);
+    void waitForWork(u32 seenWakeUps);
+    void wakeUpWorkers();
+
 private:
     mutable oneapi::tbb::mutex lock_;
     mutable oneapi::tbb::mutex transactLock_;
@@ -134,6 +179,23 @@ private:
     ACID::TransactionIterator *transactIt_;
 
     int cpuAffinityStart_;
+    u32 eventBatchSize_;
+    u32 transactionBatchSize_;
+
+    TaskManagerParams::ExecutionMode executionMode_;
+    u32 spinIterations_;
+    u32 parkTimeoutUs_;
+
+    // BUSY_POLL_EXECUTION workers, each one owns a processor of both pools
+    std::vector<std::thread> workers_;
+    std::atomic<bool> stopped_;
+    /// bumped on every new event or ready transaction
+    CacheAlignedAtomic<u32> wakeUps_;
+    CacheAlignedAtomic<int> parkedWorkers_;
+    /// workers inside a poll pass, checked by waitUntilTransactionsFinished
+    CacheAlignedAtomic<int> busyWorkers_;
+    std::mutex parkLock_;
+    std::condition_variable parked_;
 
     Queues::InQueuesContainer *inQueues_;
 
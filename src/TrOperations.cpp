@@ -17,6 +17,7 @@
 #include "OrderStorage.h"
 #include "ExchUtils.h"
 #include "DeferedEvents.h"
+#include "SourceRegistry.h"
 
 using namespace std;
 using namespace COP;
@@ -25,6 +26,22 @@ using namespace COP::Queues;
 using namespace COP::Proc;
 using namespace COP::Store;
 
+namespace
+{
+/// registry-owned names, so that intern() takes its lock-free address path
+const std::string &internalSource()
+{
+    static const std::string &source = SourceRegistry::instance()->name(SourceRegistry::instance()->intern("_"));
+    return source;
+}
+
+const std::string &cancelRejectTarget()
+{
+    static const std::string &target = SourceRegistry::instance()->name(SourceRegistry::instance()->intern("tgt"));
+    return target;
+}
+} // namespace
+
 namespace COP
 {
 namespace ACID
@@ -41,7 +58,10 @@ void processEvent_GenerateExecution(const Context &cnxt, const IdT &orderId, con
     // write lock on the order during source read + addExecution
     oneapi::tbb::spin_rw_mutex::scoped_lock ordLock(ord->entryMutex_, true);
 
-    StringT src = ord->source_.get();
+    // the source is interned once per order, later reports reuse the handle
+    if (INVALID_SOURCE_HANDLE == ord->sourceHandle_) [[unlikely]]
+        ord->sourceHandle_ = SourceRegistry::instance()->intern(ord->source_.get());
+    const StringT &src = SourceRegistry::instance()->name(ord->sourceHandle_);
 
     ExecutionEntry *execReport = cnxt.orderStorage_->save(exec, cnxt.idGenerator_);
     assert(nullptr != execReport);
@@ -57,7 +77,7 @@ void processEvent_GenerateExecution(const Context &cnxt, const IdT &orderId, con
 void executeEnqueueOrderEvent(const OrdState::onReplaceReceived &event_, const Context &cnxt)
 {
     assert(nullptr != cnxt.inQueues_);
-    cnxt.inQueues_->push("_", ProcessEvent(ProcessEvent::ON_REPLACE_RECEVIED, event_.replId_));
+    cnxt.inQueues_->push(internalSource(), ProcessEvent(ProcessEvent::ON_REPLACE_RECEVIED, event_.replId_));
 
     ReplaceExecEntry execReport;
     execReport.origOrderId_ = event_.replId_;
@@ -75,7 +95,7 @@ void rollbackEnqueueOrderEvent(const OrdState::onReplaceReceived &, const Contex
 void executeEnqueueOrderEvent(const OrdState::onExecReplace &event_, const Context &cnxt)
 {
     assert(nullptr != cnxt.inQueues_);
-    cnxt.inQueues_->push("_", ProcessEvent(ProcessEvent::ON_EXEC_REPLACE, event_.replId_));
+    cnxt.inQueues_->push(internalSource(), ProcessEvent(ProcessEvent::ON_EXEC_REPLACE, event_.replId_));
 
     ReplaceExecEntry execReport;
     execReport.origOrderId_ = event_.replId_;
@@ -93,7 +113,7 @@ void rollbackEnqueueOrderEvent(const OrdState::onExecReplace &, const Context &)
 void executeEnqueueOrderEvent(const OrdState::onReplaceRejected &event_, const Context &cnxt)
 {
     assert(nullptr != cnxt.inQueues_);
-    cnxt.inQueues_->push("_", ProcessEvent(ProcessEvent::ON_REPLACE_REJECTED));
+    cnxt.inQueues_->push(internalSource(), ProcessEvent(ProcessEvent::ON_REPLACE_REJECTED));
 
     RejectExecEntry execReport;
     execReport.orderId_ = event_.orderId_;
@@ -437,7 +457,7 @@ CancelRejectTrOperation::~CancelRejectTrOperation() {}
 void CancelRejectTrOperation::execute(const Context &cnxt)
 {
     assert(nullptr != cnxt.outQueues_);
-    cnxt.outQueues_->push(CancelRejectEvent(), "tgt");
+    cnxt.outQueues_->push(CancelRejectEvent(), cancelRejectTarget());
 }
 
 void CancelRejectTrOperation::rollback(const Context &) {}
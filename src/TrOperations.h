@@ -151,7 +151,7 @@ public:
     {
     }
     EnqueueOrderEventTrOperation(const OrderEntry &order, const T &evnt, const IdT &instrId)
-        : Operation(ENQUEUE_EVENT_TROPERATION, order.orderId_, instrId), event_(evnt)
+        : Operation(ENQUEUE_EVENT_TROPERATION, order.orderId_, instrId, read_AccessMode), event_(evnt)
     {
     }
 
@@ -16,6 +16,7 @@
 #include <memory>
 #include <vector>
 #include <set>
+#include <cassert>
 
 #include "TypesDef.h"
 
@@ -55,13 +56,32 @@ enum ObjectType
     execution_ObjectType
 };
 
+/// how a transaction uses an object: readers of the same object may run
+/// concurrently, a writer runs alone
+enum AccessMode
+{
+    invalid_AccessMode = 0,
+    read_AccessMode,
+    write_AccessMode
+};
+
+/// object is identified by type and id, access mode is not part of the identity
 struct ObjectInTransaction
 {
     IdT id_;
     ObjectType type_;
+    AccessMode access_;
+
+    constexpr ObjectInTransaction() : id_(), type_(invalid_ObjectType), access_(write_AccessMode) {}
+    constexpr ObjectInTransaction(const ObjectType &type, const IdT &id, AccessMode access = write_AccessMode)
+        : id_(id), type_(type), access_(access)
+    {
+    }
 
-    constexpr ObjectInTransaction() : type_(invalid_ObjectType), id_() {}
-    constexpr ObjectInTransaction(const ObjectType &type, const IdT &id) : type_(type), id_(id) {}
+    constexpr bool isReadOnly() const
+    {
+        return read_AccessMode == access_;
+    }
 };
 constexpr bool operator<(const ObjectInTransaction &left, const ObjectInTransaction &right)
 {
@@ -131,8 +151,15 @@ struct Context
 class Operation
 {
 public:
-    explicit Operation(OperationType type, const IdT &id) : type_(type), id_(id), relatedId_() {}
-    explicit Operation(OperationType type, const IdT &id, const IdT &relId) : type_(type), id_(id), relatedId_(relId) {}
+    explicit Operation(OperationType type, const IdT &id)
+        : type_(type), id_(id), relatedId_(), relatedAccess_(write_AccessMode)
+    {
+    }
+    /// relAccess tells whether the operation changes the related object or only reads it
+    explicit Operation(OperationType type, const IdT &id, const IdT &relId, AccessMode relAccess = write_AccessMode)
+        : type_(type), id_(id), relatedId_(relId), relatedAccess_(relAccess)
+    {
+    }
     virtual ~Operation() {}
     virtual void execute(const Context &cnxt) = 0;
     virtual void rollback(const Context &cnxt) = 0;
@@ -149,6 +176,10 @@ public:
     {
         return relatedId_;
     }
+    AccessMode getRelatedAccess() const noexcept
+    {
+        return relatedAccess_;
+    }
 
     /// Arena-aware allocation: when a TransactionScope arena is active,
     /// allocations are served from the arena's bump allocator (zero heap cost).
@@ -160,6 +191,7 @@ protected:
     OperationType type_;
     IdT id_;
     IdT relatedId_;
+    AccessMode relatedAccess_;
 };
 
 class Scope
@@ -204,6 +236,17 @@ public:
     virtual void onReadyToExecute() = 0;
 };
 
+/// ready transaction handed out by TransactionIterator
+struct ReadyTransaction
+{
+    TransactionId id_;
+    Transaction *tr_;
+
+    ReadyTransaction() : id_(), tr_(nullptr) {}
+    ReadyTransaction(const TransactionId &id, Transaction *tr) : id_(id), tr_(tr) {}
+};
+typedef std::vector<ReadyTransaction> TransactionBatchT;
+
 class TransactionIterator
 {
 public:
@@ -212,6 +255,21 @@ public:
     virtual bool next(TransactionId *id, Transaction **tr) = 0;
     virtual bool get(TransactionId *id, Transaction **tr) const = 0;
     virtual bool isValid() const = 0;
+
+    /// appends up to maxSize ready transactions to the batch, returns amount appended.
+    /// Transactions ready at the same time do not depend on each other.
+    virtual size_t nextBatch(size_t maxSize, TransactionBatchT *batch)
+    {
+        assert(nullptr != batch);
+        size_t added = 0;
+        ReadyTransaction ready;
+        while ((added < maxSize) && next(&ready.id_, &ready.tr_))
+        {
+            batch->push_back(ready);
+            ++added;
+        }
+        return added;
+    }
 };
 
 class TransactionProcessor
@@ -240,6 +298,20 @@ public:
     /// remove transaction, do not execute it
     virtual bool removeTransaction(const TransactionId &id, Transaction *t) = 0;
 
+    /// removes executed batch, returns amount of removed transactions
+    virtual size_t removeTransactions(const TransactionBatchT &batch)
+    {
+        size_t removed = 0;
+        for (TransactionBatchT::const_iterator it = batch.begin(); it != batch.end(); ++it)
+        {
+            if (removeTransaction(it->id_, it->tr_))
+            {
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
     /// returns ids of all transactions that this depends on
     virtual bool getParentTransactions(const TransactionId &id, TransactionIdsT *parent) const = 0;
 
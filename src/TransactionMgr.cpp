@@ -18,6 +18,17 @@ using namespace tbb;
 using namespace COP;
 using namespace COP::ACID;
 
+namespace
+{
+/// iterator position of the consuming thread, next() shares nothing but the ready queue
+struct DispensedTransaction
+{
+    const TransactionMgr *owner_ = nullptr;
+    TransactionId id_;
+};
+thread_local DispensedTransaction lastDispensed;
+} // namespace
+
 TransactionMgr::TransactionMgr(void) : idGenerator_(nullptr), started_(false), obs_(nullptr) {}
 
 TransactionMgr::~TransactionMgr(void)
@@ -73,20 +84,18 @@ void TransactionMgr::addTransaction(std::unique_ptr<Transaction> &tr)
     ObjectsInTransactionT objects;
     trPtr->getRelatedObjects(&objects);
     int ready2Exec = 0;
+    TransactionObserver *localObs = nullptr;
     {
         tbb::mutex::scoped_lock lock(lock_);
         IdT id =
             idGenerator_
                 ->getId(); // should be just before add() call, because tree requires sequential order adding of transactions
         tr->setTransactionId(id);
-        transactionTree_.add(id, trPtr, objects, &ready2Exec);
-    }
-    TransactionObserver *localObs = nullptr;
-    tr.release();
-    {
-        tbb::mutex::scoped_lock lock(lock_);
+        transactionTree_.add(id, trPtr, objects, &ready2Exec, &readyScratch_);
+        publishReady();
         localObs = obs_;
     }
+    tr.release();
     if ((0 < ready2Exec) && (nullptr != localObs))
     {
         localObs->onReadyToExecute();
@@ -105,7 +114,8 @@ bool TransactionMgr::removeTransaction(const TransactionId &id, Transaction *t)
     bool rez = false;
     {
         tbb::mutex::scoped_lock lock(lock_);
-        rez = transactionTree_.remove(id, &ready2Exec);
+        rez = transactionTree_.remove(id, &ready2Exec, &readyScratch_);
+        publishReady();
         localObs = obs_;
     }
     if ((0 < ready2Exec) && (nullptr != localObs))
@@ -115,6 +125,43 @@ bool TransactionMgr::removeTransaction(const TransactionId &id, Transaction *t)
     return rez;
 }
 
+size_t TransactionMgr::removeTransactions(const TransactionBatchT &batch)
+{
+    assert(started_);
+    if (batch.empty())
+    {
+        return 0;
+    }
+    TransactionObserver *localObs = nullptr;
+    int ready2Exec = 0;
+    size_t removed = 0;
+    {
+        tbb::mutex::scoped_lock lock(lock_);
+        for (TransactionBatchT::const_iterator it = batch.begin(); it != batch.end(); ++it)
+        {
+            assert(it->id_.isValid());
+            int released = 0;
+            if (transactionTree_.remove(it->id_, &released, &readyScratch_))
+            {
+                ++removed;
+            }
+            ready2Exec += released;
+        }
+        publishReady();
+        localObs = obs_;
+    }
+    for (TransactionBatchT::const_iterator it = batch.begin(); it != batch.end(); ++it)
+    {
+        assert(nullptr != it->tr_);
+        delete it->tr_;
+    }
+    if ((0 < ready2Exec) && (nullptr != localObs))
+    {
+        localObs->onReadyToExecute();
+    }
+    return removed;
+}
+
 bool TransactionMgr::getParentTransactions(const TransactionId &id, TransactionIdsT *parent) const
 {
     assert(started_);
@@ -140,18 +187,72 @@ TransactionIterator *TransactionMgr::iterator()
 
 bool TransactionMgr::next(TransactionId *id, Transaction **tr)
 {
-    tbb::mutex::scoped_lock lock(lock_);
-    return transactionTree_.next(id, tr);
+    assert(nullptr != id);
+    assert(nullptr != tr);
+    aux::ReadyNode node;
+    if (!ready_.try_pop(node))
+    {
+        return false;
+    }
+    *id = node.key_;
+    *tr = node.value_;
+    lastDispensed.owner_ = this;
+    lastDispensed.id_ = node.key_;
+    return true;
+}
+
+size_t TransactionMgr::nextBatch(size_t maxSize, TransactionBatchT *batch)
+{
+    assert(nullptr != batch);
+    size_t added = 0;
+    aux::ReadyNode node;
+    while ((added < maxSize) && ready_.try_pop(node))
+    {
+        batch->push_back(ReadyTransaction(node.key_, node.value_));
+        ++added;
+    }
+    if (0 < added)
+    {
+        lastDispensed.owner_ = this;
+        lastDispensed.id_ = batch->back().id_;
+    }
+    return added;
 }
 
 bool TransactionMgr::get(TransactionId *id, Transaction **tr) const
 {
+    assert(nullptr != id);
+    assert(nullptr != tr);
+    if ((this != lastDispensed.owner_) || (!lastDispensed.id_.isValid()))
+    {
+        return false;
+    }
     tbb::mutex::scoped_lock lock(lock_);
-    return transactionTree_.current(id, tr);
+    if (!transactionTree_.find(lastDispensed.id_, tr))
+    {
+        return false;
+    }
+    *id = lastDispensed.id_;
+    return true;
 }
 
 bool TransactionMgr::isValid() const
 {
+    if ((this != lastDispensed.owner_) || (!lastDispensed.id_.isValid()))
+    {
+        return false;
+    }
+    Transaction *tr = nullptr;
     tbb::mutex::scoped_lock lock(lock_);
-    return transactionTree_.isCurrentValid();
+    return transactionTree_.find(lastDispensed.id_, &tr);
+}
+
+void TransactionMgr::publishReady()
+{
+    // called under lock_, so the queue keeps the order in which the tree released transactions
+    for (aux::ReadyNodesT::const_iterator it = readyScratch_.begin(); it != readyScratch_.end(); ++it)
+    {
+        ready_.push(*it);
+    }
+    readyScratch_.clear();
 }
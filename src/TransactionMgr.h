@@ -16,6 +16,7 @@
 #include <memory>
 #include <deque>
 #include <oneapi/tbb/mutex.h>
+#include <oneapi/tbb/concurrent_queue.h>
 
 #include "NLinkedTree.h"
 #include "TransactionDef.h"
@@ -50,23 +51,36 @@ public:
     TransactionObserver *detach();
     virtual void addTransaction(std::unique_ptr<Transaction> &tr);
     virtual bool removeTransaction(const TransactionId &id, Transaction *t);
+    /// removes the whole batch under one lock and notifies the observer once
+    virtual size_t removeTransactions(const TransactionBatchT &batch);
     virtual bool getParentTransactions(const TransactionId &id, TransactionIdsT *parent) const;
     virtual bool getRelatedTransactions(const TransactionId &id, TransactionIdsT *related) const;
     virtual TransactionIterator *iterator();
 
 public:
     /// reimplemented from TransactionIterator
+    /// next() pops the ready queue and does not take lock_; get() and isValid()
+    /// refer to the transaction returned by the last next() on the calling thread
     virtual bool next(TransactionId *id, Transaction **tr);
     virtual bool get(TransactionId *id, Transaction **tr) const;
     virtual bool isValid() const;
+    virtual size_t nextBatch(size_t maxSize, TransactionBatchT *batch);
 
 private:
+    void publishReady();
+
+private:
+    /// guards the dependency tree and the observer
     mutable oneapi::tbb::mutex lock_;
 
     IdTValueGenerator *idGenerator_;
     bool started_;
 
     aux::NLinkTree transactionTree_;
+    /// transactions released by the tree, collected under lock_
+    aux::ReadyNodesT readyScratch_;
+    /// transactions without unfinished parents, in the order they became ready
+    oneapi::tbb::concurrent_queue<aux::ReadyNode> ready_;
 
     TransactionObserver *obs_;
 };
@@ -241,6 +241,11 @@ void TransactionScope::getRelatedObjects(ObjectsInTransactionT *obj) const
                 duplicateId = (rid == obj->list_[i].id_);
                 if (duplicateId)
                 {
+                    // object stays read-only only if every operation just reads it
+                    if (write_AccessMode == (*it)->getRelatedAccess())
+                    {
+                        obj->list_[i].access_ = write_AccessMode;
+                    }
                     break;
                 }
             }
@@ -252,7 +257,8 @@ void TransactionScope::getRelatedObjects(ObjectsInTransactionT *obj) const
                     throw std::runtime_error(
                         "getRelatedObjects() failed to fill ObjectsInTransactionT, transaction use too many objects!");
                 }
-                obj->list_[(obj->size_)++] = ObjectInTransaction(instrument_ObjectType, rid);
+                obj->list_[(obj->size_)++] =
+                    ObjectInTransaction(instrument_ObjectType, rid, (*it)->getRelatedAccess());
             }
         }
     }
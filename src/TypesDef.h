@@ -70,6 +70,15 @@ constexpr bool operator!=(const IdT &lft, const IdT &rght)
     return !operator==(lft, rght);
 }
 
+/// Hash functor for IdT in unordered containers
+struct IdTHash
+{
+    size_t operator()(const IdT &key) const
+    {
+        return std::hash<u64>()(key.id_) ^ (std::hash<u32>()(key.date_) << 1);
+    }
+};
+
 typedef u64 DateTimeT;
 
 typedef double PriceT;
@@ -96,6 +105,13 @@ typedef IdT SubscriberIdT;
 
 typedef std::string StringT;
 
+namespace Queues
+{
+/// small integer standing for an interned event source or target name
+typedef u32 SourceHandle;
+const SourceHandle INVALID_SOURCE_HANDLE = 0xFFFFFFFF;
+} // namespace Queues
+
 enum RawDataType
 {
     INVALID_RAWDATATYPE = 0,
@@ -13,17 +13,21 @@
 #pragma once
 
 #include <atomic>
-#include <mutex>
 #include "TypesDef.h"
 #include "WideDataStorage.h"
 
 namespace COP
 {
 
+/// Reference to the entry of WideDataStorage by its id.
+/// Entries are immutable and owned by the storage until it is destroyed, so
+/// the reference keeps only the pointer to the entry, resolved on the first
+/// get() and published with an atomic store. Threads racing to resolve it
+/// store the same pointer, later calls are one load.
 template <typename T> class WideDataLazyRef
 {
 public:
-    WideDataLazyRef(const SourceIdT &id, bool load = false) : id_(id), loaded_(false)
+    WideDataLazyRef(const SourceIdT &id, bool load = false) : id_(id), val_(nullptr)
     {
         if (load)
         {
@@ -32,7 +36,7 @@ public:
     }
 
     WideDataLazyRef(const WideDataLazyRef &other)
-        : val_(other.val_), id_(other.id_), loaded_(other.loaded_.load(std::memory_order_acquire))
+        : id_(other.id_), val_(other.val_.load(std::memory_order_acquire))
     {
     }
 
@@ -40,9 +44,8 @@ public:
     {
         if (this != &other)
         {
-            val_ = other.val_;
             id_ = other.id_;
-            loaded_.store(other.loaded_.load(std::memory_order_acquire), std::memory_order_release);
+            val_.store(other.val_.load(std::memory_order_acquire), std::memory_order_release);
         }
         return *this;
     }
@@ -51,28 +54,19 @@ public:
 
     const T &get() const
     {
-        if (!loaded_.load(std::memory_order_acquire))
+        const T *val = val_.load(std::memory_order_acquire);
+        if (nullptr == val) [[unlikely]]
         {
-            std::lock_guard<std::mutex> guard(mtx_);
-            if (!loaded_.load(std::memory_order_relaxed))
-            {
-                Store::WideDataStorage::instance()->get(id_, &val_);
-                loaded_.store(true, std::memory_order_release);
-            }
+            val = resolve();
         }
-        return val_;
+        return *val;
     }
 
     void load()
     {
-        if (!loaded_.load(std::memory_order_acquire))
+        if (nullptr == val_.load(std::memory_order_acquire))
         {
-            std::lock_guard<std::mutex> guard(mtx_);
-            if (!loaded_.load(std::memory_order_relaxed))
-            {
-                Store::WideDataStorage::instance()->get(id_, &val_);
-                loaded_.store(true, std::memory_order_release);
-            }
+            resolve();
         }
     }
 
@@ -82,10 +76,17 @@ public:
     };
 
 private:
-    mutable T val_;
+    const T *resolve() const
+    {
+        const T *val = nullptr;
+        Store::WideDataStorage::instance()->locate(id_, &val);
+        val_.store(val, std::memory_order_release);
+        return val;
+    }
+
+private:
     SourceIdT id_;
-    mutable std::atomic<bool> loaded_;
-    mutable std::mutex mtx_;
+    mutable std::atomic<const T *> val_;
 };
 
 } // namespace COP
\ No newline at end of file
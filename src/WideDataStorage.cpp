@@ -13,6 +13,7 @@
 #include <stdexcept>
 #include <immintrin.h> // For _mm_pause()
 #include <algorithm>   // For std::min
+#include <thread>
 #include "WideDataStorage.h"
 #include "CacheAlignedAtomic.h"
 #include "DataModelDef.h"
@@ -46,52 +47,44 @@ inline void casUpdateWithBackoff(CacheAlignedAtomic<u64> &counter, u64 newVal)
 }
 } // namespace
 
-WideParamsDataStorage::WideParamsDataStorage(void) : subscrCounter_(1), storage_(nullptr)
+WideParamsDataStorage::WideParamsDataStorage(void)
+    : reference_(new ReferenceData()), restoring_(false), unpublished_(false), readerEpoch_(0), subscrCounter_(1),
+      storage_(nullptr)
 {
     aux::ExchLogger::instance()->note("WideParamsDataStorage created");
 }
 
 WideParamsDataStorage::~WideParamsDataStorage(void)
 {
-    InstrumentsT tmpInstr;
-    StringsT tmpStr;
-    RawDataT tmpRaw;
-    AccountsT tmpAcct;
-    ClearingsT tmpClr;
-    ExecutionListsT tmpExec;
-    {
-        // Exclusive lock for destruction
-        oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, true);
-        std::swap(tmpInstr, instruments_);
-        std::swap(tmpStr, strings_);
-        std::swap(tmpRaw, rawDatas_);
-        std::swap(tmpAcct, accounts_);
-        std::swap(tmpClr, clearings_);
-        std::swap(tmpExec, executions_);
-    }
-    for (auto it = tmpInstr.begin(); it != tmpInstr.end(); ++it)
-    {
-        delete it->second;
-    }
-    for (auto it = tmpStr.begin(); it != tmpStr.end(); ++it)
-    {
-        delete it->second;
-    }
-    for (auto it = tmpRaw.begin(); it != tmpRaw.end(); ++it)
+    // the snapshot shares the entries, they are deleted once through pending_
+    delete reference_.exchange(nullptr, std::memory_order_acq_rel);
+    for (auto it = pending_.instruments_.begin(); it != pending_.instruments_.end(); ++it)
     {
         delete it->second;
     }
-    for (auto it = tmpAcct.begin(); it != tmpAcct.end(); ++it)
+    for (auto it = pending_.accounts_.begin(); it != pending_.accounts_.end(); ++it)
     {
         delete it->second;
     }
-    for (auto it = tmpClr.begin(); it != tmpClr.end(); ++it)
+    for (auto it = pending_.clearings_.begin(); it != pending_.clearings_.end(); ++it)
     {
         delete it->second;
     }
-    for (auto it = tmpExec.begin(); it != tmpExec.end(); ++it)
+    for (OrderDataShard &shard : shards_)
     {
-        delete it->second;
+        oneapi::tbb::spin_rw_mutex::scoped_lock lock(shard.lock_, true);
+        for (auto it = shard.strings_.begin(); it != shard.strings_.end(); ++it)
+        {
+            delete it->second;
+        }
+        for (auto it = shard.rawDatas_.begin(); it != shard.rawDatas_.end(); ++it)
+        {
+            delete it->second;
+        }
+        for (auto it = shard.executions_.begin(); it != shard.executions_.end(); ++it)
+        {
+            delete it->second;
+        }
     }
 
     aux::ExchLogger::instance()->note("WideParamsDataStorage destroyed");
@@ -105,95 +98,181 @@ void WideParamsDataStorage::bindStorage(DataSaver *storage)
     storage_ = storage;
 }
 
+void WideParamsDataStorage::publishReferenceData()
+{
+    if (restoring_)
+    {
+        unpublished_ = true;
+        return;
+    }
+    std::unique_ptr<const ReferenceData> published(new ReferenceData(pending_));
+    std::unique_ptr<const ReferenceData> replaced(reference_.exchange(published.release()));
+    unpublished_ = false;
+    waitForReaders();
+}
+
+void WideParamsDataStorage::waitForReaders()
+{
+    // a reader that read the epoch before a flip may count itself in the drained half
+    // after the check, so both halves are drained once; such a reader loads the new snapshot
+    for (int flip = 0; flip < 2; ++flip)
+    {
+        const u32 drained = readerEpoch_.fetch_add(1) & 1;
+        for (const ReaderSlot &slot : readerSlots_)
+        {
+            while (0 != slot.active_[drained].load())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+void WideParamsDataStorage::startRestore()
+{
+    std::lock_guard<std::mutex> lock(referenceLock_);
+    restoring_ = true;
+}
+
+void WideParamsDataStorage::finishRestore()
+{
+    std::lock_guard<std::mutex> lock(referenceLock_);
+    restoring_ = false;
+    if (unpublished_)
+    {
+        publishReferenceData();
+    }
+}
+
 // ============================================================================
-// Read operations - use shared (read) locks for concurrent access
+// Read operations - reference data without locks, per-order data under shared shard locks
 // ============================================================================
 
 void WideParamsDataStorage::get(const SourceIdT &id, StringT *val) const
 {
-    // Shared read lock - allows concurrent readers
-    oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, false);
-    StringsT::const_iterator it = strings_.find(id);
-    if (strings_.end() == it)
+    const StringT *entry = nullptr;
+    locate(id, &entry);
+    *val = *entry;
+}
+
+void WideParamsDataStorage::get(const SourceIdT &id, RawDataEntry *val) const
+{
+    const RawDataEntry *entry = nullptr;
+    locate(id, &entry);
+    *val = *entry;
+}
+
+void WideParamsDataStorage::get(const SourceIdT &id, InstrumentEntry *val) const
+{
+    const InstrumentEntry *entry = nullptr;
+    locate(id, &entry);
+    *val = *entry;
+}
+
+void WideParamsDataStorage::get(const SourceIdT &id, AccountEntry *val) const
+{
+    const AccountEntry *entry = nullptr;
+    locate(id, &entry);
+    *val = *entry;
+}
+
+void WideParamsDataStorage::get(const SourceIdT &id, ClearingEntry *val) const
+{
+    const ClearingEntry *entry = nullptr;
+    locate(id, &entry);
+    *val = *entry;
+}
+
+void WideParamsDataStorage::get(const SourceIdT &id, ExecutionsT **val) const
+{
+    ExecutionsT *const *entry = nullptr;
+    locate(id, &entry);
+    *val = *entry;
+}
+
+void WideParamsDataStorage::locate(const SourceIdT &id, const StringT **val) const
+{
+    const OrderDataShard &shard = shardOf(id);
+    oneapi::tbb::spin_rw_mutex::scoped_lock lock(shard.lock_, false);
+    StringsT::const_iterator it = shard.strings_.find(id);
+    if (shard.strings_.end() == it)
     {
         throw std::runtime_error("WideParamsDataStorage::get(StringT): string not found!");
     }
-    *val = *(const_cast<StringT *>(it->second));
+    *val = it->second;
 }
 
-void WideParamsDataStorage::get(const SourceIdT &id, RawDataEntry *val) const
+void WideParamsDataStorage::locate(const SourceIdT &id, const RawDataEntry **val) const
 {
-    // Shared read lock - allows concurrent readers
-    oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, false);
-    RawDataT::const_iterator it = rawDatas_.find(id);
-    if (rawDatas_.end() == it)
+    const OrderDataShard &shard = shardOf(id);
+    oneapi::tbb::spin_rw_mutex::scoped_lock lock(shard.lock_, false);
+    RawDataT::const_iterator it = shard.rawDatas_.find(id);
+    if (shard.rawDatas_.end() == it)
     {
         throw std::runtime_error("WideParamsDataStorage::get(RawDataEntry): rawData not found!");
     }
-    *val = *(const_cast<RawDataEntry *>(it->second));
+    *val = it->second;
 }
 
-void WideParamsDataStorage::get(const SourceIdT &id, InstrumentEntry *val) const
+void WideParamsDataStorage::locate(const SourceIdT &id, const InstrumentEntry **val) const
 {
-    // Shared read lock - allows concurrent readers
-    oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, false);
-    InstrumentsT::const_iterator it = instruments_.find(id);
-    if (instruments_.end() == it)
+    ReferenceReader data(*this);
+    InstrumentsT::const_iterator it = data->instruments_.find(id);
+    if (data->instruments_.end() == it)
     {
         throw std::runtime_error("WideParamsDataStorage::get(InstrumentEntry): instrument not found!");
     }
-    *val = *(const_cast<InstrumentEntry *>(it->second));
+    *val = it->second;
 }
 
-void WideParamsDataStorage::get(const SourceIdT &id, AccountEntry *val) const
+void WideParamsDataStorage::locate(const SourceIdT &id, const AccountEntry **val) const
 {
-    // Shared read lock - allows concurrent readers
-    oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, false);
-    AccountsT::const_iterator it = accounts_.find(id);
-    if (accounts_.end() == it)
+    ReferenceReader data(*this);
+    AccountsT::const_iterator it = data->accounts_.find(id);
+    if (data->accounts_.end() == it)
     {
         throw std::runtime_error("WideParamsDataStorage::get(AccountEntry): account not found!");
     }
-    *val = *(const_cast<AccountEntry *>(it->second));
+    *val = it->second;
 }
 
-void WideParamsDataStorage::get(const SourceIdT &id, ClearingEntry *val) const
+void WideParamsDataStorage::locate(const SourceIdT &id, const ClearingEntry **val) const
 {
-    // Shared read lock - allows concurrent readers
-    oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, false);
-    ClearingsT::const_iterator it = clearings_.find(id);
-    if (clearings_.end() == it)
+    ReferenceReader data(*this);
+    ClearingsT::const_iterator it = data->clearings_.find(id);
+    if (data->clearings_.end() == it)
     {
         throw std::runtime_error("WideParamsDataStorage::get(ClearingEntry): clearing not found!");
     }
-    *val = *(const_cast<ClearingEntry *>(it->second));
+    *val = it->second;
 }
 
-void WideParamsDataStorage::get(const SourceIdT &id, ExecutionsT **val) const
+void WideParamsDataStorage::locate(const SourceIdT &id, ExecutionsT *const **val) const
 {
-    // Shared read lock - allows concurrent readers
-    oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, false);
-    ExecutionListsT::const_iterator it = executions_.find(id);
-    if (executions_.end() == it)
+    const OrderDataShard &shard = shardOf(id);
+    oneapi::tbb::spin_rw_mutex::scoped_lock lock(shard.lock_, false);
+    ExecutionListsT::const_iterator it = shard.executions_.find(id);
+    if (shard.executions_.end() == it)
     {
         throw std::runtime_error("WideParamsDataStorage::get(ExecutionsT): execution list not found!");
     }
-    *val = (const_cast<ExecutionsT *>(it->second));
+    // unordered_map nodes are not moved on rehash, the address of the stored pointer stays valid
+    *val = &it->second;
 }
 
 // ============================================================================
-// Write operations - use exclusive (write) locks
+// Write operations - reference data under referenceLock_, per-order data under exclusive shard locks
 // ============================================================================
 
 SourceIdT WideParamsDataStorage::add(InstrumentEntry *val)
 {
     SourceIdT id(subscrCounter_.fetch_add(1, std::memory_order_relaxed), 1);
     {
-        // Exclusive write lock
-        oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, true);
-        instruments_.insert(InstrumentsT::value_type(id, val));
+        std::lock_guard<std::mutex> lock(referenceLock_);
+        pending_.instruments_.insert(InstrumentsT::value_type(id, val));
         val->id_ = id;
-        instrumentsBySymbol_[val->symbol_] = id;
+        pending_.instrumentsBySymbol_[val->symbol_] = id;
+        publishReferenceData();
     }
     if (nullptr != storage_)
     {
@@ -206,9 +285,9 @@ SourceIdT WideParamsDataStorage::add(StringT *val)
 {
     SourceIdT id(subscrCounter_.fetch_add(1, std::memory_order_relaxed), 0);
     {
-        // Exclusive write lock
-        oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, true);
-        strings_.insert(StringsT::value_type(id, val));
+        OrderDataShard &shard = shardOf(id);
+        oneapi::tbb::spin_rw_mutex::scoped_lock lock(shard.lock_, true);
+        shard.strings_.insert(StringsT::value_type(id, val));
     }
     if (nullptr != storage_)
     {
@@ -221,9 +300,9 @@ SourceIdT WideParamsDataStorage::add(RawDataEntry *val)
 {
     SourceIdT id(subscrCounter_.fetch_add(1, std::memory_order_relaxed), 1);
     {
-        // Exclusive write lock
-        oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, true);
-        rawDatas_.insert(RawDataT::value_type(id, val));
+        OrderDataShard &shard = shardOf(id);
+        oneapi::tbb::spin_rw_mutex::scoped_lock lock(shard.lock_, true);
+        shard.rawDatas_.insert(RawDataT::value_type(id, val));
         val->id_ = id;
     }
     if (nullptr != storage_)
@@ -237,11 +316,11 @@ SourceIdT WideParamsDataStorage::add(AccountEntry *val)
 {
     SourceIdT id(subscrCounter_.fetch_add(1, std::memory_order_relaxed), 1);
     {
-        // Exclusive write lock
-        oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, true);
-        accounts_.insert(AccountsT::value_type(id, val));
+        std::lock_guard<std::mutex> lock(referenceLock_);
+        pending_.accounts_.insert(AccountsT::value_type(id, val));
         val->id_ = id;
-        accountsByName_[val->account_] = id;
+        pending_.accountsByName_[val->account_] = id;
+        publishReferenceData();
     }
     if (nullptr != storage_)
     {
@@ -254,10 +333,10 @@ SourceIdT WideParamsDataStorage::add(ClearingEntry *val)
 {
     SourceIdT id(subscrCounter_.fetch_add(1, std::memory_order_relaxed), 1);
     {
-        // Exclusive write lock
-        oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, true);
-        clearings_.insert(ClearingsT::value_type(id, val));
+        std::lock_guard<std::mutex> lock(referenceLock_);
+        pending_.clearings_.insert(ClearingsT::value_type(id, val));
         val->id_ = id;
+        publishReferenceData();
     }
     if (nullptr != storage_)
     {
@@ -270,9 +349,9 @@ SourceIdT WideParamsDataStorage::add(ExecutionsT *val)
 {
     SourceIdT id(subscrCounter_.fetch_add(1, std::memory_order_relaxed), 1);
     {
-        // Exclusive write lock
-        oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, true);
-        executions_.insert(ExecutionListsT::value_type(id, val));
+        OrderDataShard &shard = shardOf(id);
+        oneapi::tbb::spin_rw_mutex::scoped_lock lock(shard.lock_, true);
+        shard.executions_.insert(ExecutionListsT::value_type(id, val));
     }
     if (nullptr != storage_)
     {
@@ -282,7 +361,7 @@ SourceIdT WideParamsDataStorage::add(ExecutionsT *val)
 }
 
 // ============================================================================
-// Restore operations - use exclusive (write) locks
+// Restore operations - same locks as the write operations
 // ============================================================================
 
 void WideParamsDataStorage::restore(InstrumentEntry *val)
@@ -290,10 +369,10 @@ void WideParamsDataStorage::restore(InstrumentEntry *val)
     // Atomically update subscrCounter_ with exponential backoff
     casUpdateWithBackoff(subscrCounter_, val->id_.id_ + 1);
     {
-        // Exclusive write lock
-        oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, true);
-        instruments_.insert(InstrumentsT::value_type(val->id_, val));
-        instrumentsBySymbol_[val->symbol_] = val->id_;
+        std::lock_guard<std::mutex> lock(referenceLock_);
+        pending_.instruments_.insert(InstrumentsT::value_type(val->id_, val));
+        pending_.instrumentsBySymbol_[val->symbol_] = val->id_;
+        publishReferenceData();
     }
 }
 
@@ -302,9 +381,9 @@ void WideParamsDataStorage::restore(const IdT &id, StringT *val)
     // Atomically update subscrCounter_ with exponential backoff
     casUpdateWithBackoff(subscrCounter_, id.id_ + 1);
     {
-        // Exclusive write lock
-        oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, true);
-        strings_.insert(StringsT::value_type(id, val));
+        OrderDataShard &shard = shardOf(id);
+        oneapi::tbb::spin_rw_mutex::scoped_lock lock(shard.lock_, true);
+        shard.strings_.insert(StringsT::value_type(id, val));
     }
 }
 
@@ -313,9 +392,9 @@ void WideParamsDataStorage::restore(RawDataEntry *val)
     // Atomically update subscrCounter_ with exponential backoff
     casUpdateWithBackoff(subscrCounter_, val->id_.id_ + 1);
     {
-        // Exclusive write lock
-        oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, true);
-        rawDatas_.insert(RawDataT::value_type(val->id_, val));
+        OrderDataShard &shard = shardOf(val->id_);
+        oneapi::tbb::spin_rw_mutex::scoped_lock lock(shard.lock_, true);
+        shard.rawDatas_.insert(RawDataT::value_type(val->id_, val));
     }
 }
 
@@ -324,10 +403,10 @@ void WideParamsDataStorage::restore(AccountEntry *val)
     // Atomically update subscrCounter_ with exponential backoff
     casUpdateWithBackoff(subscrCounter_, val->id_.id_ + 1);
     {
-        // Exclusive write lock
-        oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, true);
-        accounts_.insert(AccountsT::value_type(val->id_, val));
-        accountsByName_[val->account_] = val->id_;
+        std::lock_guard<std::mutex> lock(referenceLock_);
+        pending_.accounts_.insert(AccountsT::value_type(val->id_, val));
+        pending_.accountsByName_[val->account_] = val->id_;
+        publishReferenceData();
     }
 }
 
@@ -336,9 +415,9 @@ void WideParamsDataStorage::restore(ClearingEntry *val)
     // Atomically update subscrCounter_ with exponential backoff
     casUpdateWithBackoff(subscrCounter_, val->id_.id_ + 1);
     {
-        // Exclusive write lock
-        oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, true);
-        clearings_.insert(ClearingsT::value_type(val->id_, val));
+        std::lock_guard<std::mutex> lock(referenceLock_);
+        pending_.clearings_.insert(ClearingsT::value_type(val->id_, val));
+        publishReferenceData();
     }
 }
 
@@ -13,8 +13,13 @@
 #pragma once
 
 #include <oneapi/tbb/spin_rw_mutex.h>
+#include <array>
 #include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include "Singleton.h"
 #include "FileStorageDef.h"
 #include "CacheAlignedAtomic.h"
@@ -46,6 +51,15 @@ public:
     void get(const SourceIdT &id, ClearingEntry *val) const;
     void get(const SourceIdT &id, ExecutionsT **val) const;
 
+    /// entry owned by the storage, valid until the storage is destroyed;
+    /// entries are never changed once added
+    void locate(const SourceIdT &id, const StringT **val) const;
+    void locate(const SourceIdT &id, const RawDataEntry **val) const;
+    void locate(const SourceIdT &id, const InstrumentEntry **val) const;
+    void locate(const SourceIdT &id, const AccountEntry **val) const;
+    void locate(const SourceIdT &id, const ClearingEntry **val) const;
+    void locate(const SourceIdT &id, ExecutionsT *const **val) const;
+
     SourceIdT add(InstrumentEntry *val);
     SourceIdT add(StringT *val);
     SourceIdT add(RawDataEntry *val);
@@ -55,6 +69,8 @@ public:
 
 public:
     /// reimplementeed from DataStorageRestore
+    virtual void startRestore();
+    virtual void finishRestore();
     virtual void restore(InstrumentEntry *val);
     virtual void restore(const IdT &id, StringT *val);
     virtual void restore(RawDataEntry *val);
@@ -63,37 +79,121 @@ public:
     virtual void restore(ExecutionsT *val);
 
 private:
-    /// Reader-writer lock for read-heavy reference data access
-    /// Allows concurrent reads, exclusive writes
-    mutable oneapi::tbb::spin_rw_mutex rwLock_;
-
-    /// Cache-aligned to prevent false sharing with rwLock_
-    CacheAlignedAtomic<u64> subscrCounter_;
-
     typedef std::map<SourceIdT, InstrumentEntry *> InstrumentsT;
-    InstrumentsT instruments_;
-    typedef std::map<SourceIdT, StringT *> StringsT;
-    StringsT strings_;
     typedef std::map<SourceIdT, AccountEntry *> AccountsT;
-    AccountsT accounts_;
     typedef std::map<SourceIdT, ClearingEntry *> ClearingsT;
-    ClearingsT clearings_;
-    typedef std::map<SourceIdT, RawDataEntry *> RawDataT;
-    RawDataT rawDatas_;
 
-    typedef std::map<SourceIdT, ExecutionsT *> ExecutionListsT;
-    ExecutionListsT executions_;
+    /// Immutable copy of the reference data, replaced as a whole when it changes
+    struct ReferenceData
+    {
+        InstrumentsT instruments_;
+        AccountsT accounts_;
+        ClearingsT clearings_;
+        std::map<StringT, SourceIdT> instrumentsBySymbol_;
+        std::map<StringT, SourceIdT> accountsByName_;
+    };
 
-    DataSaver *storage_;
+    typedef std::unordered_map<SourceIdT, StringT *, IdTHash> StringsT;
+    typedef std::unordered_map<SourceIdT, RawDataEntry *, IdTHash> RawDataT;
+    typedef std::unordered_map<SourceIdT, ExecutionsT *, IdTHash> ExecutionListsT;
+
+    /// Part of the per-order data, selected by the id
+    struct alignas(CACHE_LINE_SIZE) OrderDataShard
+    {
+        mutable oneapi::tbb::spin_rw_mutex lock_;
+        StringsT strings_;
+        RawDataT rawDatas_;
+        ExecutionListsT executions_;
+    };
+    static constexpr size_t ORDER_DATA_SHARDS = 16;
+
+    /// Readers of one half of the epoch, counted per slot to keep readers of
+    /// different threads off one cache line
+    struct alignas(CACHE_LINE_SIZE) ReaderSlot
+    {
+        std::atomic<u32> active_[2];
+    };
+    static constexpr size_t READER_SLOTS = 16;
+
+    /// Pins the published snapshot for its lifetime, a replaced snapshot is freed
+    /// once no reader pins it
+    class ReferenceReader
+    {
+    public:
+        explicit ReferenceReader(const WideParamsDataStorage &storage)
+            : active_(storage.readerSlots_[readerSlot()].active_[storage.readerEpoch_.load() & 1])
+        {
+            // counted before the load, a writer that does not see the count has already replaced the snapshot
+            active_.fetch_add(1);
+            data_ = storage.reference_.load();
+        }
+        ~ReferenceReader()
+        {
+            active_.fetch_sub(1, std::memory_order_release);
+        }
+        ReferenceReader(const ReferenceReader &) = delete;
+        ReferenceReader &operator=(const ReferenceReader &) = delete;
 
-    std::map<StringT, SourceIdT> instrumentsBySymbol_;
-    std::map<StringT, SourceIdT> accountsByName_;
+        const ReferenceData *operator->() const
+        {
+            return data_;
+        }
+
+    private:
+        static size_t readerSlot()
+        {
+            static std::atomic<size_t> nextSlot(0);
+            thread_local const size_t slot = nextSlot.fetch_add(1, std::memory_order_relaxed) & (READER_SLOTS - 1);
+            return slot;
+        }
+
+        std::atomic<u32> &active_;
+        const ReferenceData *data_;
+    };
+
+    /// replaces the snapshot with a copy of pending_ and frees the old one, referenceLock_ is held
+    void publishReferenceData();
+    /// returns once the readers that could have loaded the replaced snapshot are gone
+    void waitForReaders();
+
+    OrderDataShard &shardOf(const SourceIdT &id)
+    {
+        return shards_[id.id_ & (ORDER_DATA_SHARDS - 1)];
+    }
+    const OrderDataShard &shardOf(const SourceIdT &id) const
+    {
+        return shards_[id.id_ & (ORDER_DATA_SHARDS - 1)];
+    }
+
+private:
+    /// Reference data (instruments, accounts, clearings) is read on every order
+    /// and changes rarely. Readers pin the published snapshot without a lock;
+    /// writers change pending_ under referenceLock_ and publish a copy of it.
+    /// Between startRestore() and finishRestore() the copy is made once.
+    std::atomic<const ReferenceData *> reference_;
+    std::mutex referenceLock_;
+    ReferenceData pending_;
+    bool restoring_;
+    bool unpublished_;
+    /// readers count themselves in the half selected by the low bit
+    std::atomic<u32> readerEpoch_;
+    mutable std::array<ReaderSlot, READER_SLOTS> readerSlots_;
+
+    /// Cache-aligned to prevent false sharing with the reference data
+    CacheAlignedAtomic<u64> subscrCounter_;
+
+    /// Per-order data (strings, raw data, execution lists) is added with every
+    /// order; ids are consecutive, so orders entered at once use different shards.
+    std::array<OrderDataShard, ORDER_DATA_SHARDS> shards_;
+
+    DataSaver *storage_;
 
 public:
+    /// fn must not add reference data, the snapshot stays pinned while it runs
     template <typename Fn> void forEachInstrument(Fn &&fn) const
     {
-        oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, false);
-        for (const auto &[id, entry] : instruments_)
+        ReferenceReader data(*this);
+        for (const auto &[id, entry] : data->instruments_)
         {
             fn(id, *entry);
         }
@@ -101,18 +201,53 @@ public:
 
     template <typename Fn> void forEachAccount(Fn &&fn) const
     {
-        oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, false);
-        for (const auto &[id, entry] : accounts_)
+        ReferenceReader data(*this);
+        for (const auto &[id, entry] : data->accounts_)
         {
             fn(id, *entry);
         }
     }
 
+    /// visits strings shard by shard, not in the order of ids
+    template <typename Fn> void forEachString(Fn &&fn) const
+    {
+        for (const OrderDataShard &shard : shards_)
+        {
+            oneapi::tbb::spin_rw_mutex::scoped_lock lock(shard.lock_, false);
+            for (const auto &[id, entry] : shard.strings_)
+            {
+                fn(id, *entry);
+            }
+        }
+    }
+
+    template <typename Fn> void forEachClearing(Fn &&fn) const
+    {
+        ReferenceReader data(*this);
+        for (const auto &[id, entry] : data->clearings_)
+        {
+            fn(id, *entry);
+        }
+    }
+
+    /// visits raw data shard by shard, not in the order of ids
+    template <typename Fn> void forEachRawData(Fn &&fn) const
+    {
+        for (const OrderDataShard &shard : shards_)
+        {
+            oneapi::tbb::spin_rw_mutex::scoped_lock lock(shard.lock_, false);
+            for (const auto &[id, entry] : shard.rawDatas_)
+            {
+                fn(id, *entry);
+            }
+        }
+    }
+
     SourceIdT findInstrumentBySymbol(const StringT &symbol) const
     {
-        oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, false);
-        auto it = instrumentsBySymbol_.find(symbol);
-        if (it == instrumentsBySymbol_.end())
+        ReferenceReader data(*this);
+        auto it = data->instrumentsBySymbol_.find(symbol);
+        if (it == data->instrumentsBySymbol_.end())
         {
             return SourceIdT();
         }
@@ -121,9 +256,9 @@ public:
 
     SourceIdT findAccountByName(const StringT &name) const
     {
-        oneapi::tbb::spin_rw_mutex::scoped_lock lock(rwLock_, false);
-        auto it = accountsByName_.find(name);
-        if (it == accountsByName_.end())
+        ReferenceReader data(*this);
+        auto it = data->accountsByName_.find(name);
+        if (it == data->accountsByName_.end())
         {
             return SourceIdT();
         }
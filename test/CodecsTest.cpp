@@ -10,6 +10,7 @@
 */
 
 #include <gtest/gtest.h>
+#include <cstring>
 #include <memory>
 #include <string>
 
@@ -20,6 +21,7 @@
 #include "ClearingCodec.h"
 #include "RawDataCodec.h"
 #include "OrderCodec.h"
+#include "ExecutionCodec.h"
 #include "WideDataStorage.h"
 
 using namespace COP;
@@ -352,4 +354,183 @@ TEST_F(OrderCodecTest, OrderCodecFilled)
     EXPECT_EQ(decVal->orderId_, val.orderId_);
 }
 
+OrderEntry *createFilledOrder(const SourceIdT &instrId)
+{
+    std::unique_ptr<OrderEntry> val(new OrderEntry(SourceIdT(1, 1), SourceIdT(2, 2), SourceIdT(3, 3), SourceIdT(4, 4),
+                                                   instrId, SourceIdT(6, 6), SourceIdT(7, 7), SourceIdT(8, 8)));
+    val->orderId_ = IdT(4444, 4445);
+    val->origOrderId_ = IdT(3333, 4445);
+    val->creationTime_ = 1111;
+    val->lastUpdateTime_ = 1112;
+    val->expireTime_ = 1113;
+    val->settlDate_ = 1114;
+    val->price_ = 22.22;
+    val->stopPx_ = 21.5;
+    val->avgPx_ = 22.1;
+    val->dayAvgPx_ = 22.05;
+    val->status_ = PARTFILL_ORDSTATUS;
+    val->side_ = SELL_SIDE;
+    val->ordType_ = LIMIT_ORDERTYPE;
+    val->tif_ = DAY_TIF;
+    val->settlType_ = _0_SETTLTYPE;
+    val->capacity_ = AGENCY_CAPACITY;
+    val->currency_ = USD_CURRENCY;
+    val->minQty_ = 10;
+    val->orderQty_ = 1000;
+    val->leavesQty_ = 600;
+    val->cumQty_ = 400;
+    val->dayOrderQty_ = 1000;
+    val->dayCumQty_ = 400;
+    val->stateMachinePersistance_.stateZone1Id_ = 3;
+    val->stateMachinePersistance_.stateZone2Id_ = 5;
+    return val.release();
+}
+
+TEST_F(OrderCodecTest, OrderCodecFixedRecord)
+{
+    std::unique_ptr<OrderEntry> val(createFilledOrder(addInstrument("instrument")));
+    std::string buf("prefix");
+    IdT id;
+    u32 version = 0;
+    OrderCodec::encode(*val, &buf, &id, &version);
+    ASSERT_EQ(6 + OrderCodec::RECORD_SIZE, buf.size());
+
+    char reserved[OrderCodec::RECORD_SIZE];
+    EXPECT_EQ(reserved + OrderCodec::RECORD_SIZE, OrderCodec::encode(*val, reserved, &id, &version));
+    EXPECT_EQ(0, memcmp(reserved, buf.data() + 6, OrderCodec::RECORD_SIZE));
+
+    std::unique_ptr<OrderEntry> decVal(OrderCodec::decode(id, version, reserved, sizeof(reserved)));
+    ASSERT_NE(nullptr, decVal.get());
+    EXPECT_TRUE(decVal->compare(*val));
+}
+
+TEST_F(OrderCodecTest, OrderCodecDecodesDelimitedRecord)
+{
+    std::unique_ptr<OrderEntry> val(createFilledOrder(addInstrument("instrument")));
+    std::string delimited;
+    std::string record;
+    IdT id;
+    u32 version = 0;
+    OrderCodec::encodeDelimited(*val, &delimited, &id, &version);
+    OrderCodec::encode(*val, &record, &id, &version);
+    EXPECT_NE(delimited.size(), record.size());
+
+    std::unique_ptr<OrderEntry> fromDelimited(OrderCodec::decode(id, version, delimited.c_str(), delimited.size()));
+    std::unique_ptr<OrderEntry> fromRecord(OrderCodec::decode(id, version, record.c_str(), record.size()));
+    ASSERT_NE(nullptr, fromDelimited.get());
+    ASSERT_NE(nullptr, fromRecord.get());
+    EXPECT_TRUE(fromDelimited->compare(*val));
+    EXPECT_TRUE(fromRecord->compare(*fromDelimited));
+}
+
+TEST_F(OrderCodecTest, OrderCodecDamagedRecordThrows)
+{
+    std::unique_ptr<OrderEntry> val(createFilledOrder(addInstrument("instrument")));
+    std::string buf;
+    IdT id;
+    u32 version = 0;
+    OrderCodec::encode(*val, &buf, &id, &version);
+
+    EXPECT_THROW(OrderCodec::decode(id, version, buf.c_str(), buf.size() - 1), std::runtime_error);
+    buf[0] = 'X';
+    EXPECT_THROW(OrderCodec::decode(id, version, buf.c_str(), buf.size()), std::runtime_error);
+}
+
+// =============================================================================
+// ExecutionCodec Tests
+// =============================================================================
+
+void fillExecution(ExecutionEntry *val, ExecType type)
+{
+    val->type_ = type;
+    val->transactTime_ = 1111;
+    val->orderId_ = IdT(4444, 4445);
+    val->execId_ = IdT(5555, 4445);
+    val->orderStatus_ = PARTFILL_ORDSTATUS;
+    val->market_ = "XNAS";
+}
+
+TEST(ExecutionCodecTest, TradeRoundTrip)
+{
+    TradeExecEntry val;
+    fillExecution(&val, TRADE_EXECTYPE);
+    val.lastQty_ = 300;
+    val.lastPx_ = 22.5;
+    val.currency_ = USD_CURRENCY;
+    val.tradeDate_ = 1112;
+
+    std::string buf;
+    IdT id;
+    u32 version = 0;
+    ExecutionCodec::encode(val, &buf, &id, &version);
+    EXPECT_EQ(val.execId_, id);
+
+    std::unique_ptr<ExecutionEntry> decVal(ExecutionCodec::decode(id, version, buf.c_str(), buf.size()));
+    const TradeExecEntry *trade = dynamic_cast<const TradeExecEntry *>(decVal.get());
+    ASSERT_NE(nullptr, trade);
+    EXPECT_EQ(TRADE_EXECTYPE, trade->type_);
+    EXPECT_EQ(1111u, trade->transactTime_);
+    EXPECT_EQ(val.orderId_, trade->orderId_);
+    EXPECT_EQ(val.execId_, trade->execId_);
+    EXPECT_EQ(PARTFILL_ORDSTATUS, trade->orderStatus_);
+    EXPECT_EQ("XNAS", trade->market_);
+    EXPECT_EQ(300u, trade->lastQty_);
+    EXPECT_DOUBLE_EQ(22.5, trade->lastPx_);
+    EXPECT_EQ(USD_CURRENCY, trade->currency_);
+    EXPECT_EQ(1112u, trade->tradeDate_);
+}
+
+TEST(ExecutionCodecTest, RejectAndCorrectRoundTrip)
+{
+    RejectExecEntry reject;
+    fillExecution(&reject, REJECT_EXECTYPE);
+    reject.rejectReason_ = "Unknown instrument";
+    ExecCorrectExecEntry correct;
+    fillExecution(&correct, CORRECT_EXECTYPE);
+    correct.cumQty_ = 400;
+    correct.leavesQty_ = 600;
+    correct.lastQty_ = 100;
+    correct.lastPx_ = 21.5;
+    correct.execRefId_ = IdT(5554, 4445);
+    correct.origOrderId_ = IdT(3333, 4445);
+
+    std::string buf;
+    IdT id;
+    u32 version = 0;
+    ExecutionCodec::encode(reject, &buf, &id, &version);
+    std::unique_ptr<ExecutionEntry> decReject(ExecutionCodec::decode(id, version, buf.c_str(), buf.size()));
+    const RejectExecEntry *rejectVal = dynamic_cast<const RejectExecEntry *>(decReject.get());
+    ASSERT_NE(nullptr, rejectVal);
+    EXPECT_EQ("Unknown instrument", rejectVal->rejectReason_);
+    EXPECT_EQ("XNAS", rejectVal->market_);
+
+    buf.clear();
+    ExecutionCodec::encode(correct, &buf, &id, &version);
+    std::unique_ptr<ExecutionEntry> decCorrect(ExecutionCodec::decode(id, version, buf.c_str(), buf.size()));
+    const ExecCorrectExecEntry *correctVal = dynamic_cast<const ExecCorrectExecEntry *>(decCorrect.get());
+    ASSERT_NE(nullptr, correctVal);
+    EXPECT_EQ(400u, correctVal->cumQty_);
+    EXPECT_EQ(600u, correctVal->leavesQty_);
+    EXPECT_EQ(100u, correctVal->lastQty_);
+    EXPECT_DOUBLE_EQ(21.5, correctVal->lastPx_);
+    EXPECT_EQ(correct.execRefId_, correctVal->execRefId_);
+    EXPECT_EQ(correct.origOrderId_, correctVal->origOrderId_);
+}
+
+TEST(ExecutionCodecTest, DamagedRecordThrows)
+{
+    ExecutionEntry val;
+    fillExecution(&val, NEW_EXECTYPE);
+    std::string buf;
+    IdT id;
+    u32 version = 0;
+    ExecutionCodec::encode(val, &buf, &id, &version);
+    std::unique_ptr<ExecutionEntry> decVal(ExecutionCodec::decode(id, version, buf.c_str(), buf.size()));
+    EXPECT_EQ(NEW_EXECTYPE, decVal->type_);
+
+    EXPECT_THROW(ExecutionCodec::decode(id, version, buf.c_str(), buf.size() - 1), std::runtime_error);
+    buf[1] = 'Z';
+    EXPECT_THROW(ExecutionCodec::decode(id, version, buf.c_str(), buf.size()), std::runtime_error);
+}
+
 } // namespace
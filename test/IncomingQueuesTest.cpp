@@ -35,6 +35,11 @@ public:
         return false;
     }
 
+    u32 processBatch(u32) override
+    {
+        return 0;
+    }
+
     void onEvent(const std::string &source, const OrderEvent &evnt) override
     {
         orders_.push_back({ source, evnt });
@@ -405,4 +410,190 @@ TEST_F(IncomingQueuesTest, TopIsIdempotentWithoutPop)
     EXPECT_EQ(1u, queues_->size());
 }
 
+// =============================================================================
+// Batch Drain Tests
+// =============================================================================
+
+TEST_F(IncomingQueuesTest, PopBatchOnEmptyQueueReturnsZero)
+{
+    EXPECT_EQ(0u, queues_->popBatch(observer_.get(), 16));
+}
+
+TEST_F(IncomingQueuesTest, PopBatchDrainsUpToMaxEventsInOrder)
+{
+    for (u32 i = 1; i <= 5; ++i)
+    {
+        queues_->push("source", OrderCancelEvent(IdT(i, 1)));
+    }
+
+    EXPECT_EQ(3u, queues_->popBatch(observer_.get(), 3));
+    EXPECT_EQ(2u, queues_->size());
+    ASSERT_EQ(3u, observer_->orderCancels_.size());
+    EXPECT_EQ(IdT(1, 1), observer_->orderCancels_[0].second.id_);
+    EXPECT_EQ(IdT(3, 1), observer_->orderCancels_[2].second.id_);
+
+    EXPECT_EQ(2u, queues_->popBatch(observer_.get(), 16));
+    EXPECT_EQ(0u, queues_->size());
+    ASSERT_EQ(5u, observer_->orderCancels_.size());
+    EXPECT_EQ(IdT(5, 1), observer_->orderCancels_[4].second.id_);
+}
+
+TEST_F(IncomingQueuesTest, PopBatchStartsWithPendingTopEvent)
+{
+    queues_->push("source", OrderCancelEvent(IdT(1, 1)));
+    queues_->push("source", OrderCancelEvent(IdT(2, 1)));
+
+    EXPECT_TRUE(queues_->top(observer_.get()));
+    observer_->clearAll();
+
+    EXPECT_EQ(2u, queues_->popBatch(observer_.get(), 2));
+    ASSERT_EQ(2u, observer_->orderCancels_.size());
+    EXPECT_EQ(IdT(1, 1), observer_->orderCancels_[0].second.id_);
+    EXPECT_EQ(IdT(2, 1), observer_->orderCancels_[1].second.id_);
+    EXPECT_EQ(0u, queues_->size());
+}
+
+// =============================================================================
+// Ring Buffer Backend Tests
+// =============================================================================
+
+TEST_F(IncomingQueuesTest, InvalidBackendThrows)
+{
+    EXPECT_THROW(IncomingQueues(IncomingQueues::INVALID_INGRESS), std::runtime_error);
+    EXPECT_THROW(IncomingQueues(IncomingQueues::RING_BUFFER_INGRESS, 0), std::runtime_error);
+}
+
+TEST_F(IncomingQueuesTest, RingBackendDeliversEventsInFIFOOrder)
+{
+    IncomingQueues ring(IncomingQueues::RING_BUFFER_INGRESS, 8);
+    EXPECT_EQ(IncomingQueues::RING_BUFFER_INGRESS, ring.backend());
+
+    ring.push("source", OrderCancelEvent(IdT(1, 1)));
+    ring.push("source", OrderReplaceEvent(IdT(2, 1)));
+    ring.push("source", OrderCancelEvent(IdT(3, 1)));
+    EXPECT_EQ(3u, ring.size());
+
+    EXPECT_TRUE(ring.top(observer_.get()));
+    ring.pop();
+    EXPECT_EQ(2u, ring.popBatch(observer_.get(), 16));
+    EXPECT_EQ(0u, ring.size());
+    EXPECT_FALSE(ring.top(observer_.get()));
+
+    ASSERT_EQ(2u, observer_->orderCancels_.size());
+    ASSERT_EQ(1u, observer_->orderReplaces_.size());
+    EXPECT_EQ(IdT(1, 1), observer_->orderCancels_[0].second.id_);
+    EXPECT_EQ(IdT(2, 1), observer_->orderReplaces_[0].second.id_);
+    EXPECT_EQ(IdT(3, 1), observer_->orderCancels_[1].second.id_);
+    EXPECT_EQ("source", observer_->orderCancels_[1].first);
+}
+
+TEST_F(IncomingQueuesTest, RingBackendWrapsAroundCapacity)
+{
+    IncomingQueues ring(IncomingQueues::RING_BUFFER_INGRESS, 4);
+    for (u32 i = 1; i <= 20; ++i)
+    {
+        ring.push("source", OrderCancelEvent(IdT(i, 1)));
+        EXPECT_EQ(1u, ring.popBatch(observer_.get(), 4));
+    }
+    ASSERT_EQ(20u, observer_->orderCancels_.size());
+    EXPECT_EQ(IdT(20, 1), observer_->orderCancels_[19].second.id_);
+    EXPECT_EQ(0u, ring.backpressureCount());
+}
+
+TEST_F(IncomingQueuesTest, RingBackendTryPushRejectsWhileFull)
+{
+    IncomingQueues ring(IncomingQueues::RING_BUFFER_INGRESS, 2);
+    EXPECT_TRUE(ring.tryPush("source", OrderCancelEvent(IdT(1, 1))));
+    EXPECT_TRUE(ring.tryPush("source", OrderCancelEvent(IdT(2, 1))));
+    EXPECT_TRUE(ring.full());
+
+    EXPECT_FALSE(ring.tryPush("source", OrderCancelEvent(IdT(3, 1))));
+    EXPECT_EQ(1u, ring.backpressureCount());
+    EXPECT_EQ(2u, ring.size());
+
+    EXPECT_EQ(1u, ring.popBatch(observer_.get(), 1));
+    EXPECT_FALSE(ring.full());
+    EXPECT_TRUE(ring.tryPush("source", OrderCancelEvent(IdT(3, 1))));
+
+    EXPECT_EQ(2u, ring.popBatch(observer_.get(), 16));
+    ASSERT_EQ(3u, observer_->orderCancels_.size());
+    EXPECT_EQ(IdT(3, 1), observer_->orderCancels_[2].second.id_);
+    EXPECT_EQ(0u, ring.overflowCount());
+}
+
+TEST_F(IncomingQueuesTest, RingBackendPushOverflowsWhileFull)
+{
+    IncomingQueues ring(IncomingQueues::RING_BUFFER_INGRESS, 2);
+    ring.push("source", OrderCancelEvent(IdT(1, 1)));
+    ring.push("source", OrderCancelEvent(IdT(2, 1)));
+    EXPECT_TRUE(ring.full());
+
+    // does not wait for a consumer
+    ring.push("source", OrderCancelEvent(IdT(3, 1)));
+    EXPECT_EQ(1u, ring.overflowCount());
+    EXPECT_EQ(3u, ring.size());
+
+    // the overflow counts against the external bound
+    EXPECT_EQ(1u, ring.popBatch(observer_.get(), 1));
+    EXPECT_FALSE(ring.tryPush("source", OrderCancelEvent(IdT(4, 1))));
+    EXPECT_EQ(1u, ring.backpressureCount());
+
+    EXPECT_EQ(2u, ring.popBatch(observer_.get(), 16));
+    EXPECT_EQ(0u, ring.size());
+    ASSERT_EQ(3u, observer_->orderCancels_.size());
+    EXPECT_EQ(IdT(1, 1), observer_->orderCancels_[0].second.id_);
+    EXPECT_EQ(IdT(2, 1), observer_->orderCancels_[1].second.id_);
+    EXPECT_EQ(IdT(3, 1), observer_->orderCancels_[2].second.id_);
+}
+
+TEST_F(IncomingQueuesTest, RingBackendKeepsOrderWhileOverflowDrains)
+{
+    IncomingQueues ring(IncomingQueues::RING_BUFFER_INGRESS, 2);
+    for (u32 i = 1; i <= 4; ++i)
+    {
+        ring.push("source", OrderCancelEvent(IdT(i, 1)));
+    }
+    EXPECT_EQ(2u, ring.overflowCount());
+
+    // the ring has free slots now, but the overflow is not drained yet
+    EXPECT_EQ(2u, ring.popBatch(observer_.get(), 2));
+    ring.push("source", OrderCancelEvent(IdT(5, 1)));
+    EXPECT_EQ(3u, ring.overflowCount());
+
+    EXPECT_EQ(3u, ring.popBatch(observer_.get(), 16));
+    ASSERT_EQ(5u, observer_->orderCancels_.size());
+    for (u32 i = 0; i < 5; ++i)
+    {
+        EXPECT_EQ(IdT(i + 1, 1), observer_->orderCancels_[i].second.id_);
+    }
+
+    // drained overflow lets events into the ring again
+    ring.push("source", OrderCancelEvent(IdT(6, 1)));
+    EXPECT_EQ(3u, ring.overflowCount());
+}
+
+TEST_F(IncomingQueuesTest, RingBackendReportsFullThroughInQueues)
+{
+    IncomingQueues ring(IncomingQueues::RING_BUFFER_INGRESS, 2);
+    InQueues *producer = &ring;
+    producer->push("source", OrderCancelEvent(IdT(1, 1)));
+    EXPECT_FALSE(producer->full());
+    producer->push("source", OrderCancelEvent(IdT(2, 1)));
+    EXPECT_TRUE(producer->full());
+
+    EXPECT_EQ(1u, ring.popBatch(observer_.get(), 1));
+    EXPECT_FALSE(producer->full());
+}
+
+TEST_F(IncomingQueuesTest, ConcurrentQueueBackendTryPushAlwaysAccepts)
+{
+    for (u32 i = 1; i <= 3; ++i)
+    {
+        EXPECT_TRUE(queues_->tryPush("source", OrderCancelEvent(IdT(i, 1))));
+    }
+    EXPECT_FALSE(queues_->full());
+    EXPECT_EQ(3u, queues_->popBatch(observer_.get(), 16));
+    EXPECT_EQ(0u, queues_->backpressureCount());
+}
+
 } // namespace
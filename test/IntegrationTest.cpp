@@ -117,6 +117,11 @@ public:
         return false;
     }
 
+    u32 processBatch(u32) override
+    {
+        return 0;
+    }
+
     void onEvent(const std::string &source, const OrderEvent &evnt) override
     {
         orders_.push_back({ source, evnt });
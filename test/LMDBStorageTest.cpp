@@ -479,4 +479,202 @@ TEST_F(LMDBStorageTest, MultipleRecordsDifferentIds)
     }
 }
 
+// =============================================================================
+// Durability Mode Tests
+// =============================================================================
+
+class LMDBDurabilityTest : public LMDBStorageTest,
+                           public ::testing::WithParamInterface<LMDBStorageParams::DurabilityMode>
+{
+};
+
+TEST_P(LMDBDurabilityTest, SaveAndReload)
+{
+    LMDBStorageParams params;
+    params.durability_ = GetParam();
+    params.syncIntervalMs_ = 1;
+    {
+        TestLMDBObserver observer;
+        LMDBStorage storage(testDir_, &observer, params);
+        EXPECT_EQ(GetParam(), storage.durability());
+        storage.save(IdT(1, 1), "first", 5);
+        storage.update(IdT(1, 1), "second", 6);
+        storage.sync();
+    }
+    {
+        TestLMDBObserver observer;
+        LMDBStorage storage(testDir_, &observer, params);
+        ASSERT_EQ(2u, observer.records_.size());
+        EXPECT_EQ(1u, storage.getTopVersion(IdT(1, 1)));
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Modes, LMDBDurabilityTest,
+                         ::testing::Values(LMDBStorageParams::FULL_SYNC_DURABILITY,
+                                           LMDBStorageParams::NO_META_SYNC_DURABILITY,
+                                           LMDBStorageParams::NO_SYNC_DURABILITY,
+                                           LMDBStorageParams::WRITE_MAP_ASYNC_DURABILITY));
+
+TEST_F(LMDBStorageTest, InvalidDurabilityThrows)
+{
+    LMDBStorageParams params;
+    params.durability_ = LMDBStorageParams::INVALID_DURABILITY;
+    TestLMDBObserver observer;
+    EXPECT_THROW(LMDBStorage(testDir_, &observer, params), std::runtime_error);
+}
+
+TEST_F(LMDBStorageTest, MapGrowsWhenFull)
+{
+    LMDBStorageParams params;
+    params.mapSize_ = 64 * 1024;
+    TestLMDBObserver observer;
+    LMDBStorage storage(testDir_, &observer, params);
+
+    const std::string data(1024, 'x');
+    for (u64 i = 1; i <= 256; ++i)
+    {
+        storage.save(IdT(i, 1), data.c_str(), data.size());
+    }
+    EXPECT_LT(params.mapSize_, storage.mapSize());
+    for (u64 i = 1; i <= 256; ++i)
+    {
+        EXPECT_TRUE(storage.isExists(IdT(i, 1)));
+    }
+}
+
+TEST_F(LMDBStorageTest, MapGrowthStopsAtLimit)
+{
+    LMDBStorageParams params;
+    params.mapSize_ = 64 * 1024;
+    params.maxMapSize_ = 128 * 1024;
+    TestLMDBObserver observer;
+    LMDBStorage storage(testDir_, &observer, params);
+
+    const std::string data(1024, 'x');
+    EXPECT_THROW(
+        {
+            for (u64 i = 1; i <= 256; ++i)
+            {
+                storage.save(IdT(i, 1), data.c_str(), data.size());
+            }
+        },
+        std::runtime_error);
+    EXPECT_EQ(params.maxMapSize_, storage.mapSize());
+}
+
+TEST_F(LMDBStorageTest, SaveReservedEncodesIntoValue)
+{
+    class FillEncoder : public RecordEncoder
+    {
+    public:
+        void encode(char *buf, size_t size) const override
+        {
+            memset(buf, 'z', size);
+        }
+    };
+
+    TestLMDBObserver observer;
+    LMDBStorage storage(testDir_, &observer);
+    storage.saveReserved(IdT(1, 1), 16, FillEncoder());
+    EXPECT_THROW(storage.saveReserved(IdT(1, 1), 16, FillEncoder()), std::runtime_error);
+
+    std::vector<char> buf;
+    ASSERT_TRUE(storage.loadRecord(IdT(1, 1), 0, &buf));
+    EXPECT_EQ(std::string(16, 'z'), std::string(buf.begin(), buf.end()));
+}
+
+// =============================================================================
+// Journal Tests
+// =============================================================================
+
+TEST_F(LMDBStorageTest, ReplayPassesRecordsAfterSequence)
+{
+    LMDBStorageParams params;
+    params.journal_ = true;
+    TestLMDBObserver observer;
+    LMDBStorage storage(testDir_, &observer, params);
+
+    storage.save(IdT(1, 1), "first", 5);
+    storage.save(IdT(2, 1), "second", 6);
+    const u64 seq = storage.lastSequence();
+    EXPECT_EQ(2u, seq);
+    storage.update(IdT(1, 1), "third", 5);
+
+    TestLMDBObserver replayed;
+    EXPECT_EQ(3u, storage.replay(seq, &replayed));
+    ASSERT_EQ(1u, replayed.records_.size());
+    EXPECT_EQ(IdT(1, 1), replayed.ids_[0]);
+    EXPECT_EQ(1u, replayed.versions_[0]);
+    EXPECT_EQ("third", replayed.records_[0]);
+
+    replayed.reset();
+    EXPECT_EQ(3u, storage.replay(0, &replayed));
+    EXPECT_EQ(3u, replayed.records_.size());
+}
+
+TEST_F(LMDBStorageTest, TruncatedJournalKeepsSequence)
+{
+    LMDBStorageParams params;
+    params.journal_ = true;
+    {
+        TestLMDBObserver observer;
+        LMDBStorage storage(testDir_, &observer, params);
+        storage.save(IdT(1, 1), "first", 5);
+        storage.save(IdT(2, 1), "second", 6);
+        storage.truncateJournal(storage.lastSequence());
+
+        // the last entry stays to keep the sequence
+        TestLMDBObserver replayed;
+        EXPECT_EQ(2u, storage.replay(0, &replayed));
+        EXPECT_EQ(1u, replayed.records_.size());
+    }
+    {
+        TestLMDBObserver observer;
+        LMDBStorage storage(testDir_, &observer, params);
+        EXPECT_EQ(2u, storage.lastSequence());
+        storage.save(IdT(3, 1), "third", 5);
+        EXPECT_EQ(3u, storage.lastSequence());
+
+        TestLMDBObserver replayed;
+        EXPECT_EQ(3u, storage.replay(2, &replayed));
+        ASSERT_EQ(1u, replayed.records_.size());
+        EXPECT_EQ("third", replayed.records_[0]);
+    }
+}
+
+TEST_F(LMDBStorageTest, ReplayWithoutJournalThrows)
+{
+    TestLMDBObserver observer;
+    LMDBStorage storage(testDir_, &observer);
+    storage.save(IdT(1, 1), "first", 5);
+    EXPECT_EQ(0u, storage.lastSequence());
+    EXPECT_THROW(storage.replay(0, &observer), std::runtime_error);
+}
+
+TEST_F(LMDBStorageTest, EraseWithJournalThrows)
+{
+    LMDBStorageParams params;
+    params.journal_ = true;
+    TestLMDBObserver observer;
+    LMDBStorage storage(testDir_, &observer, params);
+    storage.save(IdT(1, 1), "first", 5);
+
+    EXPECT_THROW(storage.erase(IdT(1, 1), 0), std::runtime_error);
+    EXPECT_THROW(storage.erase(IdT(1, 1)), std::runtime_error);
+
+    LMDBStorage::WriteBatchT batch;
+    batch.push_back(LMDBStorage::WriteRecord(LMDBStorage::WriteRecord::SAVE_WRITE, IdT(2, 1), 0));
+    batch.back().data_ = "second";
+    batch.push_back(LMDBStorage::WriteRecord(LMDBStorage::WriteRecord::ERASE_ALL_WRITE, IdT(1, 1), 0));
+    std::vector<size_t> failed;
+    EXPECT_EQ(1u, storage.writeSkippingFailed(batch, &failed));
+    ASSERT_EQ(1u, failed.size());
+    EXPECT_EQ(1u, failed[0]);
+
+    // the record stays and replay still passes it
+    TestLMDBObserver replayed;
+    EXPECT_EQ(2u, storage.replay(0, &replayed));
+    EXPECT_EQ(2u, replayed.records_.size());
+}
+
 } // namespace
@@ -0,0 +1,235 @@
+/**
+ Concurrent Order Processor library - Google Test
+
+ Authors: dudleylane, Claude
+ Test: 2026
+
+ Copyright (C) 2026 dudleylane
+
+ Distributed under the GNU Affero General Public License (AGPL).
+*/
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <string>
+#include <thread>
+#include <filesystem>
+
+#include "LMDBWriteBehind.h"
+
+using namespace COP;
+using namespace COP::Store;
+
+namespace
+{
+
+class CollectingObserver : public FileStorageObserver
+{
+public:
+    void startLoad() override {}
+
+    void onRecordLoaded(const IdT &id, u32 /*version*/, const char *ptr, size_t s) override
+    {
+        ids_.push_back(id);
+        records_.push_back(std::string(ptr, s));
+    }
+
+    void finishLoad() override {}
+
+public:
+    std::vector<IdT> ids_;
+    std::vector<std::string> records_;
+};
+
+class LMDBWriteBehindTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        testDir_ = "test_lmdb_write_behind";
+        std::filesystem::remove_all(testDir_);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(testDir_);
+    }
+
+    size_t reloadCount()
+    {
+        CollectingObserver observer;
+        LMDBStorage storage(testDir_, &observer);
+        return observer.records_.size();
+    }
+
+protected:
+    std::string testDir_;
+};
+
+// =============================================================================
+// Batched Writes
+// =============================================================================
+
+TEST_F(LMDBWriteBehindTest, StorageWriteAppliesBatchInOneTransaction)
+{
+    CollectingObserver observer;
+    LMDBStorage storage(testDir_, &observer);
+    storage.save(IdT(3, 1), "cccc", 4);
+
+    LMDBStorage::WriteBatchT batch;
+    batch.push_back(LMDBStorage::WriteRecord(LMDBStorage::WriteRecord::SAVE_WRITE, IdT(1, 1), 0));
+    batch.back().data_ = "aaaa";
+    batch.push_back(LMDBStorage::WriteRecord(LMDBStorage::WriteRecord::SAVE_WRITE, IdT(2, 1), 0));
+    batch.back().data_ = "bbbb";
+    batch.push_back(LMDBStorage::WriteRecord(LMDBStorage::WriteRecord::ERASE_ALL_WRITE, IdT(3, 1), 0));
+    storage.write(batch);
+
+    EXPECT_TRUE(storage.isExists(IdT(1, 1)));
+    EXPECT_TRUE(storage.isExists(IdT(2, 1)));
+    EXPECT_FALSE(storage.isExists(IdT(3, 1)));
+}
+
+TEST_F(LMDBWriteBehindTest, StorageWriteIsAllOrNothing)
+{
+    CollectingObserver observer;
+    LMDBStorage storage(testDir_, &observer);
+    storage.save(IdT(2, 1), "bbbb", 4);
+
+    LMDBStorage::WriteBatchT batch;
+    batch.push_back(LMDBStorage::WriteRecord(LMDBStorage::WriteRecord::SAVE_WRITE, IdT(1, 1), 0));
+    batch.back().data_ = "aaaa";
+    batch.push_back(LMDBStorage::WriteRecord(LMDBStorage::WriteRecord::SAVE_WRITE, IdT(2, 1), 0));
+    batch.back().data_ = "dup";
+    EXPECT_THROW(storage.write(batch), std::runtime_error);
+    EXPECT_FALSE(storage.isExists(IdT(1, 1)));
+
+    EXPECT_EQ(1u, storage.writeSkippingFailed(batch));
+    EXPECT_TRUE(storage.isExists(IdT(1, 1)));
+}
+
+// =============================================================================
+// Write-Behind Stage
+// =============================================================================
+
+TEST_F(LMDBWriteBehindTest, SavedRecordsAreDurableAfterWait)
+{
+    CollectingObserver observer;
+    LMDBStorage storage(testDir_, &observer);
+    LMDBWriteBehindParams params;
+    params.maxBatchSize_ = 8;
+    LMDBWriteBehind writer(&storage, params);
+
+    LMDBWriteBehind::TicketT ticket = 0;
+    for (u64 i = 1; i <= 20; ++i)
+    {
+        writer.save(IdT(i, 1), "record", 6);
+        ticket = writer.lastTicket();
+    }
+    EXPECT_EQ(20u, ticket);
+    EXPECT_TRUE(writer.waitDurable(ticket, 5000));
+    EXPECT_LE(ticket, writer.durableTicket());
+    EXPECT_EQ(20u, writer.totalWritten());
+    EXPECT_GE(writer.totalBatches(), 3u);
+    EXPECT_TRUE(storage.isExists(IdT(20, 1)));
+}
+
+TEST_F(LMDBWriteBehindTest, ShutdownCommitsQueuedRecords)
+{
+    {
+        CollectingObserver observer;
+        LMDBStorage storage(testDir_, &observer);
+        LMDBWriteBehindParams params;
+        params.maxDelayUs_ = 100000;
+        LMDBWriteBehind writer(&storage, params);
+        const IdT id = writer.save("auto", 4);
+        EXPECT_TRUE(id.isValid());
+        writer.save(IdT(7, 1), "seven", 5);
+        writer.erase(IdT(7, 1));
+        writer.shutdown();
+        EXPECT_THROW(writer.save(IdT(8, 1), "late", 4), std::runtime_error);
+    }
+    EXPECT_EQ(1u, reloadCount());
+}
+
+TEST_F(LMDBWriteBehindTest, FailedRecordDoesNotDropBatch)
+{
+    CollectingObserver observer;
+    LMDBStorage storage(testDir_, &observer);
+    storage.save(IdT(1, 1), "first", 5);
+    LMDBWriteBehindParams params;
+    params.maxDelayUs_ = 100000;
+    LMDBWriteBehind writer(&storage, params);
+
+    writer.save(IdT(1, 1), "duplicate", 9);
+    const LMDBWriteBehind::TicketT duplicate = writer.lastTicket();
+    writer.save(IdT(2, 1), "second", 6);
+    EXPECT_THROW(writer.flush(), std::runtime_error);
+
+    EXPECT_FALSE(writer.waitDurable(duplicate, 5000));
+    EXPECT_TRUE(writer.waitDurable(writer.lastTicket(), 5000));
+    EXPECT_EQ(1u, writer.totalErrors());
+    EXPECT_EQ(1u, writer.totalWritten());
+    EXPECT_TRUE(storage.isExists(IdT(2, 1)));
+
+    // the failure is reported by one flush only
+    EXPECT_NO_THROW(writer.flush());
+}
+
+TEST_F(LMDBWriteBehindTest, UpdateFailsAfterLostRecord)
+{
+    CollectingObserver observer;
+    LMDBStorage storage(testDir_, &observer);
+    storage.save(IdT(5, 1), "v0", 2);
+    LMDBWriteBehindParams params;
+    params.maxDelayUs_ = 100000;
+    LMDBWriteBehind writer(&storage, params);
+
+    writer.save(IdT(5, 1), "lost", 4);
+    EXPECT_THROW(writer.update(IdT(5, 1), "v1", 2), std::runtime_error);
+    EXPECT_EQ(0u, storage.getTopVersion(IdT(5, 1)));
+}
+
+TEST_F(LMDBWriteBehindTest, UpdateSeesQueuedSave)
+{
+    CollectingObserver observer;
+    LMDBStorage storage(testDir_, &observer);
+    LMDBWriteBehindParams params;
+    params.maxDelayUs_ = 100000;
+    LMDBWriteBehind writer(&storage, params);
+
+    writer.save(IdT(5, 1), "v0", 2);
+    EXPECT_EQ(1u, writer.update(IdT(5, 1), "v1", 2));
+    EXPECT_EQ(1u, storage.getTopVersion(IdT(5, 1)));
+}
+
+TEST_F(LMDBWriteBehindTest, ConcurrentProducersAreAllCommitted)
+{
+    CollectingObserver observer;
+    LMDBStorage storage(testDir_, &observer);
+    LMDBWriteBehindParams params;
+    params.maxBatchSize_ = 32;
+    LMDBWriteBehind writer(&storage, params);
+
+    const int perThread = 100;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back(
+            [&writer, t]()
+            {
+                for (int i = 0; i < perThread; ++i)
+                {
+                    writer.save(IdT(static_cast<u64>(t * perThread + i + 1), 2), "concurrent", 10);
+                }
+            });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    writer.flush();
+    EXPECT_EQ(static_cast<u64>(4 * perThread), writer.totalWritten());
+    EXPECT_EQ(0u, writer.totalErrors());
+}
+
+} // namespace
@@ -150,6 +150,218 @@ TEST_F(NLinkTreeTest, RemovingDependencyUnblocksChild)
     EXPECT_GE(newReady, 0);
 }
 
+TEST_F(NLinkTreeTest, ReadyNodesReportedOnAddAndRemove)
+{
+    int readyToExecute = 0;
+    Transaction *tr = nullptr;
+    ReadyNodesT ready;
+
+    COP::IdT keyA(1, 20260119);
+    DependObjs depsA;
+    depsA.list_[0] = ObjectInTransaction(COP::ACID::order_ObjectType, COP::IdT(7, 20260119));
+    depsA.size_ = 1;
+    tree_->add(keyA, tr, depsA, &readyToExecute, &ready);
+    ASSERT_EQ(1u, ready.size());
+    EXPECT_EQ(keyA, ready[0].key_);
+
+    COP::IdT keyB(2, 20260119);
+    tree_->add(keyB, tr, depsA, &readyToExecute, &ready);
+    EXPECT_EQ(1u, ready.size());
+
+    ready.clear();
+    V value = nullptr;
+    EXPECT_TRUE(tree_->find(keyB, &value));
+    EXPECT_TRUE(tree_->remove(keyA, &readyToExecute, &ready));
+    EXPECT_EQ(1, readyToExecute);
+    ASSERT_EQ(1u, ready.size());
+    EXPECT_EQ(keyB, ready[0].key_);
+    EXPECT_FALSE(tree_->find(keyA, &value));
+}
+
+TEST_F(NLinkTreeTest, RemovingMiddleNodeRelinksParentAndChild)
+{
+    int readyToExecute = 0;
+    Transaction *tr = nullptr;
+    DependObjs deps;
+    deps.list_[0] = ObjectInTransaction(COP::ACID::order_ObjectType, COP::IdT(7, 20260119));
+    deps.size_ = 1;
+
+    COP::IdT keyA(1, 20260119), keyB(2, 20260119), keyC(3, 20260119);
+    tree_->add(keyA, tr, deps, &readyToExecute);
+    tree_->add(keyB, tr, deps, &readyToExecute);
+    tree_->add(keyC, tr, deps, &readyToExecute);
+
+    EXPECT_TRUE(tree_->remove(keyB, &readyToExecute));
+    EXPECT_EQ(0, readyToExecute);
+    KSetT related;
+    ASSERT_TRUE(tree_->getParents(keyC, &related));
+    ASSERT_EQ(1u, related.size());
+    EXPECT_EQ(keyA, *related.begin());
+    related.clear();
+    ASSERT_TRUE(tree_->getChildren(keyA, &related));
+    ASSERT_EQ(1u, related.size());
+    EXPECT_EQ(keyC, *related.begin());
+
+    EXPECT_TRUE(tree_->remove(keyA, &readyToExecute));
+    EXPECT_EQ(1, readyToExecute);
+    K outKey;
+    V outValue;
+    ASSERT_TRUE(tree_->next(&outKey, &outValue));
+    EXPECT_EQ(keyC, outKey);
+}
+
+TEST_F(NLinkTreeTest, ChildReadyOnlyWhenAllParentsRemoved)
+{
+    int readyToExecute = 0;
+    Transaction *tr = nullptr;
+    const ObjectInTransaction order1(COP::ACID::order_ObjectType, COP::IdT(7, 20260119));
+    const ObjectInTransaction order2(COP::ACID::order_ObjectType, COP::IdT(8, 20260119));
+
+    DependObjs depsA, depsB, depsC;
+    depsA.list_[0] = order1;
+    depsA.size_ = 1;
+    depsB.list_[0] = order2;
+    depsB.size_ = 1;
+    // duplicated object is linked once
+    depsC.list_[0] = order1;
+    depsC.list_[1] = order2;
+    depsC.list_[2] = order1;
+    depsC.size_ = 3;
+
+    COP::IdT keyA(1, 20260119), keyB(2, 20260119), keyC(3, 20260119);
+    tree_->add(keyA, tr, depsA, &readyToExecute);
+    tree_->add(keyB, tr, depsB, &readyToExecute);
+    tree_->add(keyC, tr, depsC, &readyToExecute);
+    EXPECT_EQ(0, readyToExecute);
+
+    KSetT parents;
+    ASSERT_TRUE(tree_->getParents(keyC, &parents));
+    EXPECT_EQ(2u, parents.size());
+
+    EXPECT_TRUE(tree_->remove(keyA, &readyToExecute));
+    EXPECT_EQ(0, readyToExecute);
+    EXPECT_TRUE(tree_->remove(keyB, &readyToExecute));
+    EXPECT_EQ(1, readyToExecute);
+    EXPECT_TRUE(tree_->remove(keyC, &readyToExecute));
+
+    // objects are released, a new user of them is ready at once
+    COP::IdT keyD(4, 20260119);
+    tree_->add(keyD, tr, depsC, &readyToExecute);
+    EXPECT_EQ(1, readyToExecute);
+}
+
+TEST_F(NLinkTreeTest, ReadersOfSameObjectAreReadyTogether)
+{
+    int readyToExecute = 0;
+    Transaction *tr = nullptr;
+    DependObjs reader;
+    reader.list_[0] = ObjectInTransaction(COP::ACID::instrument_ObjectType, COP::IdT(7, 20260119), read_AccessMode);
+    reader.size_ = 1;
+
+    COP::IdT keyA(1, 20260119), keyB(2, 20260119), keyC(3, 20260119);
+    tree_->add(keyA, tr, reader, &readyToExecute);
+    EXPECT_EQ(1, readyToExecute);
+    tree_->add(keyB, tr, reader, &readyToExecute);
+    EXPECT_EQ(1, readyToExecute);
+    tree_->add(keyC, tr, reader, &readyToExecute);
+    EXPECT_EQ(1, readyToExecute);
+
+    KSetT related;
+    ASSERT_TRUE(tree_->getParents(keyC, &related));
+    EXPECT_TRUE(related.empty());
+    ASSERT_TRUE(tree_->getChildren(keyA, &related));
+    EXPECT_TRUE(related.empty());
+}
+
+TEST_F(NLinkTreeTest, WriterWaitsForAllReaders)
+{
+    int readyToExecute = 0;
+    Transaction *tr = nullptr;
+    const COP::IdT instrId(7, 20260119);
+    DependObjs reader, writer;
+    reader.list_[0] = ObjectInTransaction(COP::ACID::instrument_ObjectType, instrId, read_AccessMode);
+    reader.size_ = 1;
+    writer.list_[0] = ObjectInTransaction(COP::ACID::instrument_ObjectType, instrId);
+    writer.size_ = 1;
+
+    COP::IdT keyA(1, 20260119), keyB(2, 20260119), keyC(3, 20260119);
+    tree_->add(keyA, tr, reader, &readyToExecute);
+    tree_->add(keyB, tr, reader, &readyToExecute);
+    tree_->add(keyC, tr, writer, &readyToExecute);
+    EXPECT_EQ(0, readyToExecute);
+
+    KSetT related;
+    ASSERT_TRUE(tree_->getParents(keyC, &related));
+    EXPECT_EQ(2u, related.size());
+
+    // readers may finish in any order
+    EXPECT_TRUE(tree_->remove(keyB, &readyToExecute));
+    EXPECT_EQ(0, readyToExecute);
+    EXPECT_TRUE(tree_->remove(keyA, &readyToExecute));
+    EXPECT_EQ(1, readyToExecute);
+    K outKey;
+    V outValue;
+    ASSERT_TRUE(tree_->next(&outKey, &outValue));
+    EXPECT_EQ(keyC, outKey);
+}
+
+TEST_F(NLinkTreeTest, RemovingWriterReleasesReadersUpToNextWriter)
+{
+    int readyToExecute = 0;
+    Transaction *tr = nullptr;
+    const COP::IdT instrId(7, 20260119);
+    DependObjs reader, writer;
+    reader.list_[0] = ObjectInTransaction(COP::ACID::instrument_ObjectType, instrId, read_AccessMode);
+    reader.size_ = 1;
+    writer.list_[0] = ObjectInTransaction(COP::ACID::instrument_ObjectType, instrId);
+    writer.size_ = 1;
+
+    COP::IdT keyA(1, 20260119), keyB(2, 20260119), keyC(3, 20260119), keyD(4, 20260119);
+    tree_->add(keyA, tr, writer, &readyToExecute);
+    EXPECT_EQ(1, readyToExecute);
+    tree_->add(keyB, tr, reader, &readyToExecute);
+    EXPECT_EQ(0, readyToExecute);
+    tree_->add(keyC, tr, reader, &readyToExecute);
+    EXPECT_EQ(0, readyToExecute);
+    tree_->add(keyD, tr, writer, &readyToExecute);
+    EXPECT_EQ(0, readyToExecute);
+
+    KSetT related;
+    ASSERT_TRUE(tree_->getChildren(keyA, &related));
+    EXPECT_EQ(2u, related.size());
+    related.clear();
+    ASSERT_TRUE(tree_->getParents(keyC, &related));
+    ASSERT_EQ(1u, related.size());
+    EXPECT_EQ(keyA, *related.begin());
+
+    EXPECT_TRUE(tree_->remove(keyA, &readyToExecute));
+    EXPECT_EQ(2, readyToExecute);
+    EXPECT_TRUE(tree_->remove(keyC, &readyToExecute));
+    EXPECT_EQ(0, readyToExecute);
+    EXPECT_TRUE(tree_->remove(keyB, &readyToExecute));
+    EXPECT_EQ(1, readyToExecute);
+}
+
+TEST_F(NLinkTreeTest, DuplicatedObjectWithWriteAccessIsWriter)
+{
+    int readyToExecute = 0;
+    Transaction *tr = nullptr;
+    const COP::IdT instrId(7, 20260119);
+    DependObjs reader, mixed;
+    reader.list_[0] = ObjectInTransaction(COP::ACID::instrument_ObjectType, instrId, read_AccessMode);
+    reader.size_ = 1;
+    mixed.list_[0] = ObjectInTransaction(COP::ACID::instrument_ObjectType, instrId, read_AccessMode);
+    mixed.list_[1] = ObjectInTransaction(COP::ACID::instrument_ObjectType, instrId);
+    mixed.size_ = 2;
+
+    COP::IdT keyA(1, 20260119), keyB(2, 20260119);
+    tree_->add(keyA, tr, reader, &readyToExecute);
+    tree_->add(keyB, tr, mixed, &readyToExecute);
+    EXPECT_EQ(0, readyToExecute);
+    EXPECT_TRUE(tree_->remove(keyA, &readyToExecute));
+    EXPECT_EQ(1, readyToExecute);
+}
+
 // =============================================================================
 // Parent/Child Queries
 // =============================================================================
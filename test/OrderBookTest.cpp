@@ -12,6 +12,7 @@
 */
 
 #include <gtest/gtest.h>
+#include <vector>
 #include "TestFixtures.h"
 #include "TestAux.h"
 #include "MockOrderBook.h"
@@ -378,4 +379,342 @@ TEST_F(OrderBookTest, RemoveNonExistentSellOrderThrows)
     EXPECT_THROW(orderBook_->remove(*nonExistent), std::exception);
 }
 
+// =============================================================================
+// Resting Order Hot Fields Tests
+// =============================================================================
+
+class CollectRestingFunctor : public OrderFunctor
+{
+public:
+    CollectRestingFunctor(const SourceIdT &instr, Side side) : instr_(instr)
+    {
+        side_ = side;
+    }
+    SourceIdT instrument() const override
+    {
+        return instr_;
+    }
+    bool match(const IdT &, bool *) const override
+    {
+        ADD_FAILURE() << "book should pass resting order hot fields";
+        return false;
+    }
+    bool matchResting(const RestingOrder &order, bool *) const override
+    {
+        visited_.push_back(order);
+        return true;
+    }
+
+    SourceIdT instr_;
+    mutable std::vector<RestingOrder> visited_;
+};
+
+TEST_F(OrderBookTest, WalkPassesRestingOrderHotFields)
+{
+    auto order = createOrderWithId(instrumentId1_, IdT(1, 1), SELL_SIDE, 5.0);
+    order->leavesQty_ = 70;
+    order->ordType_ = LIMIT_ORDERTYPE;
+    orderBook_->add(*order);
+
+    CollectRestingFunctor functor(instrumentId1_, SELL_SIDE);
+    EXPECT_EQ(IdT(1, 1), orderBook_->find(functor));
+    ASSERT_EQ(1u, functor.visited_.size());
+    EXPECT_EQ(IdT(1, 1), functor.visited_[0].orderId_);
+    EXPECT_DOUBLE_EQ(5.0, functor.visited_[0].price_);
+    EXPECT_EQ(70u, functor.visited_[0].leavesQty_);
+    EXPECT_EQ(LIMIT_ORDERTYPE, functor.visited_[0].ordType_);
+    EXPECT_EQ(order.get(), functor.visited_[0].order_);
+}
+
+TEST_F(OrderBookTest, UpdateRefreshesRestingLeavesQty)
+{
+    auto order1 = createOrderWithId(instrumentId1_, IdT(1, 1), BUY_SIDE, 5.0);
+    auto order2 = createOrderWithId(instrumentId1_, IdT(1, 2), BUY_SIDE, 5.0);
+    order1->leavesQty_ = 100;
+    order2->leavesQty_ = 100;
+    orderBook_->add(*order1);
+    orderBook_->add(*order2);
+
+    order2->leavesQty_ = 40;
+    orderBook_->update(*order2);
+
+    // order which is not in the book is ignored
+    auto absent = createOrderWithId(instrumentId1_, IdT(1, 99), BUY_SIDE, 5.0);
+    EXPECT_NO_THROW(orderBook_->update(*absent));
+
+    CollectRestingFunctor functor(instrumentId1_, BUY_SIDE);
+    OrderBookImpl::OrdersT orders;
+    orderBook_->findAll(functor, &orders);
+    ASSERT_EQ(2u, functor.visited_.size());
+    EXPECT_EQ(100u, functor.visited_[0].leavesQty_);
+    EXPECT_EQ(40u, functor.visited_[1].leavesQty_);
+}
+
+// =============================================================================
+// Aggregated Depth Tests
+// =============================================================================
+
+TEST_F(OrderBookTest, SnapshotAggregatesLevels)
+{
+    auto buy1 = createOrderWithId(instrumentId1_, IdT(1, 1), BUY_SIDE, 5.0);
+    auto buy2 = createOrderWithId(instrumentId1_, IdT(1, 2), BUY_SIDE, 5.0);
+    auto buy3 = createOrderWithId(instrumentId1_, IdT(1, 3), BUY_SIDE, 4.9);
+    auto sell1 = createOrderWithId(instrumentId1_, IdT(1, 4), SELL_SIDE, 5.1);
+    buy1->leavesQty_ = 10;
+    buy2->leavesQty_ = 20;
+    buy3->leavesQty_ = 30;
+    sell1->leavesQty_ = 40;
+    orderBook_->add(*buy1);
+    orderBook_->add(*buy2);
+    orderBook_->add(*buy3);
+    orderBook_->add(*sell1);
+
+    BookSnapshot snap = orderBook_->getSnapshot(instrumentId1_);
+    ASSERT_EQ(2u, snap.bids.size());
+    EXPECT_DOUBLE_EQ(5.0, snap.bids[0].price);
+    EXPECT_EQ(30u, snap.bids[0].totalQty);
+    EXPECT_EQ(2u, snap.bids[0].orderCount);
+    EXPECT_DOUBLE_EQ(4.9, snap.bids[1].price);
+    EXPECT_EQ(30u, snap.bids[1].totalQty);
+    ASSERT_EQ(1u, snap.asks.size());
+    EXPECT_EQ(40u, snap.asks[0].totalQty);
+
+    // partial fill and removal are reflected without rebuilding
+    buy1->leavesQty_ = 4;
+    orderBook_->update(*buy1);
+    orderBook_->remove(*buy3);
+    snap = orderBook_->getSnapshot(instrumentId1_);
+    ASSERT_EQ(1u, snap.bids.size());
+    EXPECT_EQ(24u, snap.bids[0].totalQty);
+    EXPECT_EQ(2u, snap.bids[0].orderCount);
+
+    EXPECT_TRUE(orderBook_->getSnapshot(instrumentId2_).bids.empty());
+}
+
+TEST_F(OrderBookTest, SnapshotTopLevelsOnly)
+{
+    std::vector<std::unique_ptr<OrderEntry>> orders;
+    for (u64 i = 1; i <= 5; ++i)
+    {
+        orders.push_back(createOrderWithId(instrumentId1_, IdT(i, 1), SELL_SIDE, 5.0 + i));
+        orders.back()->leavesQty_ = 10;
+        orderBook_->add(*orders.back());
+    }
+
+    BookSnapshot snap = orderBook_->getSnapshot(instrumentId1_, 2);
+    ASSERT_EQ(2u, snap.asks.size());
+    EXPECT_DOUBLE_EQ(6.0, snap.asks[0].price);
+    EXPECT_DOUBLE_EQ(7.0, snap.asks[1].price);
+    EXPECT_EQ(5u, orderBook_->getSnapshot(instrumentId1_).asks.size());
+}
+
+// =============================================================================
+// Price-Level Book Tests
+// =============================================================================
+
+class PriceLevelOrderBookTest : public OrderBookTest
+{
+protected:
+    void SetUp() override
+    {
+        OrderBookTest::SetUp();
+        orderBook_ = std::make_unique<OrderBookImpl>();
+        orderBook_->init(instruments_, &orderSaver_, OrderBookImpl::PRICELEVEL_BOOKTYPE);
+    }
+};
+
+TEST_F(PriceLevelOrderBookTest, InitWithUnsupportedTypeThrows)
+{
+    DummyOrderSaver saver;
+    OrderBookImpl books;
+    EXPECT_THROW(books.init(instruments_, &saver, OrderBookImpl::INVALID_BOOKTYPE), std::exception);
+}
+
+TEST_F(PriceLevelOrderBookTest, BuySidePriceTimePriority)
+{
+    auto order1 = createOrderWithId(instrumentId1_, IdT(1, 1), BUY_SIDE, 5.0);
+    auto order2 = createOrderWithId(instrumentId1_, IdT(1, 2), BUY_SIDE, 5.1);
+    auto order3 = createOrderWithId(instrumentId1_, IdT(1, 3), BUY_SIDE, 5.0);
+    auto order4 = createOrderWithId(instrumentId1_, IdT(1, 4), BUY_SIDE, 5.1);
+
+    orderBook_->add(*order1);
+    orderBook_->add(*order2);
+    orderBook_->add(*order3);
+    orderBook_->add(*order4);
+
+    TestOrderFunctor functor(instrumentId1_, BUY_SIDE, true);
+    OrderBookImpl::OrdersT orders;
+    orderBook_->findAll(functor, &orders);
+
+    ASSERT_EQ(4u, orders.size());
+    EXPECT_EQ(IdT(1, 2), orders.at(0));
+    EXPECT_EQ(IdT(1, 4), orders.at(1));
+    EXPECT_EQ(IdT(1, 1), orders.at(2));
+    EXPECT_EQ(IdT(1, 3), orders.at(3));
+    EXPECT_EQ(IdT(1, 2), orderBook_->getTop(instrumentId1_, BUY_SIDE));
+}
+
+TEST_F(PriceLevelOrderBookTest, SellSidePriceTimePriority)
+{
+    auto order1 = createOrderWithId(instrumentId1_, IdT(1, 1), SELL_SIDE, 5.1);
+    auto order2 = createOrderWithId(instrumentId1_, IdT(1, 2), SELL_SIDE, 5.0);
+    auto order3 = createOrderWithId(instrumentId1_, IdT(1, 3), SELL_SIDE, 5.0);
+
+    orderBook_->add(*order1);
+    orderBook_->add(*order2);
+    orderBook_->add(*order3);
+
+    TestOrderFunctor functor(instrumentId1_, SELL_SIDE, true);
+    OrderBookImpl::OrdersT orders;
+    orderBook_->findAll(functor, &orders);
+
+    ASSERT_EQ(3u, orders.size());
+    EXPECT_EQ(IdT(1, 2), orders.at(0));
+    EXPECT_EQ(IdT(1, 3), orders.at(1));
+    EXPECT_EQ(IdT(1, 1), orders.at(2));
+    EXPECT_EQ(IdT(1, 2), orderBook_->getTop(instrumentId1_, SELL_SIDE));
+}
+
+TEST_F(PriceLevelOrderBookTest, CancelFromMiddleOfLevelKeepsFifo)
+{
+    auto order1 = createOrderWithId(instrumentId1_, IdT(1, 1), SELL_SIDE, 5.0);
+    auto order2 = createOrderWithId(instrumentId1_, IdT(1, 2), SELL_SIDE, 5.0);
+    auto order3 = createOrderWithId(instrumentId1_, IdT(1, 3), SELL_SIDE, 5.0);
+
+    orderBook_->add(*order1);
+    orderBook_->add(*order2);
+    orderBook_->add(*order3);
+
+    orderBook_->remove(*order2);
+
+    TestOrderFunctor functor(instrumentId1_, SELL_SIDE, true);
+    OrderBookImpl::OrdersT orders;
+    orderBook_->findAll(functor, &orders);
+
+    ASSERT_EQ(2u, orders.size());
+    EXPECT_EQ(IdT(1, 1), orders.at(0));
+    EXPECT_EQ(IdT(1, 3), orders.at(1));
+
+    orderBook_->remove(*order1);
+    EXPECT_EQ(IdT(1, 3), orderBook_->getTop(instrumentId1_, SELL_SIDE));
+    orderBook_->remove(*order3);
+    EXPECT_FALSE(orderBook_->getTop(instrumentId1_, SELL_SIDE).isValid());
+}
+
+TEST_F(PriceLevelOrderBookTest, FreedSlotIsReusedAtTailOfLevel)
+{
+    auto order1 = createOrderWithId(instrumentId1_, IdT(1, 1), SELL_SIDE, 5.0);
+    auto order2 = createOrderWithId(instrumentId1_, IdT(1, 2), SELL_SIDE, 5.0);
+    auto order3 = createOrderWithId(instrumentId1_, IdT(1, 3), SELL_SIDE, 5.0);
+    auto order4 = createOrderWithId(instrumentId1_, IdT(1, 4), SELL_SIDE, 5.0);
+    auto order5 = createOrderWithId(instrumentId1_, IdT(1, 5), SELL_SIDE, 4.9);
+
+    orderBook_->add(*order1);
+    orderBook_->add(*order2);
+    orderBook_->add(*order3);
+    orderBook_->remove(*order1);
+
+    // takes the slot of the cancelled head, still queued behind the older orders
+    orderBook_->add(*order4);
+    orderBook_->add(*order5);
+
+    TestOrderFunctor functor(instrumentId1_, SELL_SIDE, true);
+    OrderBookImpl::OrdersT orders;
+    orderBook_->findAll(functor, &orders);
+
+    ASSERT_EQ(4u, orders.size());
+    EXPECT_EQ(IdT(1, 5), orders.at(0));
+    EXPECT_EQ(IdT(1, 2), orders.at(1));
+    EXPECT_EQ(IdT(1, 3), orders.at(2));
+    EXPECT_EQ(IdT(1, 4), orders.at(3));
+}
+
+TEST_F(PriceLevelOrderBookTest, RemoveTopLevelExposesNextLevel)
+{
+    auto order1 = createOrderWithId(instrumentId1_, IdT(1, 1), BUY_SIDE, 5.0);
+    auto order2 = createOrderWithId(instrumentId1_, IdT(1, 2), BUY_SIDE, 5.2);
+    auto order3 = createOrderWithId(instrumentId1_, IdT(1, 3), BUY_SIDE, 5.1);
+
+    orderBook_->add(*order1);
+    orderBook_->add(*order2);
+    orderBook_->add(*order3);
+
+    orderBook_->remove(*order2);
+    EXPECT_EQ(IdT(1, 3), orderBook_->getTop(instrumentId1_, BUY_SIDE));
+
+    // re-adding at a price of an emptied level creates it again
+    orderBook_->add(*order2);
+    EXPECT_EQ(IdT(1, 2), orderBook_->getTop(instrumentId1_, BUY_SIDE));
+}
+
+TEST_F(PriceLevelOrderBookTest, RemoveNonExistentOrderThrows)
+{
+    auto order = createOrderWithId(instrumentId1_, IdT(1, 1), BUY_SIDE, 5.0);
+    orderBook_->add(*order);
+
+    auto nonExistent = createOrderWithId(instrumentId1_, IdT(1, 99), BUY_SIDE, 5.0);
+    EXPECT_THROW(orderBook_->remove(*nonExistent), std::exception);
+}
+
+TEST_F(PriceLevelOrderBookTest, AddSameOrderTwiceThrows)
+{
+    auto order = createOrderWithId(instrumentId1_, IdT(1, 1), BUY_SIDE, 5.0);
+    orderBook_->add(*order);
+    EXPECT_THROW(orderBook_->add(*order), std::exception);
+}
+
+TEST_F(PriceLevelOrderBookTest, UpdateRefreshesRestingLeavesQty)
+{
+    auto order = createOrderWithId(instrumentId1_, IdT(1, 1), SELL_SIDE, 5.0);
+    order->leavesQty_ = 100;
+    orderBook_->add(*order);
+
+    order->leavesQty_ = 25;
+    orderBook_->update(*order);
+
+    CollectRestingFunctor functor(instrumentId1_, SELL_SIDE);
+    EXPECT_EQ(IdT(1, 1), orderBook_->find(functor));
+    ASSERT_EQ(1u, functor.visited_.size());
+    EXPECT_EQ(25u, functor.visited_[0].leavesQty_);
+    EXPECT_EQ(order.get(), functor.visited_[0].order_);
+}
+
+TEST_F(PriceLevelOrderBookTest, SnapshotAggregatesLevels)
+{
+    auto sell1 = createOrderWithId(instrumentId1_, IdT(1, 1), SELL_SIDE, 5.2);
+    auto sell2 = createOrderWithId(instrumentId1_, IdT(1, 2), SELL_SIDE, 5.1);
+    auto sell3 = createOrderWithId(instrumentId1_, IdT(1, 3), SELL_SIDE, 5.1);
+    sell1->leavesQty_ = 10;
+    sell2->leavesQty_ = 20;
+    sell3->leavesQty_ = 30;
+    orderBook_->add(*sell1);
+    orderBook_->add(*sell2);
+    orderBook_->add(*sell3);
+
+    BookSnapshot snap = orderBook_->getSnapshot(instrumentId1_);
+    ASSERT_EQ(2u, snap.asks.size());
+    EXPECT_DOUBLE_EQ(5.1, snap.asks[0].price);
+    EXPECT_EQ(50u, snap.asks[0].totalQty);
+    EXPECT_EQ(2u, snap.asks[0].orderCount);
+    EXPECT_EQ(10u, snap.asks[1].totalQty);
+
+    sell2->leavesQty_ = 5;
+    orderBook_->update(*sell2);
+    orderBook_->remove(*sell1);
+    snap = orderBook_->getSnapshot(instrumentId1_, 1);
+    ASSERT_EQ(1u, snap.asks.size());
+    EXPECT_EQ(35u, snap.asks[0].totalQty);
+    EXPECT_TRUE(snap.bids.empty());
+}
+
+TEST_F(PriceLevelOrderBookTest, FindStopsWhenFunctorRequests)
+{
+    auto order1 = createOrderWithId(instrumentId1_, IdT(1, 1), BUY_SIDE, 5.0);
+    orderBook_->add(*order1);
+
+    TestOrderFunctor functor(instrumentId1_, BUY_SIDE, false);
+    EXPECT_FALSE(orderBook_->find(functor).isValid());
+    EXPECT_THROW(orderBook_->find(TestOrderFunctor(instrumentId1_, INVALID_SIDE, true)), std::exception);
+}
+
 } // namespace
@@ -328,6 +328,111 @@ TEST_F(OrderMatcherTest, MatchWithBestPriceFirst)
     SUCCEED();
 }
 
+// =============================================================================
+// Sweep-to-fill Tests
+// =============================================================================
+
+TEST_F(OrderMatcherTest, SweepCollectsAllFillsIntoSingleExecution)
+{
+    std::vector<OrderEntry *> sells;
+    for (int i = 0; i < 5; ++i)
+    {
+        OrderEntry *sellOrder = createAndSaveOrder(SELL_SIDE, 10.0 + i, 20);
+        ASSERT_NE(nullptr, sellOrder);
+        sellOrder->status_ = NEW_ORDSTATUS;
+        orderBook_->add(*sellOrder);
+        sells.push_back(sellOrder);
+    }
+
+    OrderEntry *buyOrder = createAndSaveOrder(BUY_SIDE, 14.0, 100);
+    ASSERT_NE(nullptr, buyOrder);
+    buyOrder->status_ = NEW_ORDSTATUS;
+
+    matcher_->match(buyOrder, context_);
+
+    ASSERT_EQ(1u, deferedContainer_->eventCount());
+    auto *exec = dynamic_cast<ExecutionDeferedEvent *>(deferedContainer_->events_[0]);
+    ASSERT_NE(nullptr, exec);
+    EXPECT_EQ(buyOrder, exec->baseOrder_);
+    ASSERT_EQ(5u, exec->trades_.size());
+    for (size_t i = 0; i < exec->trades_.size(); ++i)
+    {
+        EXPECT_EQ(sells[i], exec->trades_[i].order_);
+        EXPECT_EQ(20u, exec->trades_[i].lastQty_);
+        EXPECT_DOUBLE_EQ(10.0 + i, exec->trades_[i].lastPx_);
+    }
+}
+
+TEST_F(OrderMatcherTest, SweepStopsAtLimitPrice)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        OrderEntry *sellOrder = createAndSaveOrder(SELL_SIDE, 10.0 + i, 20);
+        ASSERT_NE(nullptr, sellOrder);
+        sellOrder->status_ = NEW_ORDSTATUS;
+        orderBook_->add(*sellOrder);
+    }
+
+    OrderEntry *buyOrder = createAndSaveOrder(BUY_SIDE, 11.0, 100);
+    ASSERT_NE(nullptr, buyOrder);
+    buyOrder->status_ = NEW_ORDSTATUS;
+
+    matcher_->match(buyOrder, context_);
+
+    ASSERT_EQ(1u, deferedContainer_->eventCount());
+    auto *exec = dynamic_cast<ExecutionDeferedEvent *>(deferedContainer_->events_[0]);
+    ASSERT_NE(nullptr, exec);
+    ASSERT_EQ(2u, exec->trades_.size());
+    EXPECT_DOUBLE_EQ(10.0, exec->trades_[0].lastPx_);
+    EXPECT_DOUBLE_EQ(11.0, exec->trades_[1].lastPx_);
+}
+
+TEST_F(OrderMatcherTest, SweepStopsAtLeavesQty)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        OrderEntry *buyOrder = createAndSaveOrder(BUY_SIDE, 10.0, 40);
+        ASSERT_NE(nullptr, buyOrder);
+        buyOrder->status_ = NEW_ORDSTATUS;
+        orderBook_->add(*buyOrder);
+    }
+
+    OrderEntry *sellOrder = createAndSaveOrder(SELL_SIDE, 10.0, 50);
+    ASSERT_NE(nullptr, sellOrder);
+    sellOrder->status_ = NEW_ORDSTATUS;
+
+    matcher_->match(sellOrder, context_);
+
+    ASSERT_EQ(1u, deferedContainer_->eventCount());
+    auto *exec = dynamic_cast<ExecutionDeferedEvent *>(deferedContainer_->events_[0]);
+    ASSERT_NE(nullptr, exec);
+    ASSERT_EQ(2u, exec->trades_.size());
+    EXPECT_EQ(40u, exec->trades_[0].lastQty_);
+    EXPECT_EQ(10u, exec->trades_[1].lastQty_);
+}
+
+TEST_F(OrderMatcherTest, SweepCancelsMarketOrderRemainder)
+{
+    OrderEntry *sellOrder = createAndSaveOrder(SELL_SIDE, 10.0, 30);
+    ASSERT_NE(nullptr, sellOrder);
+    sellOrder->status_ = NEW_ORDSTATUS;
+    orderBook_->add(*sellOrder);
+
+    OrderEntry *buyOrder = createAndSaveOrder(BUY_SIDE, 0.0, 100);
+    ASSERT_NE(nullptr, buyOrder);
+    buyOrder->ordType_ = MARKET_ORDERTYPE;
+    buyOrder->status_ = NEW_ORDSTATUS;
+
+    matcher_->match(buyOrder, context_);
+
+    ASSERT_EQ(2u, deferedContainer_->eventCount());
+    auto *exec = dynamic_cast<ExecutionDeferedEvent *>(deferedContainer_->events_[0]);
+    ASSERT_NE(nullptr, exec);
+    ASSERT_EQ(1u, exec->trades_.size());
+    EXPECT_EQ(30u, exec->trades_[0].lastQty_);
+    EXPECT_NE(nullptr, dynamic_cast<CancelOrderDeferedEvent *>(deferedContainer_->events_[1]));
+}
+
 // =============================================================================
 // Empty Order Book Tests
 // =============================================================================
@@ -0,0 +1,190 @@
+/**
+ Concurrent Order Processor library - Google Test
+
+ Authors: dudleylane, Claude
+ Test: 2026
+
+ Copyright (C) 2026 dudleylane
+
+ Distributed under the GNU Affero General Public License (AGPL).
+*/
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#include "TestFixtures.h"
+#include "TestAux.h"
+#include "OrderSlab.h"
+#include "OrderStorage.h"
+
+using namespace COP;
+using namespace COP::Store;
+using namespace test;
+
+namespace
+{
+
+// =============================================================================
+// Test Fixture
+// =============================================================================
+
+class OrderSlabTest : public OrderStorageFixture
+{
+protected:
+    std::unique_ptr<OrderEntry> makeOrder(u64 id, PriceT price)
+    {
+        std::unique_ptr<OrderEntry> order = createCorrectOrder();
+        order->orderId_ = IdT(id, 20260119);
+        order->price_ = price;
+        return order;
+    }
+};
+
+// =============================================================================
+// Slab Tests
+// =============================================================================
+
+TEST_F(OrderSlabTest, EmplaceCopiesOrder)
+{
+    OrderSlab slab;
+    auto order = makeOrder(1, 10.5);
+
+    OrderHandle handle = slab.emplace(*order);
+    EXPECT_TRUE(handle.isValid());
+    OrderEntry *stored = slab.get(handle);
+    ASSERT_NE(nullptr, stored);
+    EXPECT_NE(order.get(), stored);
+    EXPECT_EQ(IdT(1, 20260119), stored->orderId_);
+    EXPECT_DOUBLE_EQ(10.5, stored->price_);
+    EXPECT_EQ(1u, slab.size());
+    EXPECT_EQ(nullptr, slab.get(OrderHandle()));
+}
+
+TEST_F(OrderSlabTest, ReleasedHandleDoesNotResolve)
+{
+    OrderSlab slab;
+    auto order = makeOrder(1, 10.0);
+
+    OrderHandle first = slab.emplace(*order);
+    slab.release(first);
+    EXPECT_EQ(nullptr, slab.get(first));
+    EXPECT_THROW(slab.release(first), std::runtime_error);
+
+    // the slot is reused under the next generation
+    OrderHandle second = slab.emplace(*order);
+    EXPECT_EQ(first.slot_, second.slot_);
+    EXPECT_NE(first.generation_, second.generation_);
+    EXPECT_EQ(nullptr, slab.get(first));
+    EXPECT_NE(nullptr, slab.get(second));
+    EXPECT_EQ(1u, slab.size());
+}
+
+TEST_F(OrderSlabTest, ChunksAreAddedWhenFull)
+{
+    OrderSlabParams params;
+    params.chunkSlots_ = 3;
+    OrderSlab slab(params);
+    EXPECT_EQ(0u, slab.capacity());
+
+    std::vector<OrderHandle> handles;
+    for (u64 i = 0; i < 10; ++i)
+    {
+        handles.push_back(slab.emplace(*makeOrder(i + 1, static_cast<PriceT>(i))));
+    }
+    // chunk size is rounded up to a power of two
+    EXPECT_EQ(12u, slab.capacity());
+    EXPECT_EQ(10u, slab.size());
+    for (u64 i = 0; i < handles.size(); ++i)
+    {
+        ASSERT_NE(nullptr, slab.get(handles[i]));
+        EXPECT_EQ(i + 1, slab.get(handles[i])->orderId_.id_);
+    }
+}
+
+TEST_F(OrderSlabTest, HugePagesFallBackToRegularPages)
+{
+    OrderSlabParams params;
+    params.chunkSlots_ = 64;
+    params.hugePages_ = true;
+    OrderSlab slab(params);
+
+    OrderHandle handle = slab.emplace(*makeOrder(7, 1.0));
+    ASSERT_NE(nullptr, slab.get(handle));
+    EXPECT_EQ(7u, slab.get(handle)->orderId_.id_);
+}
+
+TEST_F(OrderSlabTest, LookupsDuringEmplace)
+{
+    OrderSlabParams params;
+    params.chunkSlots_ = 16;
+    OrderSlab slab(params);
+    const int numOrders = 500;
+    std::vector<OrderHandle> handles(numOrders);
+    std::atomic<int> published{ 0 };
+
+    std::thread reader(
+        [&]()
+        {
+            int seen = 0;
+            while (seen < numOrders)
+            {
+                seen = published.load(std::memory_order_acquire);
+                for (int i = 0; i < seen; i += 7)
+                {
+                    const OrderEntry *order = slab.get(handles[i]);
+                    ASSERT_NE(nullptr, order);
+                    EXPECT_EQ(static_cast<u64>(i + 1), order->orderId_.id_);
+                }
+            }
+        });
+    for (int i = 0; i < numOrders; ++i)
+    {
+        handles[i] = slab.emplace(*makeOrder(static_cast<u64>(i + 1), 1.0));
+        published.store(i + 1, std::memory_order_release);
+    }
+    reader.join();
+    EXPECT_EQ(static_cast<size_t>(numOrders), slab.size());
+}
+
+// =============================================================================
+// Storage Tests
+// =============================================================================
+
+TEST_F(OrderSlabTest, StorageResolvesHandleOfOrderId)
+{
+    auto order = createCorrectOrder();
+    assignClOrderId(order.get());
+    OrderEntry *saved = OrderStorage::instance()->save(*order, IdTGenerator::instance());
+    ASSERT_NE(nullptr, saved);
+
+    OrderHandle handle = OrderStorage::instance()->handleByOrderId(saved->orderId_);
+    EXPECT_TRUE(handle.isValid());
+    EXPECT_EQ(saved, OrderStorage::instance()->locate(handle));
+    EXPECT_FALSE(OrderStorage::instance()->handleByOrderId(IdT(9999, 9999)).isValid());
+}
+
+TEST_F(OrderSlabTest, RejectedBatchIsReleased)
+{
+    const size_t before = OrderStorage::instance()->orderCount();
+    auto first = makeOrder(101, 1.0);
+    assignClOrderId(first.get());
+    // same OrderId, the batch is rejected as a whole
+    auto second = makeOrder(101, 2.0);
+    assignClOrderId(second.get());
+    std::vector<OrderEntry *> batch{ first.get(), second.get() };
+
+    EXPECT_THROW(OrderStorage::instance()->restore(&batch), std::runtime_error);
+    EXPECT_EQ(before, OrderStorage::instance()->orderCount());
+    EXPECT_EQ(nullptr, OrderStorage::instance()->locateByOrderId(IdT(101, 20260119)));
+
+    // rejected orders stay with the caller, restored ones are replaced by the stored entries
+    batch.pop_back();
+    OrderStorage::instance()->restore(&batch);
+    first.release();
+    EXPECT_EQ(batch[0], OrderStorage::instance()->locateByOrderId(IdT(101, 20260119)));
+    EXPECT_EQ(before + 1, OrderStorage::instance()->orderCount());
+}
+
+} // namespace
@@ -13,6 +13,7 @@
 #include <thread>
 #include <vector>
 #include <atomic>
+#include <memory>
 
 #include "TestFixtures.h"
 #include "TestAux.h"
@@ -220,6 +221,61 @@ TEST_F(OrderStorageTest, SaveAndLocateExecution)
     EXPECT_EQ(savedExec->execId_, found->execId_);
 }
 
+class RecordingOrderSaver : public OrderSaver
+{
+public:
+    void save(const OrderEntry &order) override
+    {
+        orderIds_.push_back(order.orderId_);
+    }
+    void save(const ExecutionEntry &exec) override
+    {
+        execIds_.push_back(exec.execId_);
+    }
+
+    std::vector<IdT> orderIds_;
+    std::vector<IdT> execIds_;
+};
+
+TEST_F(OrderStorageTest, SavedExecutionPassedToSaver)
+{
+    OrderDataStorage orders;
+    RecordingOrderSaver saver;
+    orders.attach(&saver);
+
+    ExecutionEntry exec;
+    exec.orderId_ = IdT(1, 1);
+    exec.type_ = NEW_EXECTYPE;
+    ExecutionEntry *savedExec = orders.save(exec, IdTGenerator::instance());
+    ASSERT_NE(nullptr, savedExec);
+
+    ASSERT_EQ(1u, saver.execIds_.size());
+    EXPECT_EQ(savedExec->execId_, saver.execIds_[0]);
+}
+
+TEST_F(OrderStorageTest, RestoreExecutionRejectsDuplicate)
+{
+    OrderDataStorage orders;
+    RecordingOrderSaver saver;
+    orders.attach(&saver);
+
+    std::unique_ptr<ExecutionEntry> exec(new ExecutionEntry());
+    exec->execId_ = IdT(7777, 7777);
+    exec->type_ = TRADE_EXECTYPE;
+    orders.restore(exec.get());
+    exec.release();
+
+    std::unique_ptr<ExecutionEntry> duplicate(new ExecutionEntry());
+    duplicate->execId_ = IdT(7777, 7777);
+    EXPECT_THROW(orders.restore(duplicate.get()), std::runtime_error);
+
+    ExecutionEntry *found = orders.locateByExecId(IdT(7777, 7777));
+    ASSERT_NE(nullptr, found);
+    EXPECT_EQ(TRADE_EXECTYPE, found->type_);
+    // restored executions are already persisted
+    EXPECT_TRUE(saver.execIds_.empty());
+}
+
 // =============================================================================
 // Execution Lookup Tests
 // =============================================================================
@@ -334,6 +390,62 @@ TEST_F(OrderStorageTest, ConcurrentOrderLookups)
     EXPECT_EQ(numThreads * numLookupsPerThread, totalLookups.load());
 }
 
+TEST_F(OrderStorageTest, OrderFoundByIdIsIndexedByClOrderId)
+{
+    const int numOrders = 200;
+    const int numReaders = 4;
+    std::vector<IdT> orderIds(numOrders);
+    std::atomic<int> published{ 0 };
+    std::atomic<int> totalChecked{ 0 };
+
+    std::vector<std::thread> threads;
+    // lookups by OrderId do not wait for the saves
+    for (int t = 0; t < numReaders; ++t)
+    {
+        threads.emplace_back(
+            [this, &orderIds, &published, &totalChecked, numOrders]()
+            {
+                int seen = 0;
+                while (seen < numOrders)
+                {
+                    seen = published.load(std::memory_order_acquire);
+                    if (0 == seen)
+                    {
+                        continue;
+                    }
+                    OrderEntry *found = storage()->locateByOrderId(orderIds[seen - 1]);
+                    ASSERT_NE(nullptr, found);
+                    EXPECT_EQ(found, storage()->locateByClOrderId(found->clOrderId_.get()));
+                    ++totalChecked;
+                }
+            });
+    }
+    for (int i = 0; i < numOrders; ++i)
+    {
+        auto order = createCorrectOrder();
+        assignClOrderId(order.get());
+        OrderEntry *saved = storage()->save(*order, IdTGenerator::instance());
+        ASSERT_NE(nullptr, saved);
+        orderIds[i] = saved->orderId_;
+        published.store(i + 1, std::memory_order_release);
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_LE(numReaders, totalChecked.load());
+    size_t visited = 0;
+    storage()->forEachOrder(
+        [&visited](const IdT &id, const OrderEntry &order)
+        {
+            EXPECT_EQ(id, order.orderId_);
+            ++visited;
+        });
+    EXPECT_LE(static_cast<size_t>(numOrders), visited);
+}
+
 // =============================================================================
 // Concurrent Execution Save/Lookup Tests
 // =============================================================================
@@ -0,0 +1,406 @@
+/**
+ Concurrent Order Processor library - Google Test
+
+ Authors: dudleylane, Claude
+ Test: 2026
+
+ Copyright (C) 2026 dudleylane
+
+ Distributed under the GNU Affero General Public License (AGPL).
+*/
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <string>
+#include <map>
+#include <thread>
+#include <fstream>
+#include <filesystem>
+
+#include "SegmentedLogStorage.h"
+
+using namespace COP;
+using namespace COP::Store;
+
+namespace
+{
+
+// =============================================================================
+// Test Observer Implementation
+// =============================================================================
+
+/// keeps the last loaded body of every id and version
+class TestLogObserver : public FileStorageObserver
+{
+public:
+    TestLogObserver() : finished_(false) {}
+
+    void startLoad() override
+    {
+        finished_ = false;
+        records_.clear();
+    }
+
+    void onRecordLoaded(const IdT &id, u32 version, const char *ptr, size_t s) override
+    {
+        ASSERT_NE(nullptr, ptr);
+        records_[std::make_pair(id, version)] = std::string(ptr, s);
+    }
+
+    void finishLoad() override
+    {
+        finished_ = true;
+    }
+
+    const std::string *record(const IdT &id, u32 version) const
+    {
+        auto it = records_.find(std::make_pair(id, version));
+        return (records_.end() == it) ? nullptr : &it->second;
+    }
+
+public:
+    bool finished_;
+    std::map<std::pair<IdT, u32>, std::string> records_;
+};
+
+// =============================================================================
+// Test Fixture
+// =============================================================================
+
+class SegmentedLogStorageTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        testDir_ = "test_segmented_log_storage";
+        std::filesystem::remove_all(testDir_);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(testDir_);
+    }
+
+    std::string segmentPath(u32 number) const
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "%08u.seg", number);
+        return testDir_ + "/" + name;
+    }
+
+    /// overwrites one byte of the segment file
+    void damage(u32 segment, u64 offset)
+    {
+        std::fstream file(segmentPath(segment), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(static_cast<std::streamoff>(offset));
+        const char val = static_cast<char>(file.get());
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.put(static_cast<char>(val ^ 0x5a));
+    }
+
+protected:
+    std::string testDir_;
+};
+
+/// first record of a segment follows the header block, records are 40 bytes of header and the body padded to 8
+const u64 FIRST_RECORD = 4096;
+const u64 RECORD_HEADER = 40;
+
+// =============================================================================
+// Basic Tests
+// =============================================================================
+
+TEST_F(SegmentedLogStorageTest, CreateWithNewDirectory)
+{
+    TestLogObserver observer;
+    SegmentedLogStorage storage(testDir_, &observer);
+
+    EXPECT_TRUE(observer.finished_);
+    EXPECT_TRUE(observer.records_.empty());
+    EXPECT_EQ(1u, storage.segmentCount());
+}
+
+TEST_F(SegmentedLogStorageTest, SaveDuplicateIdThrows)
+{
+    TestLogObserver observer;
+    SegmentedLogStorage storage(testDir_, &observer);
+
+    storage.save(IdT(1, 1), "aaaa", 4);
+    EXPECT_THROW(storage.save(IdT(1, 1), "dubRec", 6), std::exception);
+
+    IdT id = storage.save("bbbb", 4);
+    EXPECT_TRUE(id.isValid());
+    EXPECT_TRUE(storage.isExists(id));
+}
+
+TEST_F(SegmentedLogStorageTest, SaveAndReloadViaObserver)
+{
+    {
+        TestLogObserver observer;
+        SegmentedLogStorage storage(testDir_, &observer);
+        storage.save(IdT(1, 1), "first", 5);
+        storage.save(IdT(2, 1), "second", 6);
+        storage.save(IdT(3, 1), "third", 5);
+    }
+
+    TestLogObserver observer;
+    SegmentedLogStorage storage(testDir_, &observer);
+    ASSERT_EQ(3u, observer.records_.size());
+    EXPECT_EQ("first", *observer.record(IdT(1, 1), 0));
+    EXPECT_EQ("second", *observer.record(IdT(2, 1), 0));
+    EXPECT_EQ("third", *observer.record(IdT(3, 1), 0));
+    EXPECT_THROW(storage.save(IdT(2, 1), "again", 5), std::exception);
+}
+
+// =============================================================================
+// Version Tests
+// =============================================================================
+
+TEST_F(SegmentedLogStorageTest, UpdateReplaceAndErasePersist)
+{
+    {
+        TestLogObserver observer;
+        SegmentedLogStorage storage(testDir_, &observer);
+        storage.save(IdT(1, 1), "v0", 2);
+        EXPECT_EQ(1u, storage.update(IdT(1, 1), "v1", 2));
+        EXPECT_EQ(2u, storage.update(IdT(1, 1), "v2", 2));
+        EXPECT_EQ(0u, storage.update(IdT(2, 1), "other", 5));
+
+        EXPECT_EQ(3u, storage.replace(IdT(1, 1), 1, "v3", 2));
+        EXPECT_FALSE(storage.isExists(IdT(1, 1), 1));
+        EXPECT_THROW(storage.replace(IdT(1, 1), 1, "v4", 2), std::runtime_error);
+        EXPECT_THROW(storage.replace(IdT(9, 1), 0, "v4", 2), std::runtime_error);
+
+        storage.erase(IdT(1, 1), 0);
+        storage.erase(IdT(2, 1));
+        storage.erase(IdT(7, 7));
+        EXPECT_EQ(3u, storage.getTopVersion(IdT(1, 1)));
+        EXPECT_FALSE(storage.isExists(IdT(2, 1)));
+    }
+
+    TestLogObserver observer;
+    SegmentedLogStorage storage(testDir_, &observer);
+    ASSERT_EQ(2u, observer.records_.size());
+    EXPECT_EQ("v2", *observer.record(IdT(1, 1), 2));
+    EXPECT_EQ("v3", *observer.record(IdT(1, 1), 3));
+    EXPECT_FALSE(storage.isExists(IdT(2, 1)));
+    EXPECT_EQ(2u, storage.recordSize(IdT(1, 1), 3));
+}
+
+TEST_F(SegmentedLogStorageTest, LoadRecordBeforeAndAfterWrite)
+{
+    SegmentedLogParams params;
+    params.syncOnCommit_ = false;
+    params.syncIntervalMs_ = 0;
+    TestLogObserver observer;
+    SegmentedLogStorage storage(testDir_, &observer, params);
+
+    storage.save(IdT(1, 1), "buffered", 8);
+    std::vector<char> buf;
+    ASSERT_TRUE(storage.loadRecord(IdT(1, 1), 0, &buf));
+    EXPECT_EQ("buffered", std::string(buf.begin(), buf.end()));
+
+    // a record of the full block is read back from the file
+    const std::string big(8192, 'b');
+    storage.save(IdT(2, 1), big.data(), big.size());
+    storage.sync();
+    ASSERT_TRUE(storage.loadRecord(IdT(2, 1), 0, &buf));
+    EXPECT_EQ(big, std::string(buf.begin(), buf.end()));
+    EXPECT_FALSE(storage.loadRecord(IdT(3, 1), 0, &buf));
+}
+
+// =============================================================================
+// Segment Tests
+// =============================================================================
+
+TEST_F(SegmentedLogStorageTest, CompactionRemovesSupersededSegments)
+{
+    SegmentedLogParams params;
+    params.segmentSize_ = 16 * 1024;
+    params.syncOnCommit_ = false;
+    params.syncIntervalMs_ = 0;
+    const std::string body(1000, 'x');
+    {
+        TestLogObserver observer;
+        SegmentedLogStorage storage(testDir_, &observer, params);
+        storage.save(IdT(100, 1), "kept", 4);
+        for (u32 i = 0; i < 60; ++i)
+        {
+            const u32 version = storage.update(IdT(1 + i % 3, 1), body.data(), body.size());
+            if (0 < version)
+            {
+                storage.erase(IdT(1 + i % 3, 1), version - 1);
+            }
+        }
+        const size_t segments = storage.segmentCount();
+        EXPECT_LT(3u, segments);
+        const u64 live = storage.liveBytes();
+
+        const size_t removed = storage.compact();
+        EXPECT_LT(0u, removed);
+        EXPECT_EQ(removed, storage.totalCompactedSegments());
+        EXPECT_GT(segments, storage.segmentCount());
+        EXPECT_EQ(live, storage.liveBytes());
+        std::vector<char> buf;
+        ASSERT_TRUE(storage.loadRecord(IdT(100, 1), 0, &buf));
+        EXPECT_EQ("kept", std::string(buf.begin(), buf.end()));
+    }
+
+    TestLogObserver observer;
+    SegmentedLogStorage storage(testDir_, &observer, params);
+    ASSERT_EQ(4u, observer.records_.size());
+    EXPECT_EQ("kept", *observer.record(IdT(100, 1), 0));
+    for (u64 id = 1; id <= 3; ++id)
+    {
+        EXPECT_EQ(19u, storage.getTopVersion(IdT(id, 1)));
+        EXPECT_EQ(body, *observer.record(IdT(id, 1), 19));
+    }
+}
+
+TEST_F(SegmentedLogStorageTest, CompactedOldVersionIsLoadedBeforeNewer)
+{
+    SegmentedLogParams params;
+    params.segmentSize_ = 16 * 1024;
+    params.syncOnCommit_ = false;
+    params.syncIntervalMs_ = 0;
+    const std::string body(1000, 'x');
+    {
+        TestLogObserver observer;
+        SegmentedLogStorage storage(testDir_, &observer, params);
+        // old version and dead bodies fill the first segment
+        storage.save(IdT(100, 1), "old", 3);
+        for (u32 i = 0; i < 12; ++i)
+        {
+            const u32 version = storage.update(IdT(1, 1), body.data(), body.size());
+            if (0 < version)
+            {
+                storage.erase(IdT(1, 1), version - 1);
+            }
+        }
+        EXPECT_EQ(1u, storage.update(IdT(100, 1), "new", 3));
+        // segment of the new version stays, the old version is copied behind it
+        for (u32 i = 0; i < 8; ++i)
+        {
+            storage.save(IdT(200 + i, 1), body.data(), body.size());
+        }
+        EXPECT_EQ(1u, storage.compact());
+    }
+
+    struct OrderObserver : public TestLogObserver
+    {
+        void onRecordLoaded(const IdT &id, u32 version, const char *ptr, size_t s) override
+        {
+            TestLogObserver::onRecordLoaded(id, version, ptr, s);
+            if (IdT(100, 1) == id)
+            {
+                versions_.push_back(version);
+            }
+        }
+        std::vector<u32> versions_;
+    } observer;
+    SegmentedLogStorage storage(testDir_, &observer, params);
+    EXPECT_EQ(std::vector<u32>({ 0, 1 }), observer.versions_);
+    EXPECT_EQ("new", *observer.record(IdT(100, 1), 1));
+}
+
+TEST_F(SegmentedLogStorageTest, InterruptedTailIsDropped)
+{
+    {
+        TestLogObserver observer;
+        SegmentedLogStorage storage(testDir_, &observer);
+        for (u64 i = 1; i <= 5; ++i)
+        {
+            storage.save(IdT(i, 1), "abcdefgh", 8);
+        }
+    }
+    // the 4th record is torn, the ones after it were never acknowledged
+    damage(1, FIRST_RECORD + 3 * (RECORD_HEADER + 8) + RECORD_HEADER);
+
+    {
+        TestLogObserver observer;
+        SegmentedLogStorage storage(testDir_, &observer);
+        EXPECT_EQ(3u, observer.records_.size());
+        EXPECT_FALSE(storage.isExists(IdT(4, 1)));
+        storage.save(IdT(4, 1), "restored", 8);
+    }
+
+    TestLogObserver observer;
+    SegmentedLogStorage storage(testDir_, &observer);
+    EXPECT_EQ(4u, observer.records_.size());
+    EXPECT_EQ("restored", *observer.record(IdT(4, 1), 0));
+}
+
+TEST_F(SegmentedLogStorageTest, DamagedSealedSegmentThrows)
+{
+    {
+        TestLogObserver observer;
+        SegmentedLogStorage storage(testDir_, &observer);
+        storage.save(IdT(1, 1), "abcdefgh", 8);
+        storage.save(IdT(2, 1), "abcdefgh", 8);
+    }
+    {
+        // restart seals the segment
+        TestLogObserver observer;
+        SegmentedLogStorage storage(testDir_, &observer);
+        EXPECT_EQ(2u, storage.segmentCount());
+    }
+    damage(1, FIRST_RECORD + RECORD_HEADER);
+
+    TestLogObserver observer;
+    EXPECT_THROW(SegmentedLogStorage(testDir_, &observer), std::runtime_error);
+}
+
+// =============================================================================
+// Write Mode Tests
+// =============================================================================
+
+TEST_F(SegmentedLogStorageTest, ConcurrentCommitsAreDurable)
+{
+    const u64 threads = 4;
+    const u64 perThread = 50;
+    {
+        TestLogObserver observer;
+        SegmentedLogStorage storage(testDir_, &observer);
+        std::vector<std::thread> workers;
+        for (u64 t = 0; t < threads; ++t)
+        {
+            workers.emplace_back(
+                [&storage, t]()
+                {
+                    for (u64 i = 0; i < perThread; ++i)
+                    {
+                        const std::string rec = std::to_string(t) + ":" + std::to_string(i);
+                        storage.save(IdT(1 + t * perThread + i, 1), rec.data(), rec.size());
+                    }
+                });
+        }
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    TestLogObserver observer;
+    SegmentedLogStorage storage(testDir_, &observer);
+    ASSERT_EQ(threads * perThread, observer.records_.size());
+    EXPECT_EQ("3:49", *observer.record(IdT(threads * perThread, 1), 0));
+}
+
+TEST_F(SegmentedLogStorageTest, DirectIoFallsBackWhenRefused)
+{
+    SegmentedLogParams params;
+    params.directIo_ = true;
+    {
+        TestLogObserver observer;
+        SegmentedLogStorage storage(testDir_, &observer, params);
+        storage.save(IdT(1, 1), "direct", 6);
+        storage.update(IdT(1, 1), "direct1", 7);
+    }
+
+    TestLogObserver observer;
+    SegmentedLogStorage storage(testDir_, &observer, params);
+    EXPECT_EQ(2u, observer.records_.size());
+    EXPECT_EQ("direct1", *observer.record(IdT(1, 1), 1));
+}
+
+} // namespace
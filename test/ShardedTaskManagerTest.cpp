@@ -0,0 +1,187 @@
+/**
+ Concurrent Order Processor library - New Test File
+
+ Authors: dudleylane, Claude
+ Test Implementation: 2026
+
+ Copyright (C) 2026 dudleylane
+
+ Distributed under the GNU Affero General Public License (AGPL).
+*/
+
+#include <gtest/gtest.h>
+#include <atomic>
+
+#include "TestFixtures.h"
+#include "TestAux.h"
+
+#include "ShardedQueues.h"
+#include "ShardedTaskManager.h"
+#include "OrderStorage.h"
+#include "IdTGenerator.h"
+
+using namespace COP;
+using namespace COP::Tasks;
+using namespace COP::Store;
+using namespace COP::Queues;
+using namespace test;
+
+namespace
+{
+
+class CountingOutQueues : public OutQueues
+{
+public:
+    CountingOutQueues() : execReportCount_(0), rejectCount_(0) {}
+
+    void push(const ExecReportEvent &, const std::string &) override
+    {
+        ++execReportCount_;
+    }
+    void push(const CancelRejectEvent &, const std::string &) override
+    {
+        ++rejectCount_;
+    }
+    void push(const BusinessRejectEvent &, const std::string &) override
+    {
+        ++rejectCount_;
+    }
+
+    std::atomic<int> execReportCount_;
+    std::atomic<int> rejectCount_;
+};
+
+class ShardedTaskManagerTest : public ProcessorFixture
+{
+protected:
+    void SetUp() override
+    {
+        ProcessorFixture::SetUp();
+        outQueues_ = std::make_unique<CountingOutQueues>();
+        inQueues_ = std::make_unique<ShardedInQueues>(2, OrderStorage::instance());
+    }
+
+    void TearDown() override
+    {
+        inQueues_.reset();
+        outQueues_.reset();
+        ProcessorFixture::TearDown();
+    }
+
+    std::unique_ptr<ShardedTaskManager> createManager()
+    {
+        ShardedTaskManagerParams params;
+        params.generator_ = IdTGenerator::instance();
+        params.orderStorage_ = OrderStorage::instance();
+        params.outQueues_ = outQueues_.get();
+        params.inQueues_ = inQueues_.get();
+        params.instruments_ = instruments_;
+        params.orderSaver_ = &orderSaver_;
+        return std::make_unique<ShardedTaskManager>(params);
+    }
+
+    std::unique_ptr<OrderEntry> createOrder(const SourceIdT &instrument, Side side, PriceT price)
+    {
+        auto order = createCorrectOrder(instrument);
+        assignClOrderId(order.get());
+        order->side_ = side;
+        order->price_ = price;
+        order->leavesQty_ = order->orderQty_;
+        return order;
+    }
+
+protected:
+    std::unique_ptr<CountingOutQueues> outQueues_;
+    std::unique_ptr<ShardedInQueues> inQueues_;
+};
+
+} // namespace
+
+// =============================================================================
+// Routing Tests
+// =============================================================================
+
+TEST_F(ShardedTaskManagerTest, RejectsZeroShards)
+{
+    EXPECT_THROW(ShardedInQueues(0, OrderStorage::instance()), std::runtime_error);
+}
+
+TEST_F(ShardedTaskManagerTest, OrderEventRoutedByInstrument)
+{
+    const size_t shard = inQueues_->shardOf(instrumentId2_);
+    inQueues_->push("test", OrderEvent(createOrder(instrumentId2_, BUY_SIDE, 10.0).release()));
+
+    EXPECT_EQ(1u, inQueues_->size());
+    EXPECT_EQ(1u, inQueues_->shard(shard)->size());
+}
+
+TEST_F(ShardedTaskManagerTest, CancelEventRoutedByOrderInstrument)
+{
+    auto order = createOrder(instrumentId2_, SELL_SIDE, 10.0);
+    OrderEntry *saved = OrderStorage::instance()->save(*order, IdTGenerator::instance());
+    ASSERT_NE(nullptr, saved);
+
+    inQueues_->push("test", OrderCancelEvent(saved->orderId_));
+
+    EXPECT_EQ(1u, inQueues_->shard(inQueues_->shardOf(instrumentId2_))->size());
+}
+
+TEST_F(ShardedTaskManagerTest, UnknownOrderRoutedToFirstShard)
+{
+    inQueues_->push("test", OrderCancelEvent(IdT(987654321, 1)));
+
+    EXPECT_EQ(1u, inQueues_->shard(0)->size());
+    EXPECT_EQ(1u, inQueues_->size());
+}
+
+// =============================================================================
+// Processing Tests
+// =============================================================================
+
+TEST_F(ShardedTaskManagerTest, BookSlicesFollowRouting)
+{
+    auto manager = createManager();
+
+    EXPECT_EQ(2u, manager->shardCount());
+    EXPECT_EQ(manager->shardOrderBook(inQueues_->shardOf(instrumentId1_)), manager->orderBook(instrumentId1_));
+    EXPECT_EQ(manager->shardOrderBook(inQueues_->shardOf(instrumentId2_)), manager->orderBook(instrumentId2_));
+    EXPECT_NO_THROW(manager->orderBook(instrumentId1_)->getTop(instrumentId1_, BUY_SIDE));
+    EXPECT_NO_THROW(manager->orderBook(instrumentId2_)->getTop(instrumentId2_, BUY_SIDE));
+}
+
+TEST_F(ShardedTaskManagerTest, ProcessOrdersOnOwningShard)
+{
+    auto manager = createManager();
+
+    inQueues_->push("test", OrderEvent(createOrder(instrumentId1_, BUY_SIDE, 10.0).release()));
+    inQueues_->push("test", OrderEvent(createOrder(instrumentId2_, SELL_SIDE, 20.0).release()));
+
+    ASSERT_TRUE(manager->waitUntilTransactionsFinished(5));
+
+    EXPECT_EQ(2, manager->eventsProcessed());
+    EXPECT_GE(outQueues_->execReportCount_.load(), 2);
+    EXPECT_TRUE(manager->orderBook(instrumentId1_)->getTop(instrumentId1_, BUY_SIDE).isValid());
+    EXPECT_TRUE(manager->orderBook(instrumentId2_)->getTop(instrumentId2_, SELL_SIDE).isValid());
+}
+
+TEST_F(ShardedTaskManagerTest, MatchWithinShard)
+{
+    auto manager = createManager();
+
+    inQueues_->push("test", OrderEvent(createOrder(instrumentId1_, SELL_SIDE, 10.0).release()));
+    inQueues_->push("test", OrderEvent(createOrder(instrumentId1_, BUY_SIDE, 10.0).release()));
+
+    ASSERT_TRUE(manager->waitUntilTransactionsFinished(5));
+
+    EXPECT_GE(outQueues_->execReportCount_.load(), 4);
+    EXPECT_FALSE(manager->orderBook(instrumentId1_)->getTop(instrumentId1_, BUY_SIDE).isValid());
+    EXPECT_FALSE(manager->orderBook(instrumentId1_)->getTop(instrumentId1_, SELL_SIDE).isValid());
+}
+
+TEST_F(ShardedTaskManagerTest, WaitWithEmptyQueues)
+{
+    auto manager = createManager();
+
+    EXPECT_TRUE(manager->waitUntilTransactionsFinished(1));
+    EXPECT_EQ(0, manager->eventsProcessed());
+}
@@ -0,0 +1,82 @@
+/**
+ Concurrent Order Processor library - New Test File
+
+ Authors: dudleylane, Claude
+ Test Implementation: 2026
+
+ Copyright (C) 2026 dudleylane
+
+ Distributed under the GNU Affero General Public License (AGPL).
+*/
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "SourceRegistry.h"
+
+using namespace COP;
+using namespace COP::Queues;
+
+namespace
+{
+
+TEST(SourceRegistryTest, InternReturnsSameHandleForSameName)
+{
+    SourceRegistry *reg = SourceRegistry::instance();
+
+    SourceHandle h1 = reg->intern("SourceRegistryTest.A");
+    SourceHandle h2 = reg->intern(std::string("SourceRegistryTest.") + "A");
+    SourceHandle h3 = reg->intern("SourceRegistryTest.B");
+
+    EXPECT_EQ(h1, h2);
+    EXPECT_NE(h1, h3);
+}
+
+TEST(SourceRegistryTest, NameResolvesInternedString)
+{
+    SourceRegistry *reg = SourceRegistry::instance();
+
+    SourceHandle h = reg->intern("SourceRegistryTest.Name");
+
+    EXPECT_EQ("SourceRegistryTest.Name", reg->name(h));
+    EXPECT_LT(h, reg->size());
+}
+
+TEST(SourceRegistryTest, RegistryOwnedNameResolvesToItsHandle)
+{
+    SourceRegistry *reg = SourceRegistry::instance();
+
+    SourceHandle h = reg->intern("SourceRegistryTest.Owned");
+    const std::string &owned = reg->name(h);
+
+    EXPECT_EQ(h, reg->intern(owned));
+    EXPECT_EQ(&owned, &reg->name(reg->intern(owned)));
+}
+
+TEST(SourceRegistryTest, TableGrowsBeyondOneChunk)
+{
+    SourceRegistry *reg = SourceRegistry::instance();
+
+    std::vector<SourceHandle> handles;
+    for (int i = 0; i < SourceRegistry::SOURCES_PER_CHUNK + 10; ++i)
+    {
+        handles.push_back(reg->intern("SourceRegistryTest.Grow" + std::to_string(i)));
+    }
+    EXPECT_LE(static_cast<size_t>(SourceRegistry::SOURCES_PER_CHUNK + 10), reg->size());
+    for (int i = 0; i < SourceRegistry::SOURCES_PER_CHUNK + 10; ++i)
+    {
+        const std::string &owned = reg->name(handles[i]);
+        EXPECT_EQ("SourceRegistryTest.Grow" + std::to_string(i), owned);
+        EXPECT_EQ(handles[i], reg->intern(owned));
+    }
+}
+
+TEST(SourceRegistryTest, UnknownHandleThrows)
+{
+    SourceRegistry *reg = SourceRegistry::instance();
+
+    EXPECT_THROW(reg->name(static_cast<SourceHandle>(SourceRegistry::MAX_SOURCES)), std::runtime_error);
+}
+
+} // namespace
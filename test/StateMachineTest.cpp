@@ -46,6 +46,7 @@ class TestOrderBook : public OrderBook
 public:
     void add(const OrderEntry &) override {}
     void remove(const OrderEntry &) override {}
+    void update(const OrderEntry &) override {}
     IdT find(const OrderFunctor &) const override
     {
         return IdT();
@@ -135,6 +135,8 @@ public:
 
     void remove(const OrderEntry & /*order*/) override {}
 
+    void update(const OrderEntry & /*order*/) override {}
+
     IdT find(const OrderFunctor & /*functor*/) const override
     {
         return IdT();
@@ -484,6 +486,7 @@ TEST_F(StorageRecordDispatcherTest, LoadOrderRecord)
 
     std::unique_ptr<OrderEntry> val(createTestOrder());
     val->orderId_ = IdT(1111, 6789);
+    val->status_ = NEW_ORDSTATUS;
 
     std::string buf = createRecordTypePrefix(StorageRecordDispatcher::ORDER_RECORDTYPE);
     IdT id;
@@ -500,6 +503,29 @@ TEST_F(StorageRecordDispatcherTest, LoadOrderRecord)
     dispatcher_->finishLoad();
 }
 
+TEST_F(StorageRecordDispatcherTest, LoadNotRestingOrderRecordSkipsBook)
+{
+    dispatcher_->init(restore_.get(), orderBook_.get(), saver_.get(), orderStorage_.get());
+    dispatcher_->startLoad();
+
+    // rejected order keeps leavesQty, but never rests in the book
+    std::unique_ptr<OrderEntry> val(createTestOrder());
+    val->orderId_ = IdT(1112, 6789);
+    ASSERT_EQ(REJECTED_ORDSTATUS, val->status_);
+
+    std::string buf = createRecordTypePrefix(StorageRecordDispatcher::ORDER_RECORDTYPE);
+    IdT id;
+    u32 version = 0;
+    OrderCodec::encode(*val, &buf, &id, &version);
+
+    dispatcher_->onRecordLoaded(id, version, buf.c_str(), buf.size());
+
+    EXPECT_TRUE(orderBook_->orders_.empty());
+    EXPECT_NE(nullptr, orderStorage_->locateByOrderId(val->orderId_));
+
+    dispatcher_->finishLoad();
+}
+
 // =============================================================================
 // Load Multiple Record Types Tests
 // =============================================================================
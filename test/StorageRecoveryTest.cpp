@@ -0,0 +1,306 @@
+/**
+ Concurrent Order Processor library - Google Test
+
+ Authors: dudleylane, Claude
+ Test: 2026
+
+ Copyright (C) 2026 dudleylane
+
+ Distributed under the GNU Affero General Public License (AGPL).
+*/
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <memory>
+
+#include "TestFixtures.h"
+#include "TestAux.h"
+
+#include "DataModelDef.h"
+#include "StorageRecovery.h"
+#include "StorageRecordDispatcher.h"
+#include "InstrumentCodec.h"
+#include "StringTCodec.h"
+#include "AccountCodec.h"
+#include "OrderCodec.h"
+#include "ExecutionCodec.h"
+#include "OrderStorage.h"
+
+using namespace COP;
+using namespace COP::Codec;
+using namespace COP::Store;
+using namespace test;
+
+namespace
+{
+
+// =============================================================================
+// Test Data Storage Restore Implementation
+// =============================================================================
+
+class RecordingDataStorageRestore : public DataStorageRestore
+{
+public:
+    void restore(InstrumentEntry *val) override
+    {
+        instruments_.emplace_back(val);
+    }
+
+    void restore(const IdT &id, StringT *val) override
+    {
+        stringIds_.push_back(id);
+        strings_.emplace_back(val);
+    }
+
+    void restore(RawDataEntry *val) override
+    {
+        rawDatas_.emplace_back(val);
+    }
+
+    void restore(AccountEntry *val) override
+    {
+        accounts_.emplace_back(val);
+    }
+
+    void restore(ClearingEntry *val) override
+    {
+        clearings_.emplace_back(val);
+    }
+
+    void restore(ExecutionsT * /*val*/) override {}
+
+public:
+    std::vector<std::unique_ptr<InstrumentEntry>> instruments_;
+    std::vector<IdT> stringIds_;
+    std::vector<std::unique_ptr<StringT>> strings_;
+    std::vector<std::unique_ptr<RawDataEntry>> rawDatas_;
+    std::vector<std::unique_ptr<AccountEntry>> accounts_;
+    std::vector<std::unique_ptr<ClearingEntry>> clearings_;
+};
+
+std::string createRecordTypePrefix(int recordType)
+{
+    std::string buf;
+    buf.append(reinterpret_cast<const char *>(&recordType), sizeof(recordType));
+    return buf;
+}
+
+// =============================================================================
+// Test Fixture
+// =============================================================================
+
+class StorageRecoveryTest : public OrderBookFixture
+{
+protected:
+    void SetUp() override
+    {
+        OrderBookFixture::SetUp();
+        recovery_ = std::make_unique<StorageRecovery>(&restore_, OrderStorage::instance());
+    }
+
+    void TearDown() override
+    {
+        recovery_.reset();
+        OrderBookFixture::TearDown();
+    }
+
+    /// encodes an order with its own ClOrderId as StorageRecordDispatcher saves it
+    void loadOrder(u64 seq, const SourceIdT &instrument, Side side)
+    {
+        std::unique_ptr<OrderEntry> order = createCorrectOrder(instrument);
+        const std::string clOrderId = "ClOrderId" + std::to_string(seq);
+        order->clOrderId_ = WideDataLazyRef<RawDataEntry>(WideDataStorage::instance()->add(
+            new RawDataEntry(STRING_RAWDATATYPE, clOrderId.c_str(), static_cast<u32>(clOrderId.size()))));
+        order->orderId_ = IdT(seq, 20260119);
+        order->status_ = NEW_ORDSTATUS;
+        order->leavesQty_ = order->orderQty_;
+        order->side_ = side;
+        order->price_ = 10.0 + static_cast<double>(seq % 7);
+
+        std::string buf = createRecordTypePrefix(StorageRecordDispatcher::ORDER_RECORDTYPE);
+        IdT id;
+        u32 version = 0;
+        OrderCodec::encode(*order, &buf, &id, &version);
+        recovery_->onRecordLoaded(id, version, buf.c_str(), buf.size());
+    }
+
+protected:
+    RecordingDataStorageRestore restore_;
+    std::unique_ptr<StorageRecovery> recovery_;
+};
+
+// =============================================================================
+// Reference Data Tests
+// =============================================================================
+
+TEST_F(StorageRecoveryTest, RestoresReferenceDataOnFinishLoad)
+{
+    recovery_->startLoad();
+    {
+        InstrumentEntry val;
+        val.id_ = IdT(11, 20260119);
+        val.securityId_ = "securityId_";
+        val.securityIdSource_ = "securityIdSource_";
+        val.symbol_ = "symbol_";
+        std::string buf = createRecordTypePrefix(StorageRecordDispatcher::INSTRUMENT_RECORDTYPE);
+        IdT id;
+        u32 version = 0;
+        InstrumentCodec::encode(val, &buf, &id, &version);
+        recovery_->onRecordLoaded(id, version, buf.c_str(), buf.size());
+    }
+    {
+        AccountEntry val;
+        val.id_ = IdT(12, 20260119);
+        val.account_ = "account_";
+        val.firm_ = "firm_";
+        val.type_ = PRINCIPAL_ACCOUNTTYPE;
+        std::string buf = createRecordTypePrefix(StorageRecordDispatcher::ACCOUNT_RECORDTYPE);
+        IdT id;
+        u32 version = 0;
+        AccountCodec::encode(val, &buf, &id, &version);
+        recovery_->onRecordLoaded(id, version, buf.c_str(), buf.size());
+    }
+    EXPECT_TRUE(restore_.instruments_.empty());
+
+    recovery_->finishLoad();
+
+    ASSERT_EQ(1u, restore_.instruments_.size());
+    EXPECT_EQ("symbol_", restore_.instruments_[0]->symbol_);
+    EXPECT_EQ(IdT(11, 20260119), restore_.instruments_[0]->id_);
+    ASSERT_EQ(1u, restore_.accounts_.size());
+    EXPECT_EQ("account_", restore_.accounts_[0]->account_);
+    EXPECT_EQ(1u, recovery_->recordCount(StorageRecordDispatcher::INSTRUMENT_RECORDTYPE));
+    EXPECT_EQ(1u, recovery_->recordCount(StorageRecordDispatcher::ACCOUNT_RECORDTYPE));
+    EXPECT_EQ(0u, recovery_->recordCount(StorageRecordDispatcher::ORDER_RECORDTYPE));
+}
+
+TEST_F(StorageRecoveryTest, KeepsLoadOrderWithinType)
+{
+    const size_t count = 3000;
+    recovery_->startLoad();
+    for (size_t i = 0; i < count; ++i)
+    {
+        StringT val = "string_" + std::to_string(i);
+        std::string buf = createRecordTypePrefix(StorageRecordDispatcher::STRING_RECORDTYPE);
+        StringTCodec::encode(val, &buf);
+        recovery_->onRecordLoaded(IdT(i + 1, 20260119), 0, buf.c_str(), buf.size());
+    }
+    recovery_->finishLoad();
+
+    ASSERT_EQ(count, restore_.strings_.size());
+    for (size_t i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(IdT(i + 1, 20260119), restore_.stringIds_[i]);
+        EXPECT_EQ("string_" + std::to_string(i), *restore_.strings_[i]);
+    }
+}
+
+TEST_F(StorageRecoveryTest, InvalidRecordsThrow)
+{
+    recovery_->startLoad();
+    std::string buf = createRecordTypePrefix(StorageRecordDispatcher::TOTAL_RECORDTYPE);
+    buf.append("body");
+    EXPECT_THROW(recovery_->onRecordLoaded(IdT(1, 1), 0, buf.c_str(), buf.size()), std::runtime_error);
+    EXPECT_THROW(recovery_->onRecordLoaded(IdT(1, 1), 0, "ab", 2), std::runtime_error);
+}
+
+// =============================================================================
+// Order Tests
+// =============================================================================
+
+TEST_F(StorageRecoveryTest, OrdersWaitForRestoreOrders)
+{
+    const u64 count = 2000;
+    recovery_->startLoad();
+    for (u64 i = 1; i <= count; ++i)
+    {
+        loadOrder(i, (0 == i % 2) ? instrumentId1_ : instrumentId2_, (0 == i % 3) ? SELL_SIDE : BUY_SIDE);
+    }
+    recovery_->finishLoad();
+
+    EXPECT_EQ(count, recovery_->pendingOrders());
+    EXPECT_EQ(nullptr, OrderStorage::instance()->locateByOrderId(IdT(1, 20260119)));
+
+    recovery_->restoreOrders(orderBook_.get());
+
+    EXPECT_EQ(0u, recovery_->pendingOrders());
+    for (u64 i = 1; i <= count; ++i)
+    {
+        OrderEntry *order = OrderStorage::instance()->locateByOrderId(IdT(i, 20260119));
+        ASSERT_NE(nullptr, order);
+        EXPECT_EQ(NEW_ORDSTATUS, order->status_);
+    }
+    EXPECT_TRUE(orderBook_->getTop(instrumentId1_, BUY_SIDE).isValid());
+    EXPECT_TRUE(orderBook_->getTop(instrumentId1_, SELL_SIDE).isValid());
+    EXPECT_TRUE(orderBook_->getTop(instrumentId2_, BUY_SIDE).isValid());
+    EXPECT_TRUE(orderBook_->getTop(instrumentId2_, SELL_SIDE).isValid());
+}
+
+TEST_F(StorageRecoveryTest, OrderLoadedLastWins)
+{
+    recovery_->startLoad();
+    loadOrder(1, instrumentId1_, BUY_SIDE);
+    loadOrder(2, instrumentId1_, BUY_SIDE);
+    loadOrder(1, instrumentId1_, SELL_SIDE);
+    recovery_->finishLoad();
+
+    EXPECT_EQ(2u, recovery_->pendingOrders());
+    recovery_->restoreOrders(orderBook_.get());
+    OrderEntry *order = OrderStorage::instance()->locateByOrderId(IdT(1, 20260119));
+    ASSERT_NE(nullptr, order);
+    EXPECT_EQ(SELL_SIDE, order->side_);
+}
+
+TEST_F(StorageRecoveryTest, DuplicateOrderRestoresNone)
+{
+    recovery_->startLoad();
+    loadOrder(1, instrumentId1_, BUY_SIDE);
+    recovery_->finishLoad();
+    recovery_->restoreOrders(nullptr);
+
+    recovery_->startLoad();
+    loadOrder(2, instrumentId1_, BUY_SIDE);
+    loadOrder(1, instrumentId1_, SELL_SIDE);
+    recovery_->finishLoad();
+
+    EXPECT_THROW(recovery_->restoreOrders(orderBook_.get()), std::runtime_error);
+    EXPECT_EQ(nullptr, OrderStorage::instance()->locateByOrderId(IdT(2, 20260119)));
+    EXPECT_FALSE(orderBook_->getTop(instrumentId1_, BUY_SIDE).isValid());
+}
+
+TEST_F(StorageRecoveryTest, ExecutionsRestoredWithOrders)
+{
+    recovery_->startLoad();
+    loadOrder(1, instrumentId1_, BUY_SIDE);
+    TradeExecEntry trade;
+    trade.type_ = TRADE_EXECTYPE;
+    trade.orderId_ = IdT(1, 20260119);
+    trade.execId_ = IdT(2, 20260119);
+    trade.orderStatus_ = FILLED_ORDSTATUS;
+    trade.lastQty_ = 100;
+    trade.lastPx_ = 10.5;
+    std::string buf = createRecordTypePrefix(StorageRecordDispatcher::EXECUTION_RECORDTYPE);
+    IdT id;
+    u32 version = 0;
+    ExecutionCodec::encode(trade, &buf, &id, &version);
+    recovery_->onRecordLoaded(id, version, buf.c_str(), buf.size());
+    recovery_->finishLoad();
+
+    EXPECT_EQ(1u, recovery_->recordCount(StorageRecordDispatcher::EXECUTION_RECORDTYPE));
+    EXPECT_EQ(1u, recovery_->pendingExecutions());
+    EXPECT_EQ(nullptr, OrderStorage::instance()->locateByExecId(trade.execId_));
+
+    recovery_->restoreOrders(nullptr);
+
+    EXPECT_EQ(0u, recovery_->pendingExecutions());
+    const TradeExecEntry *restored =
+        dynamic_cast<const TradeExecEntry *>(OrderStorage::instance()->locateByExecId(trade.execId_));
+    ASSERT_NE(nullptr, restored);
+    EXPECT_EQ(trade.orderId_, restored->orderId_);
+    EXPECT_EQ(100u, restored->lastQty_);
+    EXPECT_DOUBLE_EQ(10.5, restored->lastPx_);
+}
+
+} // namespace
@@ -0,0 +1,318 @@
+/**
+ Concurrent Order Processor library - Google Test
+
+ Authors: dudleylane, Claude
+ Test: 2026
+
+ Copyright (C) 2026 dudleylane
+
+ Distributed under the GNU Affero General Public License (AGPL).
+*/
+
+#include <gtest/gtest.h>
+#include <string>
+#include <cstdio>
+#include <fstream>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <atomic>
+
+#include "TestFixtures.h"
+#include "TestAux.h"
+
+#include "DataModelDef.h"
+#include "StorageSnapshot.h"
+#include "StorageRecovery.h"
+#include "StorageRecordDispatcher.h"
+#include "LMDBStorage.h"
+#include "OrderStorage.h"
+#include "WideDataStorage.h"
+
+using namespace COP;
+using namespace COP::Store;
+using namespace test;
+
+namespace
+{
+
+class NullObserver : public FileStorageObserver
+{
+public:
+    void startLoad() override {}
+    void onRecordLoaded(const IdT &, u32, const char *, size_t) override {}
+    void finishLoad() override {}
+};
+
+size_t instrumentCount(const WideParamsDataStorage &storage)
+{
+    size_t count = 0;
+    storage.forEachInstrument([&count](const SourceIdT &, const InstrumentEntry &) { ++count; });
+    return count;
+}
+
+size_t accountCount(const WideParamsDataStorage &storage)
+{
+    size_t count = 0;
+    storage.forEachAccount([&count](const SourceIdT &, const AccountEntry &) { ++count; });
+    return count;
+}
+
+// =============================================================================
+// Test Fixture
+// =============================================================================
+
+class StorageSnapshotTest : public OrderBookFixture
+{
+protected:
+    void SetUp() override
+    {
+        OrderBookFixture::SetUp();
+        testDir_ = "test_storage_snapshot";
+        std::filesystem::remove_all(testDir_);
+        std::filesystem::create_directories(testDir_);
+        path_ = testDir_ + "/snapshot.cop";
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(testDir_);
+        OrderBookFixture::TearDown();
+    }
+
+    void addOrder(u64 seq, const SourceIdT &instrument)
+    {
+        std::unique_ptr<OrderEntry> order = createCorrectOrder(instrument);
+        const std::string clOrderId = "ClOrderId" + std::to_string(seq);
+        order->clOrderId_ = WideDataLazyRef<RawDataEntry>(WideDataStorage::instance()->add(
+            new RawDataEntry(STRING_RAWDATATYPE, clOrderId.c_str(), static_cast<u32>(clOrderId.size()))));
+        order->orderId_ = IdT(seq, 20260119);
+        order->status_ = NEW_ORDSTATUS;
+        order->price_ = 10.0 + static_cast<double>(seq);
+        OrderStorage::instance()->restore(order.release());
+    }
+
+protected:
+    std::string testDir_;
+    std::string path_;
+};
+
+// =============================================================================
+// Snapshot File Tests
+// =============================================================================
+
+TEST_F(StorageSnapshotTest, RoundTripRestoresStorages)
+{
+    const u64 count = 100;
+    for (u64 i = 1; i <= count; ++i)
+    {
+        addOrder(i, (0 == i % 2) ? instrumentId1_ : instrumentId2_);
+    }
+    std::unique_ptr<TradeExecEntry> trade(new TradeExecEntry());
+    trade->type_ = TRADE_EXECTYPE;
+    trade->orderId_ = IdT(1, 20260119);
+    trade->execId_ = IdT(count + 1, 20260119);
+    trade->lastQty_ = 50;
+    OrderStorage::instance()->restore(trade.release());
+    const u64 written = StorageSnapshot::write(path_, 42, *WideDataStorage::instance(), *OrderStorage::instance());
+    EXPECT_LT(count, written);
+    EXPECT_FALSE(std::filesystem::exists(path_ + ".tmp"));
+
+    WideParamsDataStorage restored;
+    OrderDataStorage restoredOrders;
+    StorageRecovery recovery(&restored, &restoredOrders);
+    u64 sequence = 0;
+    recovery.startLoad();
+    ASSERT_TRUE(StorageSnapshot::load(path_, &recovery, &sequence));
+    recovery.finishLoad();
+    recovery.restoreOrders(nullptr);
+
+    EXPECT_EQ(42u, sequence);
+    EXPECT_EQ(instrumentCount(*WideDataStorage::instance()), instrumentCount(restored));
+    EXPECT_EQ(count, recovery.recordCount(StorageRecordDispatcher::ORDER_RECORDTYPE));
+    for (u64 i = 1; i <= count; ++i)
+    {
+        const OrderEntry *order = restoredOrders.locateByOrderId(IdT(i, 20260119));
+        ASSERT_NE(nullptr, order);
+        EXPECT_DOUBLE_EQ(10.0 + static_cast<double>(i), order->price_);
+    }
+    EXPECT_EQ(1u, recovery.recordCount(StorageRecordDispatcher::EXECUTION_RECORDTYPE));
+    const TradeExecEntry *restoredTrade = dynamic_cast<const TradeExecEntry *>(
+        restoredOrders.locateByExecId(IdT(count + 1, 20260119)));
+    ASSERT_NE(nullptr, restoredTrade);
+    EXPECT_EQ(50u, restoredTrade->lastQty_);
+}
+
+TEST_F(StorageSnapshotTest, OrdersChangedDuringSnapshotAreConsistent)
+{
+    const u64 count = 50;
+    for (u64 i = 1; i <= count; ++i)
+    {
+        addOrder(i, instrumentId1_);
+        OrderEntry *order = OrderStorage::instance()->locateByOrderId(IdT(i, 20260119));
+        order->leavesQty_ = order->orderQty_;
+        order->cumQty_ = 0;
+    }
+    std::atomic<bool> stop{ false };
+    // fills orders in place the way the processing threads do, cumQty + leavesQty stays orderQty
+    std::thread filler(
+        [&]()
+        {
+            for (QuantityT fill = 0; !stop.load(); ++fill)
+            {
+                for (u64 i = 1; i <= count; ++i)
+                {
+                    OrderEntry *order = OrderStorage::instance()->locateByOrderId(IdT(i, 20260119));
+                    oneapi::tbb::spin_rw_mutex::scoped_lock lock(order->entryMutex_, true);
+                    order->cumQty_ = fill % (order->orderQty_ + 1);
+                    order->leavesQty_ = order->orderQty_ - order->cumQty_;
+                }
+            }
+        });
+    StorageSnapshot::write(path_, 1, *WideDataStorage::instance(), *OrderStorage::instance());
+    stop = true;
+    filler.join();
+
+    WideParamsDataStorage restored;
+    OrderDataStorage restoredOrders;
+    StorageRecovery recovery(&restored, &restoredOrders);
+    u64 sequence = 0;
+    recovery.startLoad();
+    ASSERT_TRUE(StorageSnapshot::load(path_, &recovery, &sequence));
+    recovery.finishLoad();
+    recovery.restoreOrders(nullptr);
+    for (u64 i = 1; i <= count; ++i)
+    {
+        const OrderEntry *order = restoredOrders.locateByOrderId(IdT(i, 20260119));
+        ASSERT_NE(nullptr, order);
+        EXPECT_EQ(order->orderQty_, order->cumQty_ + order->leavesQty_);
+    }
+}
+
+TEST_F(StorageSnapshotTest, OnlyRestingOrdersReturnToBook)
+{
+    // canceled order keeps leavesQty, filled order is on the opposite side of the same instrument
+    addOrder(1, instrumentId1_);
+    OrderEntry *canceled = OrderStorage::instance()->locateByOrderId(IdT(1, 20260119));
+    canceled->status_ = CANCELED_ORDSTATUS;
+    canceled->leavesQty_ = canceled->orderQty_;
+
+    addOrder(2, instrumentId1_);
+    OrderEntry *filled = OrderStorage::instance()->locateByOrderId(IdT(2, 20260119));
+    filled->status_ = FILLED_ORDSTATUS;
+    filled->side_ = SELL_SIDE;
+    filled->cumQty_ = filled->orderQty_;
+    filled->leavesQty_ = 0;
+
+    addOrder(3, instrumentId2_);
+    OrderEntry *live = OrderStorage::instance()->locateByOrderId(IdT(3, 20260119));
+    live->status_ = PARTFILL_ORDSTATUS;
+    live->cumQty_ = 1;
+    live->leavesQty_ = live->orderQty_ - 1;
+
+    StorageSnapshot::write(path_, 1, *WideDataStorage::instance(), *OrderStorage::instance());
+
+    WideParamsDataStorage restored;
+    OrderDataStorage restoredOrders;
+    StorageRecovery recovery(&restored, &restoredOrders);
+    u64 sequence = 0;
+    recovery.startLoad();
+    ASSERT_TRUE(StorageSnapshot::load(path_, &recovery, &sequence));
+    recovery.finishLoad();
+    recovery.restoreOrders(orderBook_.get());
+
+    const OrderEntry *restoredCanceled = restoredOrders.locateByOrderId(IdT(1, 20260119));
+    ASSERT_NE(nullptr, restoredCanceled);
+    EXPECT_EQ(CANCELED_ORDSTATUS, restoredCanceled->status_);
+    ASSERT_NE(nullptr, restoredOrders.locateByOrderId(IdT(2, 20260119)));
+
+    EXPECT_FALSE(orderBook_->getTop(instrumentId1_, BUY_SIDE).isValid());
+    EXPECT_FALSE(orderBook_->getTop(instrumentId1_, SELL_SIDE).isValid());
+    EXPECT_EQ(IdT(3, 20260119), orderBook_->getTop(instrumentId2_, BUY_SIDE));
+}
+
+TEST_F(StorageSnapshotTest, MissingSnapshotReturnsFalse)
+{
+    NullObserver observer;
+    u64 sequence = 7;
+    EXPECT_FALSE(StorageSnapshot::load(path_, &observer, &sequence));
+    EXPECT_EQ(7u, sequence);
+}
+
+TEST_F(StorageSnapshotTest, DamagedSnapshotThrows)
+{
+    addOrder(1, instrumentId1_);
+    StorageSnapshot::write(path_, 1, *WideDataStorage::instance(), *OrderStorage::instance());
+    const auto size = std::filesystem::file_size(path_);
+    {
+        std::fstream file(path_, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(size - 1));
+        file.put('\x7f');
+    }
+    NullObserver observer;
+    u64 sequence = 0;
+    EXPECT_THROW(StorageSnapshot::load(path_, &observer, &sequence), std::runtime_error);
+
+    std::filesystem::resize_file(path_, 16);
+    EXPECT_THROW(StorageSnapshot::load(path_, &observer, &sequence), std::runtime_error);
+}
+
+// =============================================================================
+// Snapshotter Tests
+// =============================================================================
+
+TEST_F(StorageSnapshotTest, RestartLoadsSnapshotAndReplaysJournal)
+{
+    LMDBStorageParams params;
+    params.journal_ = true;
+    NullObserver observer;
+    LMDBStorage storage(testDir_ + "/db", &observer, params);
+
+    StorageRecordDispatcher dispatcher;
+    dispatcher.init(nullptr, nullptr, &storage, nullptr);
+    WideParamsDataStorage wide;
+    wide.bindStorage(&dispatcher);
+    OrderDataStorage orders;
+
+    std::unique_ptr<InstrumentEntry> instr(new InstrumentEntry());
+    instr->symbol_ = "snapshotted";
+    instr->securityId_ = "SNP";
+    instr->securityIdSource_ = "ISIN";
+    wide.add(instr.release());
+
+    StorageSnapshotParams snapshotParams;
+    snapshotParams.path_ = path_;
+    StorageSnapshotter snapshotter(&storage, nullptr, &wide, &orders, snapshotParams);
+    EXPECT_EQ(storage.lastSequence(), snapshotter.takeSnapshot());
+    EXPECT_EQ(1u, snapshotter.totalSnapshots());
+
+    std::unique_ptr<AccountEntry> acct(new AccountEntry());
+    acct->account_ = "replayed";
+    acct->firm_ = "firm";
+    acct->type_ = PRINCIPAL_ACCOUNTTYPE;
+    wide.add(acct.release());
+
+    WideParamsDataStorage restored;
+    OrderDataStorage restoredOrders;
+    StorageRecovery recovery(&restored, &restoredOrders);
+    u64 sequence = 0;
+    recovery.startLoad();
+    ASSERT_TRUE(StorageSnapshot::load(path_, &recovery, &sequence));
+    EXPECT_EQ(storage.lastSequence(), storage.replay(sequence, &recovery));
+    recovery.finishLoad();
+
+    EXPECT_EQ(1u, instrumentCount(restored));
+    EXPECT_EQ(1u, accountCount(restored));
+    EXPECT_EQ(1u, recovery.recordCount(StorageRecordDispatcher::ACCOUNT_RECORDTYPE));
+}
+
+TEST_F(StorageSnapshotTest, SnapshotterRequiresStorages)
+{
+    OrderDataStorage orders;
+    StorageSnapshotParams params;
+    params.path_ = path_;
+    EXPECT_THROW(StorageSnapshotter(nullptr, nullptr, WideDataStorage::instance(), &orders, params),
+                 std::runtime_error);
+}
+
+} // namespace
@@ -111,11 +111,16 @@ protected:
     }
 
     // Helper to create a task manager with specified number of processors
-    std::unique_ptr<TaskManager> createTaskManager(int eventProcessors, int transactionProcessors)
+    std::unique_ptr<TaskManager> createTaskManager(
+        int eventProcessors, int transactionProcessors, u32 eventBatchSize = 1,
+        TaskManagerParams::ExecutionMode mode = TaskManagerParams::TASK_GROUP_EXECUTION, u32 transactionBatchSize = 1)
     {
         TaskManagerParams params;
         params.transactMgr_ = transMgr_.get();
         params.inQueues_ = inQueues_.get();
+        params.eventBatchSize_ = eventBatchSize;
+        params.transactionBatchSize_ = transactionBatchSize;
+        params.executionMode_ = mode;
 
         for (int i = 0; i < eventProcessors; ++i)
         {
@@ -196,6 +201,132 @@ TEST_F(TaskManagerTest, ProcessMultipleOrders)
     EXPECT_GE(outQueues_->execReportCount_.load(), numOrders);
 }
 
+TEST_F(TaskManagerTest, ProcessOrdersInBatches)
+{
+    auto manager = createTaskManager(2, 2, 8);
+
+    const int numOrders = 20;
+    for (int i = 0; i < numOrders; ++i)
+    {
+        auto order = createCorrectOrder(instrumentId1_);
+        assignClOrderId(order.get());
+        inQueues_->push("test", OrderEvent(order.release()));
+    }
+
+    EXPECT_TRUE(manager->waitUntilTransactionsFinished(10));
+    EXPECT_GE(outQueues_->execReportCount_.load(), numOrders);
+    EXPECT_EQ(0u, inQueues_->size());
+}
+
+TEST_F(TaskManagerTest, ProcessOrdersInTransactionBatches)
+{
+    auto manager = createTaskManager(2, 2, 8, TaskManagerParams::TASK_GROUP_EXECUTION, 16);
+
+    const int numOrders = 30;
+    for (int i = 0; i < numOrders; ++i)
+    {
+        auto order = createCorrectOrder(instrumentId1_);
+        assignClOrderId(order.get());
+        inQueues_->push("test", OrderEvent(order.release()));
+    }
+
+    EXPECT_TRUE(manager->waitUntilTransactionsFinished(10));
+    EXPECT_GE(outQueues_->execReportCount_.load(), numOrders);
+}
+
+// =============================================================================
+// Busy-Poll Execution Tests
+// =============================================================================
+
+TEST_F(TaskManagerTest, BusyPollStartsWorkerPerProcessorPair)
+{
+    auto manager = createTaskManager(3, 2, 1, TaskManagerParams::BUSY_POLL_EXECUTION);
+    EXPECT_EQ(TaskManagerParams::BUSY_POLL_EXECUTION, manager->executionMode());
+    EXPECT_EQ(2u, manager->busyPollWorkers());
+    EXPECT_TRUE(manager->waitUntilTransactionsFinished(0));
+}
+
+TEST_F(TaskManagerTest, BusyPollProcessesOrders)
+{
+    auto manager = createTaskManager(2, 2, 8, TaskManagerParams::BUSY_POLL_EXECUTION);
+
+    const int numOrders = 20;
+    for (int i = 0; i < numOrders; ++i)
+    {
+        auto order = createCorrectOrder(instrumentId1_);
+        assignClOrderId(order.get());
+        inQueues_->push("test", OrderEvent(order.release()));
+    }
+
+    EXPECT_TRUE(manager->waitUntilTransactionsFinished(10));
+    EXPECT_GE(outQueues_->execReportCount_.load(), numOrders);
+    EXPECT_EQ(0u, inQueues_->size());
+    EXPECT_GE(manager->transactionsFinished(), numOrders);
+}
+
+TEST_F(TaskManagerTest, BusyPollExecutesTransactionBatches)
+{
+    auto manager = createTaskManager(2, 2, 8, TaskManagerParams::BUSY_POLL_EXECUTION, 16);
+
+    const int numOrders = 40;
+    for (int i = 0; i < numOrders; ++i)
+    {
+        auto order = createCorrectOrder(instrumentId1_);
+        assignClOrderId(order.get());
+        order->side_ = (0 == i % 2) ? BUY_SIDE : SELL_SIDE;
+        inQueues_->push("test", OrderEvent(order.release()));
+    }
+
+    EXPECT_TRUE(manager->waitUntilTransactionsFinished(10));
+    EXPECT_GE(outQueues_->execReportCount_.load(), numOrders);
+    EXPECT_EQ(0u, inQueues_->size());
+    EXPECT_EQ(manager->transactionsCreated(), manager->transactionsFinished());
+}
+
+TEST_F(TaskManagerTest, BusyPollMatchesAfterWorkersParked)
+{
+    auto manager = createTaskManager(1, 1, 1, TaskManagerParams::BUSY_POLL_EXECUTION);
+    // let the worker run out of spins and park
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    auto sellOrder = createCorrectOrder(instrumentId1_);
+    assignClOrderId(sellOrder.get());
+    sellOrder->side_ = SELL_SIDE;
+    sellOrder->price_ = 10.0;
+    sellOrder->leavesQty_ = 100;
+    inQueues_->push("test", OrderEvent(sellOrder.release()));
+
+    auto buyOrder = createCorrectOrder(instrumentId1_);
+    assignClOrderId(buyOrder.get());
+    buyOrder->side_ = BUY_SIDE;
+    buyOrder->price_ = 10.0;
+    buyOrder->leavesQty_ = 100;
+    inQueues_->push("test", OrderEvent(buyOrder.release()));
+
+    EXPECT_TRUE(manager->waitUntilTransactionsFinished(10));
+    EXPECT_GE(outQueues_->execReportCount_.load(), 2);
+}
+
+TEST_F(TaskManagerTest, BusyPollRejectsWorkersWithoutProcessors)
+{
+    auto evntProc = std::make_unique<Processor>();
+    evntProc->init(*procParams_);
+    auto trProc = std::make_unique<Processor>();
+    trProc->init(*procParams_);
+
+    TaskManagerParams params;
+    params.transactMgr_ = transMgr_.get();
+    params.inQueues_ = inQueues_.get();
+    params.evntProcessors_.push_back(evntProc.get());
+    params.transactProcessors_.push_back(trProc.get());
+    params.executionMode_ = TaskManagerParams::BUSY_POLL_EXECUTION;
+    params.busyPollWorkers_ = 2;
+    EXPECT_THROW(TaskManager manager(params), std::runtime_error);
+
+    params.executionMode_ = TaskManagerParams::INVALID_EXECUTION;
+    EXPECT_THROW(TaskManager manager(params), std::runtime_error);
+}
+
 // =============================================================================
 // Buy/Sell Matching Tests
 // =============================================================================
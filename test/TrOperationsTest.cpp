@@ -23,11 +23,15 @@
 #include "OrderStorage.h"
 #include "DeferedEvents.h"
 #include "OrderMatcher.h"
+#include "IncomingQueues.h"
+#include "MockQueues.h"
+#include "SourceRegistry.h"
 
 using namespace COP;
 using namespace COP::ACID;
 using namespace COP::Store;
 using namespace COP::Proc;
+using namespace COP::Queues;
 using namespace test;
 
 namespace
@@ -464,4 +468,101 @@ TEST_F(ExecReportOperationTest, CreateReplaceExecReport_Rollback_IsNoOp)
     EXPECT_NO_THROW(op.rollback(ctx));
 }
 
+// =============================================================================
+// EnqueueOrderEventTrOperation - Re-enqueue Into a Full Ring
+// =============================================================================
+
+class NullInQueueProcessor : public InQueueProcessor
+{
+public:
+    bool process() override
+    {
+        return false;
+    }
+    u32 processBatch(u32) override
+    {
+        return 0;
+    }
+    void onEvent(const std::string &, const OrderEvent &) override {}
+    void onEvent(const std::string &, const OrderCancelEvent &) override {}
+    void onEvent(const std::string &, const OrderReplaceEvent &) override {}
+    void onEvent(const std::string &, const OrderChangeStateEvent &) override {}
+    void onEvent(const std::string &, const ProcessEvent &) override
+    {
+        ++processEvents_;
+    }
+    void onEvent(const std::string &, const TimerEvent &) override {}
+
+    u32 processEvents_ = 0;
+};
+
+class EnqueueOrderEventOperationTest : public OrderStorageFixture
+{
+protected:
+    void SetUp() override
+    {
+        OrderStorageFixture::SetUp();
+
+        instrumentId_ = test::addInstrument("ENQUEUE_TEST");
+
+        auto orderTemp = test::createCorrectOrder(instrumentId_);
+        test::assignClOrderId(orderTemp.get());
+        order_ = OrderStorage::instance()->save(*orderTemp, IdTGenerator::instance());
+    }
+
+    void TearDown() override
+    {
+        order_ = nullptr;
+        OrderStorageFixture::TearDown();
+    }
+
+protected:
+    SourceIdT instrumentId_;
+    OrderEntry *order_; // Owned by OrderStorage
+    testing::NiceMock<MockOutQueues> outQueues_;
+};
+
+TEST_F(EnqueueOrderEventOperationTest, Execute_RingFull_ReEnqueueDoesNotWait)
+{
+    IncomingQueues ring(IncomingQueues::RING_BUFFER_INGRESS, 2);
+    EXPECT_TRUE(ring.tryPush("source", OrderCancelEvent(IdT(1, 1))));
+    EXPECT_TRUE(ring.tryPush("source", OrderCancelEvent(IdT(2, 1))));
+    ASSERT_TRUE(ring.full());
+
+    Context ctx(OrderStorage::instance(), nullptr, &ring, &outQueues_, nullptr, IdTGenerator::instance());
+    EnqueueOrderEventTrOperation<OrdState::onReplaceRejected> op(*order_,
+                                                                 OrdState::onReplaceRejected(order_->orderId_));
+    op.execute(ctx);
+
+    EXPECT_EQ(1u, ring.overflowCount());
+    EXPECT_EQ(3u, ring.size());
+
+    NullInQueueProcessor processor;
+    EXPECT_EQ(3u, ring.popBatch(&processor, 16));
+    EXPECT_EQ(1u, processor.processEvents_);
+    EXPECT_EQ(0u, ring.size());
+}
+
+TEST_F(EnqueueOrderEventOperationTest, Execute_PassesRegistryOwnedSourceAndTarget)
+{
+    SourceRegistry *registry = SourceRegistry::instance();
+    const std::string &internal = registry->name(registry->intern("_"));
+    const std::string &target = registry->name(registry->intern(order_->source_.get()));
+
+    testing::NiceMock<MockInQueues> inQueues;
+    EXPECT_CALL(inQueues, push(testing::Ref(internal), testing::A<const ProcessEvent &>())).Times(2);
+    EXPECT_CALL(outQueues_, push(testing::A<const ExecReportEvent &>(), testing::Ref(target))).Times(2);
+    EXPECT_EQ(INVALID_SOURCE_HANDLE, order_->sourceHandle_);
+
+    Context ctx(OrderStorage::instance(), nullptr, &inQueues, &outQueues_, nullptr, IdTGenerator::instance());
+    EnqueueOrderEventTrOperation<OrdState::onReplaceRejected> op(*order_,
+                                                                 OrdState::onReplaceRejected(order_->orderId_));
+    op.execute(ctx);
+    const SourceHandle handle = order_->sourceHandle_;
+    EXPECT_NE(INVALID_SOURCE_HANDLE, handle);
+
+    op.execute(ctx);
+    EXPECT_EQ(handle, order_->sourceHandle_);
+}
+
 } // namespace
@@ -12,7 +12,9 @@
 #include <gtest/gtest.h>
 #include <thread>
 #include <vector>
+#include <set>
 #include <atomic>
+#include <mutex>
 
 #include "TestFixtures.h"
 #include "TestAux.h"
@@ -35,7 +37,9 @@ namespace
 class TestTransaction : public Transaction
 {
 public:
-    TestTransaction() : id_(), executed_(false), rolledBack_(false) {}
+    TestTransaction() : id_(), object_(), executed_(false), rolledBack_(false) {}
+    /// transaction that depends on the order object
+    explicit TestTransaction(const IdT &object) : id_(), object_(object), executed_(false), rolledBack_(false) {}
 
     const TransactionId &transactionId() const override
     {
@@ -51,6 +55,11 @@ public:
         if (obj)
         {
             obj->size_ = 0;
+            if (object_.isValid())
+            {
+                obj->list_[0] = ObjectInTransaction(order_ObjectType, object_);
+                obj->size_ = 1;
+            }
         }
     }
 
@@ -71,6 +80,7 @@ public:
 
 private:
     TransactionId id_;
+    IdT object_;
     bool executed_;
     bool rolledBack_;
 };
@@ -334,4 +344,154 @@ TEST_F(TransactionMgrTest, ObserverNotifiedOnReady)
     transMgr_->detach();
 }
 
+// =============================================================================
+// Ready Queue Tests
+// =============================================================================
+
+TEST_F(TransactionMgrTest, NextDispensesReadyTransactionsOnce)
+{
+    std::unique_ptr<Transaction> first = std::make_unique<TestTransaction>();
+    std::unique_ptr<Transaction> second = std::make_unique<TestTransaction>();
+    Transaction *firstPtr = first.get();
+    Transaction *secondPtr = second.get();
+    transMgr_->addTransaction(first);
+    transMgr_->addTransaction(second);
+
+    TransactionIterator *iter = transMgr_->iterator();
+    TransactionId id;
+    Transaction *tr = nullptr;
+    ASSERT_TRUE(iter->next(&id, &tr));
+    EXPECT_EQ(firstPtr, tr);
+    EXPECT_EQ(firstPtr->transactionId(), id);
+    ASSERT_TRUE(iter->next(&id, &tr));
+    EXPECT_EQ(secondPtr, tr);
+    EXPECT_FALSE(iter->next(&id, &tr));
+
+    TransactionId currentId;
+    Transaction *current = nullptr;
+    EXPECT_TRUE(iter->isValid());
+    ASSERT_TRUE(iter->get(&currentId, &current));
+    EXPECT_EQ(secondPtr, current);
+
+    EXPECT_TRUE(transMgr_->removeTransaction(firstPtr->transactionId(), firstPtr));
+    EXPECT_TRUE(transMgr_->removeTransaction(id, secondPtr));
+    EXPECT_FALSE(iter->isValid());
+}
+
+TEST_F(TransactionMgrTest, DependentTransactionReadyAfterParentRemoved)
+{
+    const IdT order(42, 20260119);
+    std::unique_ptr<Transaction> parent = std::make_unique<TestTransaction>(order);
+    std::unique_ptr<Transaction> child = std::make_unique<TestTransaction>(order);
+    Transaction *parentPtr = parent.get();
+    Transaction *childPtr = child.get();
+    transMgr_->addTransaction(parent);
+    transMgr_->addTransaction(child);
+
+    TransactionIterator *iter = transMgr_->iterator();
+    TransactionId id;
+    Transaction *tr = nullptr;
+    ASSERT_TRUE(iter->next(&id, &tr));
+    EXPECT_EQ(parentPtr, tr);
+    EXPECT_FALSE(iter->next(&id, &tr));
+
+    EXPECT_TRUE(transMgr_->removeTransaction(id, parentPtr));
+    ASSERT_TRUE(iter->next(&id, &tr));
+    EXPECT_EQ(childPtr, tr);
+    EXPECT_TRUE(transMgr_->removeTransaction(id, childPtr));
+}
+
+TEST_F(TransactionMgrTest, NextBatchStopsAtMaxSize)
+{
+    for (int i = 0; i < 5; ++i)
+    {
+        std::unique_ptr<Transaction> txn = std::make_unique<TestTransaction>(IdT(100 + i, 20260119));
+        transMgr_->addTransaction(txn);
+    }
+
+    TransactionIterator *iter = transMgr_->iterator();
+    TransactionBatchT batch;
+    EXPECT_EQ(3u, iter->nextBatch(3, &batch));
+    EXPECT_EQ(2u, iter->nextBatch(3, &batch));
+    ASSERT_EQ(5u, batch.size());
+    EXPECT_EQ(0u, iter->nextBatch(3, &batch));
+    EXPECT_TRUE(iter->isValid());
+    EXPECT_EQ(5u, transMgr_->removeTransactions(batch));
+    EXPECT_FALSE(iter->isValid());
+}
+
+TEST_F(TransactionMgrTest, RemoveBatchNotifiesObserverOnce)
+{
+    TestTransactionObserver observer;
+    const IdT order1(42, 20260119), order2(43, 20260119);
+    std::unique_ptr<Transaction> parent1 = std::make_unique<TestTransaction>(order1);
+    std::unique_ptr<Transaction> parent2 = std::make_unique<TestTransaction>(order2);
+    std::unique_ptr<Transaction> child1 = std::make_unique<TestTransaction>(order1);
+    std::unique_ptr<Transaction> child2 = std::make_unique<TestTransaction>(order2);
+    Transaction *child1Ptr = child1.get();
+    Transaction *child2Ptr = child2.get();
+    transMgr_->addTransaction(parent1);
+    transMgr_->addTransaction(parent2);
+    transMgr_->addTransaction(child1);
+    transMgr_->addTransaction(child2);
+
+    TransactionIterator *iter = transMgr_->iterator();
+    TransactionBatchT batch;
+    ASSERT_EQ(2u, iter->nextBatch(16, &batch));
+
+    transMgr_->attach(&observer);
+    EXPECT_EQ(2u, transMgr_->removeTransactions(batch));
+    EXPECT_EQ(1, observer.readyCount());
+
+    batch.clear();
+    ASSERT_EQ(2u, iter->nextBatch(16, &batch));
+    EXPECT_EQ(child1Ptr, batch[0].tr_);
+    EXPECT_EQ(child2Ptr, batch[1].tr_);
+    EXPECT_EQ(2u, transMgr_->removeTransactions(batch));
+    transMgr_->detach();
+}
+
+TEST_F(TransactionMgrTest, ConcurrentNextDispensesEachTransactionOnce)
+{
+    const int numTransactions = 400;
+    for (int i = 0; i < numTransactions; ++i)
+    {
+        std::unique_ptr<Transaction> txn = std::make_unique<TestTransaction>();
+        transMgr_->addTransaction(txn);
+    }
+
+    std::mutex lock;
+    std::set<Transaction *> dispensed;
+    std::atomic<int> duplicates{ 0 };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back(
+            [this, &lock, &dispensed, &duplicates]()
+            {
+                TransactionIterator *iter = transMgr_->iterator();
+                TransactionId id;
+                Transaction *tr = nullptr;
+                while (iter->next(&id, &tr))
+                {
+                    {
+                        std::lock_guard<std::mutex> guard(lock);
+                        if (!dispensed.insert(tr).second)
+                        {
+                            ++duplicates;
+                        }
+                    }
+                    transMgr_->removeTransaction(id, tr);
+                }
+            });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(0, duplicates.load());
+    EXPECT_EQ(static_cast<size_t>(numTransactions), dispensed.size());
+}
+
 } // namespace
@@ -17,6 +17,7 @@
 #include "TestFixtures.h"
 #include "TestAux.h"
 #include "WideDataStorage.h"
+#include "WideDataLazyRef.h"
 
 using namespace COP;
 using namespace COP::Store;
@@ -388,4 +389,204 @@ TEST_F(WideDataStorageTest, AddClearingHelper)
     EXPECT_EQ("ClearFirm", retrieved.firm_);
 }
 
+// =============================================================================
+// Lazy Reference Tests
+// =============================================================================
+
+TEST_F(WideDataStorageTest, LocateReturnsStoredEntry)
+{
+    auto instr = new InstrumentEntry();
+    instr->symbol_ = "MSFT";
+    SourceIdT id = storage()->add(instr);
+
+    const InstrumentEntry *located = nullptr;
+    storage()->locate(id, &located);
+    EXPECT_EQ(instr, located);
+
+    const AccountEntry *account = nullptr;
+    EXPECT_THROW(storage()->locate(id, &account), std::runtime_error);
+}
+
+TEST_F(WideDataStorageTest, LazyRefCopiesShareStoredEntry)
+{
+    SourceIdT id = addInstrument("IBM", "US4592001014", "ISIN");
+    WideDataLazyRef<InstrumentEntry> ref(id);
+    WideDataLazyRef<InstrumentEntry> unresolved(ref);
+
+    const InstrumentEntry &entry = ref.get();
+    EXPECT_EQ("IBM", entry.symbol_);
+    WideDataLazyRef<InstrumentEntry> resolved(ref);
+    EXPECT_EQ(&entry, &resolved.get());
+    EXPECT_EQ(&entry, &unresolved.get());
+
+    WideDataLazyRef<InstrumentEntry> unknown(SourceIdT(9999, 1));
+    EXPECT_THROW(unknown.get(), std::runtime_error);
+}
+
+TEST_F(WideDataStorageTest, LazyRefResolvedConcurrently)
+{
+    ExecutionsT *execs = new ExecutionsT();
+    SourceIdT id = storage()->add(execs);
+    WideDataLazyRef<ExecutionsT *> ref(id);
+
+    std::atomic<int> matched{ 0 };
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i)
+    {
+        readers.emplace_back(
+            [&]()
+            {
+                if (execs == ref.get())
+                {
+                    ++matched;
+                }
+            });
+    }
+    for (auto &reader : readers)
+    {
+        reader.join();
+    }
+    EXPECT_EQ(4, matched.load());
+}
+
+// =============================================================================
+// Snapshot and Shard Tests
+// =============================================================================
+
+TEST_F(WideDataStorageTest, ReferenceDataVisibleToConcurrentReaders)
+{
+    const int numInstruments = 200;
+    std::atomic<int> published{ 0 };
+    std::atomic<bool> failed{ false };
+
+    std::thread reader(
+        [&]()
+        {
+            int seen = 0;
+            while (seen < numInstruments)
+            {
+                seen = published.load(std::memory_order_acquire);
+                for (int i = 0; i < seen; i += 3)
+                {
+                    if (!storage()->findInstrumentBySymbol("SYM" + std::to_string(i)).isValid())
+                    {
+                        failed = true;
+                    }
+                }
+            }
+        });
+    for (int i = 0; i < numInstruments; ++i)
+    {
+        addInstrument("SYM" + std::to_string(i), "SEC", "ISIN");
+        published.store(i + 1, std::memory_order_release);
+    }
+    reader.join();
+    EXPECT_FALSE(failed.load());
+
+    int count = 0;
+    storage()->forEachInstrument([&count](const SourceIdT &, const InstrumentEntry &) { ++count; });
+    EXPECT_EQ(numInstruments, count);
+}
+
+TEST_F(WideDataStorageTest, ReplacedSnapshotOutlivesPinnedReader)
+{
+    addInstrument("AAA", "SEC", "ISIN");
+    std::atomic<bool> visiting{ false };
+    std::atomic<bool> visited{ false };
+    std::atomic<bool> addedBeforeVisited{ false };
+
+    std::thread writer(
+        [&]()
+        {
+            while (!visiting.load())
+            {
+                std::this_thread::yield();
+            }
+            // returns once the replaced snapshot is freed, after the visit ends
+            addInstrument("BBB", "SEC", "ISIN");
+            addedBeforeVisited = !visited.load();
+        });
+    storage()->forEachInstrument(
+        [&](const SourceIdT &, const InstrumentEntry &instr)
+        {
+            visiting = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            EXPECT_NE("BBB", instr.symbol_);
+            visited = true;
+        });
+    writer.join();
+
+    EXPECT_FALSE(addedBeforeVisited.load());
+    EXPECT_TRUE(storage()->findInstrumentBySymbol("BBB").isValid());
+}
+
+TEST_F(WideDataStorageTest, RestoredReferenceDataVisibleAfterLoad)
+{
+    storage()->startRestore();
+    for (u64 i = 0; i < 50; ++i)
+    {
+        auto acct = new AccountEntry();
+        acct->account_ = "ACC" + std::to_string(i);
+        acct->id_ = IdT(1000 + i, 1);
+        storage()->restore(acct);
+    }
+    // published once, when the restore finishes
+    EXPECT_FALSE(storage()->findAccountByName("ACC49").isValid());
+    storage()->finishRestore();
+    EXPECT_EQ(IdT(1049, 1), storage()->findAccountByName("ACC49"));
+
+    // ids allocated after the load follow the restored ones
+    SourceIdT id = addAccount("NEW", "FIRM", AGENCY_ACCOUNTTYPE);
+    EXPECT_LT(1049u, id.id_);
+    int count = 0;
+    storage()->forEachAccount([&count](const SourceIdT &, const AccountEntry &) { ++count; });
+    EXPECT_EQ(51, count);
+}
+
+TEST_F(WideDataStorageTest, PerOrderDataAddedConcurrently)
+{
+    const int numThreads = 4;
+    const int perThread = 100;
+    std::vector<std::vector<SourceIdT>> ids(numThreads);
+    std::vector<std::thread> writers;
+    for (int t = 0; t < numThreads; ++t)
+    {
+        writers.emplace_back(
+            [&, t]()
+            {
+                for (int i = 0; i < perThread; ++i)
+                {
+                    const std::string val = std::to_string(t) + ":" + std::to_string(i);
+                    ids[t].push_back(storage()->add(new StringT(val)));
+                    ids[t].push_back(storage()->add(new RawDataEntry(STRING_RAWDATATYPE, val.c_str(),
+                                                                     static_cast<u32>(val.size()))));
+                }
+            });
+    }
+    for (auto &writer : writers)
+    {
+        writer.join();
+    }
+
+    for (int t = 0; t < numThreads; ++t)
+    {
+        for (int i = 0; i < perThread; ++i)
+        {
+            const std::string val = std::to_string(t) + ":" + std::to_string(i);
+            StringT str;
+            storage()->get(ids[t][2 * i], &str);
+            EXPECT_EQ(val, str);
+            RawDataEntry raw;
+            storage()->get(ids[t][2 * i + 1], &raw);
+            EXPECT_EQ(val, std::string(raw.data_, raw.length_));
+        }
+    }
+    int strings = 0;
+    storage()->forEachString([&strings](const SourceIdT &, const StringT &) { ++strings; });
+    EXPECT_EQ(numThreads * perThread, strings);
+    int raws = 0;
+    storage()->forEachRawData([&raws](const SourceIdT &, const RawDataEntry &) { ++raws; });
+    EXPECT_EQ(numThreads * perThread, raws);
+}
+
 } // namespace
@@ -54,6 +54,7 @@ class MockOrderBook : public COP::OrderBook
 public:
     MOCK_METHOD(void, add, (const COP::OrderEntry &order), (override));
     MOCK_METHOD(void, remove, (const COP::OrderEntry &order), (override));
+    MOCK_METHOD(void, update, (const COP::OrderEntry &order), (override));
     MOCK_METHOD(IdT, find, (const COP::OrderFunctor &functor), (const, override));
     MOCK_METHOD(void, findAll, (const COP::OrderFunctor &functor, OrdersT *result), (const, override));
     MOCK_METHOD(IdT, getTop, (const SourceIdT &instrument, const COP::Side &side), (const, override));
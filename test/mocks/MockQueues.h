@@ -40,6 +40,7 @@ class MockInQueueProcessor : public COP::Queues::InQueueProcessor
 {
 public:
     MOCK_METHOD(bool, process, (), (override));
+    MOCK_METHOD(u32, processBatch, (u32 maxEvents), (override));
     MOCK_METHOD(void, onEvent, (const std::string &source, const COP::Queues::OrderEvent &evnt), (override));
     MOCK_METHOD(void, onEvent, (const std::string &source, const COP::Queues::OrderCancelEvent &evnt), (override));
     MOCK_METHOD(void, onEvent, (const std::string &source, const COP::Queues::OrderReplaceEvent &evnt), (override));
@@ -77,6 +78,7 @@ public:
     MOCK_METHOD(bool, top, (COP::Queues::InQueueProcessor * obs), (override));
     MOCK_METHOD(bool, pop, (), (override));
     MOCK_METHOD(bool, pop, (COP::Queues::InQueueProcessor * obs), (override));
+    MOCK_METHOD(u32, popBatch, (COP::Queues::InQueueProcessor * obs, u32 maxEvents), (override));
     MOCK_METHOD(COP::Queues::InQueuesObserver *, attach, (COP::Queues::InQueuesObserver * obs), (override));
     MOCK_METHOD(COP::Queues::InQueuesObserver *, detach, (), (override));
 };